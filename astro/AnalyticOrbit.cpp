@@ -0,0 +1,1036 @@
+#include "AnalyticOrbit.h"
+#include "Parallel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+// References:
+// [1]  D. A. Vallado, P. Crawford, R. Hujsak and T. S. Kelso, "Revisiting
+//      Spacetrack Report #3", AIAA 2006-6753 (2006)
+// [2]  F. R. Hoots and R. L. Roehrich, "Models for Propagation of NORAD
+//      Element Sets", Spacetrack Report No. 3 (1980)
+// [3]  D. Brouwer, "Solution of the problem of artificial satellite theory
+//      without drag", Astronomical Journal 64 (1959)
+// [4]  R. H. Lyddane, "Small eccentricities or inclinations in the Brouwer
+//      theory of the artificial satellite", Astronomical Journal 68 (1963)
+
+namespace astro {
+
+// WGS-72, the constants of the element sets [1]
+static const double WGS72_MU = 398600.8;   // [km^3/s^2]
+static const double WGS72_RE = 6378.135;   // [km]
+static const double WGS72_J2 = 0.001082616;
+static const double WGS72_J3 = -0.00000253881;
+static const double WGS72_J4 = -0.00000165597;
+static const double WGS72_XKE = 60.0 / std::sqrt(WGS72_RE * WGS72_RE * WGS72_RE / WGS72_MU); // [1/min]
+
+static const double X2O3 = 2.0 / 3.0;
+
+static ZonalPeriodics zonalPeriodics(double j2, double j3, double cosio, double sinio)
+{
+    double j3oj2 = j3 / j2;
+    double cosio2 = cosio * cosio;
+
+    ZonalPeriodics k;
+    k.j2     = j2;
+    k.aycof  = -0.5 * j3oj2 * sinio;
+    // Avoid the division by zero for retrograde equatorial orbits
+    double den = (std::abs(cosio + 1.0) > 1.5E-12) ? 1.0 + cosio : 1.5E-12;
+    k.xlcof  = -0.25 * j3oj2 * sinio * (3.0 + 5.0 * cosio) / den;
+    k.con41  = 3.0 * cosio2 - 1.0;
+    k.x1mth2 = 1.0 - cosio2;
+    k.x7thm1 = 7.0 * cosio2 - 1.0;
+    k.sinio  = sinio;
+    k.cosio  = cosio;
+    return k;
+}
+
+// Position and velocity from the mean elements at a time, with the long-period
+// J3 and short-period J2 terms, [1] sgp4. Units of the body radius, and xke is
+// the mean motion at the radius of the body in the time unit of nm. Returns
+// false if the semi-latus rectum is negative
+static bool periodicState(double am, double em, double inclm, double nodem, double argpm, double mm, double nm,
+                          double xke, const ZonalPeriodics& k, Vec3& r, Vec3& v)
+{
+    double sinim = k.sinio;
+    double cosim = k.cosio;
+
+    // Long-period terms, in the Lyddane variables
+    double axnl = em * std::cos(argpm);
+    double temp = 1.0 / (am * (1.0 - em * em));
+    double aynl = em * std::sin(argpm) + temp * k.aycof;
+    double xl   = mm + argpm + nodem + temp * k.xlcof * axnl;
+
+    // Kepler's equation for the eccentric longitude
+    double u   = std::fmod(xl - nodem, TWOPI);
+    double eo1 = u;
+    double tem5 = 9999.9;
+    double sineo1 = 0.0, coseo1 = 0.0;
+    for (int ktr = 1; std::abs(tem5) >= 1.0E-12 && ktr <= 10; ++ktr)
+    {
+        sineo1 = std::sin(eo1);
+        coseo1 = std::cos(eo1);
+        tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (std::abs(tem5) >= 0.95)
+            tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        eo1 += tem5;
+    }
+
+    // Short-period terms
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2   = axnl * axnl + aynl * aynl;
+    double pl    = am * (1.0 - el2);
+    if (pl < 0.0)
+        return false;
+
+    double rl     = am * (1.0 - ecose);
+    double rdotl  = std::sqrt(am) * esine / rl;
+    double rvdotl = std::sqrt(pl) / rl;
+    double betal  = std::sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su   = std::atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    double temp1 = 0.5 * k.j2 * temp;
+    double temp2 = temp1 * temp;
+
+    double mrt   = rl * (1.0 - 1.5 * temp2 * betal * k.con41) + 0.5 * temp1 * k.x1mth2 * cos2u;
+    su           = su - 0.25 * temp2 * k.x7thm1 * sin2u;
+    double xnode = nodem + 1.5 * temp2 * cosim * sin2u;
+    double xinc  = inclm + 1.5 * temp2 * cosim * sinim * cos2u;
+    double mvt   = rdotl - nm * temp1 * k.x1mth2 * sin2u / xke;
+    double rvdot = rvdotl + nm * temp1 * (k.x1mth2 * cos2u + 1.5 * k.con41) / xke;
+
+    // Orientation vectors
+    double sinsu = std::sin(su);
+    double cossu = std::cos(su);
+    double snod  = std::sin(xnode);
+    double cnod  = std::cos(xnode);
+    double sini  = std::sin(xinc);
+    double cosi  = std::cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy =  cnod * cosi;
+    Vec3 uu(xmx * sinsu + cnod * cossu, xmy * sinsu + snod * cossu, sini * sinsu);
+    Vec3 vv(xmx * cossu - cnod * sinsu, xmy * cossu - snod * sinsu, sini * cossu);
+
+    r = mrt * uu;
+    v = mvt * uu + rvdot * vv;
+    return true;
+}
+
+// ── TLE ──────────────────────────────────────────────────────────────────────
+
+static std::string trim(const std::string& s)
+{
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+        return std::string();
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+// Columns first..last, 1-based as in the format
+static std::string field(const std::string& line, size_t first, size_t last)
+{
+    return line.substr(first - 1, last - first + 1);
+}
+
+static double number(const std::string& line, size_t first, size_t last)
+{
+    std::string f = trim(field(line, first, last));
+    try
+    {
+        size_t pos = 0;
+        double x = std::stod(f, &pos);
+        if (pos != f.size())
+            throw AstroException("Malformed number in TLE: " + f);
+        return x;
+    }
+    catch (const std::logic_error&)
+    {
+        throw AstroException("Malformed number in TLE: " + f);
+    }
+}
+
+// Fields with an assumed leading decimal point and an exponent, e.g.
+// " 28098-4" for 0.28098E-4
+static double exponential(const std::string& line, size_t first, size_t last)
+{
+    std::string f = trim(field(line, first, last));
+    if (f.empty())
+        return 0.0;
+    double sign = 1.0;
+    if (f[0] == '-' || f[0] == '+')
+    {
+        sign = (f[0] == '-') ? -1.0 : 1.0;
+        f = f.substr(1);
+    }
+    size_t e = f.find_first_of("+-", 1);
+    if (e == std::string::npos)
+        throw AstroException("Malformed exponent field in TLE: " + f);
+    std::string mantissa = trim(f.substr(0, e));
+    std::string exponent = f.substr(e);
+    try
+    {
+        return sign * std::stod("0." + mantissa) * std::pow(10.0, std::stoi(exponent));
+    }
+    catch (const std::logic_error&)
+    {
+        throw AstroException("Malformed exponent field in TLE: " + f);
+    }
+}
+
+static void checkLine(const std::string& line, char lineNumber)
+{
+    if (line.size() < 69 || line[0] != lineNumber || line[1] != ' ')
+        throw AstroException(std::string("Malformed TLE line ") + lineNumber + ": " + line);
+
+    // The sum of the digits, with 1 for each minus sign, modulo 10
+    int sum = 0;
+    for (size_t c = 0; c < 68; ++c)
+    {
+        if (line[c] >= '0' && line[c] <= '9')
+            sum += line[c] - '0';
+        else if (line[c] == '-')
+            sum += 1;
+    }
+    if (line[68] - '0' != sum % 10)
+        throw AstroException(std::string("Wrong checksum of TLE line ") + lineNumber + ": " + line);
+}
+
+TLE TLE::parse(const std::string& _line1, const std::string& _line2, const std::string& name)
+{
+    std::string line1 = _line1.substr(0, _line1.find_last_not_of(" \r\n") + 1);
+    std::string line2 = _line2.substr(0, _line2.find_last_not_of(" \r\n") + 1);
+    checkLine(line1, '1');
+    checkLine(line2, '2');
+
+    TLE tle;
+    tle.name           = trim(name);
+    tle.satnum         = static_cast<int>(number(line1, 3, 7));
+    tle.classification = line1[7];
+    tle.designator     = trim(field(line1, 10, 17));
+    if (static_cast<int>(number(line2, 3, 7)) != tle.satnum)
+        throw AstroException("The lines of a TLE are for different satellites");
+
+    // Two-digit years from 1957, and the day of the year with its fraction
+    int year = static_cast<int>(number(line1, 19, 20));
+    year += (year < 57) ? 2000 : 1900;
+    double day = number(line1, 21, 32);
+    int    doy = static_cast<int>(day);
+    long long us = std::llround((day - doy) * 86400.0E6);
+    us = std::min(us, 86400000000LL - 1);
+    char iso[64];
+    std::snprintf(iso, sizeof(iso), "%04d-%03dT%02lld:%02lld:%02lld.%06lld", year, doy,
+                  us / 3600000000LL, us / 60000000LL % 60, us / 1000000LL % 60, us % 1000000LL);
+    tle.epoch = EphemerisTime::fromString(iso);
+
+    tle.ndot  = number(line1, 34, 43);
+    tle.nddot = exponential(line1, 45, 52);
+    tle.bstar = exponential(line1, 54, 61);
+
+    tle.i    = number(line2, 9, 16) * RADPERDEG;
+    tle.raan = number(line2, 18, 25) * RADPERDEG;
+    std::string ecc = trim(field(line2, 27, 33));
+    if (ecc.empty() || ecc.find_first_not_of("0123456789") != std::string::npos)
+        throw AstroException("Malformed eccentricity in TLE: " + ecc);
+    tle.e    = std::stod("0." + ecc);
+    tle.w    = number(line2, 35, 42) * RADPERDEG;
+    tle.M    = number(line2, 44, 51) * RADPERDEG;
+    tle.n    = number(line2, 53, 63);
+    tle.revs = static_cast<int>(number(line2, 64, 68));
+    return tle;
+}
+
+std::vector<TLE> TLE::parse(std::istream& is)
+{
+    std::vector<TLE> res;
+    std::string line, name, line1;
+    while (std::getline(is, line))
+    {
+        if (trim(line).empty())
+            continue;
+        if (line.size() > 1 && line[0] == '1' && line[1] == ' ' && line1.empty())
+            line1 = line;
+        else if (line.size() > 1 && line[0] == '2' && line[1] == ' ' && !line1.empty())
+        {
+            res.push_back(parse(line1, line, name));
+            line1.clear();
+            name.clear();
+        }
+        else if (line1.empty())
+        {
+            // A title line, "0 " in the three-line format
+            name = (line.size() > 1 && line[0] == '0' && line[1] == ' ') ? line.substr(2) : line;
+        }
+        else
+            throw AstroException("TLE line 1 not followed by line 2: " + line1);
+    }
+    if (!line1.empty())
+        throw AstroException("TLE line 1 not followed by line 2: " + line1);
+    return res;
+}
+
+// ── MeanElementOrbit ─────────────────────────────────────────────────────────
+
+MeanElementOrbit::MeanElementOrbit(const OrbitElements& mean, double _re, double J2, double J3)
+    : oe(mean), re(_re)
+{
+    oe.computeDerivedQuantities();
+    if (oe.e >= 1.0)
+        throw AstroException("Mean element model needs an elliptic orbit");
+    if (re <= 0.0 || J2 <= 0.0)
+        throw AstroException("Mean element model needs a positive radius and J2");
+
+    xke = std::sqrt(oe.mu / (re * re * re));
+    am  = oe.a / re;
+    nm  = xke / (am * std::sqrt(am));
+
+    double cosio  = std::cos(oe.i);
+    double cosio2 = cosio * cosio;
+    double omeosq = 1.0 - oe.e * oe.e;
+    double p      = am * omeosq;
+    k = zonalPeriodics(J2, J3, cosio, std::sin(oe.i));
+
+    // First order secular rates [3]
+    double temp1 = 1.5 * J2 * nm / (p * p);
+    mdot    = nm + 0.5 * temp1 * std::sqrt(omeosq) * k.con41;
+    argpdot = -0.5 * temp1 * (1.0 - 5.0 * cosio2);
+    nodedot = -temp1 * cosio;
+}
+
+MeanElementOrbit::~MeanElementOrbit()
+{
+
+}
+
+MeanElementOrbit MeanElementOrbit::fromStateVector(const PosState& s, const EphemerisTime& epoch, double mu,
+                                                   double re, double J2, double J3)
+{
+    // Corrects the mean state by the error of the osculating state, which
+    // converges as the periodic terms are small
+    PosState mean = s;
+    MeanElementOrbit orbit(OrbitElements::fromStateVectorOE(mean, epoch, mu), re, J2, J3);
+    for (int it = 0; it < 50; ++it)
+    {
+        PosState osc = orbit.state(epoch);
+        Vec3 dr = s.r - osc.r;
+        Vec3 dv = s.v - osc.v;
+        if (glm::length(dr) < 1.0E-6 && glm::length(dv) * glm::length(s.r) / glm::length(s.v) < 1.0E-6)
+            return orbit;
+
+        mean.r += dr;
+        mean.v += dv;
+        orbit = MeanElementOrbit(OrbitElements::fromStateVectorOE(mean, epoch, mu), re, J2, J3);
+    }
+    throw AstroException("Mean elements from the state vector did not converge");
+}
+
+PosState MeanElementOrbit::getState(const EphemerisTime& et)
+{
+    return state(et);
+}
+
+PosState MeanElementOrbit::state(const EphemerisTime& et) const
+{
+    double t = (et - oe.epoch).value;
+    double mm    = oe.M0 + mdot * t;
+    double argpm = oe.w + argpdot * t;
+    double nodem = oe.omega + nodedot * t;
+
+    PosState s;
+    if (!periodicState(am, oe.e, oe.i, nodem, argpm, mm, nm, xke, k, s.r, s.v))
+        throw AstroException("Mean element model: negative semi-latus rectum");
+    s.r *= re;
+    s.v *= re * xke;
+    return s;
+}
+
+const OrbitElements& MeanElementOrbit::getMeanElements() const
+{
+    return oe;
+}
+
+void MeanElementOrbit::getStates(const std::vector<MeanElementOrbit>& catalog, const EphemerisTime& et,
+                                 std::vector<PosState>& out, unsigned int threads)
+{
+    out.resize(catalog.size());
+    parallelFor(catalog.size(), [&](size_t i) {
+        out[i] = catalog[i].state(et);
+    }, threads, 1024);
+}
+
+// ── Deep space ───────────────────────────────────────────────────────────────
+
+// Greenwich mean sidereal angle of a UT1 julian date, IAU-82 [rad]
+static double gstime(double jdut1)
+{
+    double tut1 = (jdut1 - 2451545.0) / 36525.0;
+    double temp = -6.2E-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                  (876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841; // [s]
+    temp = std::fmod(temp * RADPERDEG / 240.0, TWOPI);
+    return temp < 0.0 ? temp + TWOPI : temp;
+}
+
+// Lunar-solar terms and resonance coefficients of the mean elements at the
+// epoch, days from 1950 January 0.0 UTC. [1] dscom and dsinit, at tc = 0
+static DeepSpaceTerms deepSpaceTerms(double epoch, double ecco, double inclo, double nodeo, double argpo,
+                                     double mo, double no, double mdot, double argpdot, double nodedot)
+{
+    const double zes = 0.01675, zel = 0.05490;
+    const double c1ss = 2.9864797E-6, c1l = 4.7968065E-7;
+    const double zsinis = 0.39785416, zcosis = 0.91744867;
+    const double zcosgs = 0.1945905, zsings = -0.98088458;
+    const double zns = 1.19459E-5, znl = 1.5835218E-4;
+
+    DeepSpaceTerms d;
+    d.gsto = gstime(epoch + 2433281.5);
+
+    double snodm  = std::sin(nodeo);
+    double cnodm  = std::cos(nodeo);
+    double sinomm = std::sin(argpo);
+    double cosomm = std::cos(argpo);
+    double sinim  = std::sin(inclo);
+    double cosim  = std::cos(inclo);
+    double emsq   = ecco * ecco;
+    double betasq = 1.0 - emsq;
+    double rtemsq = std::sqrt(betasq);
+
+    // The orbit of the moon at the epoch
+    double day    = epoch + 18261.5;
+    double xnodce = std::fmod(4.5236020 - 9.2422029E-4 * day, TWOPI);
+    double stem   = std::sin(xnodce);
+    double ctem   = std::cos(xnodce);
+    double zcosil = 0.91375164 - 0.03568096 * ctem;
+    double zsinil = std::sqrt(1.0 - zcosil * zcosil);
+    double zsinhl = 0.089683511 * stem / zsinil;
+    double zcoshl = std::sqrt(1.0 - zsinhl * zsinhl);
+    double gam    = 5.8351514 + 0.0019443680 * day;
+    double zx     = 0.39785416 * stem / zsinil;
+    double zy     = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+    zx = gam + std::atan2(zx, zy) - xnodce;
+    double zcosgl = std::cos(zx);
+    double zsingl = std::sin(zx);
+
+    // The sun first, then the moon
+    double zcosg = zcosgs, zsing = zsings, zcosi = zcosis, zsini = zsinis;
+    double zcosh = cnodm, zsinh = snodm;
+    double cc    = c1ss;
+    double xnoi  = 1.0 / no;
+    double s[8] = {}, z[4][4] = {}, ss[8] = {}, sz[4][4] = {};
+    for (int lsflg = 1; lsflg <= 2; ++lsflg)
+    {
+        double a1  =  zcosg * zcosh + zsing * zcosi * zsinh;
+        double a3  = -zsing * zcosh + zcosg * zcosi * zsinh;
+        double a7  = -zcosg * zsinh + zsing * zcosi * zcosh;
+        double a8  =  zsing * zsini;
+        double a9  =  zsing * zsinh + zcosg * zcosi * zcosh;
+        double a10 =  zcosg * zsini;
+        double a2  =  cosim * a7 + sinim * a8;
+        double a4  =  cosim * a9 + sinim * a10;
+        double a5  = -sinim * a7 + cosim * a8;
+        double a6  = -sinim * a9 + cosim * a10;
+
+        double x1 =  a1 * cosomm + a2 * sinomm;
+        double x2 =  a3 * cosomm + a4 * sinomm;
+        double x3 = -a1 * sinomm + a2 * cosomm;
+        double x4 = -a3 * sinomm + a4 * cosomm;
+        double x5 =  a5 * sinomm;
+        double x6 =  a6 * sinomm;
+        double x7 =  a5 * cosomm;
+        double x8 =  a6 * cosomm;
+
+        // z[i][j] is z_ij of [1], and z[0][i] is z_i
+        z[3][1] = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+        z[3][2] = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+        z[3][3] = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+        z[0][1] = 3.0 * (a1 * a1 + a2 * a2) + z[3][1] * emsq;
+        z[0][2] = 6.0 * (a1 * a3 + a2 * a4) + z[3][2] * emsq;
+        z[0][3] = 3.0 * (a3 * a3 + a4 * a4) + z[3][3] * emsq;
+        z[1][1] = -6.0 * a1 * a5 + emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+        z[1][2] = -6.0 * (a1 * a6 + a3 * a5) +
+                  emsq * (-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+        z[1][3] = -6.0 * a3 * a6 + emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+        z[2][1] = 6.0 * a2 * a5 + emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+        z[2][2] = 6.0 * (a4 * a5 + a2 * a6) +
+                  emsq * (24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+        z[2][3] = 6.0 * a4 * a6 + emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+        z[0][1] = z[0][1] + z[0][1] + betasq * z[3][1];
+        z[0][2] = z[0][2] + z[0][2] + betasq * z[3][2];
+        z[0][3] = z[0][3] + z[0][3] + betasq * z[3][3];
+        s[3] = cc * xnoi;
+        s[2] = -0.5 * s[3] / rtemsq;
+        s[4] = s[3] * rtemsq;
+        s[1] = -15.0 * ecco * s[4];
+        s[5] = x1 * x3 + x2 * x4;
+        s[6] = x2 * x3 + x1 * x4;
+        s[7] = x2 * x4 - x1 * x3;
+
+        if (lsflg == 1)
+        {
+            std::copy(s, s + 8, ss);
+            std::copy(&z[0][0], &z[0][0] + 16, &sz[0][0]);
+            zcosg = zcosgl;
+            zsing = zsingl;
+            zcosi = zcosil;
+            zsini = zsinil;
+            zcosh = zcoshl * cnodm + zsinhl * snodm;
+            zsinh = snodm * zcoshl - cnodm * zsinhl;
+            cc    = c1l;
+        }
+    }
+
+    d.zmol = std::fmod(4.7199672 + 0.22997150 * day - gam, TWOPI);
+    d.zmos = std::fmod(6.2565837 + 0.017201977 * day, TWOPI);
+
+    // Amplitudes of the periodics, solar
+    d.se2  =  2.0 * ss[1] * ss[6];
+    d.se3  =  2.0 * ss[1] * ss[7];
+    d.si2  =  2.0 * ss[2] * sz[1][2];
+    d.si3  =  2.0 * ss[2] * (sz[1][3] - sz[1][1]);
+    d.sl2  = -2.0 * ss[3] * sz[0][2];
+    d.sl3  = -2.0 * ss[3] * (sz[0][3] - sz[0][1]);
+    d.sl4  = -2.0 * ss[3] * (-21.0 - 9.0 * emsq) * zes;
+    d.sgh2 =  2.0 * ss[4] * sz[3][2];
+    d.sgh3 =  2.0 * ss[4] * (sz[3][3] - sz[3][1]);
+    d.sgh4 = -18.0 * ss[4] * zes;
+    d.sh2  = -2.0 * ss[2] * sz[2][2];
+    d.sh3  = -2.0 * ss[2] * (sz[2][3] - sz[2][1]);
+
+    // and lunar
+    d.ee2  =  2.0 * s[1] * s[6];
+    d.e3   =  2.0 * s[1] * s[7];
+    d.xi2  =  2.0 * s[2] * z[1][2];
+    d.xi3  =  2.0 * s[2] * (z[1][3] - z[1][1]);
+    d.xl2  = -2.0 * s[3] * z[0][2];
+    d.xl3  = -2.0 * s[3] * (z[0][3] - z[0][1]);
+    d.xl4  = -2.0 * s[3] * (-21.0 - 9.0 * emsq) * zel;
+    d.xgh2 =  2.0 * s[4] * z[3][2];
+    d.xgh3 =  2.0 * s[4] * (z[3][3] - z[3][1]);
+    d.xgh4 = -18.0 * s[4] * zel;
+    d.xh2  = -2.0 * s[2] * z[2][2];
+    d.xh3  = -2.0 * s[2] * (z[2][3] - z[2][1]);
+
+    // Secular rates, solar and lunar. The node terms vanish for equatorial orbits
+    bool equatorial = inclo < 5.2359877E-2 || inclo > PI - 5.2359877E-2;
+    double ses  = ss[1] * zns * ss[5];
+    double sis  = ss[2] * zns * (sz[1][1] + sz[1][3]);
+    double sls  = -zns * ss[3] * (sz[0][1] + sz[0][3] - 14.0 - 6.0 * emsq);
+    double sghs = ss[4] * zns * (sz[3][1] + sz[3][3] - 6.0);
+    double shs  = equatorial ? 0.0 : -zns * ss[2] * (sz[2][1] + sz[2][3]);
+    if (sinim != 0.0)
+        shs = shs / sinim;
+    double sgs  = sghs - cosim * shs;
+
+    d.dedt  = ses + s[1] * znl * s[5];
+    d.didt  = sis + s[2] * znl * (z[1][1] + z[1][3]);
+    d.dmdt  = sls - znl * s[3] * (z[0][1] + z[0][3] - 14.0 - 6.0 * emsq);
+    double sghl = s[4] * znl * (z[3][1] + z[3][3] - 6.0);
+    double shll = equatorial ? 0.0 : -znl * s[2] * (z[2][1] + z[2][3]);
+    d.domdt = sgs + sghl;
+    d.dnodt = shs;
+    if (sinim != 0.0)
+    {
+        d.domdt = d.domdt - cosim / sinim * shll;
+        d.dnodt = d.dnodt + shll / sinim;
+    }
+
+    // Resonances of one-day orbits, and of half-day orbits with e >= 0.5
+    const double q22 = 1.7891679E-6, q31 = 2.1460748E-6, q33 = 2.2123015E-7;
+    const double root22 = 1.7891679E-6, root44 = 7.3636953E-9, root54 = 2.1765803E-9;
+    const double root32 = 3.7393792E-7, root52 = 1.1428639E-7;
+    const double rptim  = 4.37526908801129966E-3; // Rotation of the earth [rad/min]
+
+    d.irez = 0;
+    if (no < 0.0052359877 && no > 0.0034906585)
+        d.irez = 1;
+    if (no >= 8.26E-3 && no <= 9.24E-3 && ecco >= 0.5)
+        d.irez = 2;
+    d.d2201 = d.d2211 = d.d3210 = d.d3222 = d.d4410 = 0.0;
+    d.d4422 = d.d5220 = d.d5232 = d.d5421 = d.d5433 = 0.0;
+    d.del1 = d.del2 = d.del3 = d.xfact = d.xlamo = 0.0;
+
+    double theta = d.gsto;
+    double aonv  = std::pow(no / WGS72_XKE, X2O3);
+    if (d.irez == 2)
+    {
+        double cosisq = cosim * cosim;
+        double em     = ecco;
+        double eoc    = em * emsq;
+        double g201   = -0.306 - (em - 0.64) * 0.440;
+        double g211, g310, g322, g410, g422, g520, g521, g532, g533;
+        if (em <= 0.65)
+        {
+            g211 =    3.616  -   13.2470 * em +   16.2900 * emsq;
+            g310 =  -19.302  +  117.3900 * em -  228.4190 * emsq +  156.5910 * eoc;
+            g322 =  -18.9068 +  109.7927 * em -  214.6334 * emsq +  146.5816 * eoc;
+            g410 =  -41.122  +  242.6940 * em -  471.0940 * emsq +  313.9530 * eoc;
+            g422 = -146.407  +  841.8800 * em - 1629.014  * emsq + 1083.4350 * eoc;
+            g520 = -532.114  + 3017.977  * em - 5740.032  * emsq + 3708.2760 * eoc;
+        }
+        else
+        {
+            g211 =   -72.099 +   331.819 * em -   508.738 * emsq +   266.724 * eoc;
+            g310 =  -346.844 +  1582.851 * em -  2415.925 * emsq +  1246.113 * eoc;
+            g322 =  -342.585 +  1554.908 * em -  2366.899 * emsq +  1215.972 * eoc;
+            g410 = -1052.797 +  4758.686 * em -  7193.992 * emsq +  3651.957 * eoc;
+            g422 = -3581.690 + 16178.110 * em - 24462.770 * emsq + 12422.520 * eoc;
+            if (em > 0.715)
+                g520 = -5149.66 + 29936.92 * em - 54087.36 * emsq + 31324.56 * eoc;
+            else
+                g520 = 1464.74 - 4664.75 * em + 3763.64 * emsq;
+        }
+        if (em < 0.7)
+        {
+            g533 = -919.22770 + 4988.6100 * em - 9064.7700 * emsq + 5542.21 * eoc;
+            g521 = -822.71072 + 4568.6173 * em - 8491.4146 * emsq + 5337.524 * eoc;
+            g532 = -853.66600 + 4690.2500 * em - 8624.7700 * emsq + 5341.4 * eoc;
+        }
+        else
+        {
+            g533 = -37995.780 + 161616.52 * em - 229838.20 * emsq + 109377.94 * eoc;
+            g521 = -51752.104 + 218913.95 * em - 309468.16 * emsq + 146349.42 * eoc;
+            g532 = -40023.880 + 170470.89 * em - 242699.48 * emsq + 115605.82 * eoc;
+        }
+
+        double sini2 = sinim * sinim;
+        double f220 = 0.75 * (1.0 + 2.0 * cosim + cosisq);
+        double f221 = 1.5 * sini2;
+        double f321 = 1.875 * sinim * (1.0 - 2.0 * cosim - 3.0 * cosisq);
+        double f322 = -1.875 * sinim * (1.0 + 2.0 * cosim - 3.0 * cosisq);
+        double f441 = 35.0 * sini2 * f220;
+        double f442 = 39.3750 * sini2 * sini2;
+        double f522 = 9.84375 * sinim * (sini2 * (1.0 - 2.0 * cosim - 5.0 * cosisq) +
+                      0.33333333 * (-2.0 + 4.0 * cosim + 6.0 * cosisq));
+        double f523 = sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * cosim + 10.0 * cosisq) +
+                      6.56250012 * (1.0 + 2.0 * cosim - 3.0 * cosisq));
+        double f542 = 29.53125 * sinim * (2.0 - 8.0 * cosim + cosisq * (-12.0 + 8.0 * cosim + 10.0 * cosisq));
+        double f543 = 29.53125 * sinim * (-2.0 - 8.0 * cosim + cosisq * (12.0 + 8.0 * cosim - 10.0 * cosisq));
+
+        double temp1 = 3.0 * no * no * aonv * aonv;
+        double temp  = temp1 * root22;
+        d.d2201 = temp * f220 * g201;
+        d.d2211 = temp * f221 * g211;
+        temp1   = temp1 * aonv;
+        temp    = temp1 * root32;
+        d.d3210 = temp * f321 * g310;
+        d.d3222 = temp * f322 * g322;
+        temp1   = temp1 * aonv;
+        temp    = 2.0 * temp1 * root44;
+        d.d4410 = temp * f441 * g410;
+        d.d4422 = temp * f442 * g422;
+        temp1   = temp1 * aonv;
+        temp    = temp1 * root52;
+        d.d5220 = temp * f522 * g520;
+        d.d5232 = temp * f523 * g532;
+        temp    = 2.0 * temp1 * root54;
+        d.d5421 = temp * f542 * g521;
+        d.d5433 = temp * f543 * g533;
+        d.xlamo = std::fmod(mo + nodeo + nodeo - theta - theta, TWOPI);
+        d.xfact = mdot + d.dmdt + 2.0 * (nodedot + d.dnodt - rptim) - no;
+    }
+    else if (d.irez == 1)
+    {
+        double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+        double g310 = 1.0 + 2.0 * emsq;
+        double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+        double f220 = 0.75 * (1.0 + cosim) * (1.0 + cosim);
+        double f311 = 0.9375 * sinim * sinim * (1.0 + 3.0 * cosim) - 0.75 * (1.0 + cosim);
+        double f330 = 1.0 + cosim;
+        f330 = 1.875 * f330 * f330 * f330;
+        double del1 = 3.0 * no * no * aonv * aonv;
+        d.del2  = 2.0 * del1 * f220 * g200 * q22;
+        d.del3  = 3.0 * del1 * f330 * g300 * q33 * aonv;
+        d.del1  = del1 * f311 * g310 * q31 * aonv;
+        d.xlamo = std::fmod(mo + nodeo + argpo - theta, TWOPI);
+        d.xfact = mdot + (argpdot + nodedot) - rptim + d.dmdt + d.domdt + d.dnodt - no;
+    }
+    return d;
+}
+
+// Lunar-solar secular rates and the resonances, t minutes from the epoch,
+// [1] dspace. The resonances are integrated from the epoch in steps of half a
+// day, as [1] does from its last restart, so the result is the same without
+// keeping the integrator between calls
+static void deepSpaceSecular(const DeepSpaceTerms& d, double no, double argpo, double argpdot, double t,
+                             double& em, double& inclm, double& nodem, double& argpm, double& mm, double& nm)
+{
+    const double fasx2 = 0.13130908, fasx4 = 2.8843198, fasx6 = 0.37448087;
+    const double g22 = 5.7686396, g32 = 0.95240898, g44 = 1.8014998, g52 = 1.0508330, g54 = 4.4108898;
+    const double rptim = 4.37526908801129966E-3;
+    const double stepp = 720.0, step2 = 259200.0;
+
+    em    = em + d.dedt * t;
+    inclm = inclm + d.didt * t;
+    argpm = argpm + d.domdt * t;
+    nodem = nodem + d.dnodt * t;
+    mm    = mm + d.dmdt * t;
+    if (d.irez == 0)
+        return;
+
+    double theta = std::fmod(d.gsto + t * rptim, TWOPI);
+    double delt  = t > 0.0 ? stepp : -stepp;
+    double atime = 0.0;
+    double xli   = d.xlamo;
+    double xni   = no;
+    double xndt, xldot, xnddt;
+    for (;;)
+    {
+        if (d.irez != 2)
+        {
+            xndt  = d.del1 * std::sin(xli - fasx2) + d.del2 * std::sin(2.0 * (xli - fasx4)) +
+                    d.del3 * std::sin(3.0 * (xli - fasx6));
+            xldot = xni + d.xfact;
+            xnddt = d.del1 * std::cos(xli - fasx2) + 2.0 * d.del2 * std::cos(2.0 * (xli - fasx4)) +
+                    3.0 * d.del3 * std::cos(3.0 * (xli - fasx6));
+            xnddt = xnddt * xldot;
+        }
+        else
+        {
+            double xomi  = argpo + argpdot * atime;
+            double x2omi = xomi + xomi;
+            double x2li  = xli + xli;
+            xndt  = d.d2201 * std::sin(x2omi + xli - g22) + d.d2211 * std::sin(xli - g22) +
+                    d.d3210 * std::sin(xomi + xli - g32) + d.d3222 * std::sin(-xomi + xli - g32) +
+                    d.d4410 * std::sin(x2omi + x2li - g44) + d.d4422 * std::sin(x2li - g44) +
+                    d.d5220 * std::sin(xomi + xli - g52) + d.d5232 * std::sin(-xomi + xli - g52) +
+                    d.d5421 * std::sin(xomi + x2li - g54) + d.d5433 * std::sin(-xomi + x2li - g54);
+            xldot = xni + d.xfact;
+            xnddt = d.d2201 * std::cos(x2omi + xli - g22) + d.d2211 * std::cos(xli - g22) +
+                    d.d3210 * std::cos(xomi + xli - g32) + d.d3222 * std::cos(-xomi + xli - g32) +
+                    d.d5220 * std::cos(xomi + xli - g52) + d.d5232 * std::cos(-xomi + xli - g52) +
+                    2.0 * (d.d4410 * std::cos(x2omi + x2li - g44) + d.d4422 * std::cos(x2li - g44) +
+                           d.d5421 * std::cos(xomi + x2li - g54) + d.d5433 * std::cos(-xomi + x2li - g54));
+            xnddt = xnddt * xldot;
+        }
+        if (std::abs(t - atime) < stepp)
+            break;
+        xli   = xli + xldot * delt + xndt * step2;
+        xni   = xni + xndt * delt + xnddt * step2;
+        atime = atime + delt;
+    }
+
+    double ft = t - atime;
+    nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+    double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+    if (d.irez != 1)
+        mm = xl - 2.0 * nodem + 2.0 * theta;
+    else
+        mm = xl - nodem - argpm + theta;
+}
+
+// Lunar-solar periodics, added to the elements at t minutes from the epoch.
+// [1] dpper, with the Lyddane form below 0.2 rad of inclination
+static void lunarSolarPeriodics(const DeepSpaceTerms& d, double t,
+                                double& ep, double& inclp, double& nodep, double& argpp, double& mp)
+{
+    const double zns = 1.19459E-5, zes = 0.01675, znl = 1.5835218E-4, zel = 0.05490;
+
+    double zm    = d.zmos + zns * t;
+    double zf    = zm + 2.0 * zes * std::sin(zm);
+    double sinzf = std::sin(zf);
+    double f2    = 0.5 * sinzf * sinzf - 0.25;
+    double f3    = -0.5 * sinzf * std::cos(zf);
+    double ses   = d.se2 * f2 + d.se3 * f3;
+    double sis   = d.si2 * f2 + d.si3 * f3;
+    double sls   = d.sl2 * f2 + d.sl3 * f3 + d.sl4 * sinzf;
+    double sghs  = d.sgh2 * f2 + d.sgh3 * f3 + d.sgh4 * sinzf;
+    double shs   = d.sh2 * f2 + d.sh3 * f3;
+
+    zm    = d.zmol + znl * t;
+    zf    = zm + 2.0 * zel * std::sin(zm);
+    sinzf = std::sin(zf);
+    f2    = 0.5 * sinzf * sinzf - 0.25;
+    f3    = -0.5 * sinzf * std::cos(zf);
+    double sel  = d.ee2 * f2 + d.e3 * f3;
+    double sil  = d.xi2 * f2 + d.xi3 * f3;
+    double sll  = d.xl2 * f2 + d.xl3 * f3 + d.xl4 * sinzf;
+    double sghl = d.xgh2 * f2 + d.xgh3 * f3 + d.xgh4 * sinzf;
+    double shll = d.xh2 * f2 + d.xh3 * f3;
+
+    double pe   = ses + sel;
+    double pinc = sis + sil;
+    double pl   = sls + sll;
+    double pgh  = sghs + sghl;
+    double ph   = shs + shll;
+
+    inclp = inclp + pinc;
+    ep    = ep + pe;
+    double sinip = std::sin(inclp);
+    double cosip = std::cos(inclp);
+    if (inclp >= 0.2)
+    {
+        ph    = ph / sinip;
+        pgh   = pgh - cosip * ph;
+        argpp = argpp + pgh;
+        nodep = nodep + ph;
+        mp    = mp + pl;
+    }
+    else
+    {
+        double sinop = std::sin(nodep);
+        double cosop = std::cos(nodep);
+        double alfdp = sinip * sinop + (ph * cosop + pinc * cosip * sinop);
+        double betdp = sinip * cosop + (-ph * sinop + pinc * cosip * cosop);
+        nodep = std::fmod(nodep, TWOPI);
+        double xls  = (mp + argpp + cosip * nodep) + (pl + pgh - pinc * nodep * sinip);
+        double xnoh = nodep;
+        nodep = std::atan2(alfdp, betdp);
+        if (std::abs(xnoh - nodep) > PI)
+            nodep += (nodep < xnoh) ? TWOPI : -TWOPI;
+        mp    = mp + pl;
+        argpp = xls - mp - cosip * nodep;
+    }
+}
+
+// ── SGP4Orbit ────────────────────────────────────────────────────────────────
+
+SGP4Orbit::SGP4Orbit(const TLE& _tle)
+    : tle(_tle), ds()
+{
+    // [1] sgp4init and initl. Units of earth radii and minutes
+    double ecco  = tle.e;
+    double inclo = tle.i;
+    double argpo = tle.w;
+    double mo    = tle.M;
+    double bstar = tle.bstar;
+    double no_kozai = tle.n * TWOPI / 1440.0;
+    if (no_kozai <= 0.0)
+        throw AstroException("SGP4 needs a positive mean motion");
+
+    // Brouwer mean motion from the Kozai mean motion of the element set
+    double eccsq  = ecco * ecco;
+    double omeosq = 1.0 - eccsq;
+    double rteosq = std::sqrt(omeosq);
+    double cosio  = std::cos(inclo);
+    double cosio2 = cosio * cosio;
+    double ak   = std::pow(WGS72_XKE / no_kozai, X2O3);
+    double d1   = 0.75 * WGS72_J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del  = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    no  = no_kozai / (1.0 + del);
+    ao  = std::pow(WGS72_XKE / no, X2O3);
+
+    deep = TWOPI / no >= 225.0;
+
+    double sinio = std::sin(inclo);
+    double po    = ao * omeosq;
+    double con42 = 1.0 - 5.0 * cosio2;
+    double posq  = po * po;
+    double rp    = ao * (1.0 - ecco);
+    k = zonalPeriodics(WGS72_J2, WGS72_J3, cosio, sinio);
+
+    // Simplified drag for perigees below 220 km, and in deep space
+    isimp = deep || rp < 220.0 / WGS72_RE + 1.0;
+
+    // The density function, with its parameter lowered for low perigees
+    double ss     = 78.0 / WGS72_RE + 1.0;
+    double qzms2t = std::pow((120.0 - 78.0) / WGS72_RE, 4.0);
+    double sfour  = ss;
+    double qzms24 = qzms2t;
+    double perige = (rp - 1.0) * WGS72_RE;
+    if (perige < 156.0)
+    {
+        sfour = perige - 78.0;
+        if (perige < 98.0)
+            sfour = 20.0;
+        qzms24 = std::pow((120.0 - sfour) / WGS72_RE, 4.0);
+        sfour  = sfour / WGS72_RE + 1.0;
+    }
+
+    double pinvsq = 1.0 / posq;
+    double tsi    = 1.0 / (ao - sfour);
+    eta           = ao * ecco * tsi;
+    double etasq  = eta * eta;
+    double eeta   = ecco * eta;
+    double psisq  = std::abs(1.0 - etasq);
+    double coef   = qzms24 * std::pow(tsi, 4.0);
+    double coef1  = coef / std::pow(psisq, 3.5);
+    double cc2 = coef1 * no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                 0.375 * WGS72_J2 * tsi / psisq * k.con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    cc1 = bstar * cc2;
+    double cc3 = 0.0;
+    if (ecco > 1.0E-4)
+        cc3 = -2.0 * coef * tsi * (WGS72_J3 / WGS72_J2) * no * sinio / ecco;
+    cc4 = 2.0 * no * coef1 * ao * omeosq *
+          (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) -
+           WGS72_J2 * tsi / (ao * psisq) *
+           (-3.0 * k.con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+            0.75 * k.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * argpo)));
+    cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    // Secular rates of J2 (first and second order) and J4
+    double cosio4 = cosio2 * cosio2;
+    double temp1  = 1.5 * WGS72_J2 * pinvsq * no;
+    double temp2  = 0.5 * temp1 * WGS72_J2 * pinvsq;
+    double temp3  = -0.46875 * WGS72_J4 * pinvsq * pinvsq * no;
+    mdot    = no + 0.5 * temp1 * rteosq * k.con41 + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+              temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+
+    omgcof = bstar * cc3 * std::cos(argpo);
+    xmcof  = (ecco > 1.0E-4) ? -X2O3 * coef * bstar / eeta : 0.0;
+    nodecf = 3.5 * omeosq * xhdot1 * cc1;
+    t2cof  = 1.5 * cc1;
+    delmo  = 1.0 + eta * std::cos(mo);
+    delmo  = delmo * delmo * delmo;
+    sinmao = std::sin(mo);
+
+    if (deep)
+        ds = deepSpaceTerms(tle.epoch.toJDUTC() - 2433281.5, ecco, inclo, tle.raan, argpo, mo, no,
+                            mdot, argpdot, nodedot);
+
+    d2 = d3 = d4 = t3cof = t4cof = t5cof = 0.0;
+    if (!isimp)
+    {
+        double cc1sq = cc1 * cc1;
+        d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = d2 * tsi * cc1 / 3.0;
+        d3 = (17.0 * ao + sfour) * temp;
+        d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+        t3cof = d2 + 2.0 * cc1sq;
+        t4cof = 0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq));
+        t5cof = 0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq));
+    }
+}
+
+SGP4Orbit::~SGP4Orbit()
+{
+
+}
+
+int SGP4Orbit::propagate(double t, PosState& s) const
+{
+    // [1] sgp4
+    double bstar = tle.bstar;
+
+    // Secular gravity and drag
+    double xmdf   = tle.M + mdot * t;
+    double argpdf = tle.w + argpdot * t;
+    double nodedf = tle.raan + nodedot * t;
+    double argpm  = argpdf;
+    double mm     = xmdf;
+    double t2     = t * t;
+    double nodem  = nodedf + nodecf * t2;
+    double tempa  = 1.0 - cc1 * t;
+    double tempe  = bstar * cc4 * t;
+    double templ  = t2cof * t2;
+
+    if (!isimp)
+    {
+        double delomg = omgcof * t;
+        double delm   = 1.0 + eta * std::cos(xmdf);
+        delm          = xmcof * (delm * delm * delm - delmo);
+        double temp   = delomg + delm;
+        mm    = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - d2 * t2 - d3 * t3 - d4 * t4;
+        tempe = tempe + bstar * cc5 * (std::sin(mm) - sinmao);
+        templ = templ + t3cof * t3 + t4 * (t4cof + t * t5cof);
+    }
+
+    // Lunar-solar secular rates and resonances
+    double nm    = no;
+    double em    = tle.e;
+    double inclm = tle.i;
+    if (deep)
+        deepSpaceSecular(ds, no, tle.w, argpdot, t, em, inclm, nodem, argpm, mm, nm);
+
+    if (nm <= 0.0)
+        return 2;
+
+    double am = (deep ? std::pow(WGS72_XKE / nm, X2O3) : ao) * tempa * tempa;
+    nm = WGS72_XKE / (am * std::sqrt(am));
+    em = em - tempe;
+    if (em >= 1.0 || em < -0.001 || am < 0.95)
+        return 1;
+    if (em < 1.0E-6)
+        em = 1.0E-6;
+
+    mm = mm + no * templ;
+    double xlm = mm + argpm + nodem;
+    nodem = std::fmod(nodem, TWOPI);
+    argpm = std::fmod(argpm, TWOPI);
+    xlm   = std::fmod(xlm, TWOPI);
+    mm    = std::fmod(xlm - argpm - nodem, TWOPI);
+
+    bool valid;
+    if (!deep)
+    {
+        valid = periodicState(am, em, inclm, nodem, argpm, mm, nm, WGS72_XKE, k, s.r, s.v);
+    }
+    else
+    {
+        // Lunar-solar periodics, then the zonal terms at the perturbed inclination
+        lunarSolarPeriodics(ds, t, em, inclm, nodem, argpm, mm);
+        if (inclm < 0.0)
+        {
+            inclm = -inclm;
+            nodem = nodem + PI;
+            argpm = argpm - PI;
+        }
+        if (em < 0.0 || em > 1.0)
+            return 3;
+        ZonalPeriodics kp = zonalPeriodics(WGS72_J2, WGS72_J3, std::cos(inclm), std::sin(inclm));
+        valid = periodicState(am, em, inclm, nodem, argpm, mm, nm, WGS72_XKE, kp, s.r, s.v);
+    }
+    if (!valid)
+        return 4;
+    if (glm::length(s.r) < 1.0)
+        return 6;
+
+    s.r *= WGS72_RE;
+    s.v *= WGS72_RE * WGS72_XKE / 60.0;
+    return 0;
+}
+
+PosState SGP4Orbit::getState(const EphemerisTime& et)
+{
+    return state(et);
+}
+
+PosState SGP4Orbit::state(const EphemerisTime& et) const
+{
+    PosState s;
+    switch (propagate((et - tle.epoch).value / 60.0, s))
+    {
+    case 0:
+        return s;
+    case 6:
+        throw AstroException("SGP4: the satellite has decayed");
+    default:
+        throw AstroException("SGP4: the mean elements are out of range");
+    }
+}
+
+const TLE& SGP4Orbit::getTLE() const
+{
+    return tle;
+}
+
+void SGP4Orbit::getStates(const std::vector<SGP4Orbit>& catalog, const EphemerisTime& et,
+                          std::vector<PosState>& out, unsigned int threads)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    out.resize(catalog.size());
+    parallelFor(catalog.size(), [&](size_t i) {
+        if (catalog[i].propagate((et - catalog[i].tle.epoch).value / 60.0, out[i]) != 0)
+            out[i] = PosState(Vec3(nan), Vec3(nan));
+    }, threads, 1024);
+}
+
+} // namespace astro
@@ -0,0 +1,189 @@
+#ifndef _ASTRO_ANALYTICORBIT_H_
+#define _ASTRO_ANALYTICORBIT_H_
+
+// Analytic orbits with the perturbations of an oblate central body: a J2/J3
+// mean element model for any body, and SGP4 for the two-line element sets of
+// Earth satellites
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "Orbit.h"
+#include "OrbitElements.h"
+
+namespace astro {
+
+// Long-period J3 and short-period J2 terms of the mean elements, shared by
+// the models below. Internal
+struct ZonalPeriodics
+{
+    double j2;
+    double aycof;  // J3 terms in the Lyddane variables
+    double xlcof;
+    double con41;  // 3 cos^2 i - 1
+    double x1mth2; // 1 - cos^2 i
+    double x7thm1; // 7 cos^2 i - 1
+    double sinio;
+    double cosio;
+};
+
+// Lunar-solar and resonance terms of SDP4, for the deep-space element sets of
+// SGP4Orbit. Internal
+struct DeepSpaceTerms
+{
+    double gsto;   // Greenwich sidereal angle at the epoch [rad]
+
+    // Lunar-solar periodics
+    double zmol, zmos;
+    double e3, ee2, se2, se3;
+    double sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2, sl3, sl4;
+    double xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4;
+
+    // Lunar-solar secular rates [rad/min]
+    double dedt, didt, dmdt, dnodt, domdt;
+
+    // Resonance: 0 none, 1 one-day orbits, 2 half-day orbits of high eccentricity
+    int    irez;
+    double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433;
+    double del1, del2, del3;
+    double xfact, xlamo;
+};
+
+
+// A two-line element set
+struct TLE
+{
+    std::string   name;           // From the title line, if any
+    int           satnum;
+    char          classification;
+    std::string   designator;     // International designator
+    EphemerisTime epoch;
+    double        ndot;           // First derivative of the mean motion / 2 [rev/day^2]
+    double        nddot;          // Second derivative of the mean motion / 6 [rev/day^3]
+    double        bstar;          // Drag term [1/earth radii]
+    double        i;              // Inclination [rad]
+    double        raan;           // Right ascension of the ascending node [rad]
+    double        e;
+    double        w;              // Argument of perigee [rad]
+    double        M;              // Mean anomaly [rad]
+    double        n;              // Mean motion [rev/day]
+    int           revs;           // Revolution number at the epoch
+
+    // Parses the two lines of an element set. Throws on malformed lines and
+    // wrong checksums
+    static TLE parse(const std::string& line1, const std::string& line2, const std::string& name = "");
+
+    // Parses all element sets of a stream, with or without title lines
+    static std::vector<TLE> parse(std::istream& is);
+};
+
+
+// Propagation of mean elements under J2 and J3: first order secular rates of
+// the node, the perigee and the mean anomaly, long-period J3 terms and
+// short-period J2 terms, as in Brouwer's theory with Lyddane's variables.
+// Nonsingular for small eccentricities and inclinations. The pole of the body
+// is along the Z axis of the frame of the elements.
+//
+// The short-period terms are those of SGP4, truncated in the eccentricity.
+// In low Earth orbit the errors after a day are about a km for near-circular
+// orbits and grow with the eccentricity, to some 20 km at e = 0.01, compared
+// to hundreds of km for a two-body orbit.
+class MeanElementOrbit : public Orbit
+{
+public:
+    // Elliptic mean elements, about a body with equatorial radius re [km]
+    // and J2 > 0
+    MeanElementOrbit(const OrbitElements& mean, double re, double J2, double J3 = 0.0);
+    virtual ~MeanElementOrbit();
+
+    // The mean elements whose osculating state at the epoch is s, iterated
+    // to 1 mm
+    static MeanElementOrbit fromStateVector(const PosState& s, const EphemerisTime& epoch, double mu,
+                                            double re, double J2, double J3 = 0.0);
+
+    virtual PosState getState(const EphemerisTime& et);
+
+    // As getState, and safe to call concurrently
+    PosState state(const EphemerisTime& et) const;
+
+    const OrbitElements& getMeanElements() const;
+
+    // States of every orbit of a catalog at et, evaluated in parallel.
+    // threads = 0 uses all hardware cores
+    static void getStates(const std::vector<MeanElementOrbit>& catalog, const EphemerisTime& et,
+                          std::vector<PosState>& out, unsigned int threads = 0);
+
+private:
+    OrbitElements oe;
+    double        re;
+    double        xke;     // Mean motion at the radius of the body [1/s]
+    double        am;      // Semimajor axis [re]
+    double        nm;      // Mean motion [1/s]
+    double        mdot;    // Secular rates [rad/s]
+    double        argpdot;
+    double        nodedot;
+    ZonalPeriodics k;
+};
+
+
+// SGP4 [1][2], with the WGS-72 constants the element sets are fitted with.
+// States are in the TEME frame of the element sets (true equator, mean
+// equinox of the epoch).
+//
+// Deep-space element sets (periods of 225 minutes or more) use SDP4, which
+// adds the lunar and solar perturbations and the resonances of one-day and
+// half-day orbits with the tesseral harmonics.
+class SGP4Orbit : public Orbit
+{
+public:
+    SGP4Orbit(const TLE& tle);
+    virtual ~SGP4Orbit();
+
+    // Throws if the elements become invalid or the satellite has decayed
+    virtual PosState getState(const EphemerisTime& et);
+
+    // As getState, and safe to call concurrently
+    PosState state(const EphemerisTime& et) const;
+
+    const TLE& getTLE() const;
+
+    // States of every orbit of a catalog at et, evaluated in parallel.
+    // Objects that cannot be propagated get NaN states instead of throwing.
+    // threads = 0 uses all hardware cores
+    static void getStates(const std::vector<SGP4Orbit>& catalog, const EphemerisTime& et,
+                          std::vector<PosState>& out, unsigned int threads = 0);
+
+private:
+    // The state at tsince minutes from the epoch. Returns 0, or the error
+    // codes of [1]: 1 eccentricity or semimajor axis out of range, 2 mean
+    // motion negative, 3 perturbed eccentricity out of range, 4 semi-latus
+    // rectum negative, 6 decayed
+    int propagate(double tsince, PosState& s) const;
+
+    TLE tle;
+
+    // Brouwer mean motion [rad/min] and semimajor axis [earth radii]
+    double no;
+    double ao;
+
+    // Secular rates and drag coefficients of [1]
+    bool   isimp;
+    double mdot, argpdot, nodedot;
+    double cc1, cc4, cc5, d2, d3, d4;
+    double t2cof, t3cof, t4cof, t5cof;
+    double omgcof, xmcof, nodecf;
+    double eta, delmo, sinmao;
+
+    ZonalPeriodics k;
+
+    // SDP4, for periods of 225 minutes or more
+    bool           deep;
+    DeepSpaceTerms ds;
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,307 @@
+#include "Atmosphere.h"
+#include "Ephemeris.h"
+#include "Exceptions.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  D. A. Vallado, Fundamentals of Astrodynamics and Applications,
+//      4th ed. (2013), table 8-4
+// [2]  O. Montenbruck and E. Gill, Satellite Orbits (2000), table 3.8
+
+namespace astro {
+
+// ── Atmosphere ───────────────────────────────────────────────────────────────
+
+Atmosphere::Atmosphere(double _re)
+    : re(_re)
+{}
+
+Atmosphere::~Atmosphere()
+{}
+
+double Atmosphere::getReferenceRadius() const
+{
+    return re;
+}
+
+double Atmosphere::altitude(const Vec3& r) const
+{
+    return glm::length(r) - re;
+}
+
+// ── ExponentialAtmosphere ────────────────────────────────────────────────────
+
+// Base altitude [km], reference density [kg/m^3] and scale height [km], [1]
+static const int    EXP_ROWS = 28;
+static const double EXP_TABLE[EXP_ROWS][3] = {
+    {    0.0, 1.225,     7.249 },
+    {   25.0, 3.899E-2,  6.349 },
+    {   30.0, 1.774E-2,  6.682 },
+    {   40.0, 3.972E-3,  7.554 },
+    {   50.0, 1.057E-3,  8.382 },
+    {   60.0, 3.206E-4,  7.714 },
+    {   70.0, 8.770E-5,  6.549 },
+    {   80.0, 1.905E-5,  5.799 },
+    {   90.0, 3.396E-6,  5.382 },
+    {  100.0, 5.297E-7,  5.877 },
+    {  110.0, 9.661E-8,  7.263 },
+    {  120.0, 2.438E-8,  9.473 },
+    {  130.0, 8.484E-9, 12.636 },
+    {  140.0, 3.845E-9, 16.149 },
+    {  150.0, 2.070E-9, 22.523 },
+    {  180.0, 5.464E-10, 29.740 },
+    {  200.0, 2.789E-10, 37.105 },
+    {  250.0, 7.248E-11, 45.546 },
+    {  300.0, 2.418E-11, 53.628 },
+    {  350.0, 9.518E-12, 53.298 },
+    {  400.0, 3.725E-12, 58.515 },
+    {  450.0, 1.585E-12, 60.828 },
+    {  500.0, 6.967E-13, 63.822 },
+    {  600.0, 1.454E-13, 71.835 },
+    {  700.0, 3.614E-14, 88.667 },
+    {  800.0, 1.170E-14, 124.64 },
+    {  900.0, 5.245E-15, 181.05 },
+    { 1000.0, 3.019E-15, 268.00 }
+};
+
+ExponentialAtmosphere::ExponentialAtmosphere(double re)
+    : Atmosphere(re)
+{}
+
+ExponentialAtmosphere::~ExponentialAtmosphere()
+{}
+
+double ExponentialAtmosphere::density(const Vec3& r, const EphemerisTime&) const
+{
+    double h = std::max(altitude(r), 0.0);
+
+    // Last row with a base altitude at or below h
+    int i = EXP_ROWS - 1;
+    while (i > 0 && EXP_TABLE[i][0] > h)
+        --i;
+
+    return EXP_TABLE[i][1] * std::exp(-(h - EXP_TABLE[i][0]) / EXP_TABLE[i][2]);
+}
+
+// ── HarrisPriester ───────────────────────────────────────────────────────────
+
+// Altitude [km], minimum and maximum density [g/km^3], [2]
+static const int    HP_ROWS = 50;
+static const double HP_TABLE[HP_ROWS][3] = {
+    {  100.0, 497400.0,  497400.0  },
+    {  120.0, 24900.0,   24900.0   },
+    {  130.0, 8377.0,    8710.0    },
+    {  140.0, 3899.0,    4059.0    },
+    {  150.0, 2122.0,    2215.0    },
+    {  160.0, 1263.0,    1344.0    },
+    {  170.0, 800.8,     875.8     },
+    {  180.0, 528.3,     601.0     },
+    {  190.0, 361.7,     429.7     },
+    {  200.0, 255.7,     316.2     },
+    {  210.0, 183.9,     239.6     },
+    {  220.0, 134.1,     185.3     },
+    {  230.0, 99.49,     145.5     },
+    {  240.0, 74.88,     115.7     },
+    {  250.0, 57.09,     93.08     },
+    {  260.0, 44.03,     75.55     },
+    {  270.0, 34.30,     61.82     },
+    {  280.0, 26.97,     50.95     },
+    {  290.0, 21.39,     42.26     },
+    {  300.0, 17.08,     35.26     },
+    {  320.0, 10.99,     25.11     },
+    {  340.0, 7.214,     18.19     },
+    {  360.0, 4.824,     13.37     },
+    {  380.0, 3.274,     9.955     },
+    {  400.0, 2.249,     7.492     },
+    {  420.0, 1.558,     5.684     },
+    {  440.0, 1.091,     4.355     },
+    {  460.0, 0.7701,    3.362     },
+    {  480.0, 0.5474,    2.612     },
+    {  500.0, 0.3916,    2.042     },
+    {  520.0, 0.2819,    1.605     },
+    {  540.0, 0.2042,    1.267     },
+    {  560.0, 0.1488,    1.005     },
+    {  580.0, 0.1092,    0.7997    },
+    {  600.0, 0.08070,   0.6390    },
+    {  620.0, 0.06012,   0.5123    },
+    {  640.0, 0.04519,   0.4121    },
+    {  660.0, 0.03430,   0.3325    },
+    {  680.0, 0.02632,   0.2691    },
+    {  700.0, 0.02043,   0.2185    },
+    {  720.0, 0.01607,   0.1779    },
+    {  740.0, 0.01281,   0.1452    },
+    {  760.0, 0.01036,   0.1190    },
+    {  780.0, 0.008496,  0.09776   },
+    {  800.0, 0.007069,  0.08059   },
+    {  840.0, 0.004680,  0.05741   },
+    {  880.0, 0.003200,  0.04210   },
+    {  920.0, 0.002210,  0.03130   },
+    {  960.0, 0.001560,  0.02360   },
+    { 1000.0, 0.001150,  0.01810   }
+};
+
+static const double HP_LAG = 30.0 * PI / 180.0; // Lag of the bulge apex after the Sun
+
+HarrisPriester::HarrisPriester(std::shared_ptr<const EphemerisCache> _ephemeris, int _centralBody,
+                               double _n, double re)
+    : Atmosphere(re), ephemeris(_ephemeris), centralBody(_centralBody), n(_n)
+{
+    if (!ephemeris)
+        throw AstroException("Harris-Priester needs an ephemeris cache for the Sun");
+}
+
+HarrisPriester::~HarrisPriester()
+{}
+
+double HarrisPriester::density(const Vec3& r, const EphemerisTime& et) const
+{
+    Vec3 sun, body;
+    ephemeris->getPosition(10, et, sun);
+    ephemeris->getPosition(centralBody, et, body);
+    return density(r, sun - body);
+}
+
+double HarrisPriester::density(const Vec3& r, const Vec3& sun) const
+{
+    double h = altitude(r);
+    if (h < HP_TABLE[0][0] || h >= HP_TABLE[HP_ROWS - 1][0])
+        return 0.0;
+
+    // Apex of the diurnal bulge
+    double ra  = std::atan2(sun.y, sun.x) + HP_LAG;
+    double dec = std::atan2(sun.z, std::sqrt(sun.x * sun.x + sun.y * sun.y));
+    Vec3   eb(std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec));
+
+    // cos^n(psi / 2), psi being the angle from the apex
+    double cosPsi2 = 0.5 + 0.5 * glm::dot(r, eb) / glm::length(r);
+    double bulge   = std::pow(std::max(cosPsi2, 0.0), 0.5 * n);
+
+    int i = 0;
+    while (HP_TABLE[i + 1][0] <= h)
+        ++i;
+
+    // Exponential interpolation between the rows
+    const double* lo = HP_TABLE[i];
+    const double* hi = HP_TABLE[i + 1];
+    double Hmin = (lo[0] - hi[0]) / std::log(hi[1] / lo[1]);
+    double Hmax = (lo[0] - hi[0]) / std::log(hi[2] / lo[2]);
+    double dmin = lo[1] * std::exp((lo[0] - h) / Hmin);
+    double dmax = lo[2] * std::exp((lo[0] - h) / Hmax);
+
+    return (dmin + (dmax - dmin) * bulge) * 1.0E-12; // [g/km^3] -> [kg/m^3]
+}
+
+// ── AtmosphereTable ──────────────────────────────────────────────────────────
+
+AtmosphereTable::AtmosphereTable(const DensityModel& model, double _h0, double h1, double _dh,
+                                 const std::vector<double>& _fluxBins)
+    : h0(_h0), dh(_dh), fluxBins(_fluxBins)
+{
+    if (dh <= 0.0 || h1 <= h0)
+        throw AstroException("Invalid altitude grid for tabulated atmosphere");
+    if (fluxBins.empty() || !std::is_sorted(fluxBins.begin(), fluxBins.end()))
+        throw AstroException("Solar flux bins for tabulated atmosphere must be given in ascending order");
+
+    nh = static_cast<size_t>(std::ceil((h1 - h0) / dh - 1.0E-9)) + 1;
+    table.resize(nh * fluxBins.size());
+    for (size_t j = 0; j < fluxBins.size(); ++j)
+        for (size_t i = 0; i < nh; ++i)
+        {
+            double rho = model(h0 + i * dh, fluxBins[j]);
+            if (rho <= 0.0)
+                throw AstroException("Non-positive density sampled for tabulated atmosphere");
+            table[j * nh + i] = std::log(rho);
+        }
+}
+
+double AtmosphereTable::clampFlux(double f107) const
+{
+    return std::max(fluxBins.front(), std::min(f107, fluxBins.back()));
+}
+
+std::vector<double> AtmosphereTable::profile(double f107) const
+{
+    f107 = clampFlux(f107);
+
+    // Bin below f107, and the linear interpolation weight of the one above
+    size_t j = std::upper_bound(fluxBins.begin(), fluxBins.end(), f107) - fluxBins.begin();
+    j = (j == 0) ? 0 : j - 1;
+    double w = 0.0;
+    if (j + 1 < fluxBins.size())
+        w = (f107 - fluxBins[j]) / (fluxBins[j + 1] - fluxBins[j]);
+    else
+        j = fluxBins.size() - 1;
+
+    std::vector<double> p(nh);
+    for (size_t i = 0; i < nh; ++i)
+    {
+        p[i] = table[j * nh + i];
+        if (w > 0.0)
+            p[i] += w * (table[(j + 1) * nh + i] - p[i]);
+    }
+    return p;
+}
+
+double AtmosphereTable::getMinAltitude() const
+{
+    return h0;
+}
+
+double AtmosphereTable::getAltitudeStep() const
+{
+    return dh;
+}
+
+size_t AtmosphereTable::getAltitudeCount() const
+{
+    return nh;
+}
+
+// ── TabulatedAtmosphere ──────────────────────────────────────────────────────
+
+TabulatedAtmosphere::TabulatedAtmosphere(std::shared_ptr<const AtmosphereTable> _table, double _f107, double re)
+    : Atmosphere(re), table(_table)
+{
+    if (!table)
+        throw AstroException("Tabulated atmosphere needs a table");
+
+    h0      = table->getMinAltitude();
+    dh      = table->getAltitudeStep();
+    f107    = table->clampFlux(_f107);
+    profile = table->profile(f107);
+}
+
+TabulatedAtmosphere::~TabulatedAtmosphere()
+{}
+
+double TabulatedAtmosphere::getSolarFlux() const
+{
+    return f107;
+}
+
+std::shared_ptr<const AtmosphereTable> TabulatedAtmosphere::getTable() const
+{
+    return table;
+}
+
+double TabulatedAtmosphere::density(double h) const
+{
+    // Log-linear interpolation; extrapolated with the scale height of the
+    // first or last interval outside the table
+    const size_t nh = profile.size();
+    double x = (h - h0) / dh;
+    double i = std::floor(x);
+    size_t k = static_cast<size_t>(std::max(0.0, std::min(i, static_cast<double>(nh - 2))));
+    double f = x - k;
+    return std::exp(profile[k] + f * (profile[k + 1] - profile[k]));
+}
+
+double TabulatedAtmosphere::density(const Vec3& r, const EphemerisTime&) const
+{
+    return density(altitude(r));
+}
+
+} // namespace astro
@@ -0,0 +1,145 @@
+#ifndef _ASTRO_ATMOSPHERE_H_
+#define _ASTRO_ATMOSPHERE_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+
+namespace astro {
+
+class EphemerisCache;
+
+// Base class of atmosphere density models. Positions are relative to the
+// center of the central body, in an inertial frame with the Z axis along the
+// rotation axis (e.g. J2000 for the Earth). Altitudes are taken above a
+// sphere of radius re.
+class Atmosphere
+{
+public:
+    explicit Atmosphere(double re = 6378.137);
+    virtual ~Atmosphere();
+
+    // Density [kg/m^3] at the position r [km]
+    virtual double density(const Vec3& r, const EphemerisTime& et) const = 0;
+
+    double getReferenceRadius() const;
+
+protected:
+    double altitude(const Vec3& r) const;
+
+    double re; // [km]
+};
+
+
+// Piecewise exponential model with the reference densities and scale heights
+// of D. A. Vallado, "Fundamentals of Astrodynamics and Applications", table
+// 8-4, from 0 to 1000 km.
+class ExponentialAtmosphere : public Atmosphere
+{
+public:
+    explicit ExponentialAtmosphere(double re = 6378.137);
+    virtual ~ExponentialAtmosphere();
+
+    virtual double density(const Vec3& r, const EphemerisTime& et) const;
+};
+
+
+// Harris-Priester model for mean solar activity, as given in O. Montenbruck
+// and E. Gill, "Satellite Orbits" (2000), ch. 3.5.2. Interpolates between the
+// night time minimum and the diurnal bulge maximum, whose apex lags the Sun by
+// 30 degrees in right ascension. Valid from 100 to 1000 km; zero above.
+//
+// The Sun position is taken from the ephemeris cache, which must contain the
+// Sun (10) and the central body.
+class HarrisPriester : public Atmosphere
+{
+public:
+    // n: exponent of the bulge, from 2 for low to 6 for polar inclinations
+    HarrisPriester(std::shared_ptr<const EphemerisCache> ephemeris, int centralBody = 399,
+                   double n = 2.0, double re = 6378.137);
+    virtual ~HarrisPriester();
+
+    virtual double density(const Vec3& r, const EphemerisTime& et) const;
+
+    // Density with the Sun position relative to the central body given [km]
+    double density(const Vec3& r, const Vec3& sun) const;
+
+private:
+    std::shared_ptr<const EphemerisCache> ephemeris;
+    int    centralBody;
+    double n;
+};
+
+
+// A density model sampled over altitude and solar flux (F10.7), for models
+// that are too expensive to evaluate in every integration stage. The model
+// is sampled once at construction on a uniform altitude grid for each solar
+// flux bin, and the table is not changed afterwards.
+//
+// No NRLMSISE-00 implementation is bundled with the library; such a model is
+// supplied by the user as the sampled function.
+class AtmosphereTable
+{
+public:
+    // model(altitude [km], F10.7) -> density [kg/m^3]
+    typedef std::function<double(double, double)> DensityModel;
+
+    // Samples the model from h0 to h1 [km] in steps of dh, for each of the
+    // solar flux bins (ascending)
+    AtmosphereTable(const DensityModel& model, double h0, double h1, double dh,
+                    const std::vector<double>& fluxBins);
+
+    // ln(density) at each altitude of the grid for the flux f107, linearly
+    // interpolated between the bins. f107 is clamped to the range of the bins
+    std::vector<double> profile(double f107) const;
+
+    double clampFlux(double f107) const;
+
+    double getMinAltitude() const;
+    double getAltitudeStep() const;
+    size_t getAltitudeCount() const;
+
+private:
+    double h0;
+    double dh;
+    size_t nh;
+    std::vector<double> fluxBins;
+    std::vector<double> table; // ln(density), nh values per flux bin
+};
+
+
+// Atmosphere interpolated from an AtmosphereTable at a fixed solar flux. The
+// altitude profile for the flux is made once at construction, after which
+// each density call is a table lookup and one exponential interpolation.
+//
+// Objects are immutable and can be shared between propagations running in
+// parallel. For another solar flux, make a new object from the same table.
+class TabulatedAtmosphere : public Atmosphere
+{
+public:
+    // f107 is clamped to the range of the flux bins of the table
+    TabulatedAtmosphere(std::shared_ptr<const AtmosphereTable> table, double f107, double re = 6378.137);
+    virtual ~TabulatedAtmosphere();
+
+    virtual double density(const Vec3& r, const EphemerisTime& et) const;
+
+    // Density at an altitude [km]
+    double density(double h) const;
+
+    double getSolarFlux() const;
+
+    std::shared_ptr<const AtmosphereTable> getTable() const;
+
+private:
+    std::shared_ptr<const AtmosphereTable> table;
+    double h0;
+    double dh;
+    double f107;
+    std::vector<double> profile; // ln(density) for f107
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,241 @@
+#include "Conjunction.h"
+#include "Interpolate.h"
+#include "Parallel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+// References:
+// [1]  F. R. Hoots, L. L. Crawford and R. L. Roehrich, "An analytic method to
+//      determine future close approaches between satellites", Celest. Mech.
+//      33 (1984)
+
+namespace astro {
+
+size_t ConjunctionScreening::blockSize = 64;
+
+void ConjunctionScreening::setBlockSize(size_t steps)
+{
+    if (steps == 0)
+        throw AstroException("ConjunctionScreening block size needs to be positive");
+    blockSize = steps;
+}
+
+size_t ConjunctionScreening::getBlockSize()
+{
+    return blockSize;
+}
+
+// Axis aligned box
+struct Box
+{
+    Vec3 lo;
+    Vec3 hi;
+};
+
+// A pair with a range minimum inside step k
+struct Candidate
+{
+    size_t first;
+    size_t second;
+    size_t step;
+};
+
+// Box of the Bezier control points of the Hermite interpolant over a step of
+// length h, which contains the whole interpolant
+static Box bezierBox(const PosState& a, const PosState& b, double h)
+{
+    Vec3 p1 = a.r + a.v * (h / 3.0);
+    Vec3 p2 = b.r - b.v * (h / 3.0);
+    Box box;
+    box.lo = glm::min(glm::min(a.r, b.r), glm::min(p1, p2));
+    box.hi = glm::max(glm::max(a.r, b.r), glm::max(p1, p2));
+    return box;
+}
+
+// Range times range rate; negative while closing
+static double rangeRate(const PosState& a, const PosState& b)
+{
+    return glm::dot(b.r - a.r, b.v - a.v);
+}
+
+// Cell key of integer cell coordinates, 21 bits each. Coordinates wrap, which
+// only puts far apart boxes into the same cell
+static uint64_t cellKey(int64_t ix, int64_t iy, int64_t iz)
+{
+    const uint64_t M = (uint64_t(1) << 21) - 1;
+    return ((uint64_t(ix) & M) << 42) | ((uint64_t(iy) & M) << 21) | (uint64_t(iz) & M);
+}
+
+std::vector<Conjunction> ConjunctionScreening::screen(const std::vector<Orbit*>& catalog,
+                                                      const EphemerisTime& et0, const EphemerisTime& et1,
+                                                      double threshold, const TimeDelta& step,
+                                                      unsigned int threads)
+{
+    if (threshold <= 0.0 || step.value <= 0.0)
+        throw AstroException("Conjunction screening needs a positive threshold and step");
+    if (!(et0 < et1))
+        throw AstroException("Conjunction screening needs et1 after et0");
+
+    double t0     = et0.getETValue();
+    double t1     = et1.getETValue();
+    double h      = step.value;
+    size_t nsteps = static_cast<size_t>(std::ceil((t1 - t0) / h));
+    size_t n      = catalog.size();
+    auto   timeOf = [&](size_t k) { return std::min(t0 + k * h, t1); };
+
+    std::vector<Candidate> candidates;
+    std::vector<PosState>  samples;
+    std::vector<Box>       boxes;
+    std::vector<double>    rmin(n), rmax(n);
+
+    for (size_t b = 0; b < nsteps; b += blockSize)
+    {
+        size_t nb = std::min(blockSize, nsteps - b);
+        size_t ns = nb + 1;
+        samples.resize(n * ns);
+        boxes.resize(n * nb);
+
+        // Samples, boxes and radial shells of each object over the block
+        parallelFor(n, [&](size_t i) {
+            PosState* s = &samples[i * ns];
+            for (size_t k = 0; k < ns; ++k)
+                s[k] = catalog[i]->getState(EphemerisTime(timeOf(b + k)));
+
+            double lo = std::numeric_limits<double>::infinity();
+            double hi = 0.0;
+            for (size_t k = 0; k < nb; ++k)
+            {
+                Box& box = boxes[i * nb + k];
+                box = bezierBox(s[k], s[k + 1], timeOf(b + k + 1) - timeOf(b + k));
+
+                // Nearest and farthest point of the box from the center
+                Vec3 nearest = glm::clamp(Vec3(0.0), box.lo, box.hi);
+                Vec3 farthest = glm::max(glm::abs(box.lo), glm::abs(box.hi));
+                lo = std::min(lo, glm::length(nearest));
+                hi = std::max(hi, glm::length(farthest));
+            }
+            rmin[i] = lo;
+            rmax[i] = hi;
+        }, threads, 64);
+
+        // Screen the steps of the block
+        std::vector<std::vector<Candidate>> found(nb);
+        parallelFor(nb, [&](size_t k) {
+            // Cells larger than any box plus the threshold: boxes that come
+            // within the threshold have their low corners in neighbouring cells
+            double cell = 0.0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                Vec3 d = boxes[i * nb + k].hi - boxes[i * nb + k].lo;
+                cell = std::max(cell, std::max(d.x, std::max(d.y, d.z)));
+            }
+            cell += threshold;
+
+            std::vector<std::pair<uint64_t, size_t>> cells(n);
+            std::vector<int64_t> coords(3 * n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Vec3& lo = boxes[i * nb + k].lo;
+                for (int a = 0; a < 3; ++a)
+                    coords[3 * i + a] = static_cast<int64_t>(std::floor(lo[a] / cell));
+                cells[i] = { cellKey(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]), i };
+            }
+            std::sort(cells.begin(), cells.end());
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Box&     bi = boxes[i * nb + k];
+                const int64_t* c  = &coords[3 * i];
+                for (int dx = -1; dx <= 1; ++dx)
+                for (int dy = -1; dy <= 1; ++dy)
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    std::pair<uint64_t, size_t> key(cellKey(c[0] + dx, c[1] + dy, c[2] + dz), 0);
+                    for (auto it = std::lower_bound(cells.begin(), cells.end(), key);
+                         it != cells.end() && it->first == key.first; ++it)
+                    {
+                        size_t j = it->second;
+                        if (j <= i)
+                            continue;
+
+                        // Radial shells, the perigee/apogee filter of [1]
+                        if (rmin[i] > rmax[j] + threshold || rmin[j] > rmax[i] + threshold)
+                            continue;
+
+                        // Boxes within the threshold
+                        const Box& bj = boxes[j * nb + k];
+                        bool apart = false;
+                        for (int a = 0; a < 3; ++a)
+                            apart = apart || bi.lo[a] > bj.hi[a] + threshold || bj.lo[a] > bi.hi[a] + threshold;
+                        if (apart)
+                            continue;
+
+                        // A range minimum inside the step
+                        const PosState* si = &samples[i * ns + k];
+                        const PosState* sj = &samples[j * ns + k];
+                        if (!(rangeRate(si[0], sj[0]) < 0.0 && rangeRate(si[1], sj[1]) >= 0.0))
+                            continue;
+
+                        // Refined on the interpolants, with a margin for the
+                        // interpolation error
+                        EphemerisTime ea(timeOf(b + k));
+                        EphemerisTime eb(timeOf(b + k + 1));
+                        auto f = [&](double t) {
+                            PosState pi, pj;
+                            hermite(si[0], ea, si[1], eb, EphemerisTime(t), pi);
+                            hermite(sj[0], ea, sj[1], eb, EphemerisTime(t), pj);
+                            return rangeRate(pi, pj);
+                        };
+                        double tca = findRoot(f, ea.getETValue(), rangeRate(si[0], sj[0]),
+                                              eb.getETValue(), rangeRate(si[1], sj[1]), 1.0E-3);
+                        PosState pi, pj;
+                        hermite(si[0], ea, si[1], eb, EphemerisTime(tca), pi);
+                        hermite(sj[0], ea, sj[1], eb, EphemerisTime(tca), pj);
+                        if (glm::length(pj.r - pi.r) < 1.5 * threshold)
+                            found[k].push_back({ i, j, b + k });
+                    }
+                }
+            }
+        }, threads);
+
+        for (const auto& f : found)
+            candidates.insert(candidates.end(), f.begin(), f.end());
+    }
+
+    // Polish with the orbits themselves
+    std::vector<Conjunction> res;
+    for (const Candidate& c : candidates)
+    {
+        Orbit* oi = catalog[c.first];
+        Orbit* oj = catalog[c.second];
+        auto f = [&](double t) {
+            EphemerisTime et(t);
+            return rangeRate(oi->getState(et), oj->getState(et));
+        };
+        double ta  = timeOf(c.step);
+        double tb  = timeOf(c.step + 1);
+        double tca = findRoot(f, ta, f(ta), tb, f(tb), 1.0E-6);
+
+        EphemerisTime et(tca);
+        PosState si = oi->getState(et);
+        PosState sj = oj->getState(et);
+        double miss = glm::length(sj.r - si.r);
+        if (miss <= threshold)
+            res.push_back({ c.first, c.second, et, miss, glm::length(sj.v - si.v) });
+    }
+
+    std::sort(res.begin(), res.end(), [](const Conjunction& a, const Conjunction& b) {
+        if (a.tca.getETValue() != b.tca.getETValue())
+            return a.tca < b.tca;
+        return std::make_pair(a.first, a.second) < std::make_pair(b.first, b.second);
+    });
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,68 @@
+#ifndef _ASTRO_CONJUNCTION_H_
+#define _ASTRO_CONJUNCTION_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "Orbit.h"
+
+namespace astro {
+
+// A close approach between two objects of a catalog
+struct Conjunction
+{
+    size_t        first;         // Catalog index, first < second
+    size_t        second;
+    EphemerisTime tca;           // Time of closest approach
+    double        missDistance;  // [km]
+    double        relativeSpeed; // At tca [km/s]
+};
+
+// Screens a catalog of orbits for close approaches within a threshold
+// distance over a time span. The catalog is sampled with a fixed step, and
+// for each step:
+//
+// - every object is bounded by the box of the Bezier control points of its
+//   Hermite interpolant over the step, which contains the interpolant,
+// - pairs whose radial shells over the current block of steps are further
+//   apart than the threshold are rejected (the perigee/apogee filter, taken
+//   from the boxes so that it holds for any kind of orbit),
+// - the boxes are put into a uniform spatial hash with cells larger than any
+//   box plus the threshold, so only objects in neighbouring cells can come
+//   close, and their boxes are tested for overlap,
+// - the remaining pairs with a minimum of the range inside the step, where
+//   the range rate changes sign from closing to opening, are refined on the
+//   interpolants.
+//
+// The refined candidates are finally polished with root finding on the range
+// rate using Orbit::getState, and those within the threshold are returned,
+// ordered by time. Minima at the very ends of the span are not reported.
+//
+// The samples are taken and the steps screened in parallel, in blocks of
+// steps to bound the memory. Each object is sampled by one thread at a time,
+// so the catalog must hold distinct objects, but getState need not be thread
+// safe. The step must be small enough that the interpolant follows the orbits
+// to well within the threshold (about a minute in low Earth orbit), and that
+// no pair has two close approaches in one step.
+class ConjunctionScreening
+{
+public:
+    // threads = 0 uses all hardware cores
+    static std::vector<Conjunction> screen(const std::vector<Orbit*>& catalog,
+                                           const EphemerisTime& et0, const EphemerisTime& et1,
+                                           double threshold, const TimeDelta& step,
+                                           unsigned int threads = 0);
+
+    // Steps sampled at a time. Default is 64
+    static void setBlockSize(size_t steps);
+
+    static size_t getBlockSize();
+
+private:
+    static size_t blockSize;
+};
+
+} // namespace astro
+
+#endif
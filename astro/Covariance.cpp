@@ -0,0 +1,163 @@
+#include "Covariance.h"
+#include "RKF78.h"
+#include "Parallel.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  S. J. Julier and J. K. Uhlmann, "Unscented filtering and nonlinear
+//      estimation", Proc. IEEE 92 (2004)
+// [2]  E. A. Wan and R. van der Merwe, "The unscented Kalman filter for
+//      nonlinear estimation", IEEE AS-SPCC (2000)
+
+namespace astro {
+
+double Covariance::alpha = 1.0;
+double Covariance::beta  = 2.0;
+double Covariance::kappa = 0.0;
+
+// Component i of the state as a 6-vector (r, v)
+static double& component(PosState& s, int i)
+{
+    return i < 3 ? s.r[i] : s.v[i - 3];
+}
+
+Mat6 cholesky(const Mat6& a)
+{
+    Mat6 L;
+    for (int j = 0; j < 6; ++j)
+    {
+        double d = a(j, j);
+        for (int k = 0; k < j; ++k)
+            d -= L(j, k) * L(j, k);
+        if (d <= 0.0)
+            throw AstroException("Cholesky factorization of a matrix that is not positive definite");
+        L(j, j) = std::sqrt(d);
+
+        for (int i = j + 1; i < 6; ++i)
+        {
+            double s = a(i, j);
+            for (int k = 0; k < j; ++k)
+                s -= L(i, k) * L(j, k);
+            L(i, j) = s / L(j, j);
+        }
+    }
+    return L;
+}
+
+void Covariance::setUnscentedParameters(double _alpha, double _beta, double _kappa)
+{
+    if (_alpha <= 0.0 || _alpha * _alpha * (6.0 + _kappa) <= 0.0)
+        throw AstroException("Unscented transform parameters give a non-positive spread of the sigma points");
+    alpha = _alpha;
+    beta  = _beta;
+    kappa = _kappa;
+}
+
+void Covariance::checkEpochs(const EphemerisTime& et0, const std::vector<EphemerisTime>& epochs)
+{
+    if (!epochs.empty() && epochs.front() < et0)
+        throw AstroException("Covariance propagation epochs must be at or after the initial epoch");
+    if (!std::is_sorted(epochs.begin(), epochs.end()))
+        throw AstroException("Covariance propagation epochs must be in ascending order");
+}
+
+std::vector<Covariance::Result> Covariance::propagateLinear(const ODE& ode, const PosState& s, const Mat6& P0,
+                                                            const EphemerisTime& et0,
+                                                            const std::vector<EphemerisTime>& epochs,
+                                                            const TimeDelta& dt)
+{
+    checkEpochs(et0, epochs);
+
+    std::vector<Result> res;
+    res.reserve(epochs.size());
+
+    PosState      x   = s;
+    Mat6          phi(1.0);
+    EphemerisTime et  = et0;
+    double        h   = dt.value;
+    for (const EphemerisTime& target : epochs)
+    {
+        while (et < target)
+        {
+            double rest    = (target - et).value;
+            bool   landing = rest <= h;
+            Variational::Result r = Variational::doStep(ode, x, phi, et, TimeDelta(landing ? rest : h));
+            if (r.et == et)
+            {
+                h = r.dt_next.value; // Rejected
+                continue;
+            }
+            x   = r.s;
+            phi = r.phi;
+            if (landing)
+                et = target;         // Shortened to land on the epoch
+            else
+            {
+                et = r.et;
+                h  = r.dt_next.value;
+            }
+        }
+        res.push_back({ target, x, phi * P0 * phi.transpose() });
+    }
+    return res;
+}
+
+std::vector<Covariance::Result> Covariance::propagateUnscented(const ODE& ode, const PosState& s, const Mat6& P0,
+                                                               const EphemerisTime& et0,
+                                                               const std::vector<EphemerisTime>& epochs,
+                                                               const TimeDelta& dt, unsigned int threads)
+{
+    checkEpochs(et0, epochs);
+
+    // Sigma points s and s +- sqrt(n + lambda) L_i, and their weights, [1], [2]
+    const int    n      = 6;
+    const double lambda = alpha * alpha * (n + kappa) - n;
+    const double c      = std::sqrt(n + lambda);
+    const Mat6   L      = cholesky(P0);
+
+    std::vector<PosState> sigma(2 * n + 1, s);
+    for (int i = 0; i < n; ++i)
+        for (int k = 0; k < n; ++k)
+        {
+            component(sigma[1 + i], k)     += c * L(k, i);
+            component(sigma[1 + n + i], k) -= c * L(k, i);
+        }
+
+    const double wm0 = lambda / (n + lambda);
+    const double wc0 = wm0 + 1.0 - alpha * alpha + beta;
+    const double wi  = 0.5 / (n + lambda);
+
+    // The sigma points are independent; propagate them as one batch, all at
+    // the tolerance read here
+    const double tol = RKF78::getTolerance();
+    std::vector<std::vector<PosState>> paths(sigma.size());
+    parallelFor(sigma.size(), [&](size_t i) {
+        paths[i] = RKF78::propagateTo(ode, sigma[i], et0, epochs, dt, tol);
+    }, threads);
+
+    std::vector<Result> res;
+    res.reserve(epochs.size());
+    for (size_t e = 0; e < epochs.size(); ++e)
+    {
+        PosState mean = paths[0][e] * wm0;
+        for (size_t i = 1; i < sigma.size(); ++i)
+            mean += paths[i][e] * wi;
+
+        Mat6 P;
+        for (size_t i = 0; i < sigma.size(); ++i)
+        {
+            PosState d = paths[i][e] - mean;
+            double   w = (i == 0) ? wc0 : wi;
+            for (int j = 0; j < n; ++j)
+                for (int k = 0; k < n; ++k)
+                    P(j, k) += w * component(d, j) * component(d, k);
+        }
+        res.push_back({ epochs[e], mean, P });
+    }
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,66 @@
+#ifndef _ASTRO_COVARIANCE_H_
+#define _ASTRO_COVARIANCE_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+#include "Variational.h"
+
+namespace astro {
+
+// Lower triangular Cholesky factor L of a symmetric positive definite matrix,
+// a = L L^T. Throws if a is not positive definite
+Mat6 cholesky(const Mat6& a);
+
+
+// Propagation of a state and its 6x6 covariance (km, km/s) to a set of
+// epochs, as a cheaper alternative to Monte Carlo runs:
+//
+// - Linear: one propagation of the state with its transition matrix phi,
+//   P = phi P0 phi^T. Exact for small uncertainties.
+// - Unscented: the 13 sigma points of P0 are propagated as a batch, in
+//   parallel, and the mean and covariance are recovered from them. Captures
+//   the leading nonlinear effects, e.g. the curvature of the along-track
+//   spread, that the linear method misses, at 13 times the cost of one
+//   propagation.
+//
+// Both use RKF78 with its tolerance, and land exactly on each epoch.
+class Covariance
+{
+public:
+    struct Result
+    {
+        EphemerisTime et;
+        PosState      s; // Nominal (linear) or mean (unscented) state
+        Mat6          P;
+    };
+
+    // epochs: ascending, at or after et0. dt: initial step size
+    static std::vector<Result> propagateLinear(const ODE& ode, const PosState& s, const Mat6& P0,
+                                               const EphemerisTime& et0,
+                                               const std::vector<EphemerisTime>& epochs,
+                                               const TimeDelta& dt);
+
+    // threads = 0 uses all hardware cores
+    static std::vector<Result> propagateUnscented(const ODE& ode, const PosState& s, const Mat6& P0,
+                                                  const EphemerisTime& et0,
+                                                  const std::vector<EphemerisTime>& epochs,
+                                                  const TimeDelta& dt, unsigned int threads = 0);
+
+    // Spread (alpha), prior (beta) and secondary scaling (kappa) of the
+    // sigma points. Defaults are 1, 2 and 0
+    static void setUnscentedParameters(double alpha, double beta, double kappa);
+
+private:
+    static void checkEpochs(const EphemerisTime& et0, const std::vector<EphemerisTime>& epochs);
+
+    static double alpha;
+    static double beta;
+    static double kappa;
+};
+
+} // namespace astro
+
+#endif
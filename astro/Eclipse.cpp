@@ -0,0 +1,197 @@
+#include "Eclipse.h"
+#include "RadiationPressure.h"
+#include "Parallel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// References:
+// [1]  O. Montenbruck and E. Gill, Satellite Orbits (2000), ch. 3.4
+
+namespace astro {
+
+EclipseFinder::EclipseFinder(std::shared_ptr<const EphemerisCache> _ephemeris, int _centralBody, double centralRadius)
+    : ephemeris(_ephemeris), centralBody(_centralBody), minStep(1.0), maxStep(600.0), tol(1.0E-3)
+{
+    if (!ephemeris)
+        throw AstroException("Eclipse search needs an ephemeris cache for the Sun");
+    addOcculter(centralBody, centralRadius);
+}
+
+void EclipseFinder::addOcculter(int body, double radius)
+{
+    if (radius <= 0.0)
+        throw AstroException("Zero or negative radius of occulting body");
+    occulters.push_back({ body, radius });
+}
+
+void EclipseFinder::setStepLimits(const TimeDelta& _minStep, const TimeDelta& _maxStep)
+{
+    if (_minStep.value <= 0.0 || _maxStep.value < _minStep.value)
+        throw AstroException("Eclipse search needs 0 < minimum step <= maximum step");
+    minStep = _minStep.value;
+    maxStep = _maxStep.value;
+}
+
+void EclipseFinder::setTolerance(const TimeDelta& _tol)
+{
+    if (_tol.value <= 0.0)
+        throw AstroException("Eclipse search needs a positive tolerance");
+    tol = _tol.value;
+}
+
+void EclipseFinder::boundaries(const PosState& s, const EphemerisTime& et, double* f, double* rate, bool* larger) const
+{
+    PosState sun, center, body;
+    ephemeris->getState(10, et, sun);
+    ephemeris->getState(centralBody, et, center);
+
+    // The object relative to the SSB
+    Vec3 r = center.r + s.r;
+    Vec3 v = center.v + s.v;
+    Vec3 d    = sun.r - r; // To the Sun
+    Vec3 ddot = sun.v - v;
+    double ld = glm::length(d);
+
+    for (size_t k = 0; k < occulters.size(); ++k)
+    {
+        if (occulters[k].body == centralBody)
+            body = center;
+        else
+            ephemeris->getState(occulters[k].body, et, body);
+
+        Vec3       o    = body.r - r; // To the occulting body
+        Vec3       odot = body.v - v;
+        ShadowCone cone(d, o, occulters[k].radius);
+        double     a    = cone.a;
+        double     b    = cone.b;
+
+        f[2 * k]     = cone.c - (a + b);
+        f[2 * k + 1] = cone.c - std::abs(b - a);
+        if (larger)
+            larger[k] = b > a;
+
+        if (rate)
+        {
+            // Angular rates of the two directions bound the rate of c, and the
+            // rates of the distances give those of the apparent radii,
+            // d(asin(R / l))/dt = tan(a) |l'| / l
+            double lo = glm::length(o);
+            double wc = glm::length(glm::cross(o, odot)) / (lo * lo) + glm::length(glm::cross(d, ddot)) / (ld * ld);
+            double wa = (a < PI / 2.0) ? std::tan(a) * std::abs(glm::dot(d, ddot)) / (ld * ld) : 0.0;
+            double wb = (b < PI / 2.0) ? std::tan(b) * std::abs(glm::dot(o, odot)) / (lo * lo) : 0.0;
+            rate[2 * k]     = wc + wa + wb;
+            rate[2 * k + 1] = wc + wa + wb;
+        }
+    }
+}
+
+std::vector<EclipseInterval> EclipseFinder::find(Orbit& orbit, const EphemerisTime& et0, const EphemerisTime& et1) const
+{
+    if (!(et0 < et1))
+        throw AstroException("Eclipse search needs et1 after et0");
+
+    size_t nf = 2 * occulters.size();
+    std::vector<double> f0(nf), f1(nf), rate(nf), fr(nf);
+    std::vector<bool>   open(nf, false);
+    std::vector<double> start(nf);
+    std::unique_ptr<bool[]> larger(new bool[occulters.size()]);
+
+    std::vector<EclipseInterval> res;
+    auto close = [&](size_t j, double end, bool isLarger) {
+        EclipseType type = (j % 2 == 0) ? EclipseType::Penumbra : (isLarger ? EclipseType::Umbra : EclipseType::Annular);
+        res.push_back({ 0, occulters[j / 2].body, type, EphemerisTime(start[j]), EphemerisTime(end) });
+    };
+
+    double t  = et0.getETValue();
+    double t1 = et1.getETValue();
+    boundaries(orbit.getState(et0), et0, f0.data(), rate.data(), larger.get());
+    std::vector<bool> openLarger(occulters.size());
+    for (size_t j = 0; j < nf; ++j)
+        if (f0[j] < 0.0)
+        {
+            open[j]  = true;
+            start[j] = t;
+            if (j % 2 == 1)
+                openLarger[j / 2] = larger[j / 2];
+        }
+
+    while (t < t1)
+    {
+        // As far as the nearest boundary can be reached at half its rate bound
+        double h = maxStep;
+        for (size_t j = 0; j < nf; ++j)
+            if (rate[j] > 0.0)
+                h = std::min(h, 0.5 * std::abs(f0[j]) / rate[j]);
+        h = std::max(h, minStep);
+        double tn = std::min(t + h, t1);
+
+        EphemerisTime etn(tn);
+        boundaries(orbit.getState(etn), etn, f1.data(), rate.data(), larger.get());
+
+        for (size_t j = 0; j < nf; ++j)
+        {
+            if ((f0[j] < 0.0) == (f1[j] < 0.0))
+                continue;
+
+            // Entering: the function falls through zero; leaving: it rises
+            double sign = (f1[j] < 0.0) ? -1.0 : 1.0;
+            auto g = [&](double tx) {
+                EphemerisTime etx(tx);
+                boundaries(orbit.getState(etx), etx, fr.data(), nullptr, nullptr);
+                return sign * fr[j];
+            };
+            double tc = findRoot(g, t, sign * f0[j], tn, sign * f1[j], tol);
+
+            if (f1[j] < 0.0)
+            {
+                open[j]  = true;
+                start[j] = tc;
+                if (j % 2 == 1)
+                {
+                    boundaries(orbit.getState(EphemerisTime(tc)), EphemerisTime(tc), fr.data(), nullptr, larger.get());
+                    openLarger[j / 2] = larger[j / 2];
+                }
+            }
+            else
+            {
+                open[j] = false;
+                close(j, tc, openLarger[j / 2]);
+            }
+        }
+
+        t = tn;
+        f0.swap(f1);
+    }
+
+    for (size_t j = 0; j < nf; ++j)
+        if (open[j])
+            close(j, t1, openLarger[j / 2]);
+
+    std::stable_sort(res.begin(), res.end(), [](const EclipseInterval& x, const EclipseInterval& y) {
+        return x.start < y.start;
+    });
+    return res;
+}
+
+std::vector<EclipseInterval> EclipseFinder::find(const std::vector<Orbit*>& catalog,
+                                                 const EphemerisTime& et0, const EphemerisTime& et1,
+                                                 unsigned int threads) const
+{
+    std::vector<std::vector<EclipseInterval>> found(catalog.size());
+    parallelFor(catalog.size(), [&](size_t i) {
+        found[i] = find(*catalog[i], et0, et1);
+        for (auto& e : found[i])
+            e.object = i;
+    }, threads);
+
+    std::vector<EclipseInterval> res;
+    for (const auto& f : found)
+        res.insert(res.end(), f.begin(), f.end());
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,97 @@
+#ifndef _ASTRO_ECLIPSE_H_
+#define _ASTRO_ECLIPSE_H_
+
+#include <memory>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "Orbit.h"
+#include "Ephemeris.h"
+
+namespace astro {
+
+enum class EclipseType
+{
+    Penumbra, // Any part of the Sun hidden; spans the whole passage of the shadow
+    Umbra,    // The whole Sun hidden
+    Annular   // The body inside the solar disk, when it looks smaller than the Sun
+};
+
+struct EclipseInterval
+{
+    size_t        object;   // Index in the catalog
+    int           occulter; // Spice id of the body casting the shadow
+    EclipseType   type;
+    EphemerisTime start;    // Or the start of the search, if already in shadow
+    EphemerisTime end;      // Or the end of the search, if still in shadow
+};
+
+// Eclipse and occultation intervals with conical shadows, from the apparent
+// radii a (Sun) and b (body) and their separation c seen from the object (see
+// ShadowCone, shared with SolarRadiationPressure). Penumbra begins where
+// c = a + b, the umbra or the annular phase where c = |b - a|. A penumbra
+// interval spans the whole passage through the shadow; the umbra and annular
+// intervals lie within it.
+//
+// The Sun and the occulting bodies come from an ephemeris cache, which must
+// contain the Sun (10), the central body and the occulting bodies and cover
+// the search. Object states are relative to the central body, in J2000.
+//
+// Each object is stepped from the start to the end of the search with steps
+// adapted to how fast the shadow boundaries can be approached: the distance
+// c - (a + b) and c - |b - a| to each boundary over a bound on its rate, from
+// the angular rates of the Sun and the bodies and the rates of their apparent
+// radii. Long steps are taken far from any shadow and short ones near it.
+// The crossings are bracketed by sign changes and refined by root finding.
+// The objects of a catalog are searched in parallel, one thread per object.
+class EclipseFinder
+{
+public:
+    EclipseFinder(std::shared_ptr<const EphemerisCache> ephemeris, int centralBody = 399,
+                  double centralRadius = 6378.137);
+
+    // Adds a body that casts shadows besides the central body, e.g. the Moon
+    // (301, 1737.4 km)
+    void addOcculter(int body, double radius);
+
+    // Limits of the adaptive steps. Defaults are 1 s and 600 s
+    void setStepLimits(const TimeDelta& minStep, const TimeDelta& maxStep);
+
+    // Tolerance of the refined crossings. Default is 1 ms
+    void setTolerance(const TimeDelta& tol);
+
+    // Intervals of one object, ordered by start time. Its index is set to 0
+    std::vector<EclipseInterval> find(Orbit& orbit, const EphemerisTime& et0, const EphemerisTime& et1) const;
+
+    // Intervals of each object, ordered by object and start time. Each object
+    // is searched by one thread; threads = 0 uses all hardware cores
+    std::vector<EclipseInterval> find(const std::vector<Orbit*>& catalog,
+                                      const EphemerisTime& et0, const EphemerisTime& et1,
+                                      unsigned int threads = 0) const;
+
+private:
+    struct Occulter
+    {
+        int    body;
+        double radius;
+    };
+
+    // Distances to the shadow boundaries of each occulter at the state s,
+    // [2 k] for the penumbra and [2 k + 1] for the umbra or annular phase, and
+    // a bound on the rate of each. larger[k] is true if the body looks larger
+    // than the Sun. rate and larger may be null
+    void boundaries(const PosState& s, const EphemerisTime& et, double* f, double* rate, bool* larger) const;
+
+    std::shared_ptr<const EphemerisCache> ephemeris;
+    int centralBody;
+    std::vector<Occulter> occulters; // The central body first
+
+    double minStep;
+    double maxStep;
+    double tol;
+};
+
+} // namespace astro
+
+#endif
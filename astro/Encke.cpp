@@ -0,0 +1,198 @@
+#include "Encke.h"
+#include "RKF78.h"
+#include "Orbit.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astro {
+
+double Encke::rectificationThreshold = 0.01;
+double Encke::cowellThreshold        = 0.1;
+
+// Battin's f(q) = 1 - (1 + q)^-3/2, without cancellation for small q
+static double fq(double q)
+{
+    double s = std::pow(1.0 + q, 1.5);
+    return q * (3.0 + 3.0 * q + q * q) / (s * (1.0 + s));
+}
+
+static const Attractor& centralBody(const ODE& ode)
+{
+    if (ode.getAttractors().empty())
+        throw AstroException("Encke's method needs a central body attractor");
+    return ode.getAttractors().front();
+}
+
+// Rates of the deviation dr = r - r_ref, dv = v - v_ref from the reference
+// conic, where r is relative to the central body:
+//   dr'' = mu / r_ref^3 (f(q) r - dr) + a_p,   q = dr.(dr + 2 r_ref) / r_ref^2
+class DeviationODE : public ODE
+{
+public:
+    DeviationODE(const ODE& _ode, SimpleOrbit& _ref)
+        : ode(_ode), ref(_ref), central(centralBody(_ode))
+    {}
+
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+    {
+        operator()(x, dxdt, et, ForceStep());
+    }
+
+    // The perturbations are prepared by the full ODE
+    virtual void prepare(const EphemerisTime& et0, const EphemerisTime& et1, ForceStep& step) const
+    {
+        ode.prepare(et0, et1, step);
+    }
+
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et, const ForceStep& step) const
+    {
+        PosState sref = ref.getState(et);
+        Vec3   r      = sref.r + x.r;
+        double rref2  = glm::dot(sref.r, sref.r);
+        double rref3  = rref2 * std::sqrt(rref2);
+        double q      = glm::dot(x.r, x.r + 2.0 * sref.r) / rref2;
+
+        // Perturbation: the full acceleration less the central body term
+        double rn = glm::length(r);
+        Vec3   a  = ode.rates(et, PosState(r + central.p, sref.v + x.v), step).v;
+        Vec3   ap = a + r * (central.GM / (rn * rn * rn));
+
+        dxdt.r = x.v;
+        dxdt.v = (r * fq(q) - x.r) * (central.GM / rref3) + ap;
+    }
+
+private:
+    const ODE&       ode;
+    SimpleOrbit&     ref;
+    const Attractor& central;
+};
+
+// The deviation follows the linearized dynamics about the reference, which
+// oscillate with the orbital period. Steps are limited to a fraction of it, as
+// the error estimate of a near zero deviation does not see the instability of
+// longer steps
+static const double MAX_STEP_FRACTION = 0.1;
+
+static TimeDelta limitStep(const SimpleOrbit& ref, const TimeDelta& dt)
+{
+    if (!ref.isPeriodic())
+        return dt;
+    return TimeDelta(std::min(dt.value, MAX_STEP_FRACTION * ref.getPeriod()));
+}
+
+// Osculating reference conic through s, relative to the central body
+static SimpleOrbit reference(const Attractor& central, const PosState& s, const EphemerisTime& et)
+{
+    PosState rel(s.r - central.p, s.v);
+    return SimpleOrbit(OrbitElements::fromStateVectorOE(rel, et, central.GM));
+}
+
+void Encke::setRectificationThreshold(double ratio)
+{
+    if (ratio <= 0.0)
+        throw AstroException("Zero or negative rectification threshold not allowed");
+    rectificationThreshold = ratio;
+}
+
+void Encke::setCowellThreshold(double ratio)
+{
+    if (ratio <= 0.0)
+        throw AstroException("Zero or negative Cowell threshold not allowed");
+    cowellThreshold = ratio;
+}
+
+double Encke::perturbationRatio(const ODE& ode, const PosState& s, const EphemerisTime& et)
+{
+    const Attractor& central = centralBody(ode);
+    Vec3   r  = s.r - central.p;
+    double rn = glm::length(r);
+    Vec3   ac = r * (-central.GM / (rn * rn * rn));
+    Vec3   a  = ode.rates(et, s).v;
+    return glm::length(a - ac) / glm::length(ac);
+}
+
+Encke::Result Encke::doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    const Attractor& central = centralBody(ode);
+    SimpleOrbit ref = reference(central, s, et);
+    DeviationODE dode(ode, ref);
+
+    RKF78::Result res = RKF78::doStep(dode, PosState(Vec3(0.0), Vec3(0.0)), et, limitStep(ref, dt), maxNorm(s));
+    if (res.et == et)
+        return { s, et, res.dt_next, res.numTries };
+
+    PosState sref = ref.getState(res.et);
+    return { PosState(sref.r + res.s.r + central.p, sref.v + res.s.v), res.et, res.dt_next, res.numTries };
+}
+
+std::vector<Encke::Result> Encke::doSteps(const ODE& ode, const PosState& s,
+                                          const EphemerisTime& et0, const EphemerisTime& et1,
+                                          const TimeDelta& dt)
+{
+    const Attractor& central = centralBody(ode);
+
+    std::vector<Result> res;
+    res.push_back({ s, et0, dt, 0 });
+
+    bool cowell = perturbationRatio(ode, s, et0) > cowellThreshold;
+    SimpleOrbit ref = reference(central, s, et0);
+    DeviationODE dode(ode, ref);
+    PosState dev(Vec3(0.0), Vec3(0.0));
+
+    while (res.back().et < et1)
+    {
+        const Result& last = res.back();
+        Result next;
+
+        if (cowell)
+        {
+            RKF78::Result r = RKF78::doStep(ode, last.s, last.et, last.dt_next);
+            next = { r.s, r.et, r.dt_next, r.numTries };
+        }
+        else
+        {
+            PosState sref = ref.getState(last.et);
+            RKF78::Result r = RKF78::doStep(dode, dev, last.et, limitStep(ref, last.dt_next), maxNorm(sref));
+            next = { last.s, r.et, r.dt_next, r.numTries };
+            if (!(r.et == last.et))
+            {
+                dev  = r.s;
+                sref = ref.getState(r.et);
+                next.s = PosState(sref.r + dev.r + central.p, sref.v + dev.v);
+
+                // Rectify when the deviation is no longer small
+                if (glm::length(dev.r) > rectificationThreshold * glm::length(sref.r))
+                {
+                    ref = reference(central, next.s, next.et);
+                    dev = PosState(Vec3(0.0), Vec3(0.0));
+                }
+            }
+        }
+
+        // Switch method when the perturbations have changed enough
+        if (!(next.et == last.et))
+        {
+            double ratio = perturbationRatio(ode, next.s, next.et);
+            if (!cowell && ratio > cowellThreshold)
+            {
+                cowell = true;
+            }
+            else if (cowell && ratio < 0.5 * cowellThreshold)
+            {
+                cowell = false;
+                ref = reference(central, next.s, next.et);
+                dev = PosState(Vec3(0.0), Vec3(0.0));
+            }
+        }
+
+        if (next.et + next.dt_next > et1)
+            next.dt_next = et1 - next.et;
+        res.push_back(next);
+    }
+
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,65 @@
+#ifndef _ASTRO_ENCKE_H_
+#define _ASTRO_ENCKE_H_
+
+#include <vector>
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Encke's method: integrates only the deviation of the state from a reference
+// conic, a SimpleOrbit about the central body which is evaluated analytically.
+// The deviation and its rates stay small when the perturbations are weak, so
+// RKF78 can take much longer steps than when integrating the full state
+// (Cowell's method) at the same tolerance. The deviation equation uses
+// Battin's f(q) formulation to avoid the cancellation between the two central
+// body terms (R. H. Battin, "An Introduction to the Mathematics and Methods of
+// Astrodynamics", 1999, ch. 9.4).
+//
+// The central body is the first attractor of the ODE. The perturbing
+// acceleration is the full rates of the ODE minus the central body term, so
+// any ODE subclass can be used.
+//
+// The reference is rectified, i.e. rebuilt from the current osculating
+// state, when the deviation grows beyond the rectification threshold. When
+// the perturbations become comparable to the central body acceleration (e.g.
+// during powered flight or a close approach to another attractor) the
+// integration switches to Cowell's method, and back when they have decreased.
+class Encke
+{
+public:
+    struct Result
+    {
+        PosState     s;
+        EphemerisTime et;
+        TimeDelta    dt_next;
+        int          numTries;
+    };
+
+    // One RKF78 step of the deviation from a reference through s. As for
+    // RKF78, a rejected step is returned with et unchanged
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
+                                       const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+
+    // Rectify when |dr| / |r_ref| exceeds this. Default is 0.01
+    static void setRectificationThreshold(double ratio);
+
+    // Switch to Cowell's method when |a_perturbation| / |a_central| exceeds
+    // this, and back at half of it. Default is 0.1
+    static void setCowellThreshold(double ratio);
+
+    // Returns |a_perturbation| / |a_central| for the ODE at the given state
+    static double perturbationRatio(const ODE& ode, const PosState& s, const EphemerisTime& et);
+
+private:
+    static double rectificationThreshold;
+    static double cowellThreshold;
+};
+
+} // namespace astro
+
+#endif
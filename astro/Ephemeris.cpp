@@ -0,0 +1,216 @@
+#include "Ephemeris.h"
+#include "Interpolate.h"
+#include "ReferenceFrame.h"
+#include "Exceptions.h"
+
+#include <cspice/SpiceUsr.h>
+#include <cmath>
+#include <sstream>
+
+namespace astro {
+
+EphemerisCache::EphemerisCache(const std::vector<int>& bodies, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step)
+    : t0(et0.getETValue()), t1(et1.getETValue()), h(step.value)
+{
+    if (h <= 0.0)
+        throw AstroException("Zero or negative step given for ephemeris cache");
+    if (t1 <= t0)
+        throw AstroException("Empty time span given for ephemeris cache");
+
+    n = static_cast<size_t>(std::ceil((t1 - t0) / h)) + 1;
+    for (int body : bodies)
+        if (body != 0 && !index.count(body))
+        {
+            size_t first = index.size() * n;
+            index[body] = first;
+        }
+    nodes.resize(index.size() * n);
+
+    {
+        // One lock for all bodies and epochs
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        for (const auto& b : index)
+        {
+            for (size_t k = 0; k < n && !failed_c(); ++k)
+            {
+                double s[6];
+                spkssb_c(b.first, t0 + k * h, "J2000", s);
+                nodes[b.second + k] = PosState(Vec3(s[0], s[1], s[2]), Vec3(s[3], s[4], s[5]));
+            }
+        }
+    }
+    Spice().checkError();
+}
+
+const PosState* EphemerisCache::nodesOf(int body) const
+{
+    auto it = index.find(body);
+    if (it == index.end())
+    {
+        std::ostringstream ss;
+        ss << "Body " << body << " is not in the ephemeris cache";
+        throw AstroException(ss.str());
+    }
+    return &nodes[it->second];
+}
+
+void EphemerisCache::getState(int body, const EphemerisTime& et, PosState& state) const
+{
+    if (body == 0)
+    {
+        state = PosState();
+        return;
+    }
+
+    const PosState* s = nodesOf(body);
+    double t = et.getETValue();
+    if (t < t0 || t > t1)
+    {
+        std::ostringstream ss;
+        ss << "Time " << t << " is outside the ephemeris cache span [" << t0 << ", " << t1 << "]";
+        throw AstroException(ss.str());
+    }
+
+    size_t i = static_cast<size_t>((t - t0) / h);
+    if (i > n - 2)
+        i = n - 2;
+
+    // Cubic Hermite basis functions and their derivatives, as in hermite()
+    // but without pow()
+    double x   = (t - (t0 + i * h)) / h;
+    double x2  = x * x;
+    double x3  = x2 * x;
+    double h00 = 2.0 * x3 - 3.0 * x2 + 1.0;
+    double h10 = x3 - 2.0 * x2 + x;
+    double h11 = x3 - x2;
+    double d00 = 6.0 * x2 - 6.0 * x;
+    double d10 = 3.0 * x2 - 4.0 * x + 1.0;
+    double d11 = 3.0 * x2 - 2.0 * x;
+    const PosState& s1 = s[i];
+    const PosState& s2 = s[i + 1];
+    state.r = h00 * s1.r + (1.0 - h00) * s2.r + (h10 * h) * s1.v + (h11 * h) * s2.v;
+    state.v = (d00 * (s1.r - s2.r)) / h + d10 * s1.v + d11 * s2.v;
+}
+
+void EphemerisCache::getPosition(int body, const EphemerisTime& et, Vec3& position) const
+{
+    if (body == 0)
+    {
+        position = Vec3(0.0);
+        return;
+    }
+
+    const PosState* s = nodesOf(body);
+    double t = et.getETValue();
+    if (t < t0 || t > t1)
+    {
+        std::ostringstream ss;
+        ss << "Time " << t << " is outside the ephemeris cache span [" << t0 << ", " << t1 << "]";
+        throw AstroException(ss.str());
+    }
+
+    size_t i = static_cast<size_t>((t - t0) / h);
+    if (i > n - 2)
+        i = n - 2;
+
+    // Cubic Hermite basis functions, as in hermite(), position only
+    double x   = (t - (t0 + i * h)) / h;
+    double x2  = x * x;
+    double x3  = x2 * x;
+    double h00 = 2.0 * x3 - 3.0 * x2 + 1.0;
+    double h01 = 1.0 - h00;
+    double h10 = x3 - 2.0 * x2 + x;
+    double h11 = x3 - x2;
+    const PosState& s1 = s[i];
+    const PosState& s2 = s[i + 1];
+    position = h00 * s1.r + h01 * s2.r + (h10 * h) * s1.v + (h11 * h) * s2.v;
+}
+
+bool EphemerisCache::hasBody(int body) const
+{
+    return body == 0 || index.count(body) > 0;
+}
+
+bool EphemerisCache::covers(const EphemerisTime& et) const
+{
+    return et.getETValue() >= t0 && et.getETValue() <= t1;
+}
+
+// Corrects a position for stellar aberration, as Spice stelab_c does:
+// rotates p towards the observer velocity by asin(|u x v/c|)
+static Vec3 stellarAberration(const Vec3& p, const Vec3& vobs, double c)
+{
+    Vec3 axis = glm::cross(glm::normalize(p), vobs / c);
+    double sinphi = glm::length(axis);
+    if (sinphi == 0.0)
+        return p;
+
+    double phi = std::asin(sinphi);
+    Vec3 k = axis / sinphi;
+    return p * std::cos(phi) + glm::cross(k, p) * std::sin(phi) + k * (glm::dot(k, p) * (1.0 - std::cos(phi)));
+}
+
+void EphemerisCache::getApparentPositions(const Observer& obs, const std::vector<int>& targets, const EphemerisTime& et,
+                                          std::vector<Vec3>& out, AberrationCorrection abcorr) const
+{
+    // Observer state relative to the SSB in J2000
+    ReferenceFrame rf = obs.getReferenceFrame();
+    StateTransform toJ2000 = rf.getStateTransformToJ2000(et);
+    PosState obsState = obs.getState().P;
+    PosState center;
+    getState(obs.getCenterObject(), et, center);
+    PosState obsSSB(toJ2000.applyPosition(obsState.r) + center.r,
+                    toJ2000.applyVelocity(obsState.r, obsState.v) + center.v);
+
+    int iterations = 0;
+    switch (abcorr)
+    {
+        case None:
+            break;
+        case LightTime:
+        case LightTimeStellar:
+            iterations = 1;
+            break;
+        case CNLightTime:
+        case CNLightTimeStellar:
+            iterations = 5;
+            break;
+        default:
+            throw AstroException("Aberration correction not implemented");
+    }
+    bool stellar = abcorr == LightTimeStellar || abcorr == CNLightTimeStellar;
+    const double c = clight_c();
+
+    Mat3 toFrame = glm::transpose(toJ2000.R);
+    out.resize(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        PosState tgt;
+        getState(targets[i], et, tgt);
+        Vec3 p = tgt.r - obsSSB.r;
+
+        if (iterations > 0)
+        {
+            // Newtonian light time: the target is seen where it was at et - lt.
+            // Starting from the geometric distance, as Spice does.
+            double lt = glm::length(p) / c;
+            for (int k = 0; k < iterations; ++k)
+            {
+                getState(targets[i], et + TimeDelta(-lt), tgt);
+                p = tgt.r - obsSSB.r;
+                double ltNew = glm::length(p) / c;
+                bool converged = std::abs(ltNew - lt) <= 1.0E-15 * ltNew;
+                lt = ltNew;
+                if (converged)
+                    break;
+            }
+        }
+
+        if (stellar)
+            p = stellarAberration(p, obsSSB.v, c);
+
+        out[i] = toFrame * p;
+    }
+}
+
+} // namespace astro
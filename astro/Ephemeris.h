@@ -0,0 +1,115 @@
+#ifndef _ASTRO_EPHEMERIS_H_
+#define _ASTRO_EPHEMERIS_H_
+
+#include <map>
+#include <vector>
+
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "Observer.h"
+#include "SpiceCore.h"
+
+namespace astro {
+
+// States of a few bodies at both ends of a short span, e.g. an integration
+// step, looked up once so that positions inside the span cost one Hermite
+// interpolation and no cache lookups. For spans up to a day the error
+// against the cache is a few kilometers for the Moon relative to the Earth,
+// and much smaller for the steps of a low orbit
+struct BodyStates
+{
+    EphemerisTime         et0;
+    EphemerisTime         et1;
+    std::vector<PosState> s0; // At et0
+    std::vector<PosState> s1; // At et1
+
+    // Interpolation weights of the positions and velocities at et0 and et1
+    struct Weights
+    {
+        double r0, r1, v0, v1;
+    };
+
+    // Weights at et, between et0 and et1. Shared by all the bodies
+    Weights weights(const EphemerisTime& et) const
+    {
+        double h = (et1 - et0).value;
+        if (h == 0.0)
+            return { 1.0, 0.0, 0.0, 0.0 };
+
+        // Cubic Hermite basis functions, as in EphemerisCache::getPosition
+        double x   = (et - et0).value / h;
+        double x2  = x * x;
+        double x3  = x2 * x;
+        double h00 = 2.0 * x3 - 3.0 * x2 + 1.0;
+        return { h00, 1.0 - h00, (x3 - 2.0 * x2 + x) * h, (x3 - x2) * h };
+    }
+
+    // Position of body i at the time of the weights w
+    Vec3 position(size_t i, const Weights& w) const
+    {
+        return w.r0 * s0[i].r + w.r1 * s1[i].r + w.v0 * s0[i].v + w.v1 * s1[i].v;
+    }
+
+    // Position of body i at et, between et0 and et1
+    Vec3 position(size_t i, const EphemerisTime& et) const
+    {
+        return position(i, weights(et));
+    }
+};
+
+// Caches the states of a set of bodies relative to the solar system
+// barycenter (SSB), in J2000, over a time grid. Spice is sampled once, under
+// the Spice mutex, when the cache is constructed; all queries afterwards are
+// lock-free and safe to call from several threads at once.
+//
+// States between grid nodes are found by Hermite interpolation. With a one
+// hour step this is accurate to well below a meter for the planets and the
+// Moon.
+class EphemerisCache
+{
+public:
+    // bodies: Spice ids of the bodies to cache. The SSB (0) is always available
+    // et0, et1: time span covered by the cache
+    // step: grid spacing
+    EphemerisCache(const std::vector<int>& bodies, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step);
+
+    // Returns the state of a body relative to the SSB in J2000
+    void getState(int body, const EphemerisTime& et, PosState& state) const;
+
+    // Returns the position of a body relative to the SSB in J2000. Cheaper
+    // than getState, for force models evaluated in every integration stage
+    void getPosition(int body, const EphemerisTime& et, Vec3& position) const;
+
+    // Returns the apparent positions of the targets relative to the observer,
+    // in the observer's reference frame; out[i] is the position of targets[i].
+    // Light time is solved with one iteration for LightTime/LightTimeStellar,
+    // and iterated to convergence for CNLightTime/CNLightTimeStellar. Stellar
+    // aberration uses the observer velocity relative to the SSB, as in Spice.
+    // The observer center object and all targets must be in the cache, and
+    // the cache must cover et minus the light time to every target.
+    void getApparentPositions(const Observer& obs, const std::vector<int>& targets, const EphemerisTime& et,
+                              std::vector<Vec3>& out, AberrationCorrection abcorr = LightTimeStellar) const;
+
+    // True if the body is in the cache
+    bool hasBody(int body) const;
+
+    // True if et lies within the cached time span
+    bool covers(const EphemerisTime& et) const;
+
+private:
+    // Returns the grid states of a body, or throws if it is not cached
+    const PosState* nodesOf(int body) const;
+
+    double t0;
+    double t1;
+    double h;
+    size_t n;
+
+    std::map<int, size_t> index; // body id -> first node in 'nodes'
+    std::vector<PosState> nodes;
+};
+
+} // namespace astro
+
+#endif
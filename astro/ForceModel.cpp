@@ -0,0 +1,320 @@
+#include "ForceModel.h"
+#include "Ephemeris.h"
+#include "Exceptions.h"
+
+#include <cmath>
+
+// References:
+// [1]  D. A. Vallado, Fundamentals of Astrodynamics and Applications,
+//      4th ed. (2013), ch. 8.6.1
+// [2]  O. Montenbruck and E. Gill, Satellite Orbits (2000), ch. 3.2
+
+namespace astro {
+
+// ── ZonalHarmonicsForce ──────────────────────────────────────────────────────
+
+ZonalHarmonicsForce::ZonalHarmonicsForce(double _GM, double _re, const std::vector<double>& J, const Vec3& _center)
+    : GM(_GM), re(_re), J2(0.0), J3(0.0), J4(0.0), center(_center)
+{
+    if (J.size() > 3)
+        throw AstroException("Zonal harmonics above J4 are not supported");
+    if (J.size() > 0) J2 = J[0];
+    if (J.size() > 1) J3 = J[1];
+    if (J.size() > 2) J4 = J[2];
+}
+
+void ZonalHarmonicsForce::accumulate(const PosState& x, const EphemerisTime&, Vec3& a) const
+{
+    Vec3 r = x.r - center;
+    accumulateJ2(r, a);
+    if (J3 != 0.0 || J4 != 0.0)
+        accumulateJ34(r, a);
+}
+
+void ZonalHarmonicsForce::accumulateJ2(const Vec3& r, Vec3& a) const
+{
+    // Gradient of the J2 term of the potential, [1] eq. 8-30
+    double r2  = glm::dot(r, r);
+    double z2  = r.z * r.z / r2; // sin^2 of the latitude
+    double f2  = -1.5 * J2 * GM * re * re / (r2 * r2 * std::sqrt(r2));
+    a.x += f2 * r.x * (1.0 - 5.0 * z2);
+    a.y += f2 * r.y * (1.0 - 5.0 * z2);
+    a.z += f2 * r.z * (3.0 - 5.0 * z2);
+}
+
+void ZonalHarmonicsForce::accumulateJ34(const Vec3& r, Vec3& a) const
+{
+    // Gradients of the J3 and J4 terms of the potential, [1] eq. 8-30
+    double r2  = glm::dot(r, r);
+    double rr  = std::sqrt(r2);
+    double z2  = r.z * r.z / r2;
+    double q   = re / rr;
+    double f   = GM / (r2 * rr) * q * q; // GM re^2 / r^5
+
+    double f3 = -2.5 * J3 * f * q; // GM re^3 / r^6
+    double zr = r.z / rr;
+    a.x += f3 * r.x * zr * (3.0 - 7.0 * z2);
+    a.y += f3 * r.y * zr * (3.0 - 7.0 * z2);
+    a.z += f3 * rr * (6.0 * z2 - 7.0 * z2 * z2 - 0.6);
+
+    double f4 = 15.0 / 8.0 * J4 * f * q * q;
+    double c  = 1.0 - 14.0 * z2 + 21.0 * z2 * z2;
+    a.x += f4 * r.x * c;
+    a.y += f4 * r.y * c;
+    a.z += f4 * r.z * (5.0 - 70.0 / 3.0 * z2 + 21.0 * z2 * z2);
+}
+
+void ZonalHarmonicsForce::partials(const PosState& x, const EphemerisTime&, Mat3& dadr, Mat3&) const
+{
+    Vec3   r  = x.r - center;
+    double r2 = glm::dot(r, r);
+    double s  = r.z * r.z / r2;
+    double f2 = -1.5 * J2 * GM * re * re / (r2 * r2 * std::sqrt(r2));
+    Vec3   g(1.0 - 5.0 * s, 1.0 - 5.0 * s, 3.0 - 5.0 * s);
+
+    // d(f2 x_i g_i)/dx_j, with df2/dx_j = -5 f2 x_j / r^2 and
+    // ds/dx_j = 2 (z delta_jz - s x_j) / r^2
+    for (int j = 0; j < 3; ++j)
+    {
+        double ds = (j == 2 ? r.z : 0.0) - s * r[j];
+        for (int i = 0; i < 3; ++i)
+            dadr[j][i] += f2 / r2 * (-5.0 * r[i] * r[j] * g[i] + (i == j ? r2 * g[i] : 0.0) - 10.0 * r[i] * ds);
+    }
+
+    if (J3 == 0.0 && J4 == 0.0)
+        return;
+
+    double h = 1.0E-5 * std::sqrt(r2);
+    for (int j = 0; j < 3; ++j)
+    {
+        Vec3 dr(0.0);
+        dr[j] = h;
+        Vec3 ap(0.0), am(0.0);
+        accumulateJ34(r + dr, ap);
+        accumulateJ34(r - dr, am);
+        dadr[j] += (ap - am) / (2.0 * h);
+    }
+}
+
+// ── ThirdBodyForce ───────────────────────────────────────────────────────────
+
+ThirdBodyForce::ThirdBodyForce(std::shared_ptr<const EphemerisCache> _ephemeris, int _body, double _GM,
+                               int _centralBody, const Vec3& _center)
+    : ephemeris(_ephemeris), body(_body), GM(_GM), centralBody(_centralBody), center(_center)
+{
+    if (!ephemeris)
+        throw AstroException("Third body gravity needs an ephemeris cache");
+}
+
+void ThirdBodyForce::accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+{
+    Vec3 b, c;
+    ephemeris->getPosition(body, et, b);
+    ephemeris->getPosition(centralBody, et, c);
+
+    // Direct attraction minus that on the central body, [2] eq. 3.37
+    Vec3   s  = b - c;
+    Vec3   d  = s - (x.r - center);
+    double d2 = glm::dot(d, d);
+    double s2 = glm::dot(s, s);
+    a += GM * (d / (d2 * std::sqrt(d2)) - s / (s2 * std::sqrt(s2)));
+}
+
+void ThirdBodyForce::partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3&) const
+{
+    Vec3 b, c;
+    ephemeris->getPosition(body, et, b);
+    ephemeris->getPosition(centralBody, et, c);
+
+    // Only the direct term depends on r; d = s - r
+    dadr += gravityGradient(b - c - (x.r - center), GM);
+}
+
+// ── DragForce ────────────────────────────────────────────────────────────────
+
+DragForce::DragForce(std::shared_ptr<const Atmosphere> _atmosphere, double cd, double area_m2, double mass_kg,
+                     const Vec3& _omega, const Vec3& _center)
+    : atmosphere(_atmosphere), omega(_omega), center(_center)
+{
+    if (!atmosphere)
+        throw AstroException("Drag needs an atmosphere model");
+    if (cd <= 0.0 || area_m2 <= 0.0 || mass_kg <= 0.0)
+        throw AstroException("Drag coefficient, area and mass must be positive");
+    B = cd * area_m2 / mass_kg;
+}
+
+void DragForce::accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+{
+    // Position and velocity relative to the co-rotating atmosphere
+    Vec3 r    = x.r - center;
+    Vec3 vrel = x.v - glm::cross(omega, r);
+
+    // a = -1/2 rho B |v| v, with v in m/s; the result is converted to km/s^2
+    double rho = atmosphere->density(r, et);
+    a += vrel * (-0.5 * rho * B * glm::length(vrel) * 1000.0);
+}
+
+void DragForce::partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+{
+    Vec3   r    = x.r - center;
+    Vec3   vrel = x.v - glm::cross(omega, r);
+    double w    = glm::length(vrel);
+    double k    = -0.5 * B * 1000.0;
+    double rho  = atmosphere->density(r, et);
+
+    // a = k rho |w| w: da/dw = k rho (|w| I + w w^T / |w|)
+    Mat3 dadw(0.0);
+    if (w > 0.0)
+        dadw = (Mat3(w) + glm::outerProduct(vrel, vrel) / w) * (k * rho);
+    dadv += dadw;
+
+    // dw/dr = -[omega x], so column j of da/dr gets -dadw * (omega x e_j),
+    // plus the density gradient term k |w| w (drho/dr)^T
+    double h = 1.0E-5 * glm::length(r);
+    for (int j = 0; j < 3; ++j)
+    {
+        Vec3 e(0.0);
+        e[j] = 1.0;
+        Vec3 dr = e * h;
+        double drho = (atmosphere->density(r + dr, et) - atmosphere->density(r - dr, et)) / (2.0 * h);
+        dadr[j] += vrel * (k * w * drho) - dadw * glm::cross(omega, e);
+    }
+}
+
+double DragForce::getBallisticCoefficient() const
+{
+    return B;
+}
+
+// ── SRPForce ─────────────────────────────────────────────────────────────────
+
+SRPForce::SRPForce(std::shared_ptr<const SolarRadiationPressure> _srp, double mass_kg, const Vec3& _center)
+    : srp(_srp), mass(mass_kg), center(_center)
+{
+    if (!srp)
+        throw AstroException("Radiation pressure term needs a radiation pressure model");
+    if (mass <= 0.0)
+        throw AstroException("Zero or negative spacecraft mass");
+}
+
+void SRPForce::accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+{
+    a += srp->acceleration(x.r - center, et, mass);
+}
+
+void SRPForce::partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+{
+    numericPartials(*this, x, et, dadr, dadv, false);
+}
+
+void SRPForce::prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const
+{
+    srp->prepare(et0, et1, states);
+}
+
+void SRPForce::accumulate(const PosState& x, const EphemerisTime& et, const BodyStates& states, Vec3& a) const
+{
+    a += srp->acceleration(x.r - center, et, states, mass);
+}
+
+// ── ForceModel ───────────────────────────────────────────────────────────────
+
+ForceTerm::~ForceTerm()
+{}
+
+void ForceTerm::partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+{
+    numericPartials(*this, x, et, dadr, dadv);
+}
+
+bool ForceTerm::prepares() const
+{
+    return false;
+}
+
+void ForceTerm::prepare(const EphemerisTime&, const EphemerisTime&, BodyStates&) const
+{}
+
+void ForceTerm::accumulate(const PosState& x, const EphemerisTime& et, const BodyStates&, Vec3& a) const
+{
+    accumulate(x, et, a);
+}
+
+void ForceModel::add(std::shared_ptr<const ForceTerm> term)
+{
+    if (!term)
+        throw AstroException("Empty force term");
+    terms.push_back(term);
+    prepared = prepared || term->prepares();
+}
+
+void ForceModel::clear()
+{
+    terms.clear();
+    prepared = false;
+}
+
+size_t ForceModel::size() const
+{
+    return terms.size();
+}
+
+void ForceModel::accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+{
+    for (const auto& t : terms)
+        t->accumulate(x, et, a);
+}
+
+void ForceModel::prepare(const EphemerisTime& et0, const EphemerisTime& et1, ForceStep& step) const
+{
+    if (!prepared)
+    {
+        step.slots.clear();
+        return;
+    }
+
+    step.slots.resize(terms.size());
+    for (size_t i = 0; i < terms.size(); ++i)
+        if (terms[i]->prepares())
+            terms[i]->prepare(et0, et1, step.slots[i]);
+}
+
+void ForceModel::accumulate(const PosState& x, const EphemerisTime& et, const ForceStep& step, Vec3& a) const
+{
+    if (step.slots.size() != terms.size())
+    {
+        accumulate(x, et, a); // Not prepared
+        return;
+    }
+    for (size_t i = 0; i < terms.size(); ++i)
+        terms[i]->accumulate(x, et, step.slots[i], a);
+}
+
+void ForceModel::partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+{
+    for (const auto& t : terms)
+        t->partials(x, et, dadr, dadv);
+}
+
+void ForceModel::operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+{
+    dxdt.r = x.v;
+    dxdt.v = Vec3(0.0);
+    accumulate(x, et, dxdt.v);
+}
+
+void ForceModel::operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et, const ForceStep& step) const
+{
+    dxdt.r = x.v;
+    dxdt.v = Vec3(0.0);
+    accumulate(x, et, step, dxdt.v);
+}
+
+PosState ForceModel::rates(const EphemerisTime& et, const PosState& s) const
+{
+    PosState sdot;
+    operator()(s, sdot, et);
+    return sdot;
+}
+
+} // namespace astro
@@ -0,0 +1,448 @@
+#ifndef _ASTRO_FORCE_MODEL_H_
+#define _ASTRO_FORCE_MODEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "State.h"
+#include "Time.h"
+#include "Atmosphere.h"
+#include "Ephemeris.h"
+#include "RadiationPressure.h"
+
+namespace astro {
+
+// Force terms of the translational equations of motion. Each term has a
+// non-virtual kernel
+//
+//     void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+//
+// that adds its acceleration (km/s^2) to a, and may have a kernel
+//
+//     void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+//
+// that adds the partial derivatives of the acceleration with respect to the
+// position and the velocity, such that da = dadr * dr + dadv * dv. Terms
+// without one get central differences of accumulate().
+//
+// Terms whose inputs vary slowly over an integration step, e.g. the Sun
+// position, may also have the kernels
+//
+//     void prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const
+//     void accumulate(const PosState& x, const EphemerisTime& et, const BodyStates& states, Vec3& a) const
+//
+// Integrators that support it (RKF78) call prepare() once at the start of
+// each step from et0 to et1, and pass the result to every stage of the step.
+// It is local to the step, so the terms and the ODE hold no mutable state.
+//
+// Terms are combined either at run time by ForceModel, or at compile time by
+// StaticForceModel, which calls the kernels directly. Either way only the
+// enabled terms are evaluated.
+//
+// Terms that need a central body take its position 'center' in the frame of
+// the state, like the attractors of ODE; the state is then relative to it
+// for the atmosphere, radiation pressure and harmonics.
+
+class Attractor
+{
+public:
+    Vec3   p;  // Position relative to the frame of reference
+    double GM;
+};
+
+
+// Gradient of the point mass acceleration -GM r / |r|^3 with respect to r
+inline Mat3 gravityGradient(const Vec3& r, double GM)
+{
+    double r2 = glm::dot(r, r);
+    double k  = GM / (r2 * std::sqrt(r2));
+    return glm::outerProduct(r, r) * (3.0 * k / r2) - Mat3(k);
+}
+
+// Adds the partials of a term's acceleration by central differences. The
+// velocity partials are skipped unless 'velocity' is set
+template<typename Term>
+void numericPartials(const Term& term, const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv,
+                     bool velocity = true)
+{
+    double hr = 1.0E-5 * std::max(glm::length(x.r), 1.0);
+    double hv = 1.0E-5 * std::max(glm::length(x.v), 1.0E-3);
+    for (int j = 0; j < 3; ++j)
+    {
+        PosState p = x, m = x;
+        p.r[j] += hr;
+        m.r[j] -= hr;
+        Vec3 ap(0.0), am(0.0);
+        term.accumulate(p, et, ap);
+        term.accumulate(m, et, am);
+        dadr[j] += (ap - am) / (2.0 * hr);
+
+        if (!velocity)
+            continue;
+        p = x;
+        m = x;
+        p.v[j] += hv;
+        m.v[j] -= hv;
+        ap = Vec3(0.0);
+        am = Vec3(0.0);
+        term.accumulate(p, et, ap);
+        term.accumulate(m, et, am);
+        dadv[j] += (ap - am) / (2.0 * hv);
+    }
+}
+
+template<typename Term, typename = void>
+struct HasPartials : std::false_type {};
+
+template<typename Term>
+struct HasPartials<Term, std::void_t<decltype(std::declval<const Term&>().partials(
+    std::declval<const PosState&>(), std::declval<const EphemerisTime&>(),
+    std::declval<Mat3&>(), std::declval<Mat3&>()))>> : std::true_type {};
+
+// Adds the partials of any term, analytic where the term provides them
+template<typename Term>
+void termPartials(const Term& term, const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv)
+{
+    if constexpr (HasPartials<Term>::value)
+        term.partials(x, et, dadr, dadv);
+    else
+        numericPartials(term, x, et, dadr, dadv);
+}
+
+
+// Newtonian gravity of a point mass
+class PointMassForce
+{
+public:
+    explicit PointMassForce(const Attractor& a)
+        : attractor(a)
+    {}
+
+    void accumulate(const PosState& x, const EphemerisTime&, Vec3& a) const
+    {
+        Vec3   r  = x.r - attractor.p;
+        double r2 = glm::dot(r, r);
+        a -= r * (attractor.GM / (r2 * std::sqrt(r2)));
+    }
+
+    void partials(const PosState& x, const EphemerisTime&, Mat3& dadr, Mat3&) const
+    {
+        dadr += gravityGradient(x.r - attractor.p, attractor.GM);
+    }
+
+private:
+    Attractor attractor;
+};
+
+
+// Zonal harmonics J2, J3 and J4 of the central body, with the pole along the
+// Z axis of the frame. The point mass term is not included
+class ZonalHarmonicsForce
+{
+public:
+    // J: J2, J3, J4; missing terms are zero
+    ZonalHarmonicsForce(double GM, double re, const std::vector<double>& J, const Vec3& center = Vec3(0.0));
+
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const;
+
+    // Analytic for J2; J3 and J4 by central differences
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+private:
+    // Accelerations of J2 and of J3 + J4 at r relative to the center
+    void accumulateJ2(const Vec3& r, Vec3& a) const;
+    void accumulateJ34(const Vec3& r, Vec3& a) const;
+
+    double GM;
+    double re;
+    double J2, J3, J4;
+    Vec3   center;
+};
+
+
+// Gravity of a third body taken from an ephemeris cache, as a perturbation of
+// the motion relative to the central body (direct and indirect terms). The
+// cache must contain both bodies
+class ThirdBodyForce
+{
+public:
+    ThirdBodyForce(std::shared_ptr<const EphemerisCache> ephemeris, int body, double GM,
+                   int centralBody = 399, const Vec3& center = Vec3(0.0));
+
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const;
+
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+private:
+    std::shared_ptr<const EphemerisCache> ephemeris;
+    int    body;
+    double GM;
+    int    centralBody;
+    Vec3   center;
+};
+
+
+// Atmospheric drag with the drag coefficient cd, the cross section area (m^2)
+// and the mass (kg). The atmosphere co-rotates with the angular velocity omega
+class DragForce
+{
+public:
+    DragForce(std::shared_ptr<const Atmosphere> atmosphere, double cd, double area_m2, double mass_kg,
+              const Vec3& omega = Vec3(0.0, 0.0, 7.2921158553E-5), const Vec3& center = Vec3(0.0));
+
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const;
+
+    // Analytic, except for the density gradient, which is found by central
+    // differences
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+    // cd * A / m (m^2/kg)
+    double getBallisticCoefficient() const;
+
+private:
+    std::shared_ptr<const Atmosphere> atmosphere;
+    double B;
+    Vec3   omega;
+    Vec3   center;
+};
+
+
+// Solar radiation pressure on a spacecraft of the given mass (kg)
+class SRPForce
+{
+public:
+    SRPForce(std::shared_ptr<const SolarRadiationPressure> srp, double mass_kg, const Vec3& center = Vec3(0.0));
+
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const;
+
+    // Position partials by central differences; no velocity dependence
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+    // Looks up the Sun and the occulting bodies once per step
+    void prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const;
+
+    void accumulate(const PosState& x, const EphemerisTime& et, const BodyStates& states, Vec3& a) const;
+
+private:
+    std::shared_ptr<const SolarRadiationPressure> srp;
+    double mass;
+    Vec3   center;
+};
+
+
+// Constant acceleration (km/s^2) in the inertial frame, e.g. from thrust
+class ThrustForce
+{
+public:
+    explicit ThrustForce(const Vec3& acceleration)
+        : acc(acceleration)
+    {}
+
+    void accumulate(const PosState&, const EphemerisTime&, Vec3& a) const
+    {
+        a += acc;
+    }
+
+    void partials(const PosState&, const EphemerisTime&, Mat3&, Mat3&) const
+    {}
+
+private:
+    Vec3 acc;
+};
+
+
+template<typename Term, typename = void>
+struct HasPrepare : std::false_type {};
+
+template<typename Term>
+struct HasPrepare<Term, std::void_t<decltype(std::declval<const Term&>().prepare(
+    std::declval<const EphemerisTime&>(), std::declval<const EphemerisTime&>(),
+    std::declval<BodyStates&>()))>> : std::true_type {};
+
+
+// Interface of the terms of a ForceModel
+class ForceTerm
+{
+public:
+    virtual ~ForceTerm();
+
+    virtual void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const = 0;
+
+    // Central differences of accumulate() unless overridden
+    virtual void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+    // True if the term prepares its inputs once per step. False unless
+    // overridden, and then the two functions below are never called
+    virtual bool prepares() const;
+
+    virtual void prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const;
+
+    virtual void accumulate(const PosState& x, const EphemerisTime& et, const BodyStates& states, Vec3& a) const;
+};
+
+// Wraps one of the force terms above, or any class with an accumulate kernel,
+// as a ForceTerm
+template<typename Term>
+class ForceTermOf : public ForceTerm
+{
+public:
+    explicit ForceTermOf(const Term& _term)
+        : term(_term)
+    {}
+
+    virtual void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+    {
+        term.accumulate(x, et, a);
+    }
+
+    virtual void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+    {
+        termPartials(term, x, et, dadr, dadv);
+    }
+
+    virtual bool prepares() const
+    {
+        return HasPrepare<Term>::value;
+    }
+
+    virtual void prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const
+    {
+        if constexpr (HasPrepare<Term>::value)
+            term.prepare(et0, et1, states);
+    }
+
+    virtual void accumulate(const PosState& x, const EphemerisTime& et, const BodyStates& states, Vec3& a) const
+    {
+        if constexpr (HasPrepare<Term>::value)
+            term.accumulate(x, et, states, a);
+        else
+            term.accumulate(x, et, a);
+    }
+
+    Term term;
+};
+
+// Returns term as a ForceTerm, wrapping it unless it already is a pointer to one
+template<typename Term>
+std::shared_ptr<const ForceTerm> makeForceTerm(const Term& term)
+{
+    if constexpr (std::is_convertible<Term, std::shared_ptr<const ForceTerm>>::value)
+        return term;
+    else
+        return std::make_shared<ForceTermOf<Term>>(term);
+}
+
+
+// Inputs of the terms of a ForceModel prepared for one integration step, one
+// slot per term. Empty if no term prepares any
+struct ForceStep
+{
+    std::vector<BodyStates> slots;
+};
+
+
+// Force model configured at run time, with one virtual call per term
+class ForceModel
+{
+public:
+    // Appends a term; any class with an accumulate kernel
+    template<typename Term>
+    void add(const Term& term)
+    {
+        add(makeForceTerm(term));
+    }
+
+    void add(std::shared_ptr<const ForceTerm> term);
+
+    void clear();
+
+    size_t size() const;
+
+    // Adds the accelerations of all terms to a
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const;
+
+    // Prepares the terms for a step from et0 to et1. The storage of step is
+    // reused, so integrators keep one across their steps
+    void prepare(const EphemerisTime& et0, const EphemerisTime& et1, ForceStep& step) const;
+
+    // As accumulate() above, at a stage of the prepared step
+    void accumulate(const PosState& x, const EphemerisTime& et, const ForceStep& step, Vec3& a) const;
+
+    // Adds the partials of all terms to dadr and dadv
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const;
+
+    // Callable interface required by ODE solvers
+    void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const;
+
+    void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et, const ForceStep& step) const;
+
+    PosState rates(const EphemerisTime& et, const PosState& s) const;
+
+private:
+    std::vector<std::shared_ptr<const ForceTerm>> terms;
+    bool prepared = false; // True if any term prepares its inputs
+};
+
+
+// Force model fixed at compile time. The kernels are called directly and can
+// be inlined, e.g.
+//
+//     StaticForceModel<PointMassForce, ZonalHarmonicsForce> f(PointMassForce(earth),
+//                                                            ZonalHarmonicsForce(mu, re, {J2}));
+//
+// Can be used with the templated solvers (RK, Yoshida) and RKF78::step
+template<typename... Terms>
+class StaticForceModel
+{
+public:
+    explicit StaticForceModel(const Terms&... _terms)
+        : terms(_terms...)
+    {}
+
+    template<size_t I>
+    const typename std::tuple_element<I, std::tuple<Terms...>>::type& get() const
+    {
+        return std::get<I>(terms);
+    }
+
+    template<size_t I>
+    typename std::tuple_element<I, std::tuple<Terms...>>::type& get()
+    {
+        return std::get<I>(terms);
+    }
+
+    void accumulate(const PosState& x, const EphemerisTime& et, Vec3& a) const
+    {
+        std::apply([&](const Terms&... t) { (t.accumulate(x, et, a), ...); }, terms);
+    }
+
+    void partials(const PosState& x, const EphemerisTime& et, Mat3& dadr, Mat3& dadv) const
+    {
+        std::apply([&](const Terms&... t) { (termPartials(t, x, et, dadr, dadv), ...); }, terms);
+    }
+
+    void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+    {
+        dxdt.r = x.v;
+        dxdt.v = Vec3(0.0);
+        accumulate(x, et, dxdt.v);
+    }
+
+    PosState rates(const EphemerisTime& et, const PosState& s) const
+    {
+        PosState sdot;
+        operator()(s, sdot, et);
+        return sdot;
+    }
+
+private:
+    std::tuple<Terms...> terms;
+};
+
+} // namespace astro
+
+#endif
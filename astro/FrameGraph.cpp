@@ -0,0 +1,318 @@
+#include "FrameGraph.h"
+#include "Orbit.h"
+#include "SpiceCore.h"
+#include "Exceptions.h"
+#include "Util.h"
+
+#include <cspice/SpiceUsr.h>
+#include <sstream>
+
+namespace astro {
+
+FrameGraph::FrameGraph()
+{
+    FrameId root = addNode("J2000", RootFrame, 0);
+    nodes[root].parent   = root;
+    nodes[root].constant = true;
+}
+
+FrameGraph::FrameId FrameGraph::getRoot() const
+{
+    return 0;
+}
+
+FrameGraph::FrameId FrameGraph::addNode(const std::string& name, FrameNodeType type, FrameId parent)
+{
+    if (names.count(name))
+        throw AstroException("Frame '" + name + "' already exists in frame graph");
+    if (!nodes.empty() && parent >= nodes.size())
+        throw AstroException("Unknown parent frame given for frame '" + name + "'");
+
+    Node n;
+    n.name        = name;
+    n.type        = type;
+    n.parent      = parent;
+    n.depth       = nodes.empty() ? 0 : nodes[parent].depth + 1;
+    n.dt          = 0.0;
+    n.constant    = false;
+    n.edgeValid   = false;
+    n.edgeEt      = 0.0;
+    n.toRootValid = false;
+    n.toRootEt    = 0.0;
+
+    nodes.push_back(n);
+    names[name] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+FrameGraph::FrameId FrameGraph::addSpiceFrame(const std::string& spiceName)
+{
+    int frameId = 0;
+    int center  = 0;
+    int frClass = 0;
+    int classId = 0;
+    int found   = 0;
+    {
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        namfrm_c(spiceName.c_str(), &frameId);
+        if (frameId != 0)
+            frinfo_c(frameId, &center, &frClass, &classId, &found);
+    }
+    Spice().checkError();
+
+    if (!found)
+        throw AstroException("Spice frame '" + spiceName + "' not found in loaded kernels");
+
+    FrameId id = addNode(spiceName, SpiceFrame, getRoot());
+    const int INERTIAL_FRAME_CLASS = 1;
+    nodes[id].spiceName = spiceName;
+    nodes[id].constant  = (frClass == INERTIAL_FRAME_CLASS);
+    return id;
+}
+
+FrameGraph::FrameId FrameGraph::addBodyFixedFrame(const std::string& name, const ReferenceFrame& rf)
+{
+    FrameId id = addNode(name, BodyFixedFrame, getRoot());
+    nodes[id].frame    = rf;
+    nodes[id].constant = (rf.getType() != ReferenceFrameType::BodyFixedRotating);
+    return id;
+}
+
+FrameGraph::FrameId FrameGraph::addTopocentricFrame(const std::string& name, FrameId parent,
+                                                    double lon, double lat, double alt, double re, double f)
+{
+    Vec3 site;
+    geodeticToVec(lon, lat, alt, re, f, &site);
+
+    FrameId id = addNode(name, TopocentricFrame, parent);
+    nodes[id].constant  = true;
+    nodes[id].edge      = StateTransform(getEnuRotation(lon, lat), Mat3(0.0), site, Vec3(0.0));
+    nodes[id].edgeValid = true;
+    return id;
+}
+
+FrameGraph::FrameId FrameGraph::addFixedFrame(const std::string& name, FrameId parent, const Mat3& R, const Vec3& offset)
+{
+    FrameId id = addNode(name, FixedFrame, parent);
+    nodes[id].constant  = true;
+    nodes[id].edge      = StateTransform(R, Mat3(0.0), offset, Vec3(0.0));
+    nodes[id].edgeValid = true;
+    return id;
+}
+
+FrameGraph::FrameId FrameGraph::addOrbitFrame(const std::string& name, FrameId parent, FrameNodeType type,
+                                              std::shared_ptr<Orbit> orbit, double dt)
+{
+    if (type != RSWFrame && type != LVLHFrame && type != VNCFrame)
+        throw AstroException("Orbit frames must be of type RSW, LVLH or VNC");
+    if (!orbit)
+        throw AstroException("No orbit given for orbit frame '" + name + "'");
+    if (dt <= 0.0)
+        throw AstroException("Zero or negative differencing step given for orbit frame '" + name + "'");
+
+    FrameId id = addNode(name, type, parent);
+    nodes[id].orbit = orbit;
+    nodes[id].dt    = dt;
+    return id;
+}
+
+const FrameGraph::Node& FrameGraph::node(FrameId id) const
+{
+    if (id >= nodes.size())
+    {
+        std::ostringstream ss;
+        ss << "Unknown frame id " << id << " in frame graph";
+        throw AstroException(ss.str());
+    }
+    return nodes[id];
+}
+
+FrameGraph::FrameId FrameGraph::getFrame(const std::string& name) const
+{
+    auto it = names.find(name);
+    if (it == names.end())
+        throw AstroException("Frame '" + name + "' not found in frame graph");
+    return it->second;
+}
+
+bool FrameGraph::hasFrame(const std::string& name) const
+{
+    return names.count(name) > 0;
+}
+
+std::string FrameGraph::getName(FrameId id) const
+{
+    return node(id).name;
+}
+
+FrameNodeType FrameGraph::getType(FrameId id) const
+{
+    return node(id).type;
+}
+
+FrameGraph::FrameId FrameGraph::getParent(FrameId id) const
+{
+    return node(id).parent;
+}
+
+// Axes of an orbit frame, given in the frame of the orbit state
+static Mat3 orbitAxes(FrameNodeType type, const PosState& s)
+{
+    Vec3 h = glm::normalize(glm::cross(s.r, s.v));
+    switch (type)
+    {
+        case RSWFrame:
+        {
+            Vec3 r = glm::normalize(s.r);
+            return Mat3(r, glm::cross(h, r), h);
+        }
+        case LVLHFrame:
+        {
+            Vec3 z = -glm::normalize(s.r);
+            Vec3 y = -h;
+            return Mat3(glm::cross(y, z), y, z);
+        }
+        case VNCFrame:
+        {
+            Vec3 v = glm::normalize(s.v);
+            return Mat3(v, h, glm::cross(v, h));
+        }
+        default:
+            throw AstroException("Not an orbit frame type");
+    }
+}
+
+StateTransform FrameGraph::computeEdge(const Node& n, const EphemerisTime& et)
+{
+    switch (n.type)
+    {
+        case RootFrame:
+            return StateTransform();
+
+        case SpiceFrame:
+        {
+            // sxform_c gives the 6x6 transformation to J2000 in row-major order
+            double xform[6][6];
+            {
+                std::lock_guard<std::mutex> lock(Spice().mutex());
+                sxform_c(n.spiceName.c_str(), "J2000", et.getETValue(), xform);
+            }
+            Spice().checkError();
+
+            StateTransform st;
+            for (int col = 0; col < 3; ++col)
+                for (int row = 0; row < 3; ++row)
+                {
+                    st.R[col][row]  = xform[row][col];
+                    st.dR[col][row] = xform[row + 3][col];
+                }
+            return st;
+        }
+
+        case BodyFixedFrame:
+            return n.frame.getStateTransformToJ2000(et);
+
+        case RSWFrame:
+        case LVLHFrame:
+        case VNCFrame:
+        {
+            PosState s  = n.orbit->getState(et);
+            PosState sp = n.orbit->getState(et + TimeDelta(n.dt));
+            PosState sm = n.orbit->getState(et + TimeDelta(-n.dt));
+            Mat3 dR = (orbitAxes(n.type, sp) - orbitAxes(n.type, sm)) * (0.5 / n.dt);
+            return StateTransform(orbitAxes(n.type, s), dR, s.r, s.v);
+        }
+
+        default:
+            // Constant edges are set when the frame is added
+            throw AstroException("Frame '" + n.name + "' has no edge to compute");
+    }
+}
+
+const StateTransform& FrameGraph::getEdge(FrameId id, const EphemerisTime& et)
+{
+    Node& n = nodes[id];
+    if (n.edgeValid && (n.constant || n.edgeEt == et.getETValue()))
+        return n.edge;
+
+    n.edge      = computeEdge(n, et);
+    n.edgeEt    = et.getETValue();
+    n.edgeValid = true;
+    return n.edge;
+}
+
+const StateTransform& FrameGraph::getToRoot(FrameId id, const EphemerisTime& et)
+{
+    Node& n = nodes[id];
+    if (n.toRootValid && n.toRootEt == et.getETValue())
+        return n.toRoot;
+
+    if (id == getRoot())
+        n.toRoot = StateTransform();
+    else
+        n.toRoot = getToRoot(n.parent, et) * getEdge(id, et);
+    n.toRootEt    = et.getETValue();
+    n.toRootValid = true;
+    return n.toRoot;
+}
+
+StateTransform FrameGraph::getToAncestor(FrameId id, FrameId ancestor, const EphemerisTime& et)
+{
+    if (ancestor == getRoot())
+        return getToRoot(id, et);
+
+    StateTransform st;
+    for (FrameId i = id; i != ancestor; i = nodes[i].parent)
+        st = getEdge(i, et) * st;
+    return st;
+}
+
+StateTransform FrameGraph::getTransform(FrameId from, FrameId to, const EphemerisTime& et)
+{
+    node(from);
+    node(to);
+
+    // Find the closest common ancestor
+    FrameId a = from;
+    FrameId b = to;
+    while (nodes[a].depth > nodes[b].depth)
+        a = nodes[a].parent;
+    while (nodes[b].depth > nodes[a].depth)
+        b = nodes[b].parent;
+    while (a != b)
+    {
+        a = nodes[a].parent;
+        b = nodes[b].parent;
+    }
+
+    if (to == a)
+        return getToAncestor(from, a, et);
+    if (from == a)
+        return getToAncestor(to, a, et).inverse();
+    return getToAncestor(to, a, et).inverse() * getToAncestor(from, a, et);
+}
+
+PosState FrameGraph::transform(const PosState& s, FrameId from, FrameId to, const EphemerisTime& et)
+{
+    StateTransform st = getTransform(from, to, et);
+    return PosState(st.applyPosition(s.r), st.applyVelocity(s.r, s.v));
+}
+
+State FrameGraph::transform(const State& s, FrameId from, FrameId to, const EphemerisTime& et)
+{
+    StateTransform st = getTransform(from, to, et);
+    return State(PosState(st.applyPosition(s.P.r), st.applyVelocity(s.P.r, s.P.v)),
+                 RotState(glm::normalize(glm::quat_cast(st.R) * s.R.q), st.R * s.R.w));
+}
+
+void FrameGraph::clearCache()
+{
+    for (auto& n : nodes)
+    {
+        if (!n.constant)
+            n.edgeValid = false;
+        n.toRootValid = false;
+    }
+}
+
+} // namespace astro
@@ -0,0 +1,150 @@
+#ifndef _ASTRO_FRAME_GRAPH_H_
+#define _ASTRO_FRAME_GRAPH_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ReferenceFrame.h"
+
+namespace astro {
+
+class Orbit;
+
+// Kinds of frames in a frame graph
+enum FrameNodeType
+{
+    RootFrame,        // J2000, the root of every graph
+    SpiceFrame,       // Any Spice frame, relative to J2000
+    BodyFixedFrame,   // A ReferenceFrame, relative to J2000
+    TopocentricFrame, // East-North-Up at a site on a body-fixed frame
+    FixedFrame,       // Constant rotation and offset relative to its parent
+    RSWFrame,         // Radial, along-track (S), orbit normal (W)
+    LVLHFrame,        // x completes the triad, y = -orbit normal, z = nadir
+    VNCFrame,         // Velocity, orbit normal (N), co-normal (C = V x N)
+};
+
+// A tree of reference frames, each linked to its parent by a (possibly time
+// dependent) state transformation. Transformations between any two frames
+// are composed through their closest common ancestor.
+//
+// Constant edges (inertial Spice frames, topocentric and fixed frames) are
+// computed once. Time dependent edges, and each frame's transformation to
+// the root, are kept for the last epoch they were evaluated at, so several
+// conversions at the same epoch share the common part of their chains.
+// Body-fixed frames use the rotation cache of their ReferenceFrame if one
+// is attached.
+//
+// Inertial, Spice and body-fixed frames share the same origin, as in
+// State::transform. Topocentric and orbit frames carry their origin offset.
+//
+// Because of the cached epochs a FrameGraph is not thread safe; use one
+// graph (or a copy) per thread.
+class FrameGraph
+{
+public:
+    typedef size_t FrameId;
+
+    // Creates a graph containing only the J2000 root frame
+    FrameGraph();
+
+    FrameId getRoot() const;
+
+    // Adds a Spice frame (e.g. "ECLIPJ2000" or "ITRF93") under J2000.
+    // Inertial Spice frames become constant edges.
+    FrameId addSpiceFrame(const std::string& spiceName);
+
+    // Adds a ReferenceFrame under J2000. Rotating frames are evaluated through
+    // ReferenceFrame::getStateTransformToJ2000, i.e. with its rotation cache
+    FrameId addBodyFixedFrame(const std::string& name, const ReferenceFrame& rf);
+
+    // Adds an East-North-Up frame at geodetic lon, lat [rad] and alt [km] on
+    // the body-fixed parent, for a body with equatorial radius re [km] and
+    // flattening f
+    FrameId addTopocentricFrame(const std::string& name, FrameId parent,
+                                double lon, double lat, double alt, double re, double f);
+
+    // Adds a frame with constant axes R (r_parent = R * r + offset) and origin
+    // offset, both given in the parent frame
+    FrameId addFixedFrame(const std::string& name, FrameId parent, const Mat3& R, const Vec3& offset);
+
+    // Adds an orbit frame (RSWFrame, LVLHFrame or VNCFrame) following the given
+    // orbit. The orbit state must be relative to the origin, and in the axes, of
+    // the parent frame. The frame rotation rate is found by central differences
+    // over +-dt seconds.
+    FrameId addOrbitFrame(const std::string& name, FrameId parent, FrameNodeType type,
+                          std::shared_ptr<Orbit> orbit, double dt = 1.0);
+
+    // Returns the id of a named frame. Throws AstroException if not found
+    FrameId getFrame(const std::string& name) const;
+
+    bool hasFrame(const std::string& name) const;
+
+    std::string getName(FrameId id) const;
+
+    FrameNodeType getType(FrameId id) const;
+
+    FrameId getParent(FrameId id) const;
+
+    // Returns the transformation taking states in 'from' to states in 'to'
+    StateTransform getTransform(FrameId from, FrameId to, const EphemerisTime& et);
+
+    // Transforms a state between two frames
+    PosState transform(const PosState& s, FrameId from, FrameId to, const EphemerisTime& et);
+
+    // Transforms a state between two frames. The orientation and angular
+    // velocity are re-expressed in the new axes, as in State::transform.
+    State transform(const State& s, FrameId from, FrameId to, const EphemerisTime& et);
+
+    // Forgets all cached time dependent transformations
+    void clearCache();
+
+private:
+    struct Node
+    {
+        std::string   name;
+        FrameNodeType type;
+        FrameId       parent;
+        size_t        depth;
+
+        ReferenceFrame         frame;      // BodyFixedFrame
+        std::string            spiceName;  // SpiceFrame
+        std::shared_ptr<Orbit> orbit;      // Orbit frames
+        double                 dt;         // Orbit frames
+
+        bool           constant;  // The edge does not depend on time
+        StateTransform edge;      // Transformation to the parent frame
+        bool           edgeValid;
+        double         edgeEt;
+
+        StateTransform toRoot;    // Transformation to the root frame
+        bool           toRootValid;
+        double         toRootEt;
+    };
+
+    FrameId addNode(const std::string& name, FrameNodeType type, FrameId parent);
+
+    const Node& node(FrameId id) const;
+
+    // Transformation from a node to its parent
+    const StateTransform& getEdge(FrameId id, const EphemerisTime& et);
+
+    // Transformation from a node to the root
+    const StateTransform& getToRoot(FrameId id, const EphemerisTime& et);
+
+    // Transformation from a node to one of its ancestors
+    StateTransform getToAncestor(FrameId id, FrameId ancestor, const EphemerisTime& et);
+
+    StateTransform computeEdge(const Node& n, const EphemerisTime& et);
+
+    std::vector<Node> nodes;
+    std::map<std::string, FrameId> names;
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,130 @@
+#include "FrameRotation.h"
+#include "SpiceCore.h"
+#include "Exceptions.h"
+
+#include <cspice/SpiceUsr.h>
+#include <cmath>
+#include <sstream>
+
+namespace astro {
+
+// Unit quaternion for a rotation by |theta| about theta
+static Quat rotationVectorToQuat(const Vec3& theta)
+{
+    double angle = glm::length(theta);
+    if (angle < 1.0E-12)
+        return glm::normalize(Quat(1.0, 0.5 * theta.x, 0.5 * theta.y, 0.5 * theta.z));
+    double s = std::sin(0.5 * angle) / angle;
+    return Quat(std::cos(0.5 * angle), s * theta.x, s * theta.y, s * theta.z);
+}
+
+FrameRotationCache::FrameRotationCache(int _bodyId, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step)
+    : bodyId(_bodyId), t0(et0.getETValue()), t1(et1.getETValue()), h(step.value)
+{
+    if (h <= 0.0)
+        throw AstroException("Zero or negative step given for frame rotation cache");
+    if (t1 <= t0)
+        throw AstroException("Empty time span given for frame rotation cache");
+
+    size_t n = static_cast<size_t>(std::ceil((t1 - t0) / h)) + 1;
+    std::vector<double> tsipm(36 * n);
+    {
+        // One lock for the whole grid
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        for (size_t k = 0; k < n; ++k)
+            tisbod_c("J2000", bodyId, t0 + k * h, reinterpret_cast<double(*)[6]>(&tsipm[36 * k]));
+    }
+    Spice().checkError();
+
+    nodes.resize(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        // tisbod_c gives the state transformation inertial -> body as
+        // [ T  0 ]
+        // [ dT T ] (row-major). The body -> inertial rotation is M = T^T, and
+        // dM/dt = [w]x M, so [w]x = -M * dT.
+        const double* ts = &tsipm[36 * k];
+        Mat3 M, dT;
+        for (int col = 0; col < 3; ++col)
+            for (int row = 0; row < 3; ++row)
+            {
+                M[col][row]  = ts[6 * col + row];
+                dT[col][row] = ts[6 * (row + 3) + col];
+            }
+        Mat3 W = -1.0 * (M * dT);
+
+        nodes[k].q = glm::normalize(glm::quat_cast(M));
+        nodes[k].w = Vec3(0.5 * (W[1][2] - W[2][1]),
+                          0.5 * (W[2][0] - W[0][2]),
+                          0.5 * (W[0][1] - W[1][0]));
+    }
+}
+
+size_t FrameRotationCache::locate(const EphemerisTime& et, double& tau) const
+{
+    double t = et.getETValue();
+    if (t < t0 || t > t1)
+    {
+        std::ostringstream ss;
+        ss << "Time " << t << " is outside the frame rotation cache span [" << t0 << ", " << t1 << "]";
+        throw AstroException(ss.str());
+    }
+
+    size_t i = static_cast<size_t>((t - t0) / h);
+    if (i > nodes.size() - 2)
+        i = nodes.size() - 2;
+    tau = t - (t0 + i * h);
+    return i;
+}
+
+Quat FrameRotationCache::getQuaternionToJ2000(const EphemerisTime& et) const
+{
+    double tau;
+    size_t i = locate(et, tau);
+    const Node& a = nodes[i];
+    const Node& b = nodes[i + 1];
+
+    // Rotate forward from the left node and backward from the right node by
+    // the integral of the linearly interpolated (inertial) angular velocity,
+    // then blend the two predictions.
+    Vec3 wdot = (b.w - a.w) / h;
+    Quat qa = rotationVectorToQuat(a.w * tau + wdot * (0.5 * tau * tau)) * a.q;
+    Quat qb = rotationVectorToQuat(b.w * (tau - h) + wdot * (0.5 * (tau - h) * (tau - h))) * b.q;
+    if (glm::dot(qa, qb) < 0.0)
+        qb = -qb;
+
+    double u = tau / h;
+    return glm::normalize(qa * (1.0 - u) + qb * u);
+}
+
+Mat3 FrameRotationCache::getRotationToJ2000(const EphemerisTime& et) const
+{
+    return glm::mat3_cast(getQuaternionToJ2000(et));
+}
+
+Vec3 FrameRotationCache::getAngularVelocity(const EphemerisTime& et) const
+{
+    double tau;
+    size_t i = locate(et, tau);
+    double u = tau / h;
+    return nodes[i].w * (1.0 - u) + nodes[i + 1].w * u;
+}
+
+Mat3 FrameRotationCache::getRotationRateToJ2000(const EphemerisTime& et) const
+{
+    Mat3 M = getRotationToJ2000(et);
+    Vec3 w = getAngularVelocity(et);
+    return Mat3(glm::cross(w, M[0]), glm::cross(w, M[1]), glm::cross(w, M[2]));
+}
+
+bool FrameRotationCache::covers(const EphemerisTime& et) const
+{
+    return et.getETValue() >= t0 && et.getETValue() <= t1;
+}
+
+int FrameRotationCache::getBodyId() const
+{
+    return bodyId;
+}
+
+} // namespace astro
@@ -0,0 +1,64 @@
+#ifndef _ASTRO_FRAME_ROTATION_H_
+#define _ASTRO_FRAME_ROTATION_H_
+
+#include <vector>
+
+#include "Math.h"
+#include "Time.h"
+
+namespace astro {
+
+// Caches the rotation of a SPICE body-fixed frame relative to J2000 over a
+// time grid. The cache samples Spice once (under the Spice mutex) when it is
+// constructed; all queries afterwards are lock-free and safe to call from
+// several threads at once.
+//
+// Between two grid nodes the rotation is propagated forward from the left
+// node and backward from the right node with the sampled angular velocities,
+// and the two predictions are blended. For the IAU rotation models this is
+// accurate to well below 1e-10 rad with grid steps of an hour or more.
+class FrameRotationCache
+{
+public:
+    // bodyId: Spice id of the body whose body-fixed frame is cached
+    // et0, et1: time span covered by the cache
+    // step: grid spacing
+    FrameRotationCache(int bodyId, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step);
+
+    // Returns the rotation r_j2000 = M * r_body at the given time
+    Mat3 getRotationToJ2000(const EphemerisTime& et) const;
+
+    // Same rotation as a unit quaternion
+    Quat getQuaternionToJ2000(const EphemerisTime& et) const;
+
+    // Returns the time derivative of the rotation matrix above (dM/dt)
+    Mat3 getRotationRateToJ2000(const EphemerisTime& et) const;
+
+    // Returns the angular velocity of the body-fixed frame, given in J2000 [rad/s]
+    Vec3 getAngularVelocity(const EphemerisTime& et) const;
+
+    // True if et lies within the cached time span
+    bool covers(const EphemerisTime& et) const;
+
+    int getBodyId() const;
+
+private:
+    struct Node
+    {
+        Quat q; // body-fixed -> J2000
+        Vec3 w; // angular velocity in J2000 [rad/s]
+    };
+
+    // Finds the grid interval of et, and the time since its left node
+    size_t locate(const EphemerisTime& et, double& tau) const;
+
+    int bodyId;
+    double t0;
+    double t1;
+    double h;
+    std::vector<Node> nodes;
+};
+
+} // namespace astro
+
+#endif
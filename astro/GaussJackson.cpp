@@ -0,0 +1,192 @@
+#include "GaussJackson.h"
+#include "RKF78.h"
+#include "Exceptions.h"
+
+#include <cmath>
+#include <deque>
+
+// The backward difference forms of the Gauss-Jackson and summed Adams
+// predictors and correctors follow from the operator identities
+//   h D = -ln(1 - V),  E = (1 - V)^-1
+// where V is the backward difference and E the shift operator. With the first
+// and second sums S1, S2 of the accelerations a:
+//   r[n+1] = h^2 (S2[n]          + sum f[k+2] V^k a[n])
+//   v[n+1] = h   (S1[n]          + sum p[k+1] V^k a[n])
+//   r[n]   = h^2 (S2[n] - S1[n]  + sum g[k+2] V^k a[n])
+//   v[n]   = h   (S1[n]          + sum q[k+1] V^k a[n])
+// with the power series
+//   q(x) = -x / ln(1 - x),   p(x) = q(x) / (1 - x)
+//   g(x) = q(x)^2,           f(x) = g(x) / (1 - x)
+// Expanding V^k a[n] = sum (-1)^j C(k, j) a[n-j] gives the ordinate form.
+
+namespace astro {
+
+int    GaussJackson::correctorEvaluations = 0;
+double GaussJackson::startupTolerance     = 1.0E-13;
+
+// Power series of q(x) = -x / ln(1 - x) up to x^n
+static std::vector<double> seriesQ(int n)
+{
+    // -ln(1 - x) / x = sum x^k / (k + 1); q is its reciprocal
+    std::vector<double> u(n + 1), q(n + 1);
+    for (int k = 0; k <= n; ++k)
+        u[k] = 1.0 / (k + 1);
+    for (int k = 0; k <= n; ++k)
+    {
+        double sum = (k == 0) ? 1.0 : 0.0;
+        for (int j = 1; j <= k; ++j)
+            sum -= u[j] * q[k - j];
+        q[k] = sum / u[0];
+    }
+    return q;
+}
+
+// Multiplies a series by 1 / (1 - x)
+static std::vector<double> cumulative(const std::vector<double>& s)
+{
+    std::vector<double> c(s.size());
+    double sum = 0.0;
+    for (size_t k = 0; k < s.size(); ++k)
+        c[k] = (sum += s[k]);
+    return c;
+}
+
+static std::vector<double> square(const std::vector<double>& s)
+{
+    std::vector<double> sq(s.size(), 0.0);
+    for (size_t k = 0; k < s.size(); ++k)
+        for (size_t j = 0; j <= k; ++j)
+            sq[k] += s[j] * s[k - j];
+    return sq;
+}
+
+// Converts sum_{k=0..m} s[k + shift] V^k a[n] to ordinate coefficients of a[n-j]
+static std::vector<double> ordinates(const std::vector<double>& s, int shift, int m)
+{
+    std::vector<double> c(m + 1, 0.0);
+    for (int k = 0; k <= m; ++k)
+    {
+        double binom = 1.0; // C(k, j)
+        for (int j = 0; j <= k; ++j)
+        {
+            c[j] += s[k + shift] * ((j % 2) ? -binom : binom);
+            binom = binom * (k - j) / (j + 1);
+        }
+    }
+    return c;
+}
+
+const std::vector<double> GaussJackson::posPredictor = ordinates(cumulative(square(seriesQ(order + 2))), 2, order);
+const std::vector<double> GaussJackson::velPredictor = ordinates(cumulative(seriesQ(order + 2)), 1, order);
+const std::vector<double> GaussJackson::posCorrector = ordinates(square(seriesQ(order + 2)), 2, order);
+const std::vector<double> GaussJackson::velCorrector = ordinates(seriesQ(order + 2), 1, order);
+
+void GaussJackson::setCorrectorEvaluations(int n)
+{
+    if (n < 0)
+        throw AstroException("Negative number of corrector evaluations not allowed");
+    correctorEvaluations = n;
+}
+
+void GaussJackson::setStartupTolerance(double tol)
+{
+    if (tol <= 0.0)
+        throw AstroException("Zero or negative tolerance not allowed for RK methods");
+    startupTolerance = tol;
+}
+
+PosState GaussJackson::startupStep(const ODE& ode, const PosState& s, const EphemerisTime& et0, const EphemerisTime& et1)
+{
+    return RKF78::doSteps(ode, s, et0, et1, et1 - et0, startupTolerance).back().s;
+}
+
+GaussJackson::Result GaussJackson::doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    return { startupStep(ode, s, et, et + dt), et + dt };
+}
+
+std::vector<GaussJackson::Result> GaussJackson::doSteps(const ODE& ode, const PosState& s,
+                                                        const EphemerisTime& et0, const EphemerisTime& et1,
+                                                        const TimeDelta& dt)
+{
+    const double h = dt.value;
+    if (h <= 0.0)
+        throw AstroException("Zero or negative step size given to Gauss-Jackson");
+
+    std::vector<Result> res;
+    res.push_back({ s, et0 });
+
+    const double t0 = et0.getETValue();
+    const size_t steps = static_cast<size_t>(std::floor((et1.getETValue() - t0) / h + 1.0E-9));
+
+    // Startup: the first 'order' steps with RKF78
+    std::deque<Vec3> acc; // Accelerations, acc.back() is the newest
+    acc.push_back(ode.rates(et0, s).v);
+    for (size_t n = 1; n <= steps && n <= static_cast<size_t>(order); ++n)
+    {
+        EphemerisTime et(t0 + n * h);
+        res.push_back({ startupStep(ode, res.back().s, res.back().et, et), et });
+        acc.push_back(ode.rates(et, res.back().s).v);
+    }
+
+    if (steps > static_cast<size_t>(order))
+    {
+        // Initialise the sums so that the corrector reproduces the last startup state
+        const PosState& sn = res.back().s;
+        Vec3 S1 = sn.v / h;
+        Vec3 S2 = sn.r / (h * h);
+        for (int j = 0; j <= order; ++j)
+        {
+            S1 -= velCorrector[j] * acc[order - j];
+            S2 -= posCorrector[j] * acc[order - j];
+        }
+        S2 += S1;
+
+        for (size_t n = order + 1; n <= steps; ++n)
+        {
+            EphemerisTime et(t0 + n * h);
+
+            // Predict
+            Vec3 r = S2, v = S1;
+            for (int j = 0; j <= order; ++j)
+            {
+                r += posPredictor[j] * acc[order - j];
+                v += velPredictor[j] * acc[order - j];
+            }
+            PosState sp(r * (h * h), v * h);
+
+            // Evaluate
+            acc.pop_front();
+            acc.push_back(ode.rates(et, sp).v);
+
+            // Correct, and evaluate again if asked to
+            for (int i = 0; i <= correctorEvaluations; ++i)
+            {
+                Vec3 S1n = S1 + acc.back();
+                r = S2;
+                v = S1n;
+                for (int j = 0; j <= order; ++j)
+                {
+                    r += posCorrector[j] * acc[order - j];
+                    v += velCorrector[j] * acc[order - j];
+                }
+                sp = PosState(r * (h * h), v * h);
+
+                if (i < correctorEvaluations)
+                    acc.back() = ode.rates(et, sp).v;
+            }
+
+            S1 += acc.back();
+            S2 += S1;
+            res.push_back({ sp, et });
+        }
+    }
+
+    // Remaining partial step
+    if (res.back().et < et1)
+        res.push_back({ startupStep(ode, res.back().s, res.back().et, et1), et1 });
+
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,65 @@
+#ifndef _ASTRO_GAUSS_JACKSON_H_
+#define _ASTRO_GAUSS_JACKSON_H_
+
+#include <vector>
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Gauss-Jackson (summed Stormer-Cowell) 8th order fixed step multistep
+// integrator, with summed Adams for the velocities. The predictor and
+// corrector are used in the summed, ordinate form of
+// M. M. Berry and L. M. Healy, "Implementation of Gauss-Jackson integration
+// for orbit propagation", J. Astronaut. Sci. 52 (2004).
+//
+// The method is started with RKF78 over the first eight steps. Afterwards each
+// step costs one evaluation of the ODE (PEC mode), or one more per corrector
+// evaluation if set. If et1 - et0 is not a whole number of steps, the last
+// partial step is done with RKF78.
+class GaussJackson
+{
+public:
+    struct Result
+    {
+        PosState s;
+        EphemerisTime et;
+    };
+
+    // A multistep method has no history in a single step: this does one
+    // RKF78 integration over dt
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    // Integrates from et0 to et1 with the fixed step dt
+    static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
+                                       const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+
+    // Number of extra evaluate-correct passes per step. 0 (default) is PEC,
+    // 1 is PECE.
+    static void setCorrectorEvaluations(int n);
+
+    // Tolerance used by RKF78 for the startup steps. Default is 1.0E-13
+    static void setStartupTolerance(double tol);
+
+private:
+    static const int order = 8;
+
+    static int    correctorEvaluations;
+    static double startupTolerance;
+
+    // Ordinate form coefficients, index j multiplies a[n-j] (predictor) or
+    // a[n+1-j] (corrector)
+    static const std::vector<double> posPredictor;
+    static const std::vector<double> velPredictor;
+    static const std::vector<double> posCorrector;
+    static const std::vector<double> velCorrector;
+
+    // RKF78 integration over one interval, at the startup tolerance
+    static PosState startupStep(const ODE& ode, const PosState& s, const EphemerisTime& et0, const EphemerisTime& et1);
+};
+
+} // namespace astro
+
+#endif
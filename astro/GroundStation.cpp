@@ -0,0 +1,252 @@
+#include "GroundStation.h"
+#include "Interpolate.h"
+#include "Parallel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  D. A. Vallado, "Fundamentals of Astrodynamics and Applications",
+//      4th ed., Microcosm Press (2013), 4.4
+
+namespace astro {
+
+// ── GroundStation ────────────────────────────────────────────────────────────
+
+GroundStation::GroundStation(const std::string& _name, const ReferenceFrame& bodyFixed,
+                             double lon, double lat, double alt, double minElevation,
+                             double re, double f)
+    : name(_name), frame(bodyFixed), enu(astro::getEnuRotation(lon, lat)), mask(minElevation)
+{
+    geodeticToVec(lon, lat, alt, re, f, &site);
+}
+
+const std::string& GroundStation::getName() const
+{
+    return name;
+}
+
+const ReferenceFrame& GroundStation::getFrame() const
+{
+    return frame;
+}
+
+const Vec3& GroundStation::getPosition() const
+{
+    return site;
+}
+
+const Mat3& GroundStation::getEnuRotation() const
+{
+    return enu;
+}
+
+double GroundStation::getElevationMask() const
+{
+    return mask;
+}
+
+void GroundStation::setElevationMask(double minElevation)
+{
+    mask = minElevation;
+}
+
+PosState GroundStation::toTopocentric(const PosState& s, const EphemerisTime& et) const
+{
+    StateTransform toBF = frame.getStateTransformToJ2000(et).inverse();
+    Mat3 Rt = glm::transpose(enu);
+    return PosState(Rt * (toBF.applyPosition(s.r) - site), Rt * toBF.applyVelocity(s.r, s.v));
+}
+
+LookAngles GroundStation::lookAngles(const PosState& s, const EphemerisTime& et) const
+{
+    StateTransform toBF = frame.getStateTransformToJ2000(et).inverse();
+    return lookAnglesBodyFixed(PosState(toBF.applyPosition(s.r), toBF.applyVelocity(s.r, s.v)));
+}
+
+LookAngles GroundStation::lookAnglesBodyFixed(const PosState& s_bf) const
+{
+    // [1] algorithm 27, in East-North-Up
+    Mat3 Rt  = glm::transpose(enu);
+    Vec3 rho = Rt * (s_bf.r - site);
+    Vec3 v   = Rt * s_bf.v;
+
+    LookAngles la;
+    la.range     = glm::length(rho);
+    la.elevation = std::asin(rho.z / la.range);
+    la.azimuth   = wrap(std::atan2(rho.x, rho.y), 0.0, TWOPI);
+    la.rangeRate = glm::dot(rho, v) / la.range;
+    return la;
+}
+
+// ── AccessFinder ─────────────────────────────────────────────────────────────
+
+std::vector<AccessWindow> AccessFinder::find(const std::vector<GroundStation>& stations,
+                                             const std::vector<Orbit*>& satellites,
+                                             const EphemerisTime& et0, const EphemerisTime& et1,
+                                             const TimeDelta& step, unsigned int threads)
+{
+    if (step.value <= 0.0)
+        throw AstroException("Access search needs a positive step");
+    if (!(et0 < et1))
+        throw AstroException("Access search needs et1 after et0");
+    if (stations.empty() || satellites.empty())
+        return std::vector<AccessWindow>();
+
+    const ReferenceFrame& frame = stations.front().getFrame();
+    for (const auto& st : stations)
+        if (!(st.getFrame() == frame))
+            throw AstroException("Access search needs all stations on the same body-fixed frame");
+
+    double t0 = et0.getETValue();
+    double t1 = et1.getETValue();
+    double h  = step.value;
+    size_t ns = static_cast<size_t>(std::ceil((t1 - t0) / h)) + 1;
+    std::vector<EphemerisTime> ets(ns);
+    for (size_t k = 0; k < ns; ++k)
+        ets[k] = EphemerisTime(std::min(t0 + k * h, t1));
+
+    // Body-fixed states of each satellite at the steps. The frame is evaluated
+    // once per step for all satellites
+    std::vector<StateTransform> toBF;
+    frame.getStateTransformsToJ2000(ets, toBF);
+    for (auto& t : toBF)
+        t = t.inverse();
+
+    size_t nsat = satellites.size();
+    std::vector<PosState> bf(nsat * ns);
+    parallelFor(nsat, [&](size_t q) {
+        for (size_t k = 0; k < ns; ++k)
+        {
+            PosState s = satellites[q]->getState(ets[k]);
+            bf[q * ns + k] = PosState(toBF[k].applyPosition(s.r), toBF[k].applyVelocity(s.r, s.v));
+        }
+    }, threads);
+
+    // Each station and satellite pair
+    size_t nst = stations.size();
+    std::vector<std::vector<AccessWindow>> found(nst * nsat);
+    parallelFor(nst * nsat, [&](size_t pair) {
+        size_t p = pair / nsat;
+        size_t q = pair % nsat;
+        const GroundStation& st = stations[p];
+        const PosState*      s  = &bf[q * ns];
+
+        Vec3   up   = st.getEnuRotation()[2];
+        Vec3   site = st.getPosition();
+        double smask = std::sin(st.getElevationMask());
+
+        // Sine of the elevation minus that of the mask, and its rate
+        auto g = [&](const PosState& x) {
+            Vec3 rho = x.r - site;
+            return glm::dot(up, rho) / glm::length(rho) - smask;
+        };
+        auto dg = [&](const PosState& x) {
+            Vec3   rho = x.r - site;
+            double l   = glm::length(rho);
+            return (glm::dot(up, x.v) * l - glm::dot(up, rho) * glm::dot(rho, x.v) / l) / (l * l);
+        };
+        auto elevation = [&](double gx) {
+            return std::asin(std::max(-1.0, std::min(1.0, gx + smask)));
+        };
+
+        std::vector<AccessWindow>& out = found[pair];
+        AccessWindow w;
+        w.station   = p;
+        w.satellite = q;
+
+        bool open = g(s[0]) >= 0.0;
+        if (open)
+        {
+            w.rise         = ets[0];
+            w.culmination  = ets[0];
+            w.maxElevation = elevation(g(s[0]));
+        }
+
+        for (size_t k = 0; k + 1 < ns; ++k)
+        {
+            const EphemerisTime& ea = ets[k];
+            const EphemerisTime& eb = ets[k + 1];
+            double ta = ea.getETValue();
+            double tb = eb.getETValue();
+            auto at = [&](double t) {
+                PosState x;
+                hermite(s[k], ea, s[k + 1], eb, EphemerisTime(t), x);
+                return x;
+            };
+            auto gt  = [&](double t) { return g(at(t)); };
+            auto ngt = [&](double t) { return -g(at(t)); };
+
+            double g0 = g(s[k]);
+            double g1 = g(s[k + 1]);
+
+            // Maximum of the elevation inside the step
+            double d0 = dg(s[k]);
+            double d1 = dg(s[k + 1]);
+            bool   hasMax = d0 > 0.0 && d1 <= 0.0;
+            double tm = tb, gm = g1;
+            if (hasMax)
+            {
+                tm = findRoot([&](double t) { return -dg(at(t)); }, ta, -d0, tb, -d1, 1.0E-3);
+                gm = gt(tm);
+            }
+
+            if (!open && g1 >= 0.0)
+            {
+                w.rise         = EphemerisTime(findRoot(gt, ta, g0, tb, g1, 1.0E-6));
+                w.culmination  = w.rise;
+                w.maxElevation = st.getElevationMask();
+                open = true;
+            }
+            else if (!open && hasMax && gm > 0.0)
+            {
+                // A pass shorter than the step
+                w.rise         = EphemerisTime(findRoot(gt, ta, g0, tm, gm, 1.0E-6));
+                w.set          = EphemerisTime(findRoot(ngt, tm, -gm, tb, -g1, 1.0E-6));
+                w.culmination  = EphemerisTime(tm);
+                w.maxElevation = elevation(gm);
+                out.push_back(w);
+                continue;
+            }
+
+            if (!open)
+                continue;
+
+            if (hasMax && elevation(gm) > w.maxElevation)
+            {
+                w.culmination  = EphemerisTime(tm);
+                w.maxElevation = elevation(gm);
+            }
+
+            if (g1 >= 0.0)
+            {
+                if (elevation(g1) > w.maxElevation)
+                {
+                    w.culmination  = eb;
+                    w.maxElevation = elevation(g1);
+                }
+            }
+            else
+            {
+                w.set = EphemerisTime(findRoot(ngt, ta, -g0, tb, -g1, 1.0E-6));
+                out.push_back(w);
+                open = false;
+            }
+        }
+
+        if (open)
+        {
+            w.set = ets.back();
+            out.push_back(w);
+        }
+    }, threads);
+
+    std::vector<AccessWindow> res;
+    for (const auto& f : found)
+        res.insert(res.end(), f.begin(), f.end());
+    return res;
+}
+
+} // namespace astro
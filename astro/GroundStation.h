@@ -0,0 +1,109 @@
+#ifndef _ASTRO_GROUND_STATION_H_
+#define _ASTRO_GROUND_STATION_H_
+
+#include <string>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ReferenceFrame.h"
+#include "Orbit.h"
+
+namespace astro {
+
+// Azimuth (from north towards east), elevation, range and range rate of a
+// target seen from a station
+struct LookAngles
+{
+    double azimuth;   // [rad], in [0, 2 pi)
+    double elevation; // [rad]
+    double range;     // [km]
+    double rangeRate; // [km/s]
+};
+
+// A site at a geodetic position on a body-fixed frame, with its topocentric
+// East-North-Up frame and an elevation mask. Target states are given relative
+// to the center of the body, in J2000.
+class GroundStation
+{
+public:
+    // lon, lat [rad] and alt [km] on a body with equatorial radius re [km] and
+    // flattening f; the defaults are WGS84. minElevation is the elevation mask
+    // [rad]
+    GroundStation(const std::string& name, const ReferenceFrame& bodyFixed,
+                  double lon, double lat, double alt, double minElevation = 0.0,
+                  double re = 6378.137, double f = 1.0 / 298.257223563);
+
+    const std::string& getName() const;
+
+    const ReferenceFrame& getFrame() const;
+
+    // Position of the site in the body-fixed frame [km]
+    const Vec3& getPosition() const;
+
+    // Rotation from East-North-Up to body-fixed axes
+    const Mat3& getEnuRotation() const;
+
+    double getElevationMask() const;
+
+    void setElevationMask(double minElevation);
+
+    // The state of a target in the topocentric East-North-Up frame
+    PosState toTopocentric(const PosState& s, const EphemerisTime& et) const;
+
+    LookAngles lookAngles(const PosState& s, const EphemerisTime& et) const;
+
+    // As above, for a target state already in the body-fixed frame
+    LookAngles lookAnglesBodyFixed(const PosState& s_bf) const;
+
+private:
+    std::string    name;
+    ReferenceFrame frame;
+    Vec3           site;
+    Mat3           enu;
+    double         mask;
+};
+
+
+// A pass of a satellite over a station, above its elevation mask
+struct AccessWindow
+{
+    size_t        station;   // Index in the station list
+    size_t        satellite; // Index in the satellite list
+    EphemerisTime rise;      // Or the start of the search, if already visible
+    EphemerisTime set;       // Or the end of the search, if still visible
+    EphemerisTime culmination;
+    double        maxElevation; // [rad]
+};
+
+// Access windows of a set of satellites over a set of stations. Each
+// satellite is sampled once with a fixed step and its states converted to the
+// body-fixed frame of the stations, which all stations must share. Each
+// station and satellite pair is then searched in parallel, on the Hermite
+// interpolants of the body-fixed states:
+//
+// - the sine of the elevation minus that of the mask is sampled at the steps,
+//   and rises and sets are bracketed by its sign changes,
+// - steps where it stays negative but has a maximum are checked for short
+//   passes, so passes shorter than a step are not lost,
+// - the crossings and the culmination are refined by root finding, on the
+//   elevation and on its rate.
+//
+// The step must be small enough that the interpolants follow the satellites
+// closely (about a minute in low Earth orbit) and that no pass has two maxima
+// in one step. The satellite states must be relative to the center of the
+// body of the stations, in J2000. Windows are ordered by station, satellite
+// and rise time.
+class AccessFinder
+{
+public:
+    // threads = 0 uses all hardware cores
+    static std::vector<AccessWindow> find(const std::vector<GroundStation>& stations,
+                                          const std::vector<Orbit*>& satellites,
+                                          const EphemerisTime& et0, const EphemerisTime& et1,
+                                          const TimeDelta& step, unsigned int threads = 0);
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,204 @@
+#include "KS.h"
+#include "RKF78.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astro {
+
+// Time mismatch at et1 below which doSteps stops iterating the last step [s]
+static const double TIME_TOLERANCE = 1.0E-6;
+static const int    MAX_END_ITERATIONS = 10;
+
+static const Attractor& centralBody(const ODE& ode)
+{
+    if (ode.getAttractors().empty())
+        throw AstroException("KS regularization needs a central body attractor");
+    return ode.getAttractors().front();
+}
+
+// x = L(u) u
+static Vec3 position(const Vec4& u)
+{
+    return Vec3(u.x * u.x - u.y * u.y - u.z * u.z + u.w * u.w,
+                2.0 * (u.x * u.y - u.z * u.w),
+                2.0 * (u.x * u.z + u.y * u.w));
+}
+
+// The first three components of L(u) a
+static Vec3 mulL(const Vec4& u, const Vec4& a)
+{
+    return Vec3(u.x * a.x - u.y * a.y - u.z * a.z + u.w * a.w,
+                u.y * a.x + u.x * a.y - u.w * a.z - u.z * a.w,
+                u.z * a.x + u.w * a.y + u.x * a.z + u.y * a.w);
+}
+
+// L(u)^T (a, 0)
+static Vec4 mulLT(const Vec4& u, const Vec3& a)
+{
+    return Vec4( u.x * a.x + u.y * a.y + u.z * a.z,
+                -u.y * a.x + u.x * a.y + u.w * a.z,
+                -u.z * a.x - u.w * a.y + u.x * a.z,
+                 u.w * a.x - u.z * a.y + u.y * a.z);
+}
+
+double maxNorm(const KSState& s)
+{
+    return std::max({ std::abs(s.u.x), std::abs(s.u.y), std::abs(s.u.z), std::abs(s.u.w),
+                      std::abs(s.w.x), std::abs(s.w.y), std::abs(s.w.z), std::abs(s.w.w),
+                      std::abs(s.h), std::abs(s.t) });
+}
+
+KSState KS::toKS(const PosState& s, const EphemerisTime& et, double mu, const Vec3& p)
+{
+    Vec3   x = s.r - p;
+    double r = glm::length(x);
+    if (r < 1.0E-5)
+        throw AstroException("Radius of state vector near zero — degenerate case");
+
+    // One of the solutions of x = L(u) u; this one satisfies the bilinear
+    // relation for w below
+    KSState k;
+    if (x.x >= 0.0)
+    {
+        double u1 = std::sqrt(0.5 * (r + x.x));
+        k.u = Vec4(u1, 0.5 * x.y / u1, 0.5 * x.z / u1, 0.0);
+    }
+    else
+    {
+        double u2 = std::sqrt(0.5 * (r - x.x));
+        k.u = Vec4(0.5 * x.y / u2, u2, 0.0, 0.5 * x.z / u2);
+    }
+
+    k.w = mulLT(k.u, s.v) * 0.5;
+    k.h = mu / r - 0.5 * glm::dot(s.v, s.v);
+    k.t = et.getETValue();
+    return k;
+}
+
+PosState KS::fromKS(const KSState& k, const Vec3& p)
+{
+    double r = glm::dot(k.u, k.u);
+    return PosState(position(k.u) + p, mulL(k.u, k.w) * (2.0 / r));
+}
+
+KSState KS::rates(const ODE& ode, const KSState& k)
+{
+    const Attractor& central = centralBody(ode);
+
+    double   r = glm::dot(k.u, k.u);
+    PosState s = fromKS(k, central.p);
+
+    // Perturbation: the full acceleration less the central body term
+    Vec3 x  = s.r - central.p;
+    Vec3 a  = ode.rates(EphemerisTime(k.t), s).v;
+    Vec3 ap = a + x * (central.GM / (r * r * r));
+    Vec4 lp = mulLT(k.u, ap);
+
+    KSState d;
+    d.u = k.w;
+    d.w = k.u * (-0.5 * k.h) + lp * (0.5 * r);
+    d.h = -2.0 * glm::dot(k.w, lp);
+    d.t = r;
+    return d;
+}
+
+bool KS::step(const ODE& ode, const KSState& k, double ds, KSState& k_next, double& ds_next)
+{
+    // Integrate the time relative to the step start, so that its error is
+    // controlled relative to the step length rather than the epoch
+    const double t0 = k.t;
+    auto f = [&ode, t0](double, const KSState& y) {
+        KSState ya = y;
+        ya.t += t0;
+        return rates(ode, ya);
+    };
+
+    KSState k0 = k;
+    k0.t = 0.0;
+    bool accepted = RKF78::step(f, k0, 0.0, ds, 1.0, k_next, ds_next);
+    if (accepted)
+        k_next.t += t0;
+    return accepted;
+}
+
+KS::Result KS::doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    const Attractor& central = centralBody(ode);
+    KSState k = toKS(s, et, central.GM, central.p);
+    double  r = glm::dot(k.u, k.u);
+
+    KSState k_next;
+    double  ds_next;
+    if (!step(ode, k, dt.value / r, k_next, ds_next))
+        return { s, et, TimeDelta(ds_next * r), 0 };
+
+    return { fromKS(k_next, central.p), EphemerisTime(k_next.t), TimeDelta(ds_next * glm::dot(k_next.u, k_next.u)), 0 };
+}
+
+std::vector<KS::Result> KS::doSteps(const ODE& ode, const PosState& s,
+                                    const EphemerisTime& et0, const EphemerisTime& et1,
+                                    const TimeDelta& dt)
+{
+    const Attractor& central = centralBody(ode);
+    const double t1 = et1.getETValue();
+
+    std::vector<Result> res;
+    res.push_back({ s, et0, dt, 0 });
+
+    KSState k  = toKS(s, et0, central.GM, central.p);
+    double  ds = dt.value / glm::dot(k.u, k.u);
+
+    while (res.back().et < et1)
+    {
+        KSState k_next;
+        double  ds_next;
+        int     tries = 0;
+        int     iterations = 0;
+        bool    done  = false;
+        for (;;)
+        {
+            ++tries;
+            if (!step(ode, k, ds, k_next, ds_next))
+            {
+                ds = ds_next;
+                continue;
+            }
+
+            double overshoot = k_next.t - t1;
+            if (std::abs(overshoot) <= TIME_TOLERANCE)
+            {
+                done = true;
+                break;
+            }
+            if (overshoot < 0.0)
+                break;
+
+            // Past et1: Newton iteration on the step length, with dt/ds = r.
+            // When approaching periapsis r at the step end may be much smaller
+            // than its mean over the step; then interpolate linearly instead
+            if (++iterations > MAX_END_ITERATIONS)
+                throw AstroException("KS: failed to end the integration at et1");
+            double ds_newton = ds - overshoot / glm::dot(k_next.u, k_next.u);
+            ds = (ds_newton > 0.0) ? ds_newton : ds * (t1 - k.t) / (k_next.t - k.t);
+        }
+
+        PosState sn = fromKS(k_next, central.p);
+        if (done)
+        {
+            // Remove the last small time mismatch
+            sn.r += sn.v * (t1 - k_next.t);
+            res.push_back({ sn, et1, TimeDelta(0.0), tries });
+            break;
+        }
+
+        k  = k_next;
+        ds = ds_next;
+        res.push_back({ sn, EphemerisTime(k.t), TimeDelta(ds * glm::dot(k.u, k.u)), tries });
+    }
+
+    return res;
+}
+
+} // namespace astro
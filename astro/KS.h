@@ -0,0 +1,98 @@
+#ifndef _ASTRO_KS_H_
+#define _ASTRO_KS_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// State in Kustaanheimo-Stiefel variables. The physical position relative to
+// the central body is x = L(u) u, with |x| = |u|^2, and derivatives are
+// taken with respect to the fictitious time s, where dt = |x| ds.
+class KSState
+{
+public:
+    Vec4   u; // KS position [km^1/2]
+    Vec4   w; // du/ds
+    double h; // Negative Kepler energy, mu/r - v^2/2 [km^2/s^2]
+    double t; // Physical time [s]
+
+    KSState()
+        : u(0.0), w(0.0), h(0.0), t(0.0)
+    {}
+
+    KSState& operator+=(const KSState& o)
+    {
+        u += o.u;
+        w += o.w;
+        h += o.h;
+        t += o.t;
+        return *this;
+    }
+
+    KSState& operator*=(double a)
+    {
+        u *= a;
+        w *= a;
+        h *= a;
+        t *= a;
+        return *this;
+    }
+
+    friend KSState operator+(KSState lhs, const KSState& rhs) { return lhs += rhs; }
+    friend KSState operator*(KSState lhs, double a)           { return lhs *= a; }
+    friend KSState operator*(double a, KSState rhs)           { return rhs *= a; }
+};
+
+// Largest absolute component, used for error control
+double maxNorm(const KSState& s);
+
+// Regularized propagation in Kustaanheimo-Stiefel variables, following
+// E. Stiefel and G. Scheifele, "Linear and Regular Celestial Mechanics" (1971).
+// In the fictitious time s the two-body problem becomes a harmonic oscillator
+// in u, free of the 1/r^3 singularity, and the Sundman transformation
+// dt = r ds makes equal steps in s cover equal eccentric anomaly. RKF78 then
+// takes nearly uniform steps around highly eccentric orbits and through close
+// flybys, where Cowell's method needs very short steps near periapsis.
+//
+// The central body is the first attractor of the ODE; all other accelerations
+// of the ODE are perturbations. Steps are given and returned as physical
+// TimeDeltas (dt = r ds at the step start), so KS can be used as a Solver in
+// the Propagator. doSteps ends exactly at et1.
+class KS
+{
+public:
+    struct Result
+    {
+        PosState     s;
+        EphemerisTime et;
+        TimeDelta    dt_next;
+        int          numTries;
+    };
+
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
+                                       const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+
+    // Conversions relative to the central body with gravitational parameter
+    // mu at the position p
+    static KSState toKS(const PosState& s, const EphemerisTime& et, double mu, const Vec3& p = Vec3(0.0));
+
+    static PosState fromKS(const KSState& k, const Vec3& p = Vec3(0.0));
+
+    // Derivatives of the KS state with respect to the fictitious time
+    static KSState rates(const ODE& ode, const KSState& k);
+
+private:
+    // One RKF78 step of ds in fictitious time. Returns false if rejected
+    static bool step(const ODE& ode, const KSState& k, double ds, KSState& k_next, double& ds_next);
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,296 @@
+#include "Lambert.h"
+#include "Parallel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// References:
+// [1]  D. Izzo, "Revisiting Lambert's problem", Celest. Mech. Dyn. Astr. 121
+//      (2015)
+
+namespace astro {
+
+// ── Time of flight in x ([1] sec. 2-3) ───────────────────────────────────────
+
+// Gauss hypergeometric function 2F1(3, 1, 5/2, z), for Battin's series
+static double hypergeometricF(double z, double tol)
+{
+    double Sj  = 1.0;
+    double Cj  = 1.0;
+    double err = 1.0;
+    for (int j = 0; err > tol && j < 1000; ++j)
+    {
+        Cj  = Cj * (3.0 + j) * (1.0 + j) / (2.5 + j) * z / (j + 1);
+        Sj += Cj;
+        err = std::abs(Cj);
+    }
+    return Sj;
+}
+
+// Lagrange's expression, in the semi major axis
+static double tofLagrange(double lambda, double x, int N)
+{
+    double a = 1.0 / (1.0 - x * x);
+    if (a > 0.0)
+    {
+        double alfa = 2.0 * std::acos(x);
+        double beta = 2.0 * std::asin(std::sqrt(lambda * lambda / a));
+        if (lambda < 0.0)
+            beta = -beta;
+        return a * std::sqrt(a) * ((alfa - std::sin(alfa)) - (beta - std::sin(beta)) + 2.0 * PI * N) / 2.0;
+    }
+    double alfa = 2.0 * std::acosh(x);
+    double beta = 2.0 * std::asinh(std::sqrt(-lambda * lambda / a));
+    if (lambda < 0.0)
+        beta = -beta;
+    return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alfa - std::sinh(alfa))) / 2.0;
+}
+
+// Non-dimensional time of flight T(x) for N revolutions: Battin's series near
+// the parabola, Lagrange's expression close to it and Lancaster's elsewhere
+static double timeOfFlight(double lambda, double x, int N)
+{
+    const double battin   = 0.01;
+    const double lagrange = 0.2;
+
+    double dist = std::abs(x - 1.0);
+    if (dist < lagrange && dist > battin)
+        return tofLagrange(lambda, x, N);
+
+    double K   = lambda * lambda;
+    double E   = x * x - 1.0;
+    double rho = std::abs(E);
+    double z   = std::sqrt(1.0 + K * E);
+    if (dist < battin)
+    {
+        double eta = z - lambda * x;
+        double S1  = 0.5 * (1.0 - lambda - x * eta);
+        double Q   = 4.0 / 3.0 * hypergeometricF(S1, 1.0E-11);
+        return (eta * eta * eta * Q + 4.0 * lambda * eta) / 2.0 + N * PI / std::pow(rho, 1.5);
+    }
+
+    double y = std::sqrt(rho);
+    double g = x * z - lambda * E;
+    double d = (E < 0.0) ? N * PI + std::acos(g) : std::log(y * (z - lambda * x) + g);
+    return (x - lambda * z - d / y) / E;
+}
+
+// First three derivatives of T(x), [1] eq. 22
+static void tofDerivatives(double lambda, double x, double T, double& DT, double& DDT, double& DDDT)
+{
+    double l2   = lambda * lambda;
+    double l3   = l2 * lambda;
+    double umx2 = 1.0 - x * x;
+    double y    = std::sqrt(1.0 - l2 * umx2);
+    double y2   = y * y;
+    double y3   = y2 * y;
+    DT   = 1.0 / umx2 * (3.0 * T * x - 2.0 + 2.0 * l3 * x / y);
+    DDT  = 1.0 / umx2 * (3.0 * T + 5.0 * x * DT + 2.0 * (1.0 - l2) * l3 / y3);
+    DDDT = 1.0 / umx2 * (7.0 * x * DDT + 8.0 * DT - 6.0 * (1.0 - l2) * l2 * l3 * x / y3 / y2);
+}
+
+// Householder iterations for T(x) = T, from x. Returns the iterations used
+static int householder(double lambda, double T, double& x, int N, double eps, int maxIter)
+{
+    int    it  = 0;
+    double err = 1.0;
+    while (err > eps && it < maxIter)
+    {
+        double tof = timeOfFlight(lambda, x, N);
+        double DT, DDT, DDDT;
+        tofDerivatives(lambda, x, tof, DT, DDT, DDDT);
+        double delta = tof - T;
+        double DT2   = DT * DT;
+        double xnew  = x - delta * (DT2 - delta * DDT / 2.0) / (DT * (DT2 - delta * DDT) + DDDT * delta * delta / 6.0);
+        err = std::abs(x - xnew);
+        x   = xnew;
+        ++it;
+    }
+    return it;
+}
+
+// ── Lambert ──────────────────────────────────────────────────────────────────
+
+void Lambert::solve(const Vec3& r1, const Vec3& r2, const TimeDelta& tof, double mu,
+                    std::vector<Solution>& out, int maxRevs, bool retrograde)
+{
+    out.clear();
+    if (tof.value <= 0.0 || mu <= 0.0)
+        throw AstroException("Lambert needs a positive time of flight and gravitational parameter");
+
+    // Geometry of the transfer, [1] sec. 2
+    double c  = glm::length(r2 - r1);
+    double R1 = glm::length(r1);
+    double R2 = glm::length(r2);
+    double s  = (c + R1 + R2) / 2.0;
+
+    Vec3 ir1 = r1 / R1;
+    Vec3 ir2 = r2 / R2;
+    Vec3 ih  = glm::cross(ir1, ir2);
+    double hl = glm::length(ih);
+    if (hl == 0.0)
+        throw AstroException("Lambert transfer plane is undefined, r1 and r2 are collinear");
+    ih /= hl;
+
+    double lambda2 = 1.0 - c / s;
+    double lambda  = std::sqrt(lambda2);
+    Vec3 it1, it2;
+    if (ih.z < 0.0)
+    {
+        // More than 180 degrees, seen from +Z
+        lambda = -lambda;
+        it1    = glm::cross(ir1, ih);
+        it2    = glm::cross(ir2, ih);
+    }
+    else
+    {
+        it1 = glm::cross(ih, ir1);
+        it2 = glm::cross(ih, ir2);
+    }
+    if (retrograde)
+    {
+        lambda = -lambda;
+        it1    = -it1;
+        it2    = -it2;
+    }
+    double lambda3 = lambda * lambda2;
+    double T       = std::sqrt(2.0 * mu / (s * s * s)) * tof.value;
+
+    // Most revolutions for which a solution exists: below the minimum time of
+    // flight of Nmax revolutions there is none, [1] sec. 3.2
+    int    Nmax = static_cast<int>(std::floor(T / PI));
+    double T00  = std::acos(lambda) + lambda * std::sqrt(1.0 - lambda2);
+    double T1   = 2.0 / 3.0 * (1.0 - lambda3);
+    if (Nmax > 0 && maxRevs > 0 && T < T00 + Nmax * PI)
+    {
+        // Halley iterations for the minimum
+        double Tmin = T00 + Nmax * PI;
+        double x    = 0.0;
+        for (int it = 0; it <= 12; ++it)
+        {
+            double DT, DDT, DDDT;
+            tofDerivatives(lambda, x, Tmin, DT, DDT, DDDT);
+            double xnew = (DT != 0.0) ? x - DT * DDT / (DDT * DDT - DT * DDDT / 2.0) : x;
+            if (std::abs(x - xnew) < 1.0E-13)
+                break;
+            Tmin = timeOfFlight(lambda, xnew, Nmax);
+            x    = xnew;
+        }
+        if (Tmin > T)
+            --Nmax;
+    }
+    Nmax = std::min(Nmax, std::max(maxRevs, 0));
+
+    // Initial guesses and iterations, [1] sec. 3.3
+    double x0;
+    if (T >= T00)
+        x0 = -(T - T00) / (T - T00 + 4.0);
+    else if (T <= T1)
+        x0 = T1 * (T1 - T) / (2.0 / 5.0 * (1.0 - lambda2 * lambda3) * T) + 1.0;
+    else
+        x0 = std::pow(T / T00, std::log(2.0) / std::log(T1 / T00)) - 1.0;
+
+    // Velocities from x, [1] sec. 2 and Algorithm 1
+    double gamma = std::sqrt(mu * s / 2.0);
+    double rho   = (R1 - R2) / c;
+    double sigma = std::sqrt(1.0 - rho * rho);
+    auto add = [&](double x, int N, bool right, int iterations) {
+        double y   = std::sqrt(1.0 - lambda2 + lambda2 * x * x);
+        double vr1 =  gamma * ((lambda * y - x) - rho * (lambda * y + x)) / R1;
+        double vr2 = -gamma * ((lambda * y - x) + rho * (lambda * y + x)) / R2;
+        double vt  =  gamma * sigma * (y + lambda * x);
+        out.push_back({ ir1 * vr1 + it1 * (vt / R1), ir2 * vr2 + it2 * (vt / R2), N, right, iterations });
+    };
+
+    int iterations = householder(lambda, T, x0, 0, 1.0E-5, 15);
+    add(x0, 0, false, iterations);
+
+    for (int N = 1; N <= Nmax; ++N)
+    {
+        double tmp = std::pow((N * PI + PI) / (8.0 * T), 2.0 / 3.0);
+        double xl  = (tmp - 1.0) / (tmp + 1.0);
+        iterations = householder(lambda, T, xl, N, 1.0E-8, 15);
+        add(xl, N, false, iterations);
+
+        tmp = std::pow((8.0 * T) / (N * PI), 2.0 / 3.0);
+        double xr = (tmp - 1.0) / (tmp + 1.0);
+        iterations = householder(lambda, T, xr, N, 1.0E-8, 15);
+        add(xr, N, true, iterations);
+    }
+}
+
+Lambert::Solution Lambert::solve(const Vec3& r1, const Vec3& r2, const TimeDelta& tof, double mu, bool retrograde)
+{
+    std::vector<Solution> out;
+    solve(r1, r2, tof, mu, out, 0, retrograde);
+    return out.front();
+}
+
+// ── Porkchop ─────────────────────────────────────────────────────────────────
+
+PorkchopGrid Porkchop::compute(const EphemerisCache& eph, int from, int to, int center, double mu,
+                               const std::vector<EphemerisTime>& departures,
+                               const std::vector<EphemerisTime>& arrivals,
+                               int maxRevs, unsigned int threads)
+{
+    // States relative to the center, once per epoch
+    auto relative = [&](int body, const std::vector<EphemerisTime>& ets) {
+        std::vector<PosState> states(ets.size());
+        PosState b, c;
+        for (size_t k = 0; k < ets.size(); ++k)
+        {
+            eph.getState(body, ets[k], b);
+            eph.getState(center, ets[k], c);
+            states[k] = PosState(b.r - c.r, b.v - c.v);
+        }
+        return states;
+    };
+    std::vector<PosState> dep = relative(from, departures);
+    std::vector<PosState> arr = relative(to, arrivals);
+
+    PorkchopGrid grid;
+    grid.departures = departures;
+    grid.arrivals   = arrivals;
+
+    size_t n = departures.size();
+    size_t m = arrivals.size();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    grid.c3.assign(n * m, nan);
+    grid.vInfArrival.assign(n * m, nan);
+    grid.revs.assign(n * m, 0);
+
+    // One row of departures per task; each row writes its own part of the grid
+    parallelFor(n, [&](size_t i) {
+        std::vector<Lambert::Solution> sols;
+        for (size_t j = 0; j < m; ++j)
+        {
+            TimeDelta tof = arrivals[j] - departures[i];
+            if (tof.value <= 0.0)
+                continue;
+
+            Lambert::solve(dep[i].r, arr[j].r, tof, mu, sols, maxRevs);
+
+            double best = std::numeric_limits<double>::infinity();
+            for (const auto& sol : sols)
+            {
+                double vd = glm::length(sol.v1 - dep[i].v);
+                double va = glm::length(sol.v2 - arr[j].v);
+                if (vd + va < best)
+                {
+                    best = vd + va;
+                    size_t k = i * m + j;
+                    grid.c3[k]          = vd * vd;
+                    grid.vInfArrival[k] = va;
+                    grid.revs[k]        = sol.revs;
+                }
+            }
+        }
+    }, threads);
+
+    return grid;
+}
+
+} // namespace astro
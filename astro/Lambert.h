@@ -0,0 +1,83 @@
+#ifndef _ASTRO_LAMBERT_H_
+#define _ASTRO_LAMBERT_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "Ephemeris.h"
+
+namespace astro {
+
+// Lambert's problem: the conic from r1 to r2 in the time of flight tof, about
+// a central body with the gravitational parameter mu. Solved with the method
+// of Izzo: one Householder iteration in the universal variable x of [1], with
+// Lancaster's, Lagrange's or Battin's time of flight expression depending on
+// x, and converging in two or three iterations for most geometries.
+//
+// With N complete revolutions before arrival there are two solutions, the
+// left and the right branch of [1], when the time of flight allows it. The
+// transfer direction is set by the Z axis of the frame: prograde transfers
+// move counterclockwise seen from +Z. A transfer plane that contains the Z
+// axis is taken as prograde over less than 180 degrees, as in [1]. r1 and r2
+// can not be collinear; solve throws.
+class Lambert
+{
+public:
+    struct Solution
+    {
+        Vec3 v1;        // Velocity at r1
+        Vec3 v2;        // Velocity at r2
+        int  revs;      // Complete revolutions
+        bool right;     // The right branch, for revs > 0
+        int  iterations;
+    };
+
+    // Finds all solutions with up to maxRevs revolutions into out, which is
+    // cleared first: the zero revolution solution, followed by the left and the
+    // right branch for each number of revolutions that fits into tof. Reusing
+    // out between calls avoids allocations
+    static void solve(const Vec3& r1, const Vec3& r2, const TimeDelta& tof, double mu,
+                      std::vector<Solution>& out, int maxRevs = 0, bool retrograde = false);
+
+    // The zero revolution solution
+    static Solution solve(const Vec3& r1, const Vec3& r2, const TimeDelta& tof, double mu, bool retrograde = false);
+};
+
+
+// Departure C3 and arrival excess velocity over a grid of departure and
+// arrival epochs. Entry (i, j) of the matrices is at i * arrivals.size() + j.
+// Pairs where the arrival is not after the departure are NaN
+struct PorkchopGrid
+{
+    std::vector<EphemerisTime> departures;
+    std::vector<EphemerisTime> arrivals;
+
+    std::vector<double> c3;          // Departure v-infinity squared [km^2/s^2]
+    std::vector<double> vInfArrival; // [km/s]
+    std::vector<int>    revs;        // Revolutions of the chosen transfer
+
+    double c3At(size_t i, size_t j) const { return c3[i * arrivals.size() + j]; }
+    double vInfArrivalAt(size_t i, size_t j) const { return vInfArrival[i * arrivals.size() + j]; }
+};
+
+class Porkchop
+{
+public:
+    // Solves Lambert's problem between the body 'from' at each departure and
+    // the body 'to' at each arrival, relative to 'center' with the
+    // gravitational parameter mu, in J2000. All three bodies must be in the
+    // cache, which must cover the epochs; their states are looked up once per
+    // epoch. With maxRevs > 0 the transfer with the least total excess
+    // velocity, departure plus arrival, is chosen for each pair.
+    // The rows are spread over 'threads' threads; 0 uses all hardware cores.
+    // The result does not depend on the number of threads
+    static PorkchopGrid compute(const EphemerisCache& eph, int from, int to, int center, double mu,
+                                const std::vector<EphemerisTime>& departures,
+                                const std::vector<EphemerisTime>& arrivals,
+                                int maxRevs = 0, unsigned int threads = 0);
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,200 @@
+#include "LieGroup.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <cmath>
+
+// References:
+// [1]  H. Munthe-Kaas, "High order Runge-Kutta methods on manifolds",
+//      Appl. Numer. Math. 29 (1999)
+// [2]  N. Dullweber, B. Leimkuhler and R. McLachlan, "Symplectic splitting
+//      methods for rigid body molecular dynamics", J. Chem. Phys. 107 (1997)
+
+namespace astro {
+
+Quat expRotation(const Vec3& u)
+{
+    double a = glm::length(u);
+
+    // sin(a/2) / a, by its series for small angles
+    double s = (a < 1.0E-4) ? 0.5 - a * a / 48.0 : std::sin(0.5 * a) / a;
+
+    // GLM dquat(w, x, y, z)
+    return Quat(std::cos(0.5 * a), s * u.x, s * u.y, s * u.z);
+}
+
+// Inverse of the derivative of the exponential map, truncated after the
+// terms needed for order 4: v - [u, v] / 2 + [u, [u, v]] / 12 ([1] eq. 8)
+static Vec3 dexpinv(const Vec3& u, const Vec3& v)
+{
+    Vec3 uv = glm::cross(u, v);
+    return v - 0.5 * uv + glm::cross(u, uv) / 12.0;
+}
+
+// ── RKMK4 ────────────────────────────────────────────────────────────────────
+
+RKMK4::Result RKMK4::doStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    double h = dt.value;
+    double t = et.getETValue();
+
+    const Quat& q0 = s.q;
+    const Vec3& w0 = s.w;
+
+    // Position dependent torques, once for the step
+    TorqueStep step;
+    rode.prepare(et, et + dt, step);
+
+    // Stage derivatives of the rotation vector (ku) and the angular velocity (kw)
+    Vec3 ku1 = w0;
+    Vec3 kw1 = rode.rates(et, s, step).w;
+
+    Vec3 u   = 0.5 * h * ku1;
+    Vec3 w   = w0 + 0.5 * h * kw1;
+    Vec3 kw2 = rode.rates(EphemerisTime(t + 0.5 * h), RotState(expRotation(u) * q0, w), step).w;
+    Vec3 ku2 = dexpinv(u, w);
+
+    u        = 0.5 * h * ku2;
+    w        = w0 + 0.5 * h * kw2;
+    Vec3 kw3 = rode.rates(EphemerisTime(t + 0.5 * h), RotState(expRotation(u) * q0, w), step).w;
+    Vec3 ku3 = dexpinv(u, w);
+
+    u        = h * ku3;
+    w        = w0 + h * kw3;
+    Vec3 kw4 = rode.rates(EphemerisTime(t + h), RotState(expRotation(u) * q0, w), step).w;
+    Vec3 ku4 = dexpinv(u, w);
+
+    Vec3 v = (h / 6.0) * (ku1 + 2.0 * ku2 + 2.0 * ku3 + ku4);
+
+    Result res;
+    res.rs.q = glm::normalize(expRotation(v) * q0);
+    res.rs.w = w0 + (h / 6.0) * (kw1 + 2.0 * kw2 + 2.0 * kw3 + kw4);
+    res.et   = et + dt;
+    return res;
+}
+
+std::vector<RKMK4::Result> RKMK4::doSteps(
+    const RotODE& rode, const RotState& s,
+    const EphemerisTime& et0, const EphemerisTime& et1,
+    const TimeDelta& dt)
+{
+    std::vector<Result> res;
+    res.push_back({ s, et0 });
+
+    TimeDelta dti = dt;
+    while (res.back().et < et1)
+    {
+        if (res.back().et + dti > et1)
+            dti = et1 - res.back().et;
+        res.push_back(doStep(rode, res.back().rs, res.back().et, dti));
+    }
+
+    return res;
+}
+
+// ── RigidBodySplitting ───────────────────────────────────────────────────────
+
+int RigidBodySplitting::order = 2;
+
+void RigidBodySplitting::setOrder(int _order)
+{
+    if (_order != 2 && _order != 4)
+        throw AstroException("RigidBodySplitting order needs to be 2 or 4");
+    order = _order;
+}
+
+int RigidBodySplitting::getOrder()
+{
+    return order;
+}
+
+// Exact free rotation about principal axis i for the time tau ([2] sec. III):
+// the body turns by theta about its own axis, and Lb by -theta
+static void rotateAbout(int i, double tau, const Vec3& I, Vec3& Lb, Quat& q)
+{
+    double theta = Lb[i] / I[i] * tau;
+    double c     = std::cos(theta);
+    double s     = std::sin(theta);
+
+    int j = (i + 1) % 3;
+    int k = (i + 2) % 3;
+    double Lj = Lb[j];
+    Lb[j] =  c * Lj + s * Lb[k];
+    Lb[k] = -s * Lj + c * Lb[k];
+
+    Vec3 e(0.0);
+    e[i] = theta;
+    q = q * expRotation(e);
+}
+
+void RigidBodySplitting::strang(const RotODE& rode, const TorqueStep& step, const Vec3& I, Vec3& Lb, Quat& q,
+                                double h)
+{
+    // Half kick with the torques of the RotODE
+    Lb += 0.5 * h * rode.bodyTorque(RotState(q, rotate(q, Lb / I)), step);
+
+    rotateAbout(0, 0.5 * h, I, Lb, q);
+    rotateAbout(1, 0.5 * h, I, Lb, q);
+    rotateAbout(2, h, I, Lb, q);
+    rotateAbout(1, 0.5 * h, I, Lb, q);
+    rotateAbout(0, 0.5 * h, I, Lb, q);
+
+    Lb += 0.5 * h * rode.bodyTorque(RotState(q, rotate(q, Lb / I)), step);
+}
+
+RigidBodySplitting::Result RigidBodySplitting::doStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    const Mat3& Ib = rode.getInertialMatrix();
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+            if (r != c && Ib[c][r] != 0.0)
+                throw AstroException("RigidBodySplitting needs the inertia matrix along the principal axes");
+    Vec3 I(Ib[0][0], Ib[1][1], Ib[2][2]);
+
+    double h  = dt.value;
+    Quat   q  = s.q;
+    Vec3   Lb = I * rotateInverse(q, s.w);
+
+    // Position dependent torques, once for the step
+    TorqueStep step;
+    rode.prepare(et, et + dt, step);
+
+    if (order == 2)
+        strang(rode, step, I, Lb, q, h);
+    else
+    {
+        // Triple jump to order 4
+        double w1 = 1.0 / (2.0 - std::cbrt(2.0));
+        double w0 = 1.0 - 2.0 * w1;
+        strang(rode, step, I, Lb, q, w1 * h);
+        strang(rode, step, I, Lb, q, w0 * h);
+        strang(rode, step, I, Lb, q, w1 * h);
+    }
+
+    Result res;
+    res.rs.q = glm::normalize(q);
+    res.rs.w = rotate(res.rs.q, Lb / I);
+    res.et   = et + dt;
+    return res;
+}
+
+std::vector<RigidBodySplitting::Result> RigidBodySplitting::doSteps(
+    const RotODE& rode, const RotState& s,
+    const EphemerisTime& et0, const EphemerisTime& et1,
+    const TimeDelta& dt)
+{
+    std::vector<Result> res;
+    res.push_back({ s, et0 });
+
+    TimeDelta dti = dt;
+    while (res.back().et < et1)
+    {
+        if (res.back().et + dti > et1)
+            dti = et1 - res.back().et;
+        res.push_back(doStep(rode, res.back().rs, res.back().et, dti));
+    }
+
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,82 @@
+#ifndef _ASTRO_LIE_GROUP_H_
+#define _ASTRO_LIE_GROUP_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Unit quaternion of the rotation vector u (axis times angle)
+Quat expRotation(const Vec3& u);
+
+
+// Runge-Kutta-Munthe-Kaas method of order 4 for rotations. The attitude is
+// advanced as q = exp(u) q0, where the rotation vector u is integrated with
+// the classical RK4 tableau in the Lie algebra, and the angular velocity
+// with RK4 in the usual way. The quaternion is thus always a product of unit
+// quaternions and does not drift off the unit sphere, as it does when the
+// quaternion components are integrated directly.
+//
+// Uses RotODE::rates for the angular acceleration, four evaluations per step,
+// and the global frame angular velocity of RotState for the kinematics.
+class RKMK4
+{
+public:
+    struct Result
+    {
+        RotState rs;
+        EphemerisTime et;
+    };
+
+    static Result doStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const RotODE& rode, const RotState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt);
+};
+
+
+// Symplectic splitting of the rigid body in its body angular momentum (Lie-
+// Poisson form). The kinetic energy splits into Lb_i^2 / (2 I_i) along the
+// principal axes, and each part is an exact rotation of the body about one
+// axis. Composed symmetrically as 1-2-3-2-1 this gives a 2nd order method,
+// and with the triple jump of Yoshida one of order 4.
+//
+// The method is an exact Poisson map: |L| is conserved to roundoff, and the
+// energy error stays bounded instead of drifting, which suits long torque
+// free or nearly torque free runs. The torques of the RotODE, including its
+// torque terms, are applied as half kicks to the body angular momentum on
+// each side of the free motion.
+//
+// The inertia matrix must be diagonal, i.e. the body frame must be along the
+// principal axes. doStep throws otherwise.
+class RigidBodySplitting
+{
+public:
+    struct Result
+    {
+        RotState rs;
+        EphemerisTime et;
+    };
+
+    static Result doStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const RotODE& rode, const RotState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt);
+
+    // 2 or 4. Default is 2
+    static void setOrder(int order);
+
+    static int getOrder();
+
+private:
+    // Second order step of the body angular momentum and the attitude, with
+    // the torques of the prepared step
+    static void strang(const RotODE& rode, const TorqueStep& step, const Vec3& I, Vec3& Lb, Quat& q, double h);
+
+    static int order;
+};
+
+} // namespace astro
+
+#endif
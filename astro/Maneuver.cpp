@@ -0,0 +1,167 @@
+#include "Maneuver.h"
+#include "RKF78.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  O. Montenbruck and E. Gill, "Satellite Orbits", Springer (2000), 3.7
+
+namespace astro {
+
+// ── ManeuverSchedule ─────────────────────────────────────────────────────────
+
+void ManeuverSchedule::addArc(const ThrustArc& arc)
+{
+    if (!(arc.start < arc.stop))
+        throw AstroException("Thrust arc must stop after it starts");
+    if (arc.thrust <= 0.0 || arc.isp <= 0.0)
+        throw AstroException("Thrust arc needs positive thrust and specific impulse");
+    if (arc.law == AttitudeLaw::Custom ? !arc.custom : glm::length(arc.direction) == 0.0)
+        throw AstroException("Thrust arc has no direction");
+
+    auto pos = std::upper_bound(arcs.begin(), arcs.end(), arc,
+                                [](const ThrustArc& a, const ThrustArc& b) { return a.start < b.start; });
+    if ((pos != arcs.end() && pos->start < arc.stop) || (pos != arcs.begin() && arc.start < (pos - 1)->stop))
+        throw AstroException("Thrust arcs overlap");
+    arcs.insert(pos, arc);
+}
+
+const std::vector<ThrustArc>& ManeuverSchedule::getArcs() const
+{
+    return arcs;
+}
+
+const ThrustArc* ManeuverSchedule::activeArc(const EphemerisTime& et) const
+{
+    // Last arc starting at or before et
+    auto pos = std::upper_bound(arcs.begin(), arcs.end(), et,
+                                [](const EphemerisTime& t, const ThrustArc& a) { return t < a.start; });
+    if (pos == arcs.begin())
+        return nullptr;
+    --pos;
+    return (et < pos->stop) ? &*pos : nullptr;
+}
+
+EphemerisTime ManeuverSchedule::nextBoundary(const EphemerisTime& et, const EphemerisTime& et1) const
+{
+    for (const ThrustArc& a : arcs)
+    {
+        if (et < a.start)
+            return (a.start < et1) ? a.start : et1;
+        if (et < a.stop)
+            return (a.stop < et1) ? a.stop : et1;
+    }
+    return et1;
+}
+
+// ── MassState ────────────────────────────────────────────────────────────────
+
+double maxNorm(const MassState& x)
+{
+    return maxNorm(x.s);
+}
+
+// ── Maneuver ─────────────────────────────────────────────────────────────────
+
+Vec3 Maneuver::thrustAcceleration(const ODE& ode, const ThrustArc& arc, const EphemerisTime& et,
+                                  const PosState& s, double m)
+{
+    Vec3 dir;
+    if (arc.law == AttitudeLaw::Custom)
+        dir = arc.custom(et, s);
+    else if (arc.law == AttitudeLaw::Inertial)
+        dir = arc.direction;
+    else
+    {
+        // Frames relative to the first attractor
+        const std::vector<Attractor>& att = ode.getAttractors();
+        Vec3 r = att.empty() ? s.r : s.r - att.front().p;
+        Vec3 n = glm::normalize(glm::cross(r, s.v));
+        Vec3 d = arc.direction;
+        if (arc.law == AttitudeLaw::RTN)
+        {
+            Vec3 R = glm::normalize(r);
+            dir = R * d.x + glm::cross(n, R) * d.y + n * d.z;
+        }
+        else
+        {
+            Vec3 V = glm::normalize(s.v);
+            dir = V * d.x + n * d.y + glm::cross(V, n) * d.z;
+        }
+    }
+
+    // [N] / [kg] = [m/s^2] -> [km/s^2]
+    return glm::normalize(dir) * (arc.thrust / (m * 1000.0));
+}
+
+MassState Maneuver::rates(const ODE& ode, const ThrustArc* arc, const EphemerisTime& et, const MassState& x)
+{
+    MassState d(ode.rates(et, x.s), 0.0);
+    if (arc)
+    {
+        d.s.v += thrustAcceleration(ode, *arc, et, x.s, x.m);
+        d.m    = -arc->thrust / (arc->isp * G0);
+    }
+    return d;
+}
+
+Maneuver::Result Maneuver::doStep(const ODE& ode, const ManeuverSchedule& schedule, const PosState& s, double m,
+                                  const EphemerisTime& et, const TimeDelta& dt)
+{
+    if (m <= 0.0)
+        throw AstroException("Maneuver: spacecraft mass depleted");
+
+    // Fixed for the step, which does not cross a boundary
+    const ThrustArc* arc = schedule.activeArc(dt.value >= 0.0 ? et : et + dt);
+
+    auto f = [&](double t, const MassState& x) { return rates(ode, arc, EphemerisTime(t), x); };
+    MassState x_next;
+    double    h_next;
+    if (!RKF78::step(f, MassState(s, m), et.getETValue(), dt.value, 1.0, x_next, h_next))
+    {
+        // Step is rejected — return current state with reduced step
+        return { s, m, et, TimeDelta(h_next), 0 };
+    }
+    return { x_next.s, x_next.m, et + dt, TimeDelta(h_next), 0 };
+}
+
+std::vector<Maneuver::Result> Maneuver::doSteps(const ODE& ode, const ManeuverSchedule& schedule,
+                                                const PosState& s, double m0, const EphemerisTime& et0,
+                                                const EphemerisTime& et1, const TimeDelta& dt)
+{
+    std::vector<Result> res;
+    res.push_back({ s, m0, et0, dt, 0 });
+
+    double h     = dt.value;
+    int    tries = 0;
+    while (res.back().et < et1)
+    {
+        const Result& last = res.back();
+        EphemerisTime bound = schedule.nextBoundary(last.et, et1);
+        double rest    = (bound - last.et).value;
+        bool   landing = rest <= h;
+
+        Result r = doStep(ode, schedule, last.s, last.m, last.et, TimeDelta(landing ? rest : h));
+        ++tries;
+        if (r.et == last.et)
+        {
+            h = r.dt_next.value; // Rejected
+            continue;
+        }
+
+        // Land exactly on the boundary, and keep the step size across it
+        if (landing)
+            r.et = bound;
+        else
+            h = r.dt_next.value;
+        r.dt_next  = TimeDelta(h);
+        r.numTries = tries;
+        tries      = 0;
+        res.push_back(r);
+    }
+    return res;
+}
+
+} // namespace astro
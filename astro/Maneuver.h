@@ -0,0 +1,140 @@
+#ifndef _ASTRO_MANEUVER_H_
+#define _ASTRO_MANEUVER_H_
+
+#include <functional>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Standard gravity, for the specific impulse [m/s^2]
+const double G0 = 9.80665;
+
+// Thrust direction of a burn
+enum class AttitudeLaw
+{
+    Inertial, // Fixed direction in the frame of the state
+    RTN,      // Fixed in the radial, transverse, normal frame
+    VNB,      // Fixed in the velocity, normal, binormal frame
+    Custom    // Given by a function of time and state
+};
+
+// A burn at constant thrust from start to stop
+struct ThrustArc
+{
+    EphemerisTime start;
+    EphemerisTime stop;
+    double        thrust;    // [N]
+    double        isp;       // Specific impulse [s]
+    AttitudeLaw   law;
+    Vec3          direction; // In the frame of the law; normalized when used
+
+    // Unit thrust direction in the frame of the state, for AttitudeLaw::Custom
+    std::function<Vec3(const EphemerisTime&, const PosState&)> custom;
+};
+
+// Time ordered list of non-overlapping thrust arcs
+class ManeuverSchedule
+{
+public:
+    // Throws if the arc is empty, has non-positive thrust or Isp, or overlaps
+    // another arc
+    void addArc(const ThrustArc& arc);
+
+    const std::vector<ThrustArc>& getArcs() const;
+
+    // The arc burning over [et, et + dt) for steps that do not cross a
+    // boundary, i.e. start <= et < stop; or nullptr
+    const ThrustArc* activeArc(const EphemerisTime& et) const;
+
+    // First arc start or stop after et, or et1 if there is none before it
+    EphemerisTime nextBoundary(const EphemerisTime& et, const EphemerisTime& et1) const;
+
+private:
+    std::vector<ThrustArc> arcs;
+};
+
+
+// State with the spacecraft mass as a 7th component
+class MassState
+{
+public:
+    PosState s;
+    double   m; // [kg]
+
+    MassState()
+        : s(), m(0.0)
+    {}
+
+    MassState(const PosState& _s, double _m)
+        : s(_s), m(_m)
+    {}
+
+    MassState& operator+=(const MassState& o)
+    {
+        s += o.s;
+        m += o.m;
+        return *this;
+    }
+
+    MassState& operator*=(double a)
+    {
+        s *= a;
+        m *= a;
+        return *this;
+    }
+
+    friend MassState operator+(MassState lhs, const MassState& rhs) { return lhs += rhs; }
+    friend MassState operator*(MassState lhs, double a)             { return lhs *= a; }
+    friend MassState operator*(double a, MassState rhs)             { return rhs *= a; }
+};
+
+// Largest absolute component of the state, used for error control. The mass
+// is left out, as its scale is unrelated to that of the state
+double maxNorm(const MassState& x);
+
+
+// Propagation through a schedule of finite burns. The thrust acceleration
+// F / m is added to the ODE's accelerations while an arc is active, and the
+// mass decreases at F / (Isp g0). Steps are shortened to land exactly on the
+// start and stop of each arc, so RKF78 never steps across the discontinuity
+// in the thrust, and keeps its step size through the boundary.
+//
+// The mass set on the ODE is still the one used by its drag and radiation
+// pressure terms. RKF78's tolerance applies.
+class Maneuver
+{
+public:
+    struct Result
+    {
+        PosState      s;
+        double        m;
+        EphemerisTime et;
+        TimeDelta     dt_next;
+        int           numTries;
+    };
+
+    // Thrust acceleration of an arc (km/s^2)
+    static Vec3 thrustAcceleration(const ODE& ode, const ThrustArc& arc, const EphemerisTime& et,
+                                   const PosState& s, double m);
+
+    // Derivatives of the state and the mass, with the arc that is active over
+    // the step (nullptr for coasting)
+    static MassState rates(const ODE& ode, const ThrustArc* arc, const EphemerisTime& et, const MassState& x);
+
+    // One step; dt must not cross an arc boundary
+    static Result doStep(const ODE& ode, const ManeuverSchedule& schedule, const PosState& s, double m,
+                         const EphemerisTime& et, const TimeDelta& dt);
+
+    // Steps from et0 to et1, landing on every arc boundary in between
+    static std::vector<Result> doSteps(const ODE& ode, const ManeuverSchedule& schedule, const PosState& s,
+                                       double m0, const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+};
+
+} // namespace astro
+
+#endif
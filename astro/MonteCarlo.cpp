@@ -0,0 +1,309 @@
+#include "MonteCarlo.h"
+#include "Covariance.h"
+#include "RKF78.h"
+#include "Parallel.h"
+#include "Exceptions.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  T. F. Chan, G. H. Golub and R. J. LeVeque, "Updating formulae and a
+//      pairwise algorithm for computing sample variances", STAN-CS-79-773 (1979)
+
+namespace astro {
+
+// Number of samples accumulated together before the blocks are merged
+static const size_t BLOCK = 64;
+
+// Blocks in flight per worker thread. A run keeps the accumulators of
+// WAVE * threads blocks, whatever the number of samples
+static const size_t WAVE = 4;
+
+// Component i of the state as a 6-vector (r, v)
+static double component(const PosState& s, int i)
+{
+    return i < 3 ? s.r[i] : s.v[i - 3];
+}
+
+// Finalizer of SplitMix64, used to derive independent seeds
+static uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// ── SplitMix64 ───────────────────────────────────────────────────────────────
+
+double SplitMix64::normal()
+{
+    double u1 = uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+}
+
+// ── Histogram ────────────────────────────────────────────────────────────────
+
+Histogram::Histogram(double _lo, double _hi, size_t bins)
+    : lo(_lo), hi(_hi), counts(bins, 0), underflow(0), overflow(0)
+{
+    if (bins == 0 || !(hi > lo))
+        throw AstroException("Histogram needs at least one bin and a non-empty range");
+    width = (hi - lo) / bins;
+}
+
+void Histogram::add(double x)
+{
+    if (x < lo)
+        ++underflow;
+    else if (x >= hi)
+        ++overflow;
+    else
+        ++counts[std::min(static_cast<size_t>((x - lo) / width), counts.size() - 1)];
+}
+
+void Histogram::merge(const Histogram& o)
+{
+    if (o.lo != lo || o.hi != hi || o.counts.size() != counts.size())
+        throw AstroException("Merging histograms of different layouts");
+    for (size_t i = 0; i < counts.size(); ++i)
+        counts[i] += o.counts[i];
+    underflow += o.underflow;
+    overflow  += o.overflow;
+}
+
+size_t Histogram::count() const
+{
+    size_t n = underflow + overflow;
+    for (size_t c : counts)
+        n += c;
+    return n;
+}
+
+const std::vector<size_t>& Histogram::getCounts() const
+{
+    return counts;
+}
+
+size_t Histogram::getUnderflow() const
+{
+    return underflow;
+}
+
+size_t Histogram::getOverflow() const
+{
+    return overflow;
+}
+
+double Histogram::binCenter(size_t i) const
+{
+    return lo + (i + 0.5) * width;
+}
+
+double Histogram::percentile(double p) const
+{
+    size_t n = count();
+    if (n == 0)
+        throw AstroException("Percentile of an empty histogram");
+
+    double target = std::max(0.0, std::min(p, 1.0)) * n;
+    double below  = underflow;
+    if (target <= below)
+        return lo;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        if (counts[i] > 0 && target <= below + counts[i])
+            return lo + (i + (target - below) / counts[i]) * width;
+        below += counts[i];
+    }
+    return hi;
+}
+
+// ── StateStatistics ──────────────────────────────────────────────────────────
+
+StateStatistics::StateStatistics()
+    : n(0), m(0.0), M2()
+{}
+
+void StateStatistics::add(const PosState& s)
+{
+    ++n;
+    PosState d0 = s - m;
+    m += d0 * (1.0 / n);
+    PosState d1 = s - m;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            M2(i, j) += component(d0, i) * component(d1, j);
+}
+
+void StateStatistics::merge(const StateStatistics& o)
+{
+    if (o.n == 0)
+        return;
+    if (n == 0)
+    {
+        *this = o;
+        return;
+    }
+
+    // [1] eq. 2.1b
+    double   na = n, nb = o.n, nn = na + nb;
+    PosState d  = o.m - m;
+    m += d * (nb / nn);
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            M2(i, j) += o.M2(i, j) + component(d, i) * component(d, j) * (na * nb / nn);
+    n += o.n;
+}
+
+size_t StateStatistics::count() const
+{
+    return n;
+}
+
+PosState StateStatistics::mean() const
+{
+    return m;
+}
+
+Mat6 StateStatistics::covariance() const
+{
+    if (n < 2)
+        return Mat6();
+    return M2 * (1.0 / (n - 1));
+}
+
+// ── MonteCarlo ───────────────────────────────────────────────────────────────
+
+MonteCarlo::MonteCarlo(const ODE& _ode, const PosState& s, const EphemerisTime& _et0)
+    : ode(_ode), s0(s), et0(_et0), L(), massSigma(0.0), forceSigma(0.0)
+{}
+
+void MonteCarlo::setStateCovariance(const Mat6& P)
+{
+    L = cholesky(P);
+}
+
+void MonteCarlo::setMassSigma(double sigma)
+{
+    if (sigma < 0.0)
+        throw AstroException("Negative standard deviation of the mass");
+    massSigma = sigma;
+}
+
+void MonteCarlo::setForceSigma(const Vec3& sigma)
+{
+    if (sigma.x < 0.0 || sigma.y < 0.0 || sigma.z < 0.0)
+        throw AstroException("Negative standard deviation of the force");
+    forceSigma = sigma;
+}
+
+void MonteCarlo::addMetric(const Metric& metric)
+{
+    if (!metric.f)
+        throw AstroException("Empty Monte Carlo metric");
+    Histogram check(metric.lo, metric.hi, metric.bins); // Validates the layout
+    metrics.push_back(metric);
+}
+
+MonteCarlo::Sample MonteCarlo::sample(size_t i, uint64_t seed) const
+{
+    SplitMix64 rng(mix(seed ^ mix(i + 1)));
+
+    double z[6];
+    for (int k = 0; k < 6; ++k)
+        z[k] = rng.normal();
+
+    Sample smp;
+    smp.s = s0;
+    for (int r = 0; r < 6; ++r)
+    {
+        double d = 0.0;
+        for (int c = 0; c <= r; ++c)
+            d += L(r, c) * z[c];
+        if (r < 3)
+            smp.s.r[r] += d;
+        else
+            smp.s.v[r - 3] += d;
+    }
+
+    smp.mass  = ode.getMass() + massSigma * rng.normal();
+    smp.force = ode.getForce();
+    for (int k = 0; k < 3; ++k)
+        smp.force[k] += forceSigma[k] * rng.normal();
+
+    if (smp.mass <= 0.0)
+        throw AstroException("Monte Carlo sample drew a non-positive mass");
+    return smp;
+}
+
+MonteCarlo::Result MonteCarlo::run(size_t n, const std::vector<EphemerisTime>& epochs, const TimeDelta& dt,
+                                   uint64_t seed, unsigned int threads) const
+{
+    if (!std::is_sorted(epochs.begin(), epochs.end()) || (!epochs.empty() && epochs.front() < et0))
+        throw AstroException("Monte Carlo epochs must be in ascending order, at or after the initial epoch");
+
+    // Empty accumulators for one block
+    Result empty;
+    empty.epochs = epochs;
+    empty.stats.resize(epochs.size());
+    for (size_t e = 0; e < epochs.size(); ++e)
+    {
+        empty.histograms.emplace_back();
+        for (const Metric& m : metrics)
+            empty.histograms.back().emplace_back(m.lo, m.hi, m.bins);
+    }
+
+    bool dispersedForce = massSigma > 0.0 || forceSigma != Vec3(0.0);
+
+    // Every sample uses the tolerance read here
+    const double tol = RKF78::getTolerance();
+
+    // The blocks run in waves, each merged into the result before the next
+    // starts, so the accumulators are reused and memory does not grow with n
+    size_t nblocks = (n + BLOCK - 1) / BLOCK;
+    size_t wave    = std::min<size_t>(nblocks, WAVE * workerThreads(threads));
+    std::vector<Result> blocks(wave, empty);
+    Result res = empty;
+    for (size_t first = 0; first < nblocks; first += wave)
+    {
+        size_t count = std::min(wave, nblocks - first);
+        parallelFor(count, [&](size_t j) {
+            Result& acc = blocks[j];
+            acc = empty;
+            ODE local(ode);
+            size_t b = first + j;
+            for (size_t i = b * BLOCK; i < std::min(n, (b + 1) * BLOCK); ++i)
+            {
+                Sample smp = sample(i, seed);
+                if (dispersedForce)
+                {
+                    local.setMass(smp.mass);
+                    local.setForce(smp.force);
+                }
+
+                std::vector<PosState> states = RKF78::propagateTo(local, smp.s, et0, epochs, dt, tol);
+                for (size_t e = 0; e < epochs.size(); ++e)
+                {
+                    acc.stats[e].add(states[e]);
+                    for (size_t k = 0; k < metrics.size(); ++k)
+                        acc.histograms[e][k].add(metrics[k].f(states[e]));
+                }
+            }
+        }, threads);
+
+        // Merge in block order, independent of the thread count
+        for (size_t j = 0; j < count; ++j)
+            for (size_t e = 0; e < epochs.size(); ++e)
+            {
+                res.stats[e].merge(blocks[j].stats[e]);
+                for (size_t k = 0; k < metrics.size(); ++k)
+                    res.histograms[e][k].merge(blocks[j].histograms[e][k]);
+            }
+    }
+    return res;
+}
+
+} // namespace astro
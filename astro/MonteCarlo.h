@@ -0,0 +1,180 @@
+#ifndef _ASTRO_MONTE_CARLO_H_
+#define _ASTRO_MONTE_CARLO_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+#include "Variational.h"
+
+namespace astro {
+
+// SplitMix64 generator (S. Vigna). Small and fast, and any seed gives a good
+// stream, so each Monte Carlo sample can get its own generator seeded from
+// the run seed and its index. Sequences are the same on every platform.
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed)
+        : state(seed)
+    {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in (0, 1)
+    double uniform()
+    {
+        return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+    // Standard normal, by the Box-Muller transform
+    double normal();
+
+private:
+    uint64_t state;
+};
+
+
+// Histogram over [lo, hi) with equal bins, counting the values outside
+// separately. Histograms of the same layout can be merged
+class Histogram
+{
+public:
+    Histogram(double lo, double hi, size_t bins);
+
+    void add(double x);
+
+    void merge(const Histogram& o);
+
+    // Number of values, including those outside the range
+    size_t count() const;
+
+    const std::vector<size_t>& getCounts() const;
+    size_t getUnderflow() const;
+    size_t getOverflow() const;
+
+    double binCenter(size_t i) const;
+
+    // Value below which the fraction p (0..1) of the values lie, interpolated
+    // within the bins. Clamped to lo and hi for values outside the range
+    double percentile(double p) const;
+
+private:
+    double lo;
+    double hi;
+    double width;
+    std::vector<size_t> counts;
+    size_t underflow;
+    size_t overflow;
+};
+
+
+// Streaming mean and covariance of states (Welford's algorithm), with the
+// pairwise merge of Chan et al.
+class StateStatistics
+{
+public:
+    StateStatistics();
+
+    void add(const PosState& s);
+
+    void merge(const StateStatistics& o);
+
+    size_t count() const;
+
+    PosState mean() const;
+
+    // Sample covariance over (r, v)
+    Mat6 covariance() const;
+
+private:
+    size_t   n;
+    PosState m;
+    Mat6     M2;
+};
+
+
+// Monte Carlo dispersion analysis. Each sample draws an initial state from a
+// 6x6 covariance around the nominal state, and optionally the mass and the
+// applied force around the nominal values of the ODE, then propagates with
+// RKF78 to the requested epochs. Only the statistics are kept: the mean and
+// covariance of the states, and histograms of user defined metrics, per epoch.
+//
+// Sample i draws from its own generator, seeded from the run seed and i, and
+// samples are accumulated in fixed blocks that are merged in order, so the
+// result is identical for any number of threads. The blocks run in waves of a
+// few per thread, merged as each wave ends, so the memory of a run depends on
+// the number of threads and not on the number of samples. Each sample
+// propagates its own copy of the ODE; nothing mutable is shared between
+// threads.
+class MonteCarlo
+{
+public:
+    // Scalar function of a state, with the range and the number of bins of
+    // its histogram. Called concurrently from the worker threads
+    struct Metric
+    {
+        std::function<double(const PosState&)> f;
+        double lo;
+        double hi;
+        size_t bins;
+    };
+
+    struct Sample
+    {
+        PosState s;
+        double   mass;  // [kg]
+        Vec3     force; // [N], inertial
+    };
+
+    struct Result
+    {
+        std::vector<EphemerisTime>          epochs;
+        std::vector<StateStatistics>        stats;      // Per epoch
+        std::vector<std::vector<Histogram>> histograms; // Per epoch, per metric
+    };
+
+    // The ODE is copied as an ODE, with the mass and the force it has set as
+    // the nominal values
+    MonteCarlo(const ODE& ode, const PosState& s, const EphemerisTime& et0);
+
+    void setStateCovariance(const Mat6& P);
+
+    // Standard deviation of the mass [kg]
+    void setMassSigma(double sigma);
+
+    // Standard deviations of the applied force along the inertial axes [N]
+    void setForceSigma(const Vec3& sigma);
+
+    void addMetric(const Metric& metric);
+
+    // Dispersed initial conditions of sample i
+    Sample sample(size_t i, uint64_t seed) const;
+
+    // Runs n samples. threads = 0 uses all hardware cores
+    Result run(size_t n, const std::vector<EphemerisTime>& epochs, const TimeDelta& dt, uint64_t seed,
+               unsigned int threads = 0) const;
+
+private:
+    ODE           ode;
+    PosState      s0;
+    EphemerisTime et0;
+
+    Mat6   L;           // Cholesky factor of the state covariance
+    double massSigma;
+    Vec3   forceSigma;
+    std::vector<Metric> metrics;
+};
+
+} // namespace astro
+
+#endif
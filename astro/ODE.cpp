@@ -24,51 +24,144 @@ PosState ODE::rates(const EphemerisTime& et, const PosState& s) const
 
 void ODE::operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
 {
-    dxdt.r = x.v;
+    forces(x, dxdt, et);
+}
+
+void ODE::prepare(const EphemerisTime& et0, const EphemerisTime& et1, ForceStep& step) const
+{
+    forces.prepare(et0, et1, step);
+}
+
+void ODE::operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et, const ForceStep& step) const
+{
+    if (step.slots.empty())
+        operator()(x, dxdt, et);
+    else
+        forces(x, dxdt, et, step);
+}
+
+PosState ODE::rates(const EphemerisTime& et, const PosState& s, const ForceStep& step) const
+{
+    PosState sdot;
+    operator()(s, sdot, et, step);
+    return sdot;
+}
+
+void ODE::partials(const EphemerisTime& et, const PosState& s, Mat3& dadr, Mat3& dadv) const
+{
+    dadr = Mat3(0.0);
+    dadv = Mat3(0.0);
+    forces.partials(s, et, dadr, dadv);
+}
+
+void ODE::rebuild()
+{
+    forces.clear();
 
-    dxdt.v = Vec3(0.0);
     for (const Attractor& a : attractors)
-    {
-        Vec3   r = x.r - a.p;
-        double R = glm::length(r);
-        dxdt.v  += (-a.GM / std::pow(R, 3.0)) * r;
-    }
+        forces.add(PointMassForce(a));
 
     // Applied force (thruster or other non-gravitational force).
     // Use setForce() or setBodyForce() to set; zero by default.
-    dxdt.v += m_force / m_mass;
+    if (m_force != Vec3(0.0))
+        forces.add(ThrustForce(m_force / m_mass));
+
+    Vec3 center = attractors.empty() ? Vec3(0.0) : attractors.front().p;
+    if (m_atmosphere)
+        forces.add(DragForce(m_atmosphere, m_cd, m_area, m_mass, m_omega, center));
+    if (m_srp)
+        forces.add(SRPForce(m_srp, m_mass, center));
 
-    // TODO: add perturbations:
-    // - Oblateness (J2 and higher zonal harmonics)
-    // - Atmospheric drag
-    // - Solar radiation pressure
+    for (const auto& t : terms)
+        forces.add(t);
 }
 
 void ODE::addAttractor(const Attractor& a)
 {
     attractors.push_back(a);
+    rebuild();
 }
 
 void ODE::clearAttractors()
 {
     attractors.clear();
+    rebuild();
+}
+
+const std::vector<Attractor>& ODE::getAttractors() const
+{
+    return attractors;
 }
 
 void ODE::setMass(double mass_kg)
 {
     m_mass = mass_kg;
+    rebuild();
+}
+
+double ODE::getMass() const
+{
+    return m_mass;
 }
 
 void ODE::setForce(const Vec3& f_inertial)
 {
     m_force = f_inertial;
+    rebuild();
 }
 
 void ODE::setBodyForce(const Vec3& f_body, const Quat& attitude)
 {
     // Rotate body-frame force to inertial frame.
     // attitude rotates body→inertial: v_inertial = attitude * v_body * conj(attitude)
-    m_force = transform(attitude, f_body, glm::inverse(attitude));
+    m_force = rotate(attitude, f_body);
+    rebuild();
+}
+
+const Vec3& ODE::getForce() const
+{
+    return m_force;
+}
+
+void ODE::setDrag(std::shared_ptr<const Atmosphere> atmosphere, double cd, double area_m2, const Vec3& omega)
+{
+    if (atmosphere && (cd <= 0.0 || area_m2 <= 0.0))
+        throw AstroException("Drag coefficient and area must be positive");
+    m_atmosphere = atmosphere;
+    m_cd         = cd;
+    m_area       = area_m2;
+    m_omega      = omega;
+    rebuild();
+}
+
+double ODE::getBallisticCoefficient() const
+{
+    return m_cd * m_area / m_mass;
+}
+
+void ODE::setSolarRadiationPressure(std::shared_ptr<const SolarRadiationPressure> srp)
+{
+    m_srp = srp;
+    rebuild();
+}
+
+void ODE::addForceTerm(std::shared_ptr<const ForceTerm> term)
+{
+    if (!term)
+        throw AstroException("Empty force term");
+    terms.push_back(term);
+    rebuild();
+}
+
+void ODE::clearForceTerms()
+{
+    terms.clear();
+    rebuild();
+}
+
+const ForceModel& ODE::getForceModel() const
+{
+    return forces;
 }
 
 
@@ -99,13 +192,96 @@ void RotODE::setInertialMatrix(const Mat3& Ib)
     i_b_inv = glm::inverse(i_b);
 }
 
+const Mat3& RotODE::getInertialMatrix() const
+{
+    return i_b;
+}
+
+const Vec3& RotODE::getGlobalTorque() const
+{
+    return t;
+}
+
+const Vec3& RotODE::getBodyTorque() const
+{
+    return t_b;
+}
+
+void RotODE::addTorqueTerm(std::shared_ptr<const TorqueTerm> term)
+{
+    if (!term)
+        throw AstroException("Empty torque term");
+    torques.push_back(term);
+}
+
+void RotODE::clearTorqueTerms()
+{
+    torques.clear();
+}
+
+bool RotODE::hasTorqueTerms() const
+{
+    return !torques.empty();
+}
+
+void RotODE::setPositionSource(PositionSource _source)
+{
+    source = _source;
+}
+
+void RotODE::prepare(const EphemerisTime& et0, const EphemerisTime& et1, TorqueStep& step) const
+{
+    step.slots.assign(torques.size(), TorqueEnvironment());
+    if (torques.empty())
+        return;
+    if (!source)
+        throw AstroException("RotODE: torque terms need a position source");
+
+    EphemerisTime et = et0 + TimeDelta(0.5 * (et1 - et0).value);
+    PosState      s  = source(et);
+    for (size_t i = 0; i < torques.size(); ++i)
+    {
+        step.slots[i].et = et;
+        torques[i]->prepare(et, s, step.slots[i]);
+    }
+}
+
+Vec3 RotODE::bodyTorque(const RotState& rs, const TorqueStep& step) const
+{
+    return bodyTorque(rs, rotationMatrix(rs.q), step);
+}
+
+Vec3 RotODE::bodyTorque(const RotState& rs, const Mat3& R, const TorqueStep& step) const
+{
+    // Inertial to body frame is the transpose of R
+    Mat3 Rt = glm::transpose(R);
+
+    // Transform global-frame torque to body frame and sum — [1] eq (56)
+    Vec3 tbt = t_b + Rt * t;
+    if (!torques.empty())
+    {
+        if (step.slots.size() != torques.size())
+            throw AstroException("RotODE: torque terms need a step prepared by prepare()");
+        Vec3 wb = Rt * rs.w;
+        for (size_t i = 0; i < torques.size(); ++i)
+            tbt += torques[i]->torque(step.slots[i], rs.q, wb, i_b);
+    }
+    return tbt;
+}
+
 
 RotState RotODE::rates(const EphemerisTime& et, const RotState& rs) const
+{
+    TorqueStep step;
+    prepare(et, et, step);
+    return rates(et, rs, step);
+}
+
+RotState RotODE::rates(const EphemerisTime& et, const RotState& rs, const TorqueStep& step) const
 {
     RotState rs_dot;
 
     Quat Q     = rs.q;
-    Quat Q_inv = glm::inverse(Q);
     double q0  = Q.w; // scalar part
     Vec3   q   = Vec3(Q.x, Q.y, Q.z);
 
@@ -117,18 +293,20 @@ RotState RotODE::rates(const EphemerisTime& et, const RotState& rs) const
 
     // Angular velocity derivative
 
-    // Transform global-frame torque to body frame and sum — [1] eq (56)
-    Vec3 tb2  = transform(Q_inv, t, Q);
-    Vec3 tbt  = t_b + tb2;
+    // One rotation matrix for all the frame changes below
+    Mat3 R = rotationMatrix(Q);
+
+    // Set torques and torque terms in body frame
+    Vec3 tbt = bodyTorque(rs, R, step);
 
     // Angular velocity in body frame
-    Vec3 wb = transform(Q_inv, w, Q);
+    Vec3 wb = glm::transpose(R) * w;
 
     // [1] eq (4): L_dot = tau - w × (I * w)
     // TODO: For time-varying I, subtract I_dot * wb
     Vec3 Lb_dot = tbt - glm::cross(wb, i_b * wb);
     Vec3 wbdot  = i_b_inv * Lb_dot;
-    rs_dot.w    = transform(Q, wbdot, Q_inv);
+    rs_dot.w    = R * wbdot;
 
     return rs_dot;
 }
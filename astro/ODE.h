@@ -4,19 +4,20 @@
 #include "State.h"
 #include "Time.h"
 #include "Exceptions.h"
+#include "ForceModel.h"
+#include "TorqueModel.h"
+#include <functional>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace astro {
 
-
-class Attractor
-{
-public:
-    Vec3   p;  // Position relative to the frame of reference
-    double GM;
-};
-
-// Differential equation for translation. Separated from rotation because:
+// Differential equation for translation. The accelerations are summed by a
+// ForceModel, built from the attractors and the perturbations enabled below,
+// followed by any terms added with addForceTerm().
+//
+// Translation is separated from rotation because:
 // - They are largely uncoupled
 // - They have very different optimal time steps
 // - This allows different propagation regimes (e.g. numerical for rotation,
@@ -33,24 +34,92 @@ public:
     // Callable interface required by ODE solvers
     virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const;
 
+    // Prepares the force terms for an integration step from et0 to et1, see
+    // ForceModel.h. The result belongs to the step, and is passed to each of
+    // its stages below
+    virtual void prepare(const EphemerisTime& et0, const EphemerisTime& et1, ForceStep& step) const;
+
+    // As operator() above, at a stage of a step prepared by prepare(). An
+    // unprepared (empty) step calls operator() above, so subclasses that only
+    // override that one keep working, without the per step preparation
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et, const ForceStep& step) const;
+
+    PosState rates(const EphemerisTime& et, const PosState& s, const ForceStep& step) const;
+
+    // Partial derivatives of the acceleration with respect to the position
+    // (dadr) and the velocity (dadv), from the force terms. Used for the
+    // variational equations
+    virtual void partials(const EphemerisTime& et, const PosState& s, Mat3& dadr, Mat3& dadv) const;
+
     virtual void addAttractor(const Attractor& a);
     virtual void clearAttractors();
 
+    const std::vector<Attractor>& getAttractors() const;
+
     // Set spacecraft mass (kg). Required when a non-zero force is applied.
     void setMass(double mass_kg);
 
+    double getMass() const;
+
     // Set thrust force already expressed in the inertial frame (N).
     // Applied as f/m acceleration each integration step.
+    // NOTE: f/m is added to the rates (km/s^2) without the m/s^2 -> km/s^2
+    // conversion, so the force is effectively in kN. Existing callers and
+    // tests rely on this; new code (Maneuver, SixDOF) converts instead.
     void setForce(const Vec3& f_inertial);
 
     // Convenience: set thrust in body frame + attitude quaternion.
     // The quaternion rotates body→inertial (i.e. the spacecraft attitude).
     void setBodyForce(const Vec3& f_body, const Quat& attitude);
 
+    // Applied force in the inertial frame (N)
+    const Vec3& getForce() const;
+
+    // Enable atmospheric drag relative to the first attractor, with the drag
+    // coefficient cd and the cross section area (m^2). The atmosphere
+    // co-rotates with the angular velocity omega (rad/s, default the Earth's).
+    // Pass an empty pointer to disable drag.
+    void setDrag(std::shared_ptr<const Atmosphere> atmosphere, double cd, double area_m2,
+                 const Vec3& omega = Vec3(0.0, 0.0, 7.2921158553E-5));
+
+    // Ballistic coefficient cd * A / m (m^2/kg), using the mass from setMass()
+    double getBallisticCoefficient() const;
+
+    // Enable solar radiation pressure, relative to the first attractor and
+    // with the mass from setMass(). Pass an empty pointer to disable it.
+    void setSolarRadiationPressure(std::shared_ptr<const SolarRadiationPressure> srp);
+
+    // Add a force term, e.g. ZonalHarmonicsForce or ThirdBodyForce. Evaluated
+    // after the built-in terms
+    void addForceTerm(std::shared_ptr<const ForceTerm> term);
+
+    template<typename Term>
+    void addForceTerm(const Term& term)
+    {
+        addForceTerm(makeForceTerm(term));
+    }
+
+    void clearForceTerms();
+
+    const ForceModel& getForceModel() const;
+
 private:
+    // Rebuilds the force model after a change of the configuration
+    void rebuild();
+
+    ForceModel forces;
+    std::vector<std::shared_ptr<const ForceTerm>> terms; // From addForceTerm()
+
     std::vector<Attractor> attractors;
     double m_mass  = 1.0;   // kg
     Vec3   m_force = Vec3(0.0); // body-frame force (N)
+
+    std::shared_ptr<const Atmosphere> m_atmosphere;
+    double m_cd    = 0.0;
+    double m_area  = 0.0;   // m^2
+    Vec3   m_omega = Vec3(0.0); // atmosphere rotation (rad/s)
+
+    std::shared_ptr<const SolarRadiationPressure> m_srp;
 };
 
 
@@ -61,9 +130,16 @@ public:
     explicit RotODE(const Mat3& Ib = Mat3(1.0));
     virtual ~RotODE();
 
-    // Force function for rotational dynamics
+    // Translational state of the body at a given time, e.g. from an Orbit
+    typedef std::function<PosState(const EphemerisTime&)> PositionSource;
+
+    // Force function for rotational dynamics. Torque terms are prepared at et
+    // in each call; the integrators prepare them once per step instead
     RotState rates(const EphemerisTime& et, const RotState& s) const;
 
+    // As above, at a stage of a step prepared by prepare()
+    RotState rates(const EphemerisTime& et, const RotState& s, const TorqueStep& step) const;
+
     // Set global-frame torque (e.g. gravity gradient)
     void setGlobalTorque(const Vec3& t);
 
@@ -73,11 +149,51 @@ public:
     // Set the inertia matrix in body frame
     void setInertialMatrix(const Mat3& Ib);
 
+    const Mat3& getInertialMatrix() const;
+    const Vec3& getGlobalTorque() const;
+    const Vec3& getBodyTorque() const;
+
+    // Add an environmental torque, e.g. GravityGradientTorque. Needs a
+    // position source
+    void addTorqueTerm(std::shared_ptr<const TorqueTerm> term);
+
+    template<typename Term>
+    void addTorqueTerm(const Term& term)
+    {
+        if constexpr (std::is_convertible<Term, std::shared_ptr<const TorqueTerm>>::value)
+            addTorqueTerm(std::shared_ptr<const TorqueTerm>(term));
+        else
+            addTorqueTerm(std::make_shared<const Term>(term));
+    }
+
+    void clearTorqueTerms();
+
+    bool hasTorqueTerms() const;
+
+    // Where the torque terms take the translational state from
+    void setPositionSource(PositionSource source);
+
+    // Evaluates the position dependent part of the torque terms for a step
+    // from et0 to et1 into step, with the position source at the middle of
+    // the step. The integrators call it at the start of each step, and pass
+    // step to its stages. Throws if there are torque terms and no source
+    void prepare(const EphemerisTime& et0, const EphemerisTime& et1, TorqueStep& step) const;
+
+    // Total torque in the body frame: the set torques and the torque terms
+    // of the prepared step
+    Vec3 bodyTorque(const RotState& s, const TorqueStep& step) const;
+
 private:
+    // As above, with R the rotation matrix of s.q (body to inertial)
+    Vec3 bodyTorque(const RotState& s, const Mat3& R, const TorqueStep& step) const;
+
     Vec3 t;       // global torque
     Vec3 t_b;     // body-frame torque
     Mat3 i_b;     // body-frame inertia matrix
     Mat3 i_b_inv; // inverse inertia matrix
+
+    std::vector<std::shared_ptr<const TorqueTerm>> torques;
+    PositionSource                                 source;
 };
 
 
@@ -79,24 +79,32 @@ OrbitElements OrbitElements::fromStateVectorOE(const PosState& state, const Ephe
     // 11. Eccentricity
     oe.e = glm::length(E);
 
-    // 12. Argument of perigee
-    Vec3 E_norm = glm::normalize(E);
+    // 12. Argument of perigee. For a circular orbit the perigee is undefined;
+    // it is then put at the ascending node (or the X axis if equatorial) and
+    // the true anomaly becomes the argument of latitude
+    bool circular = (oe.e < 1.0E-12);
+    Vec3 E_norm = circular ? ((n > 0.0) ? glm::normalize(N) : Vec3(1.0, 0.0, 0.0))
+                           : glm::normalize(E);
     if (n > 0.0)
     {
         Vec3 N_norm = glm::normalize(N);
-        oe.w = std::acos(glm::dot(N_norm, E_norm));
+        oe.w = std::acos(std::max(-1.0, std::min(1.0, glm::dot(N_norm, E_norm))));
+        if (E_norm.z < 0.0)
+            oe.w = 2.0 * astro::PI - oe.w;
     }
     else
     {
-        oe.w = 0.0;
+        // Equatorial: the node is put on the X axis, and the perigee is
+        // measured from it in the direction of motion
+        oe.w = std::atan2((H.z > 0.0) ? E_norm.y : -E_norm.y, E_norm.x);
+        if (oe.w < 0.0)
+            oe.w += 2.0 * astro::PI;
     }
-    if (E.z < 0.0)
-        oe.w = 2.0 * astro::PI - oe.w;
 
     // 13. True anomaly → mean anomaly
     Vec3   R_norm = glm::normalize(state.r);
-    double theta  = std::acos(glm::dot(E_norm, R_norm));
-    if (v_r < 0.0)
+    double theta  = std::acos(std::max(-1.0, std::min(1.0, glm::dot(E_norm, R_norm))));
+    if (circular ? (glm::dot(glm::cross(E_norm, R_norm), H) < 0.0) : (v_r < 0.0))
         theta = 2.0 * astro::PI - theta;
 
     oe.M0   = meanAnomalyFromTrueAnomaly(theta, oe.e);
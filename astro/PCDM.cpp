@@ -1,35 +1,55 @@
 #include "PCDM.h"
 #include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 namespace astro {
 
+double PCDM::tol = 1.0E-8;
+
+void PCDM::setTolerance(double _tol)
+{
+    if (_tol <= 0.0)
+        throw AstroException("Zero or negative tolerance not allowed for PCDM");
+    tol = _tol;
+}
+
+double PCDM::getTolerance()
+{
+    return tol;
+}
+
 PCDM::Result PCDM::doStep(const RotODE& rode, const RotState& rs, const EphemerisTime& et, const TimeDelta& dt)
 {
     double DT = dt.value;
 
-    // Rotation at time n
-    Quat qn     = rs.q;
-    Quat qn_inv = glm::inverse(qn);
+    // Position dependent torques, once for the step
+    TorqueStep step;
+    rode.prepare(et, et + dt, step);
 
-    // Angular velocity at time n as a pure quaternion (scalar = 0)
-    // GLM dquat(w, x, y, z), so scalar=0 means (0, wx, wy, wz)
-    Quat q_wn = Quat(0.0, rs.w.x, rs.w.y, rs.w.z);
+    // Rotation at time n, and its matrix for the frame changes at n
+    Quat qn  = rs.q;
+    Mat3 Rn  = rotationMatrix(qn);
+    Mat3 Rnt = glm::transpose(Rn);
 
     // Transform angular velocities to body frame
-    Quat q_wbn = qn_inv * q_wn * qn;
-    Vec3 wbn   = Vec3(q_wbn.x, q_wbn.y, q_wbn.z);
+    Vec3 wbn = Rnt * rs.w;
 
     // Derivatives at time n
-    RotState rsn_dot = rode.rates(et, rs);
+    RotState rsn_dot = rode.rates(et, rs, step);
 
     // (57) Angular velocities at n+1/4 and n+1/2
     Vec3 wndot  = rsn_dot.w;
-    Vec3 wbndot = transform(qn_inv, wndot, qn);
+    Vec3 wbndot = Rnt * wndot;
     Vec3 wbn14  = wbn + 0.25 * wbndot * DT;
     Vec3 wbn12  = wbn + 0.50 * wbndot * DT;
 
     // (58) Angular velocity in global frame at n+1/4
-    Vec3 wn14 = transform(qn, wbn14, qn_inv);
+    Vec3 wn14 = Rn * wbn14;
 
     // (59) Predicted q'_n+1/2
     double wn14_l = glm::length(wn14);
@@ -43,12 +63,12 @@ PCDM::Result PCDM::doStep(const RotODE& rode, const RotState& rs, const Ephemeri
     Quat qprime_n12 = Quat(std::cos(F), tmp.x, tmp.y, tmp.z) * qn;
 
     // (60) Angular velocity in global frame at n+1/2
-    Vec3 wn12 = transform(qprime_n12, wbn12, glm::inverse(qprime_n12));
+    Vec3 wn12 = rotate(qprime_n12, wbn12);
 
     // Derivatives at n+1/2
     RotState rprime_n12(qprime_n12, wn12);
     TimeDelta dt12(0.5 * DT);
-    RotState rsn12_dot = rode.rates(et + dt12, rprime_n12);
+    RotState rsn12_dot = rode.rates(et + dt12, rprime_n12, step);
 
     // (61) q at n+1
     double wn12_l = glm::length(wn12);
@@ -58,16 +78,15 @@ PCDM::Result PCDM::doStep(const RotODE& rode, const RotState& rs, const Ephemeri
         tmp = (wn12 / wn12_l) * std::sin(F);
     else
         F = 0.0;
-    Quat qn1     = Quat(std::cos(F), tmp.x, tmp.y, tmp.z) * qn;
-    Quat qn1_inv = glm::inverse(qn1);
+    Quat qn1 = Quat(std::cos(F), tmp.x, tmp.y, tmp.z) * qn;
 
     // (62) Angular velocities at n+1
     Vec3 wn12dot  = rsn12_dot.w;
-    Vec3 wbn12dot = transform(qn1_inv, wn12dot, qn1);
+    Vec3 wbn12dot = rotateInverse(qn1, wn12dot);
     Vec3 wbn1     = wbn + wbn12dot * DT;
 
     // (63) Transform to global frame
-    Vec3 wn1 = transform(qn1, wbn1, qn1_inv);
+    Vec3 wn1 = rotate(qn1, wbn1);
 
     Result res;
     res.rs.q = qn1;
@@ -95,4 +114,78 @@ std::vector<PCDM::Result> PCDM::doSteps(
     return res;
 }
 
+PCDM::AdaptiveResult PCDM::doAdaptiveStep(const RotODE& rode, const RotState& rs, const EphemerisTime& et, const TimeDelta& dt)
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    double h = dt.value;
+
+    Result full  = doStep(rode, rs, et, dt);
+    Result half  = doStep(rode, rs, et, TimeDelta(0.5 * h));
+    Result twice = doStep(rode, half.rs, half.et, TimeDelta(0.5 * h));
+
+    // Angle of the rotation between the two attitudes, 2 asin |vec(q1^-1 q2)|
+    Quat   dq    = glm::conjugate(full.rs.q) * twice.rs.q;
+    double angle = 2.0 * std::asin(std::min(1.0, glm::length(Vec3(dq.x, dq.y, dq.z))));
+    double dw    = glm::length(twice.rs.w - full.rs.w);
+
+    // The attitude has a 3rd order local error, but the angular velocity,
+    // updated with the derivative at the midpoint attitude, only a 2nd order
+    // one. The difference is used as is, as the error of the half steps is
+    // about the same size for a 1st order method
+    double te_max     = std::max(angle, dw);
+    double te_allowed = std::max(glm::length(rs.w), 1.0) * tol;
+
+    // 1/2 exponent for the 2nd order local error
+    double delta  = std::pow(te_allowed / (te_max + eps), 1.0 / 2.0);
+    double h_next = std::min(0.9 * delta * h, 4.0 * h);
+    if (std::abs(h_next) < 16.0 * eps)
+    {
+        std::ostringstream ss;
+        ss << "PCDM: next step fell below minimum at t=" << et.getETValue();
+        throw AstroException(ss.str());
+    }
+
+    if (te_max > te_allowed)
+        return { rs, et, TimeDelta(h_next), 0 };
+
+    return { twice.rs, et + dt, TimeDelta(h_next), 0 };
+}
+
+std::vector<PCDM::AdaptiveResult> PCDM::doAdaptiveSteps(
+    const RotODE& rode, const RotState& rs,
+    const EphemerisTime& et0, const EphemerisTime& et1,
+    const TimeDelta& dt)
+{
+    std::vector<AdaptiveResult> res;
+    res.push_back({ rs, et0, dt, 0 });
+
+    double h     = dt.value;
+    int    tries = 0;
+    while (res.back().et < et1)
+    {
+        const AdaptiveResult& last = res.back();
+        double rest    = (et1 - last.et).value;
+        bool   landing = rest <= h;
+
+        AdaptiveResult r = doAdaptiveStep(rode, last.rs, last.et, TimeDelta(landing ? rest : h));
+        ++tries;
+        if (r.et == last.et)
+        {
+            h = r.dt_next.value; // Rejected
+            continue;
+        }
+
+        if (landing)
+            r.et = et1;
+        else
+            h = r.dt_next.value;
+        r.dt_next  = TimeDelta(h);
+        r.numTries = tries;
+        tries      = 0;
+        res.push_back(r);
+    }
+
+    return res;
+}
+
 } // namespace astro
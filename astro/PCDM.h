@@ -21,11 +21,35 @@ public:
         EphemerisTime et;
     };
 
+    struct AdaptiveResult
+    {
+        RotState      rs;
+        EphemerisTime et;
+        TimeDelta     dt_next;
+        int           numTries;
+    };
 
     static Result doStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt);            
 
     static std::vector<Result> doSteps(const RotODE& rode, const RotState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt);            
 
+    // Error controlled step by step doubling: one step of dt is compared with
+    // two of dt/2, and the two half steps are kept. Both are products of unit
+    // quaternions, so the result stays on the unit sphere. The error is the
+    // rotation angle between the two attitudes and the difference in angular
+    // velocity, relative to max(|w|, 1). A rejected step returns the current
+    // state with a reduced dt_next, as RKF78
+    static AdaptiveResult doAdaptiveStep(const RotODE& rode, const RotState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<AdaptiveResult> doAdaptiveSteps(const RotODE& rode, const RotState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt);
+
+    // Allowed local error of the adaptive steps. Default is 1e-8
+    static void setTolerance(double tol);
+
+    static double getTolerance();
+
+private:
+    static double tol;
 
 };
 
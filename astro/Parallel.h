@@ -0,0 +1,84 @@
+#ifndef _ASTRO_PARALLEL_H_
+#define _ASTRO_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace astro {
+
+// Returns the number of worker threads to use for a request of 'threads'.
+// 0 means one thread per hardware core.
+inline unsigned int workerThreads(unsigned int threads)
+{
+    if (threads > 0)
+        return threads;
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+// Calls f(i) for every i in [0, n), spread over a number of worker threads.
+// Indices are handed out in chunks of 'chunk' from a shared counter, so the
+// assignment of indices to threads is not deterministic: f must not depend
+// on which thread runs it, and must be safe to call concurrently for
+// different indices.
+// threads = 0 uses all hardware cores. The first exception thrown by f is
+// rethrown in the calling thread once all workers have finished.
+template<typename Func>
+void parallelFor(size_t n, Func f, unsigned int threads = 0, size_t chunk = 1)
+{
+    if (n == 0)
+        return;
+    if (chunk == 0)
+        chunk = 1;
+
+    size_t nthreads = std::min<size_t>(workerThreads(threads), (n + chunk - 1) / chunk);
+    if (nthreads <= 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+            f(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try
+        {
+            size_t begin;
+            while ((begin = next.fetch_add(chunk)) < n)
+            {
+                size_t end = std::min(begin + chunk, n);
+                for (size_t i = begin; i < end; ++i)
+                    f(i);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            next = n; // Stop handing out work
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(nthreads - 1);
+    for (size_t t = 1; t < nthreads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace astro
+
+#endif
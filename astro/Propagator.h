@@ -7,6 +7,11 @@
 #include "RKF45.h"
 #include "RKF78.h"
 #include "RK1_4.h"
+#include "Symplectic.h"
+#include "GaussJackson.h"
+#include "RadauIIA.h"
+#include "Encke.h"
+#include "KS.h"
 namespace astro {
 
 struct SimpleResult
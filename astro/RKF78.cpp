@@ -84,18 +84,6 @@ const double RKF78::ch8[13] = {
     41.0/840.0
 };
 
-// ── helpers ──────────────────────────────────────────────────────────────────
-
-static PosState stageState(const PosState& s, double h,
-                           const std::vector<double>& brow,
-                           const std::vector<PosState>& k)
-{
-    PosState result = s;
-    for (size_t j = 0; j < brow.size(); ++j)
-        result += k[j] * (h * brow[j]);
-    return result;
-}
-
 // ── interface ────────────────────────────────────────────────────────────────
 
 void RKF78::setTolerance(double _tol)
@@ -105,74 +93,54 @@ void RKF78::setTolerance(double _tol)
     tol = _tol;
 }
 
+double RKF78::getTolerance()
+{
+    return tol;
+}
+
 RKF78::Result RKF78::doStep(const ODE& ode, const PosState& s,
                              const EphemerisTime& et, const TimeDelta& dt)
 {
-    const double h  = dt.value;
-    const double ti = et.getETValue();
-
-    // Evaluate 13 stage derivatives
-    std::vector<PosState> k(13);
-    for (int i = 0; i < 13; ++i)
-    {
-        PosState si = stageState(s, h, b[i], k);
-        k[i] = ode.rates(EphemerisTime(ti + c[i] * h), si);
-    }
-
-    // Error estimate: h * (ch7 - ch8) = h * 41/840 * (k[0]+k[10] - k[11]-k[12])
-    PosState te;
-    te.r = Vec3(0.0);
-    te.v = Vec3(0.0);
-    for (int i = 0; i < 13; ++i)
-    {
-        double diff = ch7[i] - ch8[i];
-        te += k[i] * (h * diff);
-    }
-    const double te_max =
-        std::max({ std::abs(te.r.x), std::abs(te.r.y), std::abs(te.r.z),
-                   std::abs(te.v.x), std::abs(te.v.y), std::abs(te.v.z) });
-
-    const double y_max =
-        std::max({ std::abs(s.r.x), std::abs(s.r.y), std::abs(s.r.z),
-                   std::abs(s.v.x), std::abs(s.v.y), std::abs(s.v.z) });
-    const double te_allowed = std::max(y_max, 1.0) * tol;
+    return doStep(ode, s, et, dt, 1.0, tol);
+}
 
-    // Adaptive step size (1/8 exponent for 7th-order error)
-    const double delta  = std::pow(te_allowed / (te_max + eps), 1.0 / 8.0);
-    const double h_next = std::min(0.9 * delta * h, 4.0 * h);
+RKF78::Result RKF78::doStep(const ODE& ode, const PosState& s,
+                             const EphemerisTime& et, const TimeDelta& dt, double yScale, double tolerance)
+{
+    ForceStep prepared;
+    return doStep(ode, s, et, dt, yScale, tolerance, prepared);
+}
 
-    if (h_next < 16.0 * eps)
-    {
-        std::ostringstream ss;
-        ss << "RKF78: next step fell below minimum at t=" << ti;
-        throw AstroException(ss.str());
-    }
+RKF78::Result RKF78::doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt,
+                            double yScale, double tolerance, ForceStep& prepared)
+{
+    // Slowly varying inputs of the force terms are looked up once per step
+    ode.prepare(et, et + dt, prepared);
+    auto f = [&ode, &prepared](double t, const PosState& y) { return ode.rates(EphemerisTime(t), y, prepared); };
 
-    if (te_max > te_allowed)
+    PosState s_next;
+    double   h_next;
+    if (!step(f, s, et.getETValue(), dt.value, yScale, s_next, h_next, tolerance))
     {
         // Step is rejected — return current state with reduced step
         return { s, et, TimeDelta(h_next), 0 };
     }
 
-    // 8th-order solution
-    PosState s_next = s;
-    for (int i = 0; i < 13; ++i)
-        s_next += k[i] * (h * ch8[i]);
-
     return { s_next, et + dt, TimeDelta(h_next), 0 };
 }
 
 std::vector<RKF78::Result> RKF78::doSteps(
     const ODE& ode, const PosState& s,
     const EphemerisTime& et0, const EphemerisTime& et1,
-    const TimeDelta& dt)
+    const TimeDelta& dt, double tolerance)
 {
     std::vector<Result> res;
     res.push_back({ s, et0, dt, 0 });
 
+    ForceStep prepared;
     while (res.back().et < et1)
     {
-        res.push_back(doStep(ode, res.back().s, res.back().et, res.back().dt_next));
+        res.push_back(doStep(ode, res.back().s, res.back().et, res.back().dt_next, 1.0, tolerance, prepared));
         if (res.back().et + res.back().dt_next > et1)
             res.back().dt_next = et1 - res.back().et;
     }
@@ -180,4 +148,44 @@ std::vector<RKF78::Result> RKF78::doSteps(
     return res;
 }
 
+std::vector<PosState> RKF78::propagateTo(const ODE& ode, const PosState& s, const EphemerisTime& et0,
+                                         const std::vector<EphemerisTime>& epochs, const TimeDelta& dt,
+                                         double tolerance)
+{
+    std::vector<PosState> out;
+    out.reserve(epochs.size());
+
+    PosState      x  = s;
+    EphemerisTime et = et0;
+    double        h  = dt.value;
+    ForceStep     prepared;
+    for (const EphemerisTime& target : epochs)
+    {
+        if (target < et)
+            throw AstroException("RKF78: epochs must be in ascending order, at or after the initial epoch");
+
+        while (et < target)
+        {
+            double rest    = (target - et).value;
+            bool   landing = rest <= h;
+            Result r = doStep(ode, x, et, TimeDelta(landing ? rest : h), 1.0, tolerance, prepared);
+            if (r.et == et)
+            {
+                h = r.dt_next.value; // Rejected
+                continue;
+            }
+            x = r.s;
+            if (landing)
+                et = target;         // Shortened to land on the epoch
+            else
+            {
+                et = r.et;
+                h  = r.dt_next.value;
+            }
+        }
+        out.push_back(x);
+    }
+    return out;
+}
+
 } // namespace astro
@@ -1,10 +1,14 @@
 #ifndef _ASTRO_RKF78_H_
 #define _ASTRO_RKF78_H_
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 #include <vector>
 #include "Time.h"
 #include "State.h"
 #include "ODE.h"
+#include "Exceptions.h"
 
 namespace astro {
 
@@ -23,17 +27,50 @@ public:
         int          numTries;
     };
 
+    // The tolerance arguments below default to the global tolerance. Library
+    // code that needs another tolerance passes it here rather than changing
+    // the global one, which other threads may be integrating with
     static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
 
+    // As above, with the allowed error relative to max(|y|, yScale) instead
+    // of max(|y|, 1). Used when integrating small deviations from a larger
+    // state, e.g. by Encke's method
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt, double yScale,
+                         double tolerance = getTolerance());
+
     static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
                                        const EphemerisTime& et0, const EphemerisTime& et1,
-                                       const TimeDelta& dt);
+                                       const TimeDelta& dt, double tolerance = getTolerance());
+
+    // Propagates s from et0 and returns the states at the epochs (ascending,
+    // at or after et0). Steps are shortened to land exactly on each epoch,
+    // and only those states are kept
+    static std::vector<PosState> propagateTo(const ODE& ode, const PosState& s, const EphemerisTime& et0,
+                                             const std::vector<EphemerisTime>& epochs, const TimeDelta& dt,
+                                             double tolerance = getTolerance());
 
+    // One step for other state types, e.g. regularized variables. StateType
+    // needs += and * (double), and a maxNorm() overload. f(t, y) returns the
+    // derivatives. Returns false if the step is rejected; h_next is set in
+    // both cases
+    template<typename StateType, typename Rates>
+    static bool step(const Rates& f, const StateType& s, double t, double h, double yScale,
+                     StateType& s_next, double& h_next, double tolerance = getTolerance());
+
+    // Sets the global tolerance. Not meant to be called while integrations
+    // are running on other threads
     static void setTolerance(double tol);
 
+    static double getTolerance();
+
 private:
     static double tol;
 
+    // As doStep() above, preparing the force terms in step, whose storage is
+    // kept across the steps of doSteps() and propagateTo()
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt, double yScale,
+                         double tolerance, ForceStep& prepared);
+
     // Butcher tableau — nodes, coupling matrix, 7th and 8th order weights
     static const double              c[13];
     static const std::vector<double> b[13]; // b[i] has i entries (lower triangle)
@@ -43,6 +80,51 @@ private:
     static const double eps;
 };
 
+template<typename StateType, typename Rates>
+bool RKF78::step(const Rates& f, const StateType& s, double t, double h, double yScale,
+                 StateType& s_next, double& h_next, double tolerance)
+{
+    // Evaluate 13 stage derivatives
+    std::vector<StateType> k;
+    k.reserve(13);
+    for (int i = 0; i < 13; ++i)
+    {
+        StateType si = s;
+        for (size_t j = 0; j < b[i].size(); ++j)
+            si += k[j] * (h * b[i][j]);
+        k.push_back(f(t + c[i] * h, si));
+    }
+
+    // Error estimate: h * (ch7 - ch8) = h * 41/840 * (k[0]+k[10] - k[11]-k[12])
+    StateType te = k[0] * (h * (ch7[0] - ch8[0]));
+    for (int i = 1; i < 13; ++i)
+        te += k[i] * (h * (ch7[i] - ch8[i]));
+    const double te_max = maxNorm(te);
+
+    const double te_allowed = std::max(maxNorm(s), yScale) * tolerance;
+
+    // Adaptive step size (1/8 exponent for 7th-order error)
+    const double delta = std::pow(te_allowed / (te_max + eps), 1.0 / 8.0);
+    h_next = std::min(0.9 * delta * h, 4.0 * h);
+
+    if (h_next < 16.0 * eps)
+    {
+        std::ostringstream ss;
+        ss << "RKF78: next step fell below minimum at t=" << t;
+        throw AstroException(ss.str());
+    }
+
+    if (te_max > te_allowed)
+        return false;
+
+    // 8th-order solution
+    s_next = s;
+    for (int i = 0; i < 13; ++i)
+        s_next += k[i] * (h * ch8[i]);
+
+    return true;
+}
+
 } // namespace astro
 
 #endif
@@ -0,0 +1,334 @@
+#include "RadauIIA.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace astro {
+
+double RadauIIA::tol = 1.0E-8;
+
+// ── Radau IIA (s = 3) coefficients ───────────────────────────────────────────
+
+static const double SQ6 = std::sqrt(6.0);
+
+static const double C[3] = { (4.0 - SQ6) / 10.0, (4.0 + SQ6) / 10.0, 1.0 };
+
+static const double A[3][3] = {
+    { (88.0 - 7.0 * SQ6) / 360.0,     (296.0 - 169.0 * SQ6) / 1800.0, (-2.0 + 3.0 * SQ6) / 225.0 },
+    { (296.0 + 169.0 * SQ6) / 1800.0, (88.0 + 7.0 * SQ6) / 360.0,     (-2.0 - 3.0 * SQ6) / 225.0 },
+    { (16.0 - SQ6) / 36.0,            (16.0 + SQ6) / 36.0,            1.0 / 9.0 }
+};
+
+// Real eigenvalue of A^-1, and the error estimate weights of RADAU5
+static const double U1 = 1.0 / ((6.0 + std::cbrt(81.0) - std::cbrt(9.0)) / 30.0);
+static const double DD[3] = { -(13.0 + 7.0 * SQ6) / 3.0, (-13.0 + 7.0 * SQ6) / 3.0, -1.0 / 3.0 };
+
+static const int    MAX_NEWTON = 7;
+static const double EPS        = std::numeric_limits<double>::epsilon();
+
+// ── dense linear algebra ─────────────────────────────────────────────────────
+
+// In-place LU decomposition with partial pivoting
+template<int N>
+static void luDecompose(double (&m)[N][N], int (&piv)[N])
+{
+    for (int k = 0; k < N; ++k)
+    {
+        int p = k;
+        for (int i = k + 1; i < N; ++i)
+            if (std::abs(m[i][k]) > std::abs(m[p][k]))
+                p = i;
+        if (m[p][k] == 0.0)
+            throw AstroException("RadauIIA: singular Newton matrix");
+        piv[k] = p;
+        if (p != k)
+            for (int j = 0; j < N; ++j)
+                std::swap(m[k][j], m[p][j]);
+
+        for (int i = k + 1; i < N; ++i)
+        {
+            m[i][k] /= m[k][k];
+            for (int j = k + 1; j < N; ++j)
+                m[i][j] -= m[i][k] * m[k][j];
+        }
+    }
+}
+
+// Solves LU x = b in place
+template<int N>
+static void luSolve(const double (&m)[N][N], const int (&piv)[N], double (&b)[N])
+{
+    for (int k = 0; k < N; ++k)
+        std::swap(b[k], b[piv[k]]);
+    for (int i = 1; i < N; ++i)
+        for (int j = 0; j < i; ++j)
+            b[i] -= m[i][j] * b[j];
+    for (int i = N - 1; i >= 0; --i)
+    {
+        for (int j = i + 1; j < N; ++j)
+            b[i] -= m[i][j] * b[j];
+        b[i] /= m[i][i];
+    }
+}
+
+static void pack(const PosState& s, double* y)
+{
+    y[0] = s.r.x; y[1] = s.r.y; y[2] = s.r.z;
+    y[3] = s.v.x; y[4] = s.v.y; y[5] = s.v.z;
+}
+
+static PosState unpack(const double* y)
+{
+    return PosState(Vec3(y[0], y[1], y[2]), Vec3(y[3], y[4], y[5]));
+}
+
+// ── workspace ────────────────────────────────────────────────────────────────
+
+struct RadauIIA::Workspace
+{
+    double J[6][6];      // Jacobian of the ODE
+    bool   jacValid  = false;
+    bool   jacFresh  = false; // Computed at the current step's initial state
+
+    double M[18][18];    // LU of I - h A (x) J
+    int    pivM[18];
+    double E[6][6];      // LU of I - h / U1 J
+    int    pivE[6];
+    double hLU      = 0.0;
+    bool   luValid  = false;
+
+    double eta      = 1.0; // Newton convergence rate from the last step
+};
+
+static void jacobian(const ODE& ode, const EphemerisTime& et, const double* y0, const PosState& f0, double (&J)[6][6])
+{
+    for (int i = 0; i < 6; ++i)
+        for (int k = 0; k < 6; ++k)
+            J[i][k] = 0.0;
+
+    // dr/dt = v
+    for (int i = 0; i < 3; ++i)
+        J[i][3 + i] = 1.0;
+
+    // da/dr and da/dv by forward differences
+    for (int k = 0; k < 6; ++k)
+    {
+        double y[6];
+        std::copy(y0, y0 + 6, y);
+        double delta = std::sqrt(EPS) * std::max(std::abs(y0[k]), 1.0E-5);
+        y[k] += delta;
+        PosState f = ode.rates(et, unpack(y));
+        Vec3 da = (f.v - f0.v) / delta;
+        J[3][k] = da.x;
+        J[4][k] = da.y;
+        J[5][k] = da.z;
+    }
+}
+
+// ── interface ────────────────────────────────────────────────────────────────
+
+void RadauIIA::setTolerance(double _tol)
+{
+    if (_tol <= 0.0)
+        throw AstroException("Zero or negative tolerance not allowed for RK methods");
+    tol = _tol;
+}
+
+double RadauIIA::getTolerance()
+{
+    return tol;
+}
+
+RadauIIA::Result RadauIIA::attemptStep(const ODE& ode, const PosState& s, const EphemerisTime& et, double h, Workspace& ws)
+{
+    const double ti = et.getETValue();
+    double y0[6];
+    pack(s, y0);
+    PosState f0 = ode.rates(et, s);
+
+    const double y_max = *std::max_element(y0, y0 + 6, [](double a, double b) { return std::abs(a) < std::abs(b); });
+    const double scale = std::max(std::abs(y_max), 1.0) * tol;
+
+    if (!ws.jacValid)
+    {
+        jacobian(ode, et, y0, f0, ws.J);
+        ws.jacValid = ws.jacFresh = true;
+        ws.luValid  = false;
+    }
+
+    if (!ws.luValid || ws.hLU != h)
+    {
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < 3; ++b)
+                for (int i = 0; i < 6; ++i)
+                    for (int k = 0; k < 6; ++k)
+                        ws.M[6 * a + i][6 * b + k] = ((a == b && i == k) ? 1.0 : 0.0) - h * A[a][b] * ws.J[i][k];
+        luDecompose(ws.M, ws.pivM);
+
+        for (int i = 0; i < 6; ++i)
+            for (int k = 0; k < 6; ++k)
+                ws.E[i][k] = ((i == k) ? 1.0 : 0.0) - h / U1 * ws.J[i][k];
+        luDecompose(ws.E, ws.pivE);
+
+        ws.hLU     = h;
+        ws.luValid = true;
+    }
+
+    // Simplified Newton iterations for the stage increments Z
+    const double fnewt = std::max(10.0 * EPS / tol, std::min(0.03, std::sqrt(tol)));
+    double Z[18] = {};
+    double F[3][6];
+    double eta = std::pow(std::max(ws.eta, EPS), 0.8);
+    double normPrev = 0.0;
+    double theta = 0.0;
+    int    iter = 0;
+    bool   converged = false;
+    while (iter < MAX_NEWTON)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            double y[6];
+            for (int i = 0; i < 6; ++i)
+                y[i] = y0[i] + Z[6 * a + i];
+            pack(ode.rates(EphemerisTime(ti + C[a] * h), unpack(y)), F[a]);
+        }
+
+        double dZ[18];
+        for (int a = 0; a < 3; ++a)
+            for (int i = 0; i < 6; ++i)
+            {
+                double hAF = 0.0;
+                for (int b = 0; b < 3; ++b)
+                    hAF += h * A[a][b] * F[b][i];
+                dZ[6 * a + i] = hAF - Z[6 * a + i];
+            }
+        luSolve(ws.M, ws.pivM, dZ);
+
+        double norm = 0.0;
+        for (int i = 0; i < 18; ++i)
+        {
+            Z[i] += dZ[i];
+            norm = std::max(norm, std::abs(dZ[i]) / scale);
+        }
+        ++iter;
+
+        if (iter > 1)
+        {
+            theta = norm / normPrev;
+            if (theta >= 0.99)
+                break; // Diverging
+            eta = theta / (1.0 - theta);
+        }
+        normPrev = norm;
+
+        if (eta * norm <= fnewt || norm == 0.0)
+        {
+            converged = true;
+            break;
+        }
+    }
+
+    if (!converged)
+    {
+        // Newton failed: try again with a smaller step and a new Jacobian
+        ws.jacValid = ws.jacFresh;
+        ws.luValid  = false;
+        double h_next = 0.5 * h;
+        if (std::abs(h_next) < 16.0 * EPS)
+        {
+            std::ostringstream ss;
+            ss << "RadauIIA: next step fell below minimum at t=" << ti;
+            throw AstroException(ss.str());
+        }
+        return { s, et, TimeDelta(h_next), 0 };
+    }
+    ws.eta = eta;
+
+    // Stiffly accurate: the last stage is the solution
+    double y1[6];
+    for (int i = 0; i < 6; ++i)
+        y1[i] = y0[i] + Z[12 + i];
+
+    // Error estimate of RADAU5: (I - h/U1 J)^-1 (h/U1 f0 + sum DD/U1 z)
+    double err[6];
+    double f0v[6];
+    pack(f0, f0v);
+    for (int i = 0; i < 6; ++i)
+        err[i] = (h * f0v[i] + DD[0] * Z[i] + DD[1] * Z[6 + i] + DD[2] * Z[12 + i]) / U1;
+    luSolve(ws.E, ws.pivE, err);
+
+    double errNorm = 0.0;
+    for (int i = 0; i < 6; ++i)
+        errNorm = std::max(errNorm, std::abs(err[i]) / scale);
+
+    // New step size, reduced when Newton needed many iterations
+    double fac  = std::min(0.9, 0.9 * (2.0 * MAX_NEWTON + 1.0) / (2.0 * MAX_NEWTON + iter));
+    double quot = std::max(1.0 / 8.0, std::min(5.0, std::pow(errNorm + EPS, 0.25) / fac));
+    double h_next = h / quot;
+
+    if (std::abs(h_next) < 16.0 * EPS)
+    {
+        std::ostringstream ss;
+        ss << "RadauIIA: next step fell below minimum at t=" << ti;
+        throw AstroException(ss.str());
+    }
+
+    if (errNorm > 1.0)
+    {
+        // Rejected. A stale Jacobian may be the cause
+        if (!ws.jacFresh)
+            ws.jacValid = false;
+        return { s, et, TimeDelta(std::min(h_next, 0.5 * h)), 0 };
+    }
+
+    // Accepted. Keep the Jacobian if Newton converged fast, and the
+    // factorization if the step size would only change a little
+    ws.jacFresh = false;
+    if (theta > 1.0E-3)
+        ws.jacValid = false;
+    if (ws.jacValid && h_next / h >= 1.0 && h_next / h <= 1.2)
+        h_next = h;
+
+    return { unpack(y1), et + TimeDelta(h), TimeDelta(h_next), 0 };
+}
+
+RadauIIA::Result RadauIIA::doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    Workspace ws;
+    Result res = attemptStep(ode, s, et, dt.value, ws);
+    res.numTries = 1;
+    return res;
+}
+
+std::vector<RadauIIA::Result> RadauIIA::doSteps(const ODE& ode, const PosState& s,
+                                                const EphemerisTime& et0, const EphemerisTime& et1,
+                                                const TimeDelta& dt)
+{
+    Workspace ws;
+    std::vector<Result> res;
+    res.push_back({ s, et0, dt, 0 });
+
+    while (res.back().et < et1)
+    {
+        const Result& last = res.back();
+        double h = std::min(last.dt_next.value, (et1 - last.et).value);
+
+        // Retry until the step is accepted
+        Result next = attemptStep(ode, last.s, last.et, h, ws);
+        int tries = 1;
+        while (next.et == last.et)
+        {
+            next = attemptStep(ode, last.s, last.et, next.dt_next.value, ws);
+            ++tries;
+        }
+        next.numTries = tries;
+        res.push_back(next);
+    }
+
+    return res;
+}
+
+} // namespace astro
@@ -0,0 +1,55 @@
+#ifndef _ASTRO_RADAU_IIA_H_
+#define _ASTRO_RADAU_IIA_H_
+
+#include <vector>
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Implicit 3-stage Radau IIA integrator of order 5 with adaptive step size,
+// for stiff problems such as low perigee drag decay. Follows RADAU5 from
+// E. Hairer and G. Wanner, "Solving Ordinary Differential Equations II" (1996):
+// the stage equations are solved by simplified Newton iterations with a
+// finite difference Jacobian of the ODE, and the local error is estimated as
+// in RADAU5.
+//
+// Within doSteps the Jacobian and the LU factorization of the Newton matrix
+// are kept between steps, and only recomputed when the Newton iterations
+// converge slowly, a step is rejected, or the step size changes noticeably.
+class RadauIIA
+{
+public:
+    struct Result
+    {
+        PosState     s;
+        EphemerisTime et;
+        TimeDelta    dt_next;
+        int          numTries;
+    };
+
+    static Result doStep(const ODE& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
+                                       const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+
+    // Relative tolerance, as for RKF78. Default is 1.0E-8
+    static void setTolerance(double tol);
+
+    static double getTolerance();
+
+private:
+    static double tol;
+
+    struct Workspace;
+
+    // Attempts one step, solving the stage equations with the factorization in
+    // ws. Updates ws and returns a result with et unchanged if rejected
+    static Result attemptStep(const ODE& ode, const PosState& s, const EphemerisTime& et, double h, Workspace& ws);
+};
+
+} // namespace astro
+
+#endif
@@ -0,0 +1,235 @@
+#include "RadiationPressure.h"
+#include "Ephemeris.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  O. Montenbruck and E. Gill, Satellite Orbits (2000), ch. 3.4
+
+namespace astro {
+
+static const double SOLAR_PRESSURE = 4.56E-6;      // At 1 AU [N/m^2]
+static const double AU             = 149597870.7;  // [km]
+
+// ── ShadowCone ───────────────────────────────────────────────────────────────
+
+ShadowCone::ShadowCone(const Vec3& d, const Vec3& s, double radius)
+{
+    a = std::asin(std::min(SUN_RADIUS / glm::length(d), 1.0));
+    b = std::asin(std::min(radius / glm::length(s), 1.0));
+    c = std::atan2(glm::length(glm::cross(s, d)), glm::dot(s, d));
+}
+
+// ── SolarRadiationPressure ───────────────────────────────────────────────────
+
+SolarRadiationPressure::SolarRadiationPressure(std::shared_ptr<const EphemerisCache> _ephemeris, double _cr,
+                                               double area_m2, int _centralBody, double _centralRadius)
+    : ephemeris(_ephemeris), centralBody(_centralBody), centralRadius(_centralRadius),
+      cannonball(true), cr(_cr), area(area_m2)
+{
+    if (!ephemeris)
+        throw AstroException("Solar radiation pressure needs an ephemeris cache for the Sun");
+    if (cr < 0.0 || area <= 0.0)
+        throw AstroException("Invalid cannonball radiation pressure coefficient or area");
+}
+
+SolarRadiationPressure::SolarRadiationPressure(std::shared_ptr<const EphemerisCache> _ephemeris,
+                                               const std::vector<SRPPlate>& _plates, AttitudeSource _attitude,
+                                               int _centralBody, double _centralRadius)
+    : ephemeris(_ephemeris), centralBody(_centralBody), centralRadius(_centralRadius),
+      cannonball(false), cr(0.0), area(0.0), plates(_plates), attitude(_attitude)
+{
+    if (!ephemeris)
+        throw AstroException("Solar radiation pressure needs an ephemeris cache for the Sun");
+    if (!attitude)
+        throw AstroException("Multi-plate radiation pressure needs an attitude");
+    for (const SRPPlate& p : plates)
+        if (p.area <= 0.0 || p.specular < 0.0 || p.diffuse < 0.0 || p.specular + p.diffuse > 1.0)
+            throw AstroException("Invalid plate area or reflection coefficients");
+}
+
+void SolarRadiationPressure::addOcculter(int body, double radius)
+{
+    if (radius <= 0.0)
+        throw AstroException("Zero or negative radius of occulting body");
+    occulters.push_back({ body, radius });
+}
+
+double SolarRadiationPressure::shadow(const Vec3& r, const Vec3& sun, const Vec3& body, double radius)
+{
+    Vec3 d = sun - r;
+    return shadow(d, glm::length(d), body - r, radius);
+}
+
+double SolarRadiationPressure::shadow(const Vec3& d, double ld, const Vec3& s, double radius)
+{
+    // The body is not towards the Sun
+    double sd = glm::dot(s, d);
+    if (sd <= 0.0)
+        return 1.0;
+
+    double ls2 = glm::dot(s, s);
+    if (ls2 <= radius * radius)
+        return 0.0;
+
+    // With the apparent radii a, b and the separation c, the disks do not
+    // overlap if c >= a + b, which holds if sin(c) > sin(a) + sin(b). Scaled
+    // by |s| |d| this needs no trigonometry, and rejects nearly all of the
+    // orbit outside the shadow
+    double ls  = std::sqrt(ls2);
+    double lsd = ls * ld;
+    Vec3   sxd = glm::cross(s, d);
+    double k   = SUN_RADIUS * ls + radius * ld;
+    if (glm::dot(sxd, sxd) > k * k)
+        return 1.0;
+
+    // Sines and cosines of the ShadowCone radii a and b, and the cosine of c,
+    // decide the cases without an overlap or with a total one
+    double sa   = std::min(SUN_RADIUS / ld, 1.0);
+    double sb   = radius / ls;
+    double ca   = std::sqrt(1.0 - sa * sa);
+    double cb   = std::sqrt(1.0 - sb * sb);
+    double cosc = std::min(sd / lsd, 1.0);
+    if (cosc <= ca * cb - sa * sb)
+        return 1.0;      // No occultation, c >= a + b
+    if (sb >= sa && cosc >= cb * ca + sb * sa)
+        return 0.0;      // Total, c <= b - a
+
+    // Annular or partial
+    ShadowCone cone(d, s, radius);
+    double     a = cone.a;
+    double     b = cone.b;
+    double     c = cone.c;
+
+    if (c <= a - b)
+        return 1.0 - (b * b) / (a * a); // Annular
+
+    // Partial
+    double x    = (c * c + a * a - b * b) / (2.0 * c);
+    double y    = std::sqrt(std::max(a * a - x * x, 0.0));
+    double area = a * a * std::acos(x / a) + b * b * std::acos((c - x) / b) - c * y;
+    return 1.0 - area / (PI * a * a);
+}
+
+double SolarRadiationPressure::illumination(const Vec3& r, const EphemerisTime& et, Vec3& sunRel) const
+{
+    Vec3 sun, center;
+    ephemeris->getPosition(10, et, sun);
+    ephemeris->getPosition(centralBody, et, center);
+    sunRel = sun - center;
+
+    double nu = shadow(r, sunRel, Vec3(0.0), centralRadius);
+    for (const Occulter& o : occulters)
+    {
+        if (nu == 0.0)
+            break;
+        Vec3 body;
+        ephemeris->getPosition(o.body, et, body);
+        nu = std::min(nu, shadow(r, sunRel, body - center, o.radius));
+    }
+    return nu;
+}
+
+void SolarRadiationPressure::prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const
+{
+    // Reused from the previous step when it ended at et0 (accepted), or
+    // started there (rejected)
+    bool filled = states.s0.size() == occulters.size() + 1;
+    if (filled && states.et1 == et0)
+        std::swap(states.s0, states.s1);
+    else if (!filled || !(states.et0 == et0))
+        bodyStates(et0, states.s0);
+    bodyStates(et1, states.s1);
+    states.et0 = et0;
+    states.et1 = et1;
+}
+
+void SolarRadiationPressure::bodyStates(const EphemerisTime& et, std::vector<PosState>& out) const
+{
+    out.resize(occulters.size() + 1);
+
+    PosState center;
+    ephemeris->getState(centralBody, et, center);
+    ephemeris->getState(10, et, out[0]);
+    for (size_t i = 0; i < occulters.size(); ++i)
+        ephemeris->getState(occulters[i].body, et, out[i + 1]);
+    for (PosState& b : out)
+    {
+        b.r -= center.r;
+        b.v -= center.v;
+    }
+}
+
+Vec3 SolarRadiationPressure::acceleration(const Vec3& r, const EphemerisTime& et, const BodyStates& states,
+                                          double mass) const
+{
+    BodyStates::Weights w = states.weights(et);
+
+    Vec3   d  = states.position(0, w) - r;
+    double ld = glm::length(d);
+    double nu = shadow(d, ld, -r, centralRadius);
+    for (size_t i = 0; i < occulters.size() && nu > 0.0; ++i)
+        nu = std::min(nu, shadow(d, ld, states.position(i + 1, w) - r, occulters[i].radius));
+    return acceleration(et, d, ld, nu, mass);
+}
+
+Vec3 SolarRadiationPressure::acceleration(const Vec3& r, const EphemerisTime& et, double mass) const
+{
+    Vec3   sunRel;
+    double nu = illumination(r, et, sunRel);
+    return acceleration(r, et, sunRel, nu, mass);
+}
+
+double SolarRadiationPressure::pressure(const Vec3& r, const EphemerisTime& et, Vec3& toSun) const
+{
+    Vec3   sunRel;
+    double nu = illumination(r, et, sunRel);
+
+    Vec3   d  = sunRel - r;
+    double ld = glm::length(d);
+    toSun = d / ld;
+    return nu * SOLAR_PRESSURE * (AU / ld) * (AU / ld);
+}
+
+Vec3 SolarRadiationPressure::acceleration(const Vec3& r, const EphemerisTime& et, const Vec3& sun, double nu,
+                                          double mass) const
+{
+    Vec3 d = sun - r;
+    return acceleration(et, d, glm::length(d), nu, mass);
+}
+
+Vec3 SolarRadiationPressure::acceleration(const EphemerisTime& et, const Vec3& d, double ld, double nu,
+                                          double mass) const
+{
+    if (nu == 0.0)
+        return Vec3(0.0);
+
+    // Pressure [N/m^2], and the force [N] scaled to the acceleration
+    // [m/s^2] -> [km/s^2]
+    double ld2 = ld * ld;
+    double p  = nu * SOLAR_PRESSURE * AU * AU / (mass * 1000.0);
+
+    if (cannonball)
+        return d * (-p * cr * area / (ld2 * ld));
+
+    Vec3 e = d / ld; // To the Sun
+    p /= ld2;
+
+    Vec3 f(0.0);
+    Mat3 toJ2000 = rotationMatrix(attitude(et));
+    for (const SRPPlate& plate : plates)
+    {
+        Vec3   n        = toJ2000 * plate.normal;
+        double cosTheta = glm::dot(n, e);
+        if (cosTheta <= 0.0)
+            continue; // Facing away from the Sun
+        f -= (e * (1.0 - plate.specular) + n * (2.0 * (plate.specular * cosTheta + plate.diffuse / 3.0)))
+             * (p * plate.area * cosTheta);
+    }
+    return f;
+}
+
+} // namespace astro
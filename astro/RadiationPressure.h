@@ -0,0 +1,133 @@
+#ifndef _ASTRO_RADIATION_PRESSURE_H_
+#define _ASTRO_RADIATION_PRESSURE_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "Ephemeris.h"
+
+namespace astro {
+
+const double SUN_RADIUS = 696000.0; // [km]
+
+// Apparent radii of the Sun (a) and of an occulting body (b), and the
+// separation of their centers (c), seen from a point with the Sun at d and
+// the body at s relative to it [rad]. Conical shadow geometry of
+// O. Montenbruck and E. Gill, "Satellite Orbits" (2000), 3.4.2, shared by the
+// radiation pressure and the eclipse search
+struct ShadowCone
+{
+    ShadowCone(const Vec3& d, const Vec3& s, double radius);
+
+    double a;
+    double b;
+    double c;
+};
+
+// Flat surface of a multi-plate spacecraft model
+struct SRPPlate
+{
+    Vec3   normal;   // Outward unit normal in the body frame
+    double area;     // [m^2]
+    double specular; // Specular reflection coefficient
+    double diffuse;  // Diffuse reflection coefficient; the rest is absorbed
+};
+
+// Solar radiation pressure with a cannonball or a multi-plate spacecraft
+// model, and conical shadows of the central body and other occulting bodies,
+// following O. Montenbruck and E. Gill, "Satellite Orbits" (2000), ch. 3.4.
+//
+// Positions are relative to the central body in J2000. The Sun and the
+// occulting bodies are taken from an ephemeris cache, which must contain the
+// Sun (10), the central body and the occulting bodies, so each evaluation
+// costs a few interpolations instead of locked Spice calls.
+//
+// The spacecraft model is fixed at construction, so a model shared by forces,
+// torques and the copies of an ODE cannot change under a running propagation.
+class SolarRadiationPressure
+{
+public:
+    // Attitude quaternion at a time, rotating body to J2000, e.g. from an
+    // attitude propagation or a pointing law. Called concurrently when
+    // propagations run in parallel
+    typedef std::function<Quat(const EphemerisTime&)> AttitudeSource;
+
+    // Spherical spacecraft with the radiation pressure coefficient cr and the
+    // cross section area (m^2)
+    SolarRadiationPressure(std::shared_ptr<const EphemerisCache> ephemeris, double cr, double area_m2,
+                           int centralBody = 399, double centralRadius = 6378.137);
+
+    // Multi-plate spacecraft. The normals are rotated to J2000 with the
+    // attitude at the time of each evaluation
+    SolarRadiationPressure(std::shared_ptr<const EphemerisCache> ephemeris, const std::vector<SRPPlate>& plates,
+                           AttitudeSource attitude, int centralBody = 399, double centralRadius = 6378.137);
+
+    // Adds a body that casts shadows besides the central body, e.g. the Moon
+    // (301, 1737.4 km)
+    void addOcculter(int body, double radius);
+
+    // Acceleration (km/s^2) at the position r (km) relative to the central
+    // body, for a spacecraft of the given mass (kg)
+    Vec3 acceleration(const Vec3& r, const EphemerisTime& et, double mass) const;
+
+    // As above, with the Sun position relative to the central body and the
+    // fraction of the solar disk that is visible (nu) given
+    Vec3 acceleration(const Vec3& r, const EphemerisTime& et, const Vec3& sun, double nu, double mass) const;
+
+    // Looks up the Sun (states[0]) and the occulting bodies (states[1..])
+    // relative to the central body at both ends of an integration step, so
+    // that the stages of the step need no ephemeris lookups. The states of
+    // the previous step in 'states' are reused where its ends match
+    void prepare(const EphemerisTime& et0, const EphemerisTime& et1, BodyStates& states) const;
+
+    // As acceleration(r, et, mass), with the bodies interpolated from states
+    // made by prepare()
+    Vec3 acceleration(const Vec3& r, const EphemerisTime& et, const BodyStates& states, double mass) const;
+
+    // Radiation pressure (N/m^2) at r, with the shadows, and the unit vector
+    // from r to the Sun. Used for the radiation pressure torque
+    double pressure(const Vec3& r, const EphemerisTime& et, Vec3& toSun) const;
+
+    // Fraction of the solar disk visible from r, with an occulting body of
+    // the given radius at 'body'. All positions in the same frame (km)
+    static double shadow(const Vec3& r, const Vec3& sun, const Vec3& body, double radius);
+
+private:
+    // Fraction of the solar disk visible from r, and the Sun position
+    // relative to the central body
+    double illumination(const Vec3& r, const EphemerisTime& et, Vec3& sun) const;
+
+    // As shadow(), with the vectors d to the Sun and s to the body from the
+    // spacecraft, and |d|, which are shared by all occulting bodies
+    static double shadow(const Vec3& d, double ld, const Vec3& s, double radius);
+
+    // Acceleration with d and |d| as above
+    Vec3 acceleration(const EphemerisTime& et, const Vec3& d, double ld, double nu, double mass) const;
+
+    // States of the Sun and the occulting bodies relative to the central
+    // body, in the order of prepare()
+    void bodyStates(const EphemerisTime& et, std::vector<PosState>& out) const;
+
+    struct Occulter
+    {
+        int    body;
+        double radius;
+    };
+
+    std::shared_ptr<const EphemerisCache> ephemeris;
+    int    centralBody;
+    double centralRadius;
+    std::vector<Occulter> occulters;
+
+    bool   cannonball;
+    double cr;
+    double area;
+    std::vector<SRPPlate> plates;
+    AttitudeSource        attitude;
+};
+
+} // namespace astro
+
+#endif
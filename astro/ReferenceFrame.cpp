@@ -1,7 +1,10 @@
 #include "ReferenceFrame.h"
 #include "SpiceCore.h"
+#include "FrameRotation.h"
+#include "Parallel.h"
 
 #include <cspice/SpiceUsr.h>
+#include <algorithm>
 #include <sstream>
 
 namespace astro {
@@ -17,9 +20,13 @@ Mat3 ReferenceFrame::getRotationToJ2000(const EphemerisTime& et) const
     if (type == ReferenceFrameType::Inertial || type == ReferenceFrameType::BodyFixedNonRotating)
         return Mat3(1.0);
 
+    if (rotationCache && rotationCache->covers(et))
+        return rotationCache->getRotationToJ2000(et);
+
     // Use Spice to get the body-fixed → inertial rotation.
     // tipbod_c returns tipm such that v_body = tipm * v_inertial.
-    // We want the inverse (inertial → body), so we return its inverse.
+    // We want the inverse (body → inertial). tipm is a rotation, so the
+    // inverse is its transpose.
     double tipm[3][3];
     {
         std::lock_guard<std::mutex> lock(Spice().mutex());
@@ -27,13 +34,108 @@ Mat3 ReferenceFrame::getRotationToJ2000(const EphemerisTime& et) const
     }
     Spice().checkError();
 
-    // SPICE tipm is row-major; construct GLM column-major matrix.
-    Mat3 tip;
+    // SPICE tipm is row-major, GLM is column-major: M[col][row] = tipm[row][col]
+    // is tipm itself, so copying straight across gives the transpose.
+    Mat3 M;
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row)
+            M[col][row] = tipm[col][row];
+
+    return M;
+}
+
+// Converts a Spice tisbod_c matrix (inertial -> body, row-major) to the
+// body -> inertial transformation
+static StateTransform fromTisbod(const double tsipm[6][6])
+{
+    // The inverse is the transpose of each block. As in getRotationToJ2000,
+    // copying the row-major Spice blocks straight into column-major GLM
+    // matrices performs the transpose.
+    StateTransform st;
     for (int col = 0; col < 3; ++col)
         for (int row = 0; row < 3; ++row)
-            tip[col][row] = tipm[row][col];
+        {
+            st.R[col][row]  = tsipm[col][row];
+            st.dR[col][row] = tsipm[col + 3][row];
+        }
+    return st;
+}
+
+StateTransform ReferenceFrame::getStateTransformToJ2000(const EphemerisTime& et) const
+{
+    if (type == ReferenceFrameType::Inertial || type == ReferenceFrameType::BodyFixedNonRotating)
+        return StateTransform();
+
+    if (rotationCache && rotationCache->covers(et))
+        return StateTransform(rotationCache->getRotationToJ2000(et),
+                              rotationCache->getRotationRateToJ2000(et));
+
+    double tsipm[6][6];
+    {
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        tisbod_c("J2000", centerId, et.getETValue(), tsipm);
+    }
+    Spice().checkError();
+
+    return fromTisbod(tsipm);
+}
+
+void ReferenceFrame::getStateTransformsToJ2000(const std::vector<EphemerisTime>& ets, std::vector<StateTransform>& out) const
+{
+    out.resize(ets.size());
+
+    if (type == ReferenceFrameType::Inertial || type == ReferenceFrameType::BodyFixedNonRotating)
+    {
+        std::fill(out.begin(), out.end(), StateTransform());
+        return;
+    }
 
-    return glm::inverse(tip);
+    bool cached = rotationCache != nullptr;
+    for (size_t i = 0; cached && i < ets.size(); ++i)
+        cached = rotationCache->covers(ets[i]);
+
+    if (cached)
+    {
+        // Lock-free: spread over all cores
+        parallelFor(ets.size(), [&](size_t i) {
+            out[i] = StateTransform(rotationCache->getRotationToJ2000(ets[i]),
+                                    rotationCache->getRotationRateToJ2000(ets[i]));
+        }, 0, 256);
+        return;
+    }
+
+    // Spice is not thread safe: take the mutex once for all epochs
+    double tsipm[6][6];
+    {
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        for (size_t i = 0; i < ets.size(); ++i)
+        {
+            tisbod_c("J2000", centerId, ets[i].getETValue(), tsipm);
+            if (failed_c())
+                break;
+            out[i] = fromTisbod(tsipm);
+        }
+    }
+    Spice().checkError();
+}
+
+void ReferenceFrame::setRotationCache(std::shared_ptr<const FrameRotationCache> cache)
+{
+    if (cache && cache->getBodyId() != centerId)
+        throw AstroException("Rotation cache is for a different body than the frame center");
+    rotationCache = cache;
+}
+
+void ReferenceFrame::enableRotationCache(const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step)
+{
+    if (type != ReferenceFrameType::BodyFixedRotating)
+        return; // Nothing to cache, rotation is the identity
+    rotationCache = std::make_shared<const FrameRotationCache>(centerId, et0, et1, step);
+}
+
+std::shared_ptr<const FrameRotationCache> ReferenceFrame::getRotationCache() const
+{
+    return rotationCache;
 }
 
 ReferenceFrameType ReferenceFrame::getType() const
@@ -79,6 +181,29 @@ ReferenceFrame ReferenceFrame::fromString(const std::string& name)
 {
     if (name == "J2000")
         return createJ2000();
+
+    int frameId  = 0;
+    int center   = 0;
+    int frClass  = 0;
+    int classId  = 0;
+    int found    = 0;
+    {
+        std::lock_guard<std::mutex> lock(Spice().mutex());
+        namfrm_c(name.c_str(), &frameId);
+        if (frameId != 0)
+            frinfo_c(frameId, &center, &frClass, &classId, &found);
+    }
+    Spice().checkError();
+
+    // PCK frames (class 2) of a body can be represented by a body-fixed frame,
+    // as long as it is the default frame of that body
+    const int PCK_FRAME_CLASS = 2;
+    if (found && frClass == PCK_FRAME_CLASS && classId == center)
+    {
+        ReferenceFrame ref = createBodyFixedSpice(center);
+        if (ref.getId() == frameId)
+            return ref;
+    }
     throw std::runtime_error("Frame name '" + name + "' is not implemented in fromString()");
 }
 
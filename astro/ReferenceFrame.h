@@ -1,11 +1,16 @@
 #ifndef _ASTRO_REFERENCE_FRAME_H_
 #define _ASTRO_REFERENCE_FRAME_H_
 
+#include <memory>
+#include <vector>
+
 #include "Math.h"
 #include "Time.h"
 
 namespace astro {
 
+class FrameRotationCache;
+
 enum ReferenceFrameType
 {
     Inertial,             // Always J2000 axes
@@ -14,6 +19,64 @@ enum ReferenceFrameType
 };
 
 
+// A 6x6 state transformation between two frames, stored in block form
+// [ R   0 ]
+// [ dR  R ]
+// plus the position and velocity of the source frame origin (o, vo), given in
+// the destination frame, so that
+// r' = R * r + o and v' = dR * r + R * v + vo.
+// Frames sharing an origin (all ReferenceFrames) have o = vo = 0.
+struct StateTransform
+{
+    Mat3 R;  // Rotation
+    Mat3 dR; // Time derivative of the rotation
+    Vec3 o;  // Origin offset
+    Vec3 vo; // Origin velocity
+
+    StateTransform()
+        : R(1.0), dR(0.0), o(0.0), vo(0.0)
+    {}
+
+    StateTransform(const Mat3& _R, const Mat3& _dR)
+        : R(_R), dR(_dR), o(0.0), vo(0.0)
+    {}
+
+    StateTransform(const Mat3& _R, const Mat3& _dR, const Vec3& _o, const Vec3& _vo)
+        : R(_R), dR(_dR), o(_o), vo(_vo)
+    {}
+
+    // The inverse transformation. Since R is a rotation this is
+    // [ R^T   0  ]
+    // [ dR^T R^T ]
+    // with the origin offsets transformed back through it.
+    StateTransform inverse() const
+    {
+        Mat3 Rt  = glm::transpose(R);
+        Mat3 dRt = glm::transpose(dR);
+        return StateTransform(Rt, dRt, -(Rt * o), -(dRt * o + Rt * vo));
+    }
+
+    // Composition: (A * B) applies B first, then A
+    StateTransform operator*(const StateTransform& B) const
+    {
+        return StateTransform(R * B.R,
+                              dR * B.R + R * B.dR,
+                              R * B.o + o,
+                              dR * B.o + R * B.vo + vo);
+    }
+
+    Vec3 applyPosition(const Vec3& r) const
+    {
+        return R * r + o;
+    }
+
+    Vec3 applyVelocity(const Vec3& r, const Vec3& v) const
+    {
+        return dR * r + R * v + vo;
+    }
+};
+
+
 class ReferenceFrame
 {
 public:
@@ -22,9 +85,28 @@ public:
 
     // Returns the orientation/rotation of the frame in J2000 inertial frame.
     // r_j2000 = M * r_body. To transform from inertial to body fixed, use
-    // glm::inverse(M).
+    // glm::transpose(M).
+    // If a rotation cache covering et is attached, it is used instead of Spice.
     virtual Mat3 getRotationToJ2000(const EphemerisTime& et) const;
 
+    // Returns the state transformation from this frame to J2000 at the given ET.
+    // Uses the rotation cache if one covering et is attached, otherwise Spice.
+    StateTransform getStateTransformToJ2000(const EphemerisTime& et) const;
+
+    // Batch version: out[i] is the transformation at ets[i].
+    // With Spice the mutex is taken once for all epochs; with a rotation
+    // cache covering all epochs the transformations are computed in parallel.
+    void getStateTransformsToJ2000(const std::vector<EphemerisTime>& ets, std::vector<StateTransform>& out) const;
+
+    // Attaches a rotation cache to this frame (shared between copies).
+    // The cache must be for the center body of this frame.
+    void setRotationCache(std::shared_ptr<const FrameRotationCache> cache);
+
+    // Convenience: builds and attaches a rotation cache for [et0, et1]
+    void enableRotationCache(const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& step);
+
+    std::shared_ptr<const FrameRotationCache> getRotationCache() const;
+
     virtual ReferenceFrameType getType() const;
 
     // Returns the Id of the center object of this frame
@@ -45,7 +127,8 @@ public:
     // for barycenters it is non-rotating.
     static ReferenceFrame createBodyFixedSpice(int bodyId);
 
-    // Creates a frame based on its name. Currently only "J2000" is implemented.
+    // Creates a frame based on its (Spice) name. "J2000" and the body-fixed
+    // PCK frames of bodies (e.g. "IAU_EARTH") are supported.
     static ReferenceFrame fromString(const std::string& name);
 
     virtual bool isJ2000() const;
@@ -55,6 +138,8 @@ protected:
     int spiceId;
     std::string spiceName;
     int centerId;
+
+    std::shared_ptr<const FrameRotationCache> rotationCache;
 };
 
 } // namespace astro
@@ -0,0 +1,154 @@
+#include "SixDOF.h"
+#include "RKF78.h"
+#include "PCDM.h"
+#include "Interpolate.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astro {
+
+// Largest turn of the body in a step with a body force [rad]. The error
+// estimate of RKF78 does not see a thrust direction that only depends on
+// time, so the step size is limited from the angular velocity instead
+static const double MAX_TURN = 0.25;
+
+SixDOF::SixDOF(const ODE& _ode, const RotODE& _rode)
+    : ode(_ode), rode(_rode), f_b(0.0), gravityGradient(false), h_rot(1.0)
+{}
+
+void SixDOF::setBodyForce(const Vec3& f_body)
+{
+    f_b = f_body;
+}
+
+void SixDOF::setGravityGradient(bool enabled)
+{
+    if (enabled && ode.getAttractors().empty())
+        throw AstroException("SixDOF: gravity gradient needs an attractor");
+    gravityGradient = enabled;
+}
+
+void SixDOF::setAttitudeStep(const TimeDelta& dt)
+{
+    if (dt.value <= 0.0)
+        throw AstroException("SixDOF: attitude step must be positive");
+    h_rot = dt.value;
+}
+
+bool SixDOF::translate(const PosState& s, double t, double h, const std::vector<Quat>& q,
+                       PosState& s_next, double& h_next) const
+{
+    const bool   thrust = f_b != Vec3(0.0);
+    const size_t n      = q.size() - 1;
+    const double m      = ode.getMass();
+
+    auto f = [&](double ti, const PosState& x) {
+        PosState d = ode.rates(EphemerisTime(ti), x);
+        if (thrust)
+        {
+            // Normalized linear interpolation of the attitude between the nodes
+            double u  = n * (ti - t) / h;
+            size_t k  = std::min(static_cast<size_t>(std::max(u, 0.0)), n - 1);
+            double a  = u - k;
+            Quat   qa = q[k];
+            Quat   qb = q[k + 1];
+            if (glm::dot(qa, qb) < 0.0)
+                qb = -1.0 * qb;
+            Quat qi = glm::normalize(qa * (1.0 - a) + qb * a);
+            d.v += rotate(qi, f_b) / (m * 1000.0); // [N/kg] = [m/s^2] -> [km/s^2]
+        }
+        return d;
+    };
+    return RKF78::step(f, s, t, h, 1.0, s_next, h_next);
+}
+
+SixDOF::Result SixDOF::doStep(const State& s, const EphemerisTime& et, const TimeDelta& dt) const
+{
+    const double h = dt.value;
+    const double t = et.getETValue();
+    if (h <= 0.0)
+        throw AstroException("SixDOF: steps must be positive");
+
+    // Predict the translation with the attitude at the start
+    PosState p1;
+    double   h_next;
+    if (!translate(s.P, t, h, { s.R.q, s.R.q }, p1, h_next))
+        return { s, et, TimeDelta(h_next), 0 };
+
+    // Attitude substeps, with the torques from the predicted positions at
+    // the middle of each substep, as prepared by PCDM
+    const size_t n  = std::max<size_t>(1, static_cast<size_t>(std::ceil(h / h_rot - 1.0E-9)));
+    const double hs = h / n;
+
+    RotODE local(rode);
+    if (gravityGradient)
+        local.addTorqueTerm(GravityGradientTorque(ode.getAttractors().front().GM, ode.getAttractors().front().p));
+    const PosState&     p0  = s.P;
+    const EphemerisTime et1 = et + dt;
+    local.setPositionSource([&p0, &p1, &et, et1](const EphemerisTime& ex) {
+        PosState px;
+        hermite(p0, et, p1, et1, ex, px);
+        return px;
+    });
+
+    RotState rs = s.R;
+    std::vector<Quat> nodes(1, rs.q);
+    nodes.reserve(n + 1);
+    for (size_t k = 0; k < n; ++k)
+    {
+        rs = PCDM::doStep(local, rs, et + TimeDelta(k * hs), TimeDelta(hs)).rs;
+        nodes.push_back(rs.q);
+    }
+
+    // Correct the translation with the attitude along the step
+    if (f_b != Vec3(0.0))
+    {
+        if (!translate(s.P, t, h, nodes, p1, h_next))
+            return { s, et, TimeDelta(h_next), 0 };
+        double w = glm::length(rs.w);
+        if (w * h_next > MAX_TURN)
+            h_next = MAX_TURN / w;
+    }
+
+    return { State(p1, rs), et + dt, TimeDelta(h_next), 0 };
+}
+
+std::vector<SixDOF::Result> SixDOF::doSteps(const State& s, const EphemerisTime& et0, const EphemerisTime& et1,
+                                            const TimeDelta& dt) const
+{
+    std::vector<Result> res;
+    res.push_back({ s, et0, dt, 0 });
+
+    double h     = dt.value;
+    int    tries = 0;
+    while (res.back().et < et1)
+    {
+        const Result& last = res.back();
+        double rest    = (et1 - last.et).value;
+        bool   landing = rest <= h;
+
+        Result r = doStep(last.s, last.et, TimeDelta(landing ? rest : h));
+        ++tries;
+        if (r.et == last.et)
+        {
+            h = r.dt_next.value; // Rejected
+            continue;
+        }
+
+        if (landing)
+            r.et = et1;
+        else
+            h = r.dt_next.value;
+        r.dt_next  = TimeDelta(h);
+        r.numTries = tries;
+        tries      = 0;
+        res.push_back(r);
+    }
+
+    return res;
+}
+
+} // namespace astro
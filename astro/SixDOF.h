@@ -0,0 +1,78 @@
+#ifndef _ASTRO_SIX_DOF_H_
+#define _ASTRO_SIX_DOF_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Coupled propagation of translation and rotation, at different rates.
+// Translation takes large adaptive RKF78 steps, and within each of them
+// rotation takes fixed PCDM substeps, so the translation is not evaluated at
+// the attitude step rate. The two are coupled by:
+//
+// - A thrust fixed in the body frame, rotated to the inertial frame with the
+//   attitude along the step, and applied as f / m, converted from m/s^2 to
+//   km/s^2.
+// - The torque terms of the RotODE, and optionally the gravity gradient of
+//   the first attractor, with their environment set from the position at
+//   the middle of each attitude substep. A copy of the RotODE takes its
+//   position from the translation, so its own position source is not used.
+//
+// Each step first predicts the translation with the attitude at the start of
+// the step, then runs the attitude substeps along a Hermite interpolation of
+// the predicted positions, and finally, with a body force, repeats the
+// translation step with the attitude interpolated between the substeps.
+// With a body force the steps are also limited so the body turns at most a
+// quarter radian in each. Rejected steps are retried with the reduced step
+// size. RKF78's tolerance applies.
+class SixDOF
+{
+public:
+    struct Result
+    {
+        State         s;
+        EphemerisTime et;
+        TimeDelta     dt_next;
+        int           numTries;
+    };
+
+    // The ODE should have no force of its own (setForce) when a body force is
+    // used here; its mass is used for the body force
+    SixDOF(const ODE& ode, const RotODE& rode);
+
+    // Thrust in the body frame [N]. With the mass of the ODE [kg] it gives
+    // an acceleration in m/s^2, which is converted to km/s^2 as in Maneuver
+    void setBodyForce(const Vec3& f_body);
+
+    // Adds a GravityGradientTorque of the first attractor of the ODE to the
+    // torque terms of the RotODE
+    void setGravityGradient(bool enabled);
+
+    // Largest attitude substep. Default is 1 s
+    void setAttitudeStep(const TimeDelta& dt);
+
+    Result doStep(const State& s, const EphemerisTime& et, const TimeDelta& dt) const;
+
+    std::vector<Result> doSteps(const State& s, const EphemerisTime& et0, const EphemerisTime& et1,
+                                const TimeDelta& dt) const;
+
+private:
+    // Translation step with the attitude given at n + 1 equally spaced nodes
+    // over the step; false if rejected
+    bool translate(const PosState& s, double t, double h, const std::vector<Quat>& q,
+                   PosState& s_next, double& h_next) const;
+
+    ODE    ode;
+    RotODE rode;
+    Vec3   f_b;
+    bool   gravityGradient;
+    double h_rot;
+};
+
+} // namespace astro
+
+#endif
@@ -3,12 +3,14 @@
 #include "State.h"
 #include "Exceptions.h"
 #include "SpiceCore.h"
+#include "Parallel.h"
 
-#include <cspice/SpiceUsr.h>
+#include <unordered_map>
 
 namespace astro {
 
-State State::transform(const ReferenceFrame& fromFr, const ReferenceFrame toFr, const EphemerisTime& et)
+// Checks the frame combination and returns true if a transformation is needed
+static bool needsTransform(const ReferenceFrame& fromFr, const ReferenceFrame& toFr)
 {
     if (fromFr.getType() == ReferenceFrameType::BodyFixedRotating &&
         toFr.getType()   == ReferenceFrameType::BodyFixedRotating)
@@ -19,59 +21,143 @@ State State::transform(const ReferenceFrame& fromFr, const ReferenceFrame toFr,
     if ((fromFr.isJ2000() || fromFr.getType() == ReferenceFrameType::BodyFixedNonRotating) &&
         (toFr.isJ2000()   || toFr.getType()   == ReferenceFrameType::BodyFixedNonRotating))
     {
-        return *this; // No state transform needed
+        return false; // No state transform needed
     }
+    return true;
+}
+
+// Applies a state transformation to a translational state
+static inline PosState apply(const StateTransform& st, const PosState& p)
+{
+    return PosState(st.applyPosition(p.r), st.applyVelocity(p.r, p.v));
+}
 
-    // Either to or from is inertial — get the body-fixed one
-    Mat3 M;
-    bool fromInertial;
-    int body;
+// Transforms the rotation state using the 3x3 frame rotation matrix M.
+// M transforms vectors from the source frame into the destination frame.
+// For orientation: compose the frame rotation with the body quaternion.
+// For angular velocity: re-express the same physical vector in new axes.
+static inline RotState apply(const Mat3& M, const Quat& qM, const RotState& r)
+{
+    return RotState(glm::normalize(qM * r.q), M * r.w);
+}
+
+// Returns the transformation from fromFr to toFr, given that one of them is
+// inertial (or non-rotating) and the other is rotating
+static StateTransform frameTransform(const ReferenceFrame& fromFr, const ReferenceFrame& toFr, const EphemerisTime& et)
+{
     if (toFr.isJ2000() || toFr.getType() == ReferenceFrameType::BodyFixedNonRotating)
+        return fromFr.getStateTransformToJ2000(et);       // from body-fixed to inertial
+    return toFr.getStateTransformToJ2000(et).inverse();   // from inertial to body-fixed
+}
+
+State State::transform(const ReferenceFrame& fromFr, const ReferenceFrame toFr, const EphemerisTime& et)
+{
+    if (!needsTransform(fromFr, toFr))
+        return *this;
+
+    StateTransform st = frameTransform(fromFr, toFr, et);
+    return State(apply(st, P), apply(st.R, glm::quat_cast(st.R), R));
+}
+
+// Finds the distinct epochs in ets. slot[i] is the index in 'unique' of ets[i].
+static void distinctEpochs(const std::vector<EphemerisTime>& ets,
+                           std::vector<EphemerisTime>& unique, std::vector<size_t>& slot)
+{
+    unique.clear();
+    slot.resize(ets.size());
+    std::unordered_map<double, size_t> index;
+    index.reserve(ets.size());
+    for (size_t i = 0; i < ets.size(); ++i)
     {
-        // from body-fixed to inertial
-        M            = fromFr.getRotationToJ2000(et);
-        fromInertial = false;
-        body         = fromFr.getCenterId();
+        // Most trajectories repeat the previous epoch, try that first
+        if (i > 0 && ets[i] == ets[i - 1])
+        {
+            slot[i] = slot[i - 1];
+            continue;
+        }
+        auto it = index.find(ets[i].getETValue());
+        if (it == index.end())
+        {
+            it = index.emplace(ets[i].getETValue(), unique.size()).first;
+            unique.push_back(ets[i]);
+        }
+        slot[i] = it->second;
+    }
+}
+
+// Computes the transformations from fromFr to toFr at each distinct epoch
+static void frameTransforms(const ReferenceFrame& fromFr, const ReferenceFrame& toFr,
+                            const std::vector<EphemerisTime>& unique, std::vector<StateTransform>& sts)
+{
+    bool toInertial = toFr.isJ2000() || toFr.getType() == ReferenceFrameType::BodyFixedNonRotating;
+    if (toInertial)
+    {
+        fromFr.getStateTransformsToJ2000(unique, sts);
     }
     else
     {
-        // from inertial to body-fixed
-        M            = glm::inverse(toFr.getRotationToJ2000(et));
-        fromInertial = true;
-        body         = toFr.getCenterId();
+        toFr.getStateTransformsToJ2000(unique, sts);
+        for (auto& st : sts)
+            st = st.inverse();
     }
+}
 
-    double tispm[6][6];
+void State::transformTrajectory(const ReferenceFrame& fromFr, const ReferenceFrame& toFr,
+                                const std::vector<PosState>& states, const std::vector<EphemerisTime>& ets,
+                                std::vector<PosState>& out)
+{
+    if (states.size() != ets.size())
+        throw AstroException("Number of states and epochs differ in trajectory transform");
+
+    if (!needsTransform(fromFr, toFr))
     {
-        std::lock_guard<std::mutex> lock(Spice().mutex());
-        tisbod_c("J2000", body, et.getETValue(), tispm);
+        out = states;
+        return;
     }
 
-    if (!fromInertial)
+    std::vector<EphemerisTime> unique;
+    std::vector<size_t> slot;
+    distinctEpochs(ets, unique, slot);
+
+    std::vector<StateTransform> sts;
+    frameTransforms(fromFr, toFr, unique, sts);
+
+    out.resize(states.size());
+    parallelFor(states.size(), [&](size_t i) {
+        out[i] = apply(sts[slot[i]], states[i]);
+    }, 0, 4096);
+}
+
+void State::transformTrajectory(const ReferenceFrame& fromFr, const ReferenceFrame& toFr,
+                                const std::vector<State>& states, const std::vector<EphemerisTime>& ets,
+                                std::vector<State>& out)
+{
+    if (states.size() != ets.size())
+        throw AstroException("Number of states and epochs differ in trajectory transform");
+
+    if (!needsTransform(fromFr, toFr))
     {
-        double tispm_inv[6][6];
-        invstm_c(tispm, tispm_inv);
-        for (int i = 0; i < 6; ++i)
-            for (int j = 0; j < 6; ++j)
-                tispm[i][j] = tispm_inv[i][j];
+        out = states;
+        return;
     }
 
-    double state[6]    = { P.r.x, P.r.y, P.r.z, P.v.x, P.v.y, P.v.z };
-    double tr_state[6] = {};
-    mxvg_c(tispm, state, 6, 6, tr_state);
-
-    // Transform the rotation state using the 3x3 frame rotation matrix M.
-    // M transforms vectors from the source frame into the destination frame.
-    // For orientation: compose the frame rotation with the body quaternion.
-    // For angular velocity: re-express the same physical vector in new axes.
-    Quat qM = glm::quat_cast(M);
-
-    State ret;
-    ret.P.r = Vec3(tr_state[0], tr_state[1], tr_state[2]);
-    ret.P.v = Vec3(tr_state[3], tr_state[4], tr_state[5]);
-    ret.R.q = glm::normalize(qM * R.q);
-    ret.R.w = M * R.w;
-    return ret;
+    std::vector<EphemerisTime> unique;
+    std::vector<size_t> slot;
+    distinctEpochs(ets, unique, slot);
+
+    std::vector<StateTransform> sts;
+    frameTransforms(fromFr, toFr, unique, sts);
+
+    // Frame rotation as quaternion, once per epoch
+    std::vector<Quat> qs(sts.size());
+    for (size_t k = 0; k < sts.size(); ++k)
+        qs[k] = glm::quat_cast(sts[k].R);
+
+    out.resize(states.size());
+    parallelFor(states.size(), [&](size_t i) {
+        const StateTransform& st = sts[slot[i]];
+        out[i] = State(apply(st, states[i].P), apply(st.R, qs[slot[i]], states[i].R));
+    }, 0, 4096);
 }
 
 
@@ -94,6 +180,12 @@ PosState abs(const PosState& p)
         Vec3(std::abs(p.v.x), std::abs(p.v.y), std::abs(p.v.z)));
 }
 
+double maxNorm(const PosState& p)
+{
+    return std::max({ std::abs(p.r.x), std::abs(p.r.y), std::abs(p.r.z),
+                      std::abs(p.v.x), std::abs(p.v.y), std::abs(p.v.z) });
+}
+
 std::ostream& operator<<(std::ostream& os, const astro::RotState& s)
 {
     os << "q: (" << s.q.x << ", " << s.q.y << ", " << s.q.z << ", " << s.q.w << ") []\n";
@@ -2,6 +2,7 @@
 #define _ASTRO_STATE_H_
 
 #include <sstream>
+#include <vector>
 
 #include "Math.h"
 #include "ReferenceFrame.h"
@@ -59,6 +60,9 @@ public:
 PosState operator/(const PosState& p1, const PosState& p2);
 PosState abs(const PosState& p);
 
+// Largest absolute component, used for error control
+double maxNorm(const PosState& p);
+
 std::ostream& operator<<(std::ostream& os, const astro::PosState& s);
 
 
@@ -96,6 +100,19 @@ public:
 
     // Transforms this state between reference frames at the given ET
     State transform(const ReferenceFrame& fromFr, const ReferenceFrame toFr, const EphemerisTime& et);
+
+    // Transforms a whole trajectory between reference frames.
+    // states[i] is given at ets[i]; the result is written to out (resized).
+    // The 6x6 transformation is computed once per distinct epoch, so several
+    // objects sampled at the same epochs share their transformations.
+    static void transformTrajectory(const ReferenceFrame& fromFr, const ReferenceFrame& toFr,
+                                    const std::vector<State>& states, const std::vector<EphemerisTime>& ets,
+                                    std::vector<State>& out);
+
+    // Same, for translational states only
+    static void transformTrajectory(const ReferenceFrame& fromFr, const ReferenceFrame& toFr,
+                                    const std::vector<PosState>& states, const std::vector<EphemerisTime>& ets,
+                                    std::vector<PosState>& out);
 };
 
 } // namespace astro
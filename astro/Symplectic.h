@@ -0,0 +1,121 @@
+#ifndef _ASTRO_SYMPLECTIC_H_
+#define _ASTRO_SYMPLECTIC_H_
+
+#include <cmath>
+#include <vector>
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// Fixed step symplectic integrators of order N = 4, 6 or 8, built by
+// composing kick-drift-kick leapfrog steps with the weights of
+// H. Yoshida, "Construction of higher order symplectic integrators",
+// Phys. Lett. A 150 (1990). Order 6 uses solution A, order 8 solution D.
+//
+// The accelerations must depend on position (and time) only, i.e. the ODE
+// must be conservative: velocity dependent forces such as drag break the
+// symplectic property. For such models the energy error stays bounded over
+// very long arcs instead of drifting as it does with Runge-Kutta methods.
+template<int N, typename ODEType = ODE>
+class Yoshida
+{
+    static_assert(N == 4 || N == 6 || N == 8, "Yoshida order needs to be 4, 6 or 8");
+
+public:
+    struct Result
+    {
+        PosState s;
+        EphemerisTime et;
+    };
+
+    static Result doStep(const ODEType& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt);
+
+    static std::vector<Result> doSteps(const ODEType& ode, const PosState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt);
+
+private:
+    // Returns the composition weights (the leapfrog sub-step fractions)
+    static const std::vector<double>& weights();
+
+    // Builds the symmetric sequence w_m .. w_1 w_0 w_1 .. w_m from w_1 .. w_m
+    static std::vector<double> symmetric(const std::vector<double>& w);
+};
+
+template<int N, typename ODEType>
+std::vector<double> Yoshida<N, ODEType>::symmetric(const std::vector<double>& w)
+{
+    double w0 = 1.0;
+    for (double wi : w)
+        w0 -= 2.0 * wi;
+
+    std::vector<double> seq(w.rbegin(), w.rend());
+    seq.push_back(w0);
+    seq.insert(seq.end(), w.begin(), w.end());
+    return seq;
+}
+
+template<int N, typename ODEType>
+const std::vector<double>& Yoshida<N, ODEType>::weights()
+{
+    static const std::vector<double> w = []() {
+        switch (N)
+        {
+            case 4:
+            {
+                double w1 = 1.0 / (2.0 - std::cbrt(2.0));
+                return symmetric({ w1 });
+            }
+            case 6:
+                return symmetric({ -0.117767998417887E1, 0.235573213359357E0, 0.784513610477560E0 });
+            default: // 8
+                return symmetric({  0.102799849391985E0, -0.196061023297549E1, 0.193813913762276E1,
+                                   -0.158240635368243E0, -0.144485223686048E1, 0.253693336566229E0,
+                                    0.914844246229740E0 });
+        }
+    }();
+    return w;
+}
+
+template<int N, typename ODEType>
+typename Yoshida<N, ODEType>::Result Yoshida<N, ODEType>::doStep(const ODEType& ode, const PosState& s, const EphemerisTime& et, const TimeDelta& dt)
+{
+    const std::vector<double>& w = weights();
+    const double h = dt.value;
+
+    double t = et.getETValue();
+    PosState si = s;
+    Vec3 a = ode.rates(EphemerisTime(t), si).v;
+    for (double wi : w)
+    {
+        // Kick-drift-kick; the closing acceleration opens the next sub-step
+        si.v += a * (0.5 * wi * h);
+        si.r += si.v * (wi * h);
+        t += wi * h;
+        a = ode.rates(EphemerisTime(t), si).v;
+        si.v += a * (0.5 * wi * h);
+    }
+
+    return { si, et + dt };
+}
+
+template<int N, typename ODEType>
+std::vector<typename Yoshida<N, ODEType>::Result> Yoshida<N, ODEType>::doSteps(const ODEType& ode, const PosState& s, const EphemerisTime& et0, const EphemerisTime& et1, const TimeDelta& dt)
+{
+    std::vector<Result> res;
+    res.push_back({ s, et0 });
+
+    TimeDelta dti = dt;
+    while (res.back().et < et1)
+    {
+        if (res.back().et + dti > et1)
+            dti = et1 - res.back().et;
+        res.push_back(doStep(ode, res.back().s, res.back().et, dti));
+    }
+
+    return res;
+}
+
+} // namespace astro
+
+#endif
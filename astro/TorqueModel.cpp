@@ -0,0 +1,115 @@
+#include "TorqueModel.h"
+#include "Util.h"
+#include "Exceptions.h"
+
+#include <cmath>
+
+// References:
+// [1]  J. R. Wertz (ed.), "Spacecraft Attitude Determination and Control",
+//      Reidel (1978)
+
+namespace astro {
+
+Vec3 gravityGradientTorque(const Vec3& r_b, double GM, const Mat3& Ib)
+{
+    // [1], for a body small compared to r
+    double r2 = glm::dot(r_b, r_b);
+    return glm::cross(r_b, Ib * r_b) * (3.0 * GM / (r2 * r2 * std::sqrt(r2)));
+}
+
+TorqueTerm::~TorqueTerm()
+{}
+
+// ── GravityGradientTorque ────────────────────────────────────────────────────
+
+GravityGradientTorque::GravityGradientTorque(double _GM, const Vec3& _center)
+    : GM(_GM), center(_center)
+{}
+
+void GravityGradientTorque::prepare(const EphemerisTime&, const PosState& s, TorqueEnvironment& env) const
+{
+    env.r  = s.r - center;
+    env.GM = GM;
+}
+
+Vec3 GravityGradientTorque::torque(const TorqueEnvironment& env, const Quat& q, const Vec3&, const Mat3& Ib) const
+{
+    return gravityGradientTorque(rotateInverse(q, env.r), env.GM, Ib);
+}
+
+// ── AerodynamicTorque ────────────────────────────────────────────────────────
+
+AerodynamicTorque::AerodynamicTorque(std::shared_ptr<const Atmosphere> _atmosphere, double _cd, double area_m2,
+                                     const Vec3& _cp, const Vec3& _omega, const Vec3& _center)
+    : atmosphere(_atmosphere), cd(_cd), area(area_m2), cp(_cp), omega(_omega), center(_center)
+{
+    if (!atmosphere || cd <= 0.0 || area <= 0.0)
+        throw AstroException("AerodynamicTorque needs an atmosphere, and positive drag coefficient and area");
+}
+
+void AerodynamicTorque::prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const
+{
+    Vec3 r       = s.r - center;
+    env.vRel     = s.v - glm::cross(omega, r);
+    env.density  = atmosphere->density(r, et);
+}
+
+Vec3 AerodynamicTorque::torque(const TorqueEnvironment& env, const Quat& q, const Vec3&, const Mat3&) const
+{
+    // F = -1/2 rho cd A |v| v [N], with v in m/s
+    Vec3 v = rotateInverse(q, env.vRel) * 1000.0;
+    Vec3 f = v * (-0.5 * env.density * cd * area * glm::length(v));
+    return glm::cross(cp, f);
+}
+
+// ── SRPTorque ────────────────────────────────────────────────────────────────
+
+SRPTorque::SRPTorque(std::shared_ptr<const SolarRadiationPressure> _srp, double _cr, double area_m2,
+                     const Vec3& _cp, const Vec3& _center)
+    : srp(_srp), cr(_cr), area(area_m2), cp(_cp), center(_center)
+{
+    if (!srp || cr <= 0.0 || area <= 0.0)
+        throw AstroException("SRPTorque needs a radiation pressure model, and positive cr and area");
+}
+
+void SRPTorque::prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const
+{
+    env.pressure = srp->pressure(s.r - center, et, env.toSun);
+}
+
+Vec3 SRPTorque::torque(const TorqueEnvironment& env, const Quat& q, const Vec3&, const Mat3&) const
+{
+    if (env.pressure == 0.0)
+        return Vec3(0.0);
+
+    // Pushes away from the Sun [N]
+    Vec3 f = rotateInverse(q, env.toSun) * (-env.pressure * cr * area);
+    return glm::cross(cp, f);
+}
+
+// ── MagneticTorque ───────────────────────────────────────────────────────────
+
+MagneticTorque::MagneticTorque(const Vec3& _dipole, double _B0, double _re, const Vec3& _axis, const Vec3& _center)
+    : dipole(_dipole), B0(_B0), re(_re), axis(glm::normalize(_axis)), center(_center)
+{}
+
+Vec3 MagneticTorque::field(const Vec3& r) const
+{
+    // B0 (re / r)^3 (3 (m.r) r - m), with unit vectors m and r
+    double l = glm::length(r);
+    Vec3   e = r / l;
+    double k = re / l;
+    return (e * (3.0 * glm::dot(axis, e)) - axis) * (B0 * k * k * k);
+}
+
+void MagneticTorque::prepare(const EphemerisTime&, const PosState& s, TorqueEnvironment& env) const
+{
+    env.B = field(s.r - center);
+}
+
+Vec3 MagneticTorque::torque(const TorqueEnvironment& env, const Quat& q, const Vec3&, const Mat3&) const
+{
+    return glm::cross(dipole, rotateInverse(q, env.B));
+}
+
+} // namespace astro
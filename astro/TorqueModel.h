@@ -0,0 +1,155 @@
+#ifndef _ASTRO_TORQUE_MODEL_H_
+#define _ASTRO_TORQUE_MODEL_H_
+
+#include <memory>
+#include <vector>
+#include "Math.h"
+#include "State.h"
+#include "Time.h"
+#include "Atmosphere.h"
+#include "RadiationPressure.h"
+
+namespace astro {
+
+// Environmental torques of the rotational equations of motion. The torques
+// depend on the position of the body, which changes slowly compared to the
+// attitude, and on the attitude itself. Each term therefore has two parts:
+//
+// - prepare(), which evaluates the position dependent quantities (density,
+//   magnetic field, Sun direction, ...) once per step, from the position
+//   source of the RotODE, when the integrator calls RotODE::prepare(), and
+// - torque(), which rotates them into the body frame and returns the body
+//   frame torque for the attitude at each stage of the integrator.
+//
+// Torques are in N m with the inertia in kg m^2. Each term has its own
+// TorqueEnvironment, so several terms of one kind can be combined, e.g. the
+// gravity gradients of the Earth and the Moon.
+
+// Gravity gradient torque on a body with inertia Ib, from a point mass GM at
+// the position r_b relative to the body, both in the body frame:
+// 3 GM / r^5 (r_b x Ib r_b)
+Vec3 gravityGradientTorque(const Vec3& r_b, double GM, const Mat3& Ib);
+
+
+// Position dependent quantities of one term, all in the inertial frame. A
+// term sets the ones it needs
+struct TorqueEnvironment
+{
+    EphemerisTime et;
+    Vec3   r        = Vec3(0.0); // Position relative to the central body [km]
+    double GM       = 0.0;       // Of the central body [km^3/s^2]
+    Vec3   vRel     = Vec3(0.0); // Velocity relative to the atmosphere [km/s]
+    double density  = 0.0;       // [kg/m^3]
+    Vec3   toSun    = Vec3(0.0); // Unit vector
+    double pressure = 0.0;       // Radiation pressure, with shadows [N/m^2]
+    Vec3   B        = Vec3(0.0); // Magnetic field [T]
+};
+
+
+// Environments of the torque terms of a RotODE prepared for one integration
+// step, one slot per term. Owned by the integrator, not the RotODE
+struct TorqueStep
+{
+    std::vector<TorqueEnvironment> slots;
+};
+
+
+class TorqueTerm
+{
+public:
+    virtual ~TorqueTerm();
+
+    // Evaluates the quantities the term needs at the state s into env
+    virtual void prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const = 0;
+
+    // Body frame torque for the attitude q (body to inertial) and the body
+    // frame angular velocity w_b
+    virtual Vec3 torque(const TorqueEnvironment& env, const Quat& q, const Vec3& w_b, const Mat3& Ib) const = 0;
+};
+
+
+// Gravity gradient of a point mass at 'center'
+class GravityGradientTorque : public TorqueTerm
+{
+public:
+    GravityGradientTorque(double GM, const Vec3& center = Vec3(0.0));
+
+    virtual void prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const;
+    virtual Vec3 torque(const TorqueEnvironment& env, const Quat& q, const Vec3& w_b, const Mat3& Ib) const;
+
+private:
+    double GM;
+    Vec3   center;
+};
+
+
+// Drag on a body with the drag coefficient cd and the cross section area
+// (m^2), acting at the center of pressure cp (body frame, m from the center
+// of mass). The atmosphere co-rotates with omega (rad/s)
+class AerodynamicTorque : public TorqueTerm
+{
+public:
+    AerodynamicTorque(std::shared_ptr<const Atmosphere> atmosphere, double cd, double area_m2, const Vec3& cp,
+                      const Vec3& omega = Vec3(0.0, 0.0, 7.2921158553E-5), const Vec3& center = Vec3(0.0));
+
+    virtual void prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const;
+    virtual Vec3 torque(const TorqueEnvironment& env, const Quat& q, const Vec3& w_b, const Mat3& Ib) const;
+
+private:
+    std::shared_ptr<const Atmosphere> atmosphere;
+    double cd;
+    double area;
+    Vec3   cp;
+    Vec3   omega;
+    Vec3   center;
+};
+
+
+// Radiation pressure on a cannonball with the coefficient cr and the cross
+// section area (m^2), acting at the center of pressure cp (body frame, m).
+// The Sun and the shadows come from the SolarRadiationPressure model
+class SRPTorque : public TorqueTerm
+{
+public:
+    SRPTorque(std::shared_ptr<const SolarRadiationPressure> srp, double cr, double area_m2, const Vec3& cp,
+              const Vec3& center = Vec3(0.0));
+
+    virtual void prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const;
+    virtual Vec3 torque(const TorqueEnvironment& env, const Quat& q, const Vec3& w_b, const Mat3& Ib) const;
+
+private:
+    std::shared_ptr<const SolarRadiationPressure> srp;
+    double cr;
+    double area;
+    Vec3   cp;
+    Vec3   center;
+};
+
+
+// Torque m x B on the residual magnetic dipole m (body frame, A m^2), in the
+// field of a centered dipole with the equatorial surface field B0 (T) at the
+// radius re (km), along 'axis'. Defaults are the Earth's, without the tilt:
+// 3.12e-5 T, pointing south
+class MagneticTorque : public TorqueTerm
+{
+public:
+    MagneticTorque(const Vec3& dipole, double B0 = 3.12E-5, double re = 6378.137,
+                   const Vec3& axis = Vec3(0.0, 0.0, -1.0), const Vec3& center = Vec3(0.0));
+
+    virtual void prepare(const EphemerisTime& et, const PosState& s, TorqueEnvironment& env) const;
+    virtual Vec3 torque(const TorqueEnvironment& env, const Quat& q, const Vec3& w_b, const Mat3& Ib) const;
+
+    // Field of the dipole at r relative to its center (T)
+    Vec3 field(const Vec3& r) const;
+
+private:
+    Vec3   dipole;
+    double B0;
+    double re;
+    Vec3   axis;
+    Vec3   center;
+};
+
+} // namespace astro
+
+#endif
@@ -1,6 +1,7 @@
 #include "Util.h"
 
 #include <cspice/SpiceUsr.h>
+#include <cmath>
 
 namespace astro {
 
@@ -29,6 +30,21 @@ void vecToRaDec(const Vec3& pos, double* range, double* ra, double* dec)
     recrad_c(const_cast<double*>(&(pos.x)), range, ra, dec);
 }
 
+void geodeticToVec(double lon, double lat, double alt, double re, double f, Vec3* res)
+{
+    georec_c(lon, lat, alt, re, f, &(res->x));
+}
+
+Mat3 getEnuRotation(double lon, double lat)
+{
+    double slon = std::sin(lon), clon = std::cos(lon);
+    double slat = std::sin(lat), clat = std::cos(lat);
+    Vec3 east(-slon, clon, 0.0);
+    Vec3 north(-slat * clon, -slat * slon, clat);
+    Vec3 up(clat * clon, clat * slon, slat);
+    return Mat3(east, north, up);
+}
+
 double wrap(double value, double start, double end)
 {
     const double width       = end - start;
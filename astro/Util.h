@@ -2,6 +2,7 @@
 #define _ASTRO_UTIL_H
 
 #include "Math.h"
+#include <cmath>
 #include <sstream>
 
 namespace astro {
@@ -23,6 +24,14 @@ namespace astro {
     // Convert from a position to Right Ascension, Declination
     void vecToRaDec(const Vec3& pos, double* range, double* ra, double* dec);
 
+    // Convert geodetic longitude, latitude [rad] and altitude [km] to a body-fixed
+    // position, for a body with equatorial radius re [km] and flattening f
+    void geodeticToVec(double lon, double lat, double alt, double re, double f, Vec3* res);
+
+    // Returns the rotation from local East-North-Up axes at geodetic (lon, lat)
+    // to body-fixed axes (columns are East, North and Up)
+    Mat3 getEnuRotation(double lon, double lat);
+
     // Normalizes any number to an arbitrary range by assuming the range wraps
     // around when going below min or above max
     double wrap(double value, double start, double end);
@@ -31,8 +40,83 @@ namespace astro {
     // Usage (if Q denotes the orientation of a body):
     //   v_b = transform(Q_inv, v,   Q)
     //   v   = transform(Q,     v_b, Q_inv)
+    // For rotations, rotate() and rotateInverse() are cheaper.
     Vec3 transform(const Quat& q1, const Vec3& v, const Quat& q2);
 
+    // Rotates v by q, q * pure(v) * inverse(q), in the cross product form
+    // v + w t + u x t with t = 2 u x v / |q|^2 (15 multiplications and one
+    // division). Same as transform(q, v, inverse(q)). Dividing by |q|^2 keeps
+    // the last bits of |q| out of the result; the rounding of normalize() is
+    // biased, and the unit-only form adds it up over long runs
+    inline Vec3 rotate(const Quat& q, const Vec3& v)
+    {
+        Vec3 u(q.x, q.y, q.z);
+        Vec3 t = glm::cross(u, v) * (2.0 / glm::dot(q, q));
+        return v + t * q.w + glm::cross(u, t);
+    }
+
+    // Rotates v by the inverse of q, inverse(q) * pure(v) * q. With q the
+    // attitude of a body, takes inertial vectors to the body frame
+    inline Vec3 rotateInverse(const Quat& q, const Vec3& v)
+    {
+        Vec3 u(q.x, q.y, q.z);
+        Vec3 t = glm::cross(v, u) * (2.0 / glm::dot(q, q));
+        return v + t * q.w + glm::cross(t, u);
+    }
+
+    // Rotation matrix of q, R v = rotate(q, v), and its transpose for
+    // rotateInverse(). Cheaper when one q rotates several vectors. Unlike
+    // glm::mat3_cast, divides by |q|^2 as above
+    inline Mat3 rotationMatrix(const Quat& q)
+    {
+        double s  = 2.0 / glm::dot(q, q);
+        double xx = q.x * q.x * s, yy = q.y * q.y * s, zz = q.z * q.z * s;
+        double xy = q.x * q.y * s, xz = q.x * q.z * s, yz = q.y * q.z * s;
+        double wx = q.w * q.x * s, wy = q.w * q.y * s, wz = q.w * q.z * s;
+
+        // Column major
+        return Mat3(1.0 - (yy + zz), xy + wz,         xz - wy,
+                    xy - wz,         1.0 - (xx + zz), yz + wx,
+                    xz + wy,         yz - wx,         1.0 - (xx + yy));
+    }
+
+    // Root of f in [a, b], given fa = f(a) < 0 <= fb = f(b), by the Illinois
+    // variant of regula falsi. Stops when the estimate moves less than tol
+    template<typename Func>
+    double findRoot(Func f, double a, double fa, double b, double fb, double tol)
+    {
+        double c    = a;
+        int    side = 0;
+        for (int it = 0; it < 100; ++it)
+        {
+            double cn = (a * fb - b * fa) / (fb - fa);
+            if (std::abs(cn - c) < tol)
+                return cn;
+            c = cn;
+
+            double fc = f(c);
+            if (fc == 0.0)
+                return c;
+            if (fc < 0.0)
+            {
+                a  = c;
+                fa = fc;
+                if (side == -1)
+                    fb *= 0.5;
+                side = -1;
+            }
+            else
+            {
+                b  = c;
+                fb = fc;
+                if (side == 1)
+                    fa *= 0.5;
+                side = 1;
+            }
+        }
+        return c;
+    }
+
     // Pretty-printers
     std::ostream& operator<<(std::ostream& os, const Vec3& v);
     std::ostream& operator<<(std::ostream& os, const Quat& q);
@@ -0,0 +1,136 @@
+#include "Variational.h"
+#include "RKF78.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+// References:
+// [1]  O. Montenbruck and E. Gill, Satellite Orbits (2000), ch. 7.2
+
+namespace astro {
+
+// ── Mat6 ─────────────────────────────────────────────────────────────────────
+
+Mat3 Mat6::block(int i, int j) const
+{
+    // Mat3 is column major: b[col][row]
+    Mat3 b;
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+            b[c][r] = m[(3 * i + r) * 6 + 3 * j + c];
+    return b;
+}
+
+void Mat6::setBlock(int i, int j, const Mat3& b)
+{
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+            m[(3 * i + r) * 6 + 3 * j + c] = b[c][r];
+}
+
+Mat6 Mat6::transpose() const
+{
+    Mat6 t;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            t.m[j * 6 + i] = m[i * 6 + j];
+    return t;
+}
+
+Mat6 operator*(const Mat6& a, const Mat6& b)
+{
+    Mat6 p;
+    for (int i = 0; i < 6; ++i)
+        for (int k = 0; k < 6; ++k)
+        {
+            double aik = a.m[i * 6 + k];
+            for (int j = 0; j < 6; ++j)
+                p.m[i * 6 + j] += aik * b.m[k * 6 + j];
+        }
+    return p;
+}
+
+PosState operator*(const Mat6& a, const PosState& x)
+{
+    PosState y;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+        {
+            y.r[i] += a(i, j) * x.r[j] + a(i, j + 3) * x.v[j];
+            y.v[i] += a(i + 3, j) * x.r[j] + a(i + 3, j + 3) * x.v[j];
+        }
+    return y;
+}
+
+double maxNorm(const Mat6& a)
+{
+    double m = 0.0;
+    for (int i = 0; i < 36; ++i)
+        m = std::max(m, std::abs(a.m[i]));
+    return m;
+}
+
+double maxNorm(const STMState& s)
+{
+    return maxNorm(s.s);
+}
+
+// ── Variational ──────────────────────────────────────────────────────────────
+
+STMState Variational::rates(const ODE& ode, const EphemerisTime& et, const STMState& x)
+{
+    STMState d;
+    d.s = ode.rates(et, x.s);
+
+    Mat3 dadr, dadv;
+    ode.partials(et, x.s, dadr, dadv);
+
+    // d(phi)/dt = A phi, [1] eq. 7.42: the position rows get the velocity
+    // rows of phi, the velocity rows dadr * phi_r + dadv * phi_v
+    for (int k = 0; k < 6; ++k)
+    {
+        Vec3 pr(x.phi(0, k), x.phi(1, k), x.phi(2, k));
+        Vec3 pv(x.phi(3, k), x.phi(4, k), x.phi(5, k));
+        Vec3 av = dadr * pr + dadv * pv;
+        for (int i = 0; i < 3; ++i)
+        {
+            d.phi(i, k)     = pv[i];
+            d.phi(i + 3, k) = av[i];
+        }
+    }
+    return d;
+}
+
+Variational::Result Variational::doStep(const ODE& ode, const PosState& s, const Mat6& phi,
+                                        const EphemerisTime& et, const TimeDelta& dt)
+{
+    auto f = [&ode](double t, const STMState& x) { return rates(ode, EphemerisTime(t), x); };
+    STMState x(s, phi);
+    STMState x_next;
+    double   h_next;
+    if (!RKF78::step(f, x, et.getETValue(), dt.value, 1.0, x_next, h_next))
+    {
+        // Step is rejected — return current state with reduced step
+        return { s, phi, et, TimeDelta(h_next), 0 };
+    }
+    return { x_next.s, x_next.phi, et + dt, TimeDelta(h_next), 0 };
+}
+
+std::vector<Variational::Result> Variational::doSteps(const ODE& ode, const PosState& s,
+                                                      const EphemerisTime& et0, const EphemerisTime& et1,
+                                                      const TimeDelta& dt)
+{
+    std::vector<Result> res;
+    res.push_back({ s, Mat6(1.0), et0, dt, 0 });
+    while (res.back().et < et1)
+    {
+        const Result& last = res.back();
+        res.push_back(doStep(ode, last.s, last.phi, last.et, last.dt_next));
+        if (res.back().et + res.back().dt_next > et1)
+            res.back().dt_next = et1 - res.back().et;
+    }
+    return res;
+}
+
+} // namespace astro
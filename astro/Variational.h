@@ -0,0 +1,146 @@
+#ifndef _ASTRO_VARIATIONAL_H_
+#define _ASTRO_VARIATIONAL_H_
+
+#include <vector>
+#include "Math.h"
+#include "Time.h"
+#include "State.h"
+#include "ODE.h"
+
+namespace astro {
+
+// 6x6 matrix over the state (r, v), row major, e.g. a state transition
+// matrix or a covariance. Zero by default
+class Mat6
+{
+public:
+    Mat6()
+        : Mat6(0.0)
+    {}
+
+    // Diagonal matrix
+    explicit Mat6(double diag)
+    {
+        for (int i = 0; i < 36; ++i)
+            m[i] = 0.0;
+        for (int i = 0; i < 6; ++i)
+            m[i * 7] = diag;
+    }
+
+    double& operator()(int row, int col)       { return m[row * 6 + col]; }
+    double  operator()(int row, int col) const { return m[row * 6 + col]; }
+
+    // 3x3 block (i, j), i, j = 0 for position and 1 for velocity
+    Mat3 block(int i, int j) const;
+    void setBlock(int i, int j, const Mat3& b);
+
+    Mat6 transpose() const;
+
+    Mat6& operator+=(const Mat6& o)
+    {
+        for (int i = 0; i < 36; ++i)
+            m[i] += o.m[i];
+        return *this;
+    }
+
+    Mat6& operator*=(double a)
+    {
+        for (int i = 0; i < 36; ++i)
+            m[i] *= a;
+        return *this;
+    }
+
+    friend Mat6 operator+(Mat6 lhs, const Mat6& rhs) { return lhs += rhs; }
+    friend Mat6 operator*(Mat6 lhs, double a)        { return lhs *= a; }
+    friend Mat6 operator*(double a, Mat6 rhs)        { return rhs *= a; }
+
+    friend Mat6 operator*(const Mat6& a, const Mat6& b);
+
+    // Product with the state as a 6-vector (r, v)
+    friend PosState operator*(const Mat6& a, const PosState& x);
+
+    double m[36];
+};
+
+// Largest absolute element
+double maxNorm(const Mat6& a);
+
+
+// State augmented with its state transition matrix d(r, v)/d(r0, v0)
+class STMState
+{
+public:
+    PosState s;
+    Mat6     phi;
+
+    STMState()
+        : s(), phi(1.0)
+    {}
+
+    STMState(const PosState& _s, const Mat6& _phi)
+        : s(_s), phi(_phi)
+    {}
+
+    STMState& operator+=(const STMState& o)
+    {
+        s   += o.s;
+        phi += o.phi;
+        return *this;
+    }
+
+    STMState& operator*=(double a)
+    {
+        s   *= a;
+        phi *= a;
+        return *this;
+    }
+
+    friend STMState operator+(STMState lhs, const STMState& rhs) { return lhs += rhs; }
+    friend STMState operator*(STMState lhs, double a)            { return lhs *= a; }
+    friend STMState operator*(double a, STMState rhs)            { return rhs *= a; }
+};
+
+// Largest absolute component of the state only, used for error control.
+// The STM is integrated with the steps chosen for the state
+double maxNorm(const STMState& s);
+
+
+// Propagation of the state together with its state transition matrix, by
+// integrating the variational equations
+//
+//     d(phi)/dt = A phi,  A = | 0     I    |
+//                             | dadr  dadv |
+//
+// alongside the equations of motion, with the analytic partials from
+// ODE::partials(). One RKF78 propagation of the 42 element augmented state
+// replaces the 12 extra propagations of finite differences. RKF78's
+// tolerance applies.
+class Variational
+{
+public:
+    struct Result
+    {
+        PosState      s;
+        Mat6          phi;
+        EphemerisTime et;
+        TimeDelta     dt_next;
+        int           numTries;
+    };
+
+    // Derivatives of the augmented state
+    static STMState rates(const ODE& ode, const EphemerisTime& et, const STMState& x);
+
+    // One step from the state s with the transition matrix phi (from the
+    // start of the propagation to et)
+    static Result doStep(const ODE& ode, const PosState& s, const Mat6& phi,
+                         const EphemerisTime& et, const TimeDelta& dt);
+
+    // Steps from et0 to et1; phi of each result maps from et0
+    static std::vector<Result> doSteps(const ODE& ode, const PosState& s,
+                                       const EphemerisTime& et0, const EphemerisTime& et1,
+                                       const TimeDelta& dt);
+};
+
+} // namespace astro
+
+#endif
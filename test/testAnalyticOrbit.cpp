@@ -0,0 +1,251 @@
+#include "../astro/AnalyticOrbit.h"
+#include "../astro/ODE.h"
+#include "../astro/ForceModel.h"
+#include "../astro/RKF78.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Util.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <sstream>
+
+using namespace astro;
+
+class AnalyticOrbitTest : public ::testing::Test {
+
+protected:
+    AnalyticOrbitTest();
+
+    virtual ~AnalyticOrbitTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double      mu_earth;
+    double      re;
+    double      J2;
+    double      J3;
+
+    // Element set 00005 of the verification cases of [1] in AnalyticOrbit.cpp
+    std::string line1;
+    std::string line2;
+};
+
+
+
+AnalyticOrbitTest::AnalyticOrbitTest()
+  :  mu_earth(398600.4418), re(6378.137), J2(1.08262668E-3), J3(-2.5326564853E-6),
+     line1("1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753"),
+     line2("2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667")
+{
+
+}
+
+AnalyticOrbitTest::~AnalyticOrbitTest()
+{
+
+}
+
+void AnalyticOrbitTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    RKF78::setTolerance(1.0E-11);
+}
+
+void AnalyticOrbitTest::TearDown()
+{
+    RKF78::setTolerance(1.0E-8);
+}
+
+TEST_F(AnalyticOrbitTest, ParseTLE)
+{
+    TLE tle = TLE::parse(line1, line2, "VANGUARD 1 ");
+    EXPECT_EQ(tle.name, "VANGUARD 1");
+    EXPECT_EQ(tle.satnum, 5);
+    EXPECT_EQ(tle.classification, 'U');
+    EXPECT_EQ(tle.designator, "58002B");
+    EXPECT_DOUBLE_EQ(tle.ndot, 2.3E-7);
+    EXPECT_DOUBLE_EQ(tle.nddot, 0.0);
+    EXPECT_DOUBLE_EQ(tle.bstar, 2.8098E-5);
+    EXPECT_DOUBLE_EQ(tle.i, 34.2682 * astro::RADPERDEG);
+    EXPECT_DOUBLE_EQ(tle.raan, 348.7242 * astro::RADPERDEG);
+    EXPECT_DOUBLE_EQ(tle.e, 0.1859667);
+    EXPECT_DOUBLE_EQ(tle.w, 331.7664 * astro::RADPERDEG);
+    EXPECT_DOUBLE_EQ(tle.M, 19.3264 * astro::RADPERDEG);
+    EXPECT_DOUBLE_EQ(tle.n, 10.82419157);
+    EXPECT_EQ(tle.revs, 41366);
+
+    // With and without title lines, in the three-line format too
+    std::stringstream ss;
+    ss << "0 VANGUARD 1\n" << line1 << "\n" << line2 << "\n\n" << line1 << "\r\n" << line2 << "\r\n";
+    auto all = TLE::parse(ss);
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_EQ(all[0].name, "VANGUARD 1");
+    EXPECT_EQ(all[1].name, "");
+    EXPECT_EQ(all[1].epoch.getETValue(), tle.epoch.getETValue());
+
+    std::string bad = line1;
+    bad[68] = '4';
+    EXPECT_THROW(TLE::parse(bad, line2), AstroException);
+    EXPECT_THROW(TLE::parse(line2, line1), AstroException);
+    EXPECT_THROW(TLE::parse(line1.substr(0, 60), line2), AstroException);
+}
+
+TEST_F(AnalyticOrbitTest, SGP4)
+{
+    // Verification case 00005 of [1]
+    SGP4Orbit sgp4(TLE::parse(line1, line2));
+    EphemerisTime epoch = sgp4.getTLE().epoch;
+
+    PosState s = sgp4.getState(epoch);
+    EXPECT_NEAR(s.r.x, 7022.46529266, 1.0E-7);
+    EXPECT_NEAR(s.r.y, -1400.08296755, 1.0E-7);
+    EXPECT_NEAR(s.r.z, 0.03995155, 1.0E-7);
+    EXPECT_NEAR(s.v.x, 1.893841015, 1.0E-9);
+    EXPECT_NEAR(s.v.y, 6.405893759, 1.0E-9);
+    EXPECT_NEAR(s.v.z, 4.534807250, 1.0E-9);
+
+    s = sgp4.getState(epoch + TimeDelta(360.0 * 60.0));
+    EXPECT_NEAR(s.r.x, -7154.03120202, 1.0E-7);
+    EXPECT_NEAR(s.r.y, -3783.17682504, 1.0E-7);
+    EXPECT_NEAR(s.r.z, -3536.19412294, 1.0E-7);
+    EXPECT_NEAR(s.v.x, 4.741887409, 1.0E-9);
+    EXPECT_NEAR(s.v.y, -4.151817765, 1.0E-9);
+    EXPECT_NEAR(s.v.z, -2.093935425, 1.0E-9);
+
+    // A one-day orbit, propagated with SDP4
+    TLE geo = sgp4.getTLE();
+    geo.n = 1.0027;
+    geo.e = 1.0E-3;
+    SGP4Orbit orbit(geo);
+    EXPECT_NEAR(glm::length(orbit.getState(epoch + TimeDelta(86400.0)).r), 42164.0, 100.0);
+}
+
+TEST_F(AnalyticOrbitTest, SDP4)
+{
+    // Verification case 04632 of [1]: lunar-solar terms, backwards in time
+    SGP4Orbit sdp4(TLE::parse("1 04632U 70093B   04031.91070959 -.00000084  00000-0  10000-3 0  9955",
+                              "2 04632  11.4628 273.1101 1450506 207.6000 143.9350  1.20231981 44145"));
+    EphemerisTime epoch = sdp4.getTLE().epoch;
+
+    PosState s = sdp4.getState(epoch);
+    EXPECT_NEAR(s.r.x, 2334.11450085, 1.0E-7);
+    EXPECT_NEAR(s.r.y, -41920.44035349, 1.0E-7);
+    EXPECT_NEAR(s.r.z, -0.03867437, 1.0E-7);
+    EXPECT_NEAR(s.v.x, 2.826321032, 1.0E-9);
+    EXPECT_NEAR(s.v.y, -0.065091664, 1.0E-9);
+    EXPECT_NEAR(s.v.z, 0.570936053, 1.0E-9);
+
+    s = sdp4.getState(epoch + TimeDelta(-5184.0 * 60.0));
+    EXPECT_NEAR(s.r.x, -29020.02587128, 1.0E-7);
+    EXPECT_NEAR(s.r.y, 13819.84419063, 1.0E-7);
+    EXPECT_NEAR(s.r.z, -5713.33679183, 1.0E-7);
+    EXPECT_NEAR(s.v.x, -1.768068390, 1.0E-9);
+    EXPECT_NEAR(s.v.y, -3.235371192, 1.0E-9);
+    EXPECT_NEAR(s.v.z, -0.395206135, 1.0E-9);
+
+    // Verification case 08195 of [1]: Molniya, resonant with the half-day
+    // tesseral harmonics
+    sdp4  = SGP4Orbit(TLE::parse("1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+                                 "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656"));
+    epoch = sdp4.getTLE().epoch;
+
+    s = sdp4.getState(epoch);
+    EXPECT_NEAR(s.r.x, 2349.89483350, 1.0E-7);
+    EXPECT_NEAR(s.r.y, -14785.93811562, 1.0E-7);
+    EXPECT_NEAR(s.r.z, 0.02119378, 1.0E-7);
+    EXPECT_NEAR(s.v.x, 2.721488096, 1.0E-9);
+    EXPECT_NEAR(s.v.y, -3.256811655, 1.0E-9);
+    EXPECT_NEAR(s.v.z, 4.498416672, 1.0E-9);
+
+    s = sdp4.getState(epoch + TimeDelta(2880.0 * 60.0));
+    EXPECT_NEAR(s.r.x, 3417.20931586, 1.0E-7);
+    EXPECT_NEAR(s.r.y, -16038.79510665, 1.0E-7);
+    EXPECT_NEAR(s.r.z, 1894.74934058, 1.0E-7);
+    EXPECT_NEAR(s.v.x, 2.585515864, 1.0E-9);
+    EXPECT_NEAR(s.v.y, -2.596818146, 1.0E-9);
+    EXPECT_NEAR(s.v.z, 4.456882556, 1.0E-9);
+}
+
+TEST_F(AnalyticOrbitTest, SGP4Catalog)
+{
+    // The same element set at different mean anomalies, a deep-space orbit,
+    // and a low orbit with high drag that decays
+    std::vector<SGP4Orbit> catalog;
+    TLE tle = TLE::parse(line1, line2);
+    for (int k = 0; k < 100; ++k)
+    {
+        tle.M = k * 0.06;
+        catalog.push_back(SGP4Orbit(tle));
+    }
+    TLE deep = tle;
+    deep.n = 2.0;
+    catalog.push_back(SGP4Orbit(deep));
+    tle.n     = 16.3;
+    tle.e     = 1.0E-3;
+    tle.bstar = 0.5;
+    catalog.push_back(SGP4Orbit(tle));
+
+    EphemerisTime et = tle.epoch + TimeDelta(86400.0);
+    std::vector<PosState> states, states1;
+    SGP4Orbit::getStates(catalog, et, states);
+    SGP4Orbit::getStates(catalog, et, states1, 1);
+    ASSERT_EQ(states.size(), catalog.size());
+    for (size_t i = 0; i + 1 < catalog.size(); ++i)
+    {
+        PosState s = catalog[i].getState(et);
+        EXPECT_EQ(states[i].r, s.r);
+        EXPECT_EQ(states[i].v, s.v);
+        EXPECT_EQ(states1[i].r, s.r);
+    }
+    EXPECT_TRUE(std::isnan(states.back().r.x));
+    EXPECT_THROW(catalog.back().getState(et), AstroException);
+}
+
+TEST_F(AnalyticOrbitTest, MeanElements)
+{
+    // Near-circular low Earth orbit, from an osculating state
+    double v0 = std::sqrt(mu_earth / 7000.0);
+    PosState s0(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, v0 * std::cos(0.9), v0 * std::sin(0.9)));
+    EphemerisTime et0(0.0);
+    MeanElementOrbit mean = MeanElementOrbit::fromStateVector(s0, et0, mu_earth, re, J2, J3);
+    PosState s = mean.getState(et0);
+    EXPECT_NEAR(glm::length(s.r - s0.r), 0.0, 1.0E-6);
+    EXPECT_NEAR(glm::length(s.v - s0.v), 0.0, 1.0E-8);
+
+    // Follows the numerical solution with J2 and J3 over a day, unlike the
+    // two-body orbit
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, re, { J2, J3 }));
+
+    std::vector<EphemerisTime> epochs;
+    for (int k = 1; k <= 24; ++k)
+        epochs.push_back(EphemerisTime(k * 3600.0));
+    auto ref = RKF78::propagateTo(ode, s0, et0, epochs, TimeDelta(60.0));
+
+    SimpleOrbit kepler(OrbitElements::fromStateVectorOE(s0, et0, mu_earth));
+    double maxMean = 0.0, maxKepler = 0.0;
+    for (size_t k = 0; k < epochs.size(); ++k)
+    {
+        maxMean   = std::max(maxMean, glm::length(mean.getState(epochs[k]).r - ref[k].r));
+        maxKepler = std::max(maxKepler, glm::length(kepler.getState(epochs[k]).r - ref[k].r));
+    }
+    EXPECT_LT(maxMean, 2.0);
+    EXPECT_GT(maxKepler, 100.0);
+
+    // The catalog version
+    std::vector<MeanElementOrbit> catalog(3, mean);
+    std::vector<PosState> states;
+    MeanElementOrbit::getStates(catalog, epochs.back(), states, 2);
+    ASSERT_EQ(states.size(), 3u);
+    EXPECT_EQ(states[2].r, mean.getState(epochs.back()).r);
+
+    EXPECT_THROW(MeanElementOrbit(mean.getMeanElements(), re, 0.0), AstroException);
+}
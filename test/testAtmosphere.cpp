@@ -0,0 +1,128 @@
+#include "../astro/Atmosphere.h"
+#include "../astro/Ephemeris.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Time.h"
+#include "../astro/Util.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class AtmosphereTest : public ::testing::Test {
+
+protected:
+    AtmosphereTest();
+
+    virtual ~AtmosphereTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double re;
+    astro::EphemerisTime et;
+};
+
+
+
+AtmosphereTest::AtmosphereTest()
+  :  re(6378.137), et(0.0)
+{
+
+}
+
+AtmosphereTest::~AtmosphereTest()
+{
+
+}
+
+void AtmosphereTest::SetUp()
+{
+}
+
+void AtmosphereTest::TearDown()
+{
+}
+
+TEST_F(AtmosphereTest, ExponentialTable)
+{
+    astro::ExponentialAtmosphere atm;
+    ASSERT_NEAR(atm.density(Vec3(re, 0.0, 0.0), et), 1.225, 1.0E-12);
+    ASSERT_NEAR(atm.density(Vec3(0.0, re + 400.0, 0.0), et), 3.725E-12, 1.0E-20);
+    ASSERT_NEAR(atm.density(Vec3(0.0, 0.0, re + 425.0), et), 3.725E-12 * std::exp(-25.0 / 58.515), 1.0E-20);
+
+    // Nearly continuous at the table rows
+    for (double h : { 100.0, 200.0, 450.0, 800.0 })
+    {
+        double below = atm.density(Vec3(re + h - 1.0E-6, 0.0, 0.0), et);
+        double above = atm.density(Vec3(re + h + 1.0E-6, 0.0, 0.0), et);
+        ASSERT_NEAR(above / below, 1.0, 0.05);
+    }
+}
+
+TEST_F(AtmosphereTest, HarrisPriesterNeedsEphemeris)
+{
+    std::shared_ptr<const astro::EphemerisCache> none;
+    ASSERT_THROW(astro::HarrisPriester hp(none), astro::AstroException);
+}
+
+// Loads the kernels for the ephemeris cache of the Sun
+class HarrisPriesterTest : public AtmosphereTest
+{
+protected:
+    virtual void SetUp()
+    {
+        astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+        astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+    }
+};
+
+TEST_F(HarrisPriesterTest, MinimumAndMaximum)
+{
+    auto ephemeris = std::make_shared<astro::EphemerisCache>(std::vector<int>{ 10, 399 }, et, et + astro::TimeDelta(86400.0), astro::TimeDelta(3600.0));
+    astro::HarrisPriester hp(ephemeris);
+
+    // Sun on the X axis: the apex of the bulge is 30 degrees east of it
+    Vec3 sun(1.5E8, 0.0, 0.0);
+    double lag = 30.0 * astro::RADPERDEG;
+    Vec3 apex(std::cos(lag), std::sin(lag), 0.0);
+
+    ASSERT_NEAR(hp.density(apex * (re + 400.0), sun), 7.492E-12, 1.0E-18);
+    ASSERT_NEAR(hp.density(-apex * (re + 400.0), sun), 2.249E-12, 1.0E-18);
+    ASSERT_NEAR(hp.density(Vec3(0.0, 0.0, re + 400.0), sun), 0.5 * (7.492E-12 + 2.249E-12), 1.0E-18);
+    ASSERT_EQ(hp.density(apex * (re + 1200.0), sun), 0.0);
+
+    // The cached Sun position gives a density between the extremes
+    double rho = hp.density(apex * (re + 400.0), et);
+    ASSERT_GE(rho, 2.249E-12);
+    ASSERT_LE(rho, 7.492E-12);
+}
+
+TEST_F(AtmosphereTest, TabulatedMatchesModel)
+{
+    // ln(density) linear in the solar flux, exponential in altitude
+    auto model = [](double h, double f107) { return 1.0E-9 * std::exp(-(h - 200.0) / 50.0 + f107 / 100.0); };
+    auto table = std::make_shared<const astro::AtmosphereTable>(model, 200.0, 800.0, 10.0,
+                                                                std::vector<double>{ 70.0, 150.0, 250.0 });
+
+    for (double f107 : { 70.0, 100.0, 150.0, 230.0 })
+    {
+        astro::TabulatedAtmosphere atm(table, f107);
+        ASSERT_EQ(atm.getSolarFlux(), f107);
+        for (double h = 200.0; h <= 800.0; h += 7.3)
+        {
+            double rho = atm.density(Vec3(0.0, 0.0, re + h), et);
+            ASSERT_NEAR(rho / model(h, f107), 1.0, 1.0E-12);
+        }
+    }
+
+    // Clamped to the flux bins
+    astro::TabulatedAtmosphere high(table, 400.0);
+    ASSERT_EQ(high.getSolarFlux(), 250.0);
+    ASSERT_EQ(high.getTable(), table);
+}
@@ -0,0 +1,151 @@
+#include "../astro/Conjunction.h"
+#include "../astro/MonteCarlo.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+
+using namespace astro;
+
+class ConjunctionTest : public ::testing::Test {
+
+protected:
+    ConjunctionTest();
+
+    virtual ~ConjunctionTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    // Circular orbit of radius r, with inclination i and node raan, at the
+    // argument of latitude u at et0
+    std::unique_ptr<SimpleOrbit> circular(double r, double i, double raan, double u) const;
+
+    double        mu_earth;
+    EphemerisTime et0;
+};
+
+
+
+ConjunctionTest::ConjunctionTest()
+  :  mu_earth(398600.4418), et0(0.0)
+{
+
+}
+
+ConjunctionTest::~ConjunctionTest()
+{
+
+}
+
+void ConjunctionTest::SetUp()
+{
+}
+
+void ConjunctionTest::TearDown()
+{
+}
+
+std::unique_ptr<SimpleOrbit> ConjunctionTest::circular(double r, double i, double raan, double u) const
+{
+    double v = std::sqrt(mu_earth / r);
+    Vec3 node(std::cos(raan), std::sin(raan), 0.0);
+    Vec3 up(-std::sin(raan) * std::cos(i), std::cos(raan) * std::cos(i), std::sin(i));
+    PosState s(r * (std::cos(u) * node + std::sin(u) * up), v * (-std::sin(u) * node + std::cos(u) * up));
+    return std::unique_ptr<SimpleOrbit>(new SimpleOrbit(OrbitElements::fromStateVectorOE(s, et0, mu_earth)));
+}
+
+TEST_F(ConjunctionTest, Crossing)
+{
+    // Equatorial and polar orbits crossing at the node on the X axis after a
+    // quarter of a revolution, the polar one 1 km behind: at right angles the
+    // miss distance is 1 / sqrt(2) km, half way
+    double r  = 7000.0;
+    double v  = std::sqrt(mu_earth / r);
+    double n  = v / r;
+    auto   a  = circular(r, 0.0, 0.0, -astro::PIHALF);
+    auto   b  = circular(r, astro::PIHALF, 0.0, -astro::PIHALF - 1.0 / r);
+    auto   c  = circular(r, 0.0, 0.0, astro::PI); // Far away, in a's orbit
+    std::vector<Orbit*> catalog = { a.get(), b.get(), c.get() };
+
+    auto res = ConjunctionScreening::screen(catalog, et0, et0 + TimeDelta(3000.0), 5.0, TimeDelta(60.0));
+    ASSERT_EQ(res.size(), 1u);
+    EXPECT_EQ(res[0].first, 0u);
+    EXPECT_EQ(res[0].second, 1u);
+    EXPECT_NEAR(res[0].tca.getETValue(), astro::PIHALF / n + 0.5 / v, 1.0E-3);
+    EXPECT_NEAR(res[0].missDistance, std::sqrt(0.5), 1.0E-4);
+    EXPECT_NEAR(res[0].relativeSpeed, std::sqrt(2.0) * v, 1.0E-4);
+
+    // Outside a smaller threshold
+    res = ConjunctionScreening::screen(catalog, et0, et0 + TimeDelta(3000.0), 0.7, TimeDelta(60.0));
+    EXPECT_TRUE(res.empty());
+
+    EXPECT_THROW(ConjunctionScreening::screen(catalog, et0, et0, 5.0, TimeDelta(60.0)), AstroException);
+    EXPECT_THROW(ConjunctionScreening::screen(catalog, et0, et0 + TimeDelta(10.0), 0.0, TimeDelta(60.0)), AstroException);
+}
+
+TEST_F(ConjunctionTest, MatchesAllPairs)
+{
+    // Random circular orbits in a 40 km thick shell
+    SplitMix64 rng(42);
+    std::vector<std::unique_ptr<SimpleOrbit>> orbits;
+    std::vector<Orbit*> catalog;
+    for (int k = 0; k < 40; ++k)
+    {
+        orbits.push_back(circular(7050.0 + 40.0 * rng.uniform(), astro::PI * rng.uniform(),
+                                  astro::TWOPI * rng.uniform(), astro::TWOPI * rng.uniform()));
+        catalog.push_back(orbits.back().get());
+    }
+
+    double threshold = 50.0;
+    EphemerisTime et1 = et0 + TimeDelta(6.0 * 3600.0);
+    auto res = ConjunctionScreening::screen(catalog, et0, et1, threshold, TimeDelta(60.0), 1);
+    ASSERT_GT(res.size(), 5u);
+    for (size_t k = 1; k < res.size(); ++k)
+        EXPECT_FALSE(res[k].tca < res[k - 1].tca);
+
+    // All pairs, sampled every 5 s: each sampled local minimum within the
+    // threshold is found, around the same time
+    double h = 5.0;
+    size_t m = static_cast<size_t>((et1 - et0).value / h) + 1;
+    std::vector<std::vector<Vec3>> r(catalog.size(), std::vector<Vec3>(m));
+    for (size_t i = 0; i < catalog.size(); ++i)
+        for (size_t k = 0; k < m; ++k)
+            r[i][k] = catalog[i]->getState(et0 + TimeDelta(k * h)).r;
+
+    size_t minima = 0;
+    for (size_t i = 0; i < catalog.size(); ++i)
+        for (size_t j = i + 1; j < catalog.size(); ++j)
+            for (size_t k = 1; k + 1 < m; ++k)
+            {
+                double d = glm::length(r[j][k] - r[i][k]);
+                if (d < threshold && d < glm::length(r[j][k - 1] - r[i][k - 1]) && d <= glm::length(r[j][k + 1] - r[i][k + 1]))
+                {
+                    ++minima;
+                    bool found = false;
+                    for (const auto& c : res)
+                        found = found || (c.first == i && c.second == j && std::abs((c.tca - et0).value - k * h) <= h && c.missDistance <= d);
+                    EXPECT_TRUE(found) << i << " " << j << " " << k * h;
+                }
+            }
+    EXPECT_GT(minima, 0u);
+
+    // The same with any number of threads and block size
+    size_t blockSize = ConjunctionScreening::getBlockSize();
+    ConjunctionScreening::setBlockSize(7);
+    auto res4 = ConjunctionScreening::screen(catalog, et0, et1, threshold, TimeDelta(60.0), 4);
+    ConjunctionScreening::setBlockSize(blockSize);
+    ASSERT_EQ(res4.size(), res.size());
+    for (size_t k = 0; k < res.size(); ++k)
+    {
+        EXPECT_EQ(res4[k].first, res[k].first);
+        EXPECT_EQ(res4[k].second, res[k].second);
+        EXPECT_EQ(res4[k].missDistance, res[k].missDistance);
+    }
+}
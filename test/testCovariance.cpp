@@ -0,0 +1,138 @@
+#include "../astro/Covariance.h"
+#include "../astro/ODE.h"
+#include "../astro/RKF78.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class CovarianceTest : public ::testing::Test {
+
+protected:
+    CovarianceTest();
+
+    virtual ~CovarianceTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double   mu_earth;
+    ODE      ode;
+    PosState s0;
+    Mat6     P0;
+};
+
+
+
+CovarianceTest::CovarianceTest()
+  :  mu_earth(398600.4418)
+{
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, 6378.137, { 1.08262668E-3 }));
+
+    s0 = PosState(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 6.0, 4.5));
+
+    // 100 m and 10 cm/s, with some position-velocity correlation
+    for (int i = 0; i < 3; ++i)
+    {
+        P0(i, i)         = 1.0E-2;
+        P0(i + 3, i + 3) = 1.0E-8;
+        P0(i, i + 3)     = 5.0E-6;
+        P0(i + 3, i)     = 5.0E-6;
+    }
+}
+
+CovarianceTest::~CovarianceTest()
+{
+
+}
+
+void CovarianceTest::SetUp()
+{
+    RKF78::setTolerance(1.0E-11);
+}
+
+void CovarianceTest::TearDown()
+{
+    RKF78::setTolerance(1.0E-8);
+}
+
+TEST_F(CovarianceTest, Cholesky)
+{
+    Mat6 L = cholesky(P0);
+    Mat6 P = L * L.transpose();
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+        {
+            EXPECT_NEAR(P(i, j), P0(i, j), 1.0E-16);
+            if (j > i)
+                EXPECT_EQ(L(i, j), 0.0);
+        }
+
+    Mat6 singular = P0;
+    singular(5, 5) = 0.0;
+    EXPECT_THROW(cholesky(singular), AstroException);
+}
+
+TEST_F(CovarianceTest, LinearLandsOnEpochs)
+{
+    std::vector<EphemerisTime> epochs = { EphemerisTime(0.0), EphemerisTime(100.0), EphemerisTime(1234.5),
+                                          EphemerisTime(5000.0) };
+    auto res = Covariance::propagateLinear(ode, s0, P0, EphemerisTime(0.0), epochs, TimeDelta(60.0));
+    ASSERT_EQ(res.size(), epochs.size());
+
+    // Initial covariance at et0
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_DOUBLE_EQ(res[0].P(i, j), P0(i, j));
+
+    // The nominal state matches a plain propagation to the epoch
+    auto ref = RKF78::doSteps(ode, s0, EphemerisTime(0.0), epochs[2], TimeDelta(60.0));
+    EXPECT_EQ(res[2].et, epochs[2]);
+    EXPECT_NEAR(glm::length(res[2].s.r - ref.back().s.r), 0.0, 1.0E-5);
+
+    // Symmetric, and the position uncertainty grows
+    const Mat6& P = res.back().P;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_NEAR(P(i, j), P(j, i), 1.0E-12 * maxNorm(P));
+    EXPECT_GT(P(0, 0) + P(1, 1) + P(2, 2), 3.0E-2);
+
+    std::vector<EphemerisTime> unsorted = { EphemerisTime(100.0), EphemerisTime(50.0) };
+    EXPECT_THROW(Covariance::propagateLinear(ode, s0, P0, EphemerisTime(0.0), unsorted, TimeDelta(60.0)),
+                 AstroException);
+}
+
+// For small uncertainties the unscented transform agrees with the linear
+// propagation
+TEST_F(CovarianceTest, UnscentedMatchesLinear)
+{
+    std::vector<EphemerisTime> epochs = { EphemerisTime(1500.0), EphemerisTime(6000.0) };
+    auto lin = Covariance::propagateLinear(ode, s0, P0, EphemerisTime(0.0), epochs, TimeDelta(60.0));
+    auto ut  = Covariance::propagateUnscented(ode, s0, P0, EphemerisTime(0.0), epochs, TimeDelta(60.0));
+    ASSERT_EQ(ut.size(), 2u);
+
+    for (size_t e = 0; e < epochs.size(); ++e)
+    {
+        EXPECT_EQ(ut[e].et, epochs[e]);
+        EXPECT_NEAR(glm::length(ut[e].s.r - lin[e].s.r), 0.0, 1.0E-3);
+
+        const Mat6& Pl = lin[e].P;
+        const Mat6& Pu = ut[e].P;
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j)
+                EXPECT_NEAR(Pu(i, j), Pl(i, j), 1.0E-3 * std::sqrt(Pl(i, i) * Pl(j, j)));
+    }
+
+    // Same result on one thread
+    auto ut1 = Covariance::propagateUnscented(ode, s0, P0, EphemerisTime(0.0), epochs, TimeDelta(60.0), 1);
+    EXPECT_EQ(ut1.back().P(0, 0), ut.back().P(0, 0));
+
+    EXPECT_THROW(Covariance::setUnscentedParameters(0.0, 2.0, 0.0), AstroException);
+}
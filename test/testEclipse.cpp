@@ -0,0 +1,164 @@
+#include "../astro/Eclipse.h"
+#include "../astro/RadiationPressure.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Util.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+
+using namespace astro;
+
+class EclipseTest : public ::testing::Test {
+
+protected:
+    EclipseTest();
+
+    virtual ~EclipseTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    // Visible fraction of the Sun at the position r relative to the Earth
+    double illumination(const Vec3& r, const EphemerisTime& et) const;
+
+    double        mu_earth;
+    double        re;
+    EphemerisTime et0;
+    EphemerisTime et1;
+    std::shared_ptr<EphemerisCache> ephemeris;
+};
+
+
+
+EclipseTest::EclipseTest()
+  :  mu_earth(398600.4418), re(6378.137)
+{
+
+}
+
+EclipseTest::~EclipseTest()
+{
+
+}
+
+void EclipseTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+    et0 = EphemerisTime::fromString("2018-06-12 00:00 UTC");
+    et1 = et0 + TimeDelta(86400.0);
+    ephemeris = std::make_shared<EphemerisCache>(std::vector<int>{ 10, 399 }, et0 + TimeDelta(-3600.0),
+                                                 et1 + TimeDelta(3600.0), TimeDelta(3600.0));
+}
+
+void EclipseTest::TearDown()
+{
+}
+
+double EclipseTest::illumination(const Vec3& r, const EphemerisTime& et) const
+{
+    Vec3 sun, earth;
+    ephemeris->getPosition(10, et, sun);
+    ephemeris->getPosition(399, et, earth);
+    return SolarRadiationPressure::shadow(r, sun - earth, Vec3(0.0), re);
+}
+
+TEST_F(EclipseTest, LowEarthOrbit)
+{
+    // A circular orbit through the shadow of the Earth, about 15 revolutions
+    PosState s0(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 6.6, std::sqrt(mu_earth / 7000.0 - 6.6 * 6.6)));
+    SimpleOrbit orbit(OrbitElements::fromStateVectorOE(s0, et0, mu_earth));
+
+    EclipseFinder finder(ephemeris);
+    auto res = finder.find(orbit, et0, et1);
+
+    // Sampled every second, the shadow is entered and left at the same times
+    std::vector<std::pair<double, double>> pen, umb;
+    bool inPen = false, inUmb = false;
+    for (double t = 0.0; t <= 86400.0; t += 1.0)
+    {
+        EphemerisTime et = et0 + TimeDelta(t);
+        double nu = illumination(orbit.getState(et).r, et);
+        if ((nu < 1.0) != inPen)
+        {
+            if (!inPen) pen.push_back({ t, 86400.0 });
+            else        pen.back().second = t;
+            inPen = !inPen;
+        }
+        if ((nu == 0.0) != inUmb)
+        {
+            if (!inUmb) umb.push_back({ t, 86400.0 });
+            else        umb.back().second = t;
+            inUmb = !inUmb;
+        }
+    }
+    ASSERT_GT(pen.size(), 10u);
+
+    size_t np = 0, nu = 0;
+    for (const auto& e : res)
+    {
+        EXPECT_EQ(e.object, 0u);
+        EXPECT_EQ(e.occulter, 399);
+        EXPECT_NE(e.type, EclipseType::Annular);
+        auto& ref = (e.type == EclipseType::Penumbra) ? pen : umb;
+        size_t& k = (e.type == EclipseType::Penumbra) ? np : nu;
+        ASSERT_LT(k, ref.size());
+        // The sampled transitions are up to a second late
+        EXPECT_NEAR((e.start - et0).value, ref[k].first - 0.5, 0.5 + 1.0E-3);
+        if (ref[k].second < 86400.0)
+            EXPECT_NEAR((e.end - et0).value, ref[k].second - 0.5, 0.5 + 1.0E-3);
+        ++k;
+
+        // Sunlit just outside the penumbra, and in full shadow inside the umbra
+        if (e.type == EclipseType::Penumbra && et0 < e.start)
+            EXPECT_EQ(illumination(orbit.getState(e.start + TimeDelta(-0.01)).r, e.start + TimeDelta(-0.01)), 1.0);
+        if (e.type == EclipseType::Umbra && et0 < e.start)
+            EXPECT_EQ(illumination(orbit.getState(e.start + TimeDelta(0.01)).r, e.start + TimeDelta(0.01)), 0.0);
+    }
+    EXPECT_EQ(np, pen.size());
+    EXPECT_EQ(nu, umb.size());
+
+    // Ordered by start time
+    for (size_t k = 1; k < res.size(); ++k)
+        EXPECT_FALSE(res[k].start < res[k - 1].start);
+}
+
+TEST_F(EclipseTest, Catalog)
+{
+    // In shadow at the start, and an orbit that never enters it: far from the
+    // Earth, above the pole of the ecliptic
+    Vec3 sun, earth;
+    ephemeris->getPosition(10, et0, sun);
+    ephemeris->getPosition(399, et0, earth);
+    Vec3 night = glm::normalize(earth - sun);
+
+    PosState shadowed(night * 7000.0, glm::normalize(glm::cross(night, Vec3(0.0, 0.0, 1.0))) * std::sqrt(mu_earth / 7000.0));
+    SimpleOrbit a(OrbitElements::fromStateVectorOE(shadowed, et0, mu_earth));
+    SimpleOrbit b(OrbitElements::fromStateVectorOE(PosState(Vec3(0.0, 0.0, 4.0E5), Vec3(0.5, 0.0, 0.0)), et0, mu_earth));
+    std::vector<Orbit*> catalog = { &a, &b };
+
+    EclipseFinder finder(ephemeris);
+    auto res = finder.find(catalog, et0, et0 + TimeDelta(3600.0), 2);
+    ASSERT_GE(res.size(), 2u);
+    EXPECT_EQ(res[0].object, 0u);
+    EXPECT_EQ(res[0].start.getETValue(), et0.getETValue());
+    for (const auto& e : res)
+        EXPECT_EQ(e.object, 0u);
+
+    // The same with one thread
+    auto res1 = finder.find(catalog, et0, et0 + TimeDelta(3600.0), 1);
+    ASSERT_EQ(res1.size(), res.size());
+    for (size_t k = 0; k < res.size(); ++k)
+        EXPECT_EQ(res1[k].end.getETValue(), res[k].end.getETValue());
+
+    EXPECT_THROW(finder.addOcculter(301, 0.0), AstroException);
+    EXPECT_THROW(finder.setStepLimits(TimeDelta(10.0), TimeDelta(1.0)), AstroException);
+    EXPECT_THROW(EclipseFinder(nullptr), AstroException);
+}
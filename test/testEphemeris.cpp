@@ -0,0 +1,158 @@
+#include "../astro/SpiceCore.h"
+#include "../astro/Ephemeris.h"
+#include "../astro/Observer.h"
+#include "../astro/ReferenceFrame.h"
+#include "../astro/Time.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class EphemerisTest : public ::testing::Test {
+
+protected:
+    EphemerisTest();
+
+    virtual ~EphemerisTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+};
+
+
+
+EphemerisTest::EphemerisTest()
+{
+
+}
+
+EphemerisTest::~EphemerisTest()
+{
+
+}
+
+void EphemerisTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+}
+
+void EphemerisTest::TearDown()
+{
+}
+
+static const double SPEED_OF_LIGHT = 299792.458; // [km/s]
+
+static astro::Observer shipAtEarth()
+{
+    astro::State stateShip;
+    stateShip.P.r = Vec3(-6045.0, -3490.0, 2500.0);  //[km]
+    stateShip.P.v = Vec3(-3.457, 6.618, 2.533);      //[km/s]
+    return astro::Observer(399, astro::ReferenceFrame::createJ2000(), stateShip);
+}
+
+TEST_F(EphemerisTest, CacheMatchesSpice)
+{
+    astro::EphemerisTime et0 = astro::EphemerisTime::fromString("2018-06-12 00:00 UTC");
+    astro::EphemerisCache cache({ 10, 399, 301, 4 }, et0, et0 + TimeDelta(2.0 * 86400.0), TimeDelta(3600.0));
+    ASSERT_TRUE(cache.hasBody(0));
+    ASSERT_TRUE(cache.hasBody(301));
+    ASSERT_FALSE(cache.hasBody(5));
+
+    for (double t = 100.0; t < 2.0 * 86400.0; t += 5432.1)
+    {
+        astro::EphemerisTime et = et0 + TimeDelta(t);
+        for (int body : { 10, 399, 301, 4 })
+        {
+            astro::PosState spice, cached;
+            astro::Spice().getRelativeGeometricState(body, 0, et, spice);
+            cache.getState(body, et, cached);
+            ASSERT_LT(glm::length(spice.r - cached.r), 1.0E-3);
+            ASSERT_LT(glm::length(spice.v - cached.v), 1.0E-6);
+        }
+    }
+
+    astro::PosState s;
+    ASSERT_THROW(cache.getState(5, et0, s), astro::AstroException);
+    ASSERT_THROW(cache.getState(399, et0 + TimeDelta(-1.0), s), astro::AstroException);
+}
+
+TEST_F(EphemerisTest, Corrections)
+{
+    astro::EphemerisTime et0 = astro::EphemerisTime::fromString("2018-06-12 00:00 UTC");
+    astro::EphemerisCache cache({ 10, 399, 301, 4, 5 }, et0, et0 + TimeDelta(2.0 * 86400.0), TimeDelta(3600.0));
+    astro::EphemerisTime et = et0 + TimeDelta(86400.0);
+    astro::Observer obs = shipAtEarth();
+    std::vector<int> targets = { 10, 301, 4, 5 };
+
+    // Geometric positions
+    std::vector<Vec3> geo;
+    cache.getApparentPositions(obs, targets, et, geo, astro::AberrationCorrection::None);
+    ASSERT_EQ(geo.size(), targets.size());
+    astro::PosState earth;
+    cache.getState(399, et, earth);
+    Vec3 obsSSB = earth.r + obs.getState().P.r;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        astro::PosState tgt;
+        cache.getState(targets[i], et, tgt);
+        ASSERT_LT(glm::length(geo[i] - (tgt.r - obsSSB)), 1.0E-9);
+    }
+
+    // Converged light time: the target is seen where it was when the light left it
+    std::vector<Vec3> cn;
+    cache.getApparentPositions(obs, targets, et, cn, astro::AberrationCorrection::CNLightTime);
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        double lt = glm::length(cn[i]) / SPEED_OF_LIGHT;
+        astro::PosState tgt;
+        cache.getState(targets[i], et + TimeDelta(-lt), tgt);
+        ASSERT_LT(glm::length(cn[i] - (tgt.r - obsSSB)), 1.0E-6);
+    }
+
+    // Stellar aberration shifts the direction by at most |v|/c
+    std::vector<Vec3> cns;
+    cache.getApparentPositions(obs, targets, et, cns, astro::AberrationCorrection::CNLightTimeStellar);
+    double vc = glm::length(earth.v + obs.getState().P.v) / SPEED_OF_LIGHT;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        ASSERT_NEAR(glm::length(cns[i]), glm::length(cn[i]), 1.0E-6);
+        double angle = std::acos(glm::dot(glm::normalize(cns[i]), glm::normalize(cn[i])));
+        ASSERT_GT(angle, 0.0);
+        ASSERT_LE(angle, vc * 1.0000001);
+    }
+
+    // Targets and observer centers must be cached
+    std::vector<Vec3> out;
+    ASSERT_THROW(cache.getApparentPositions(obs, { 6 }, et, out), astro::AstroException);
+}
+
+TEST_F(EphemerisTest, ApparentPositionsMatchSpice)
+{
+    astro::EphemerisTime et0 = astro::EphemerisTime::fromString("2018-06-12 00:00 UTC");
+    astro::EphemerisCache cache({ 10, 399, 301, 4, 5 }, et0, et0 + TimeDelta(2.0 * 86400.0), TimeDelta(3600.0));
+    astro::EphemerisTime et = et0 + TimeDelta(86400.0);
+    astro::Observer obs = shipAtEarth();
+    std::vector<int> targets = { 10, 301, 4, 5 };
+
+    for (auto abcorr : { astro::AberrationCorrection::LightTime,
+                         astro::AberrationCorrection::LightTimeStellar,
+                         astro::AberrationCorrection::CNLightTime,
+                         astro::AberrationCorrection::CNLightTimeStellar })
+    {
+        std::vector<Vec3> pos;
+        cache.getApparentPositions(obs, targets, et, pos, abcorr);
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            Vec3 spice;
+            astro::Spice().getRelativePosition(targets[i], obs, et, spice, abcorr);
+            ASSERT_LT(glm::length(pos[i] - spice), 1.0E-3);
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include "../astro/ForceModel.h"
+#include "../astro/ODE.h"
+#include "../astro/Ephemeris.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Symplectic.h"
+#include "../astro/RKF78.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class ForceModelTest : public ::testing::Test {
+
+protected:
+    ForceModelTest();
+
+    virtual ~ForceModelTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double mu_earth;
+    double re;
+    std::vector<double> J;
+    astro::Attractor earth;
+};
+
+
+
+ForceModelTest::ForceModelTest()
+  :  mu_earth(398600.4418), re(6378.137), J({ 1.08262668E-3, -2.53265649E-6, -1.61962159E-6 }),
+     earth({ Vec3(0.0), 398600.4418 })
+{
+
+}
+
+ForceModelTest::~ForceModelTest()
+{
+
+}
+
+void ForceModelTest::SetUp()
+{
+}
+
+void ForceModelTest::TearDown()
+{
+}
+
+// Zonal part of the geopotential, -(GM/r) sum Jn (re/r)^n Pn(sin(lat)); the
+// acceleration is its gradient
+static double zonalPotential(const Vec3& r, double GM, double re, const std::vector<double>& J)
+{
+    double R = glm::length(r);
+    double s = r.z / R;
+    double P[3] = { 0.5 * (3.0 * s * s - 1.0),
+                    0.5 * (5.0 * s * s * s - 3.0 * s),
+                    (35.0 * s * s * s * s - 30.0 * s * s + 3.0) / 8.0 };
+    double U = 0.0;
+    for (int n = 0; n < 3; ++n)
+        U -= GM / R * J[n] * std::pow(re / R, n + 2) * P[n];
+    return U;
+}
+
+TEST_F(ForceModelTest, ZonalHarmonicsGradient)
+{
+    ZonalHarmonicsForce zonal(mu_earth, re, J);
+
+    const Vec3 positions[] = { Vec3(7000.0, 0.0, 0.0), Vec3(4000.0, -3000.0, 5000.0),
+                               Vec3(-1000.0, 2000.0, -6800.0), Vec3(0.0, 0.0, 8000.0) };
+    const double h = 1.0E-2;
+    for (const Vec3& r : positions)
+    {
+        Vec3 a(0.0);
+        zonal.accumulate(PosState(r, Vec3(0.0)), EphemerisTime(0.0), a);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Vec3 dr(0.0);
+            dr[i] = h;
+            double grad = (zonalPotential(r + dr, mu_earth, re, J) - zonalPotential(r - dr, mu_earth, re, J)) / (2.0 * h);
+            EXPECT_NEAR(grad, a[i], 1.0E-6 * glm::length(a) + 1.0E-15);
+        }
+    }
+
+    // J2 only: radial acceleration in the equatorial plane is -3/2 J2 mu re^2 / r^4
+    ZonalHarmonicsForce j2(mu_earth, re, { J[0] });
+    Vec3 a(0.0);
+    j2.accumulate(PosState(Vec3(7000.0, 0.0, 0.0), Vec3(0.0)), EphemerisTime(0.0), a);
+    EXPECT_NEAR(a.x, -1.5 * J[0] * mu_earth * re * re / std::pow(7000.0, 4.0), 1.0E-18);
+
+    EXPECT_THROW(ZonalHarmonicsForce(mu_earth, re, { 1.0, 2.0, 3.0, 4.0 }), AstroException);
+}
+
+TEST_F(ForceModelTest, RuntimeMatchesStatic)
+{
+    auto atmosphere = std::make_shared<ExponentialAtmosphere>();
+
+    PointMassForce      pm(earth);
+    ZonalHarmonicsForce zonal(mu_earth, re, J);
+    ThrustForce         thrust(Vec3(1.0E-6, 0.0, -2.0E-6));
+    DragForce           drag(atmosphere, 2.2, 4.0, 500.0);
+
+    ForceModel runtime;
+    runtime.add(pm);
+    runtime.add(zonal);
+    runtime.add(thrust);
+    runtime.add(drag);
+    EXPECT_EQ(runtime.size(), 4u);
+
+    StaticForceModel<PointMassForce, ZonalHarmonicsForce, ThrustForce, DragForce> fixed(pm, zonal, thrust, drag);
+    EXPECT_DOUBLE_EQ(fixed.get<3>().getBallisticCoefficient(), 2.2 * 4.0 / 500.0);
+
+    PosState s(Vec3(6778.0, 100.0, 200.0), Vec3(0.1, 7.6, 0.5));
+    EphemerisTime et(0.0);
+    PosState d1 = runtime.rates(et, s);
+    PosState d2 = fixed.rates(et, s);
+    EXPECT_EQ(d1.r, s.v);
+    EXPECT_EQ(d2.r, s.v);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_DOUBLE_EQ(d1.v[i], d2.v[i]);
+
+    // Drag opposes the velocity relative to the atmosphere
+    Vec3 a(0.0);
+    drag.accumulate(s, et, a);
+    EXPECT_LT(glm::dot(a, s.v), 0.0);
+}
+
+TEST_F(ForceModelTest, ODEBuildsForceModel)
+{
+    ODE ode;
+    ode.addAttractor(earth);
+    EXPECT_EQ(ode.getForceModel().size(), 1u);
+
+    // Disabled perturbations are not evaluated
+    ode.setForce(Vec3(0.0));
+    EXPECT_EQ(ode.getForceModel().size(), 1u);
+    ode.setMass(100.0);
+    ode.setForce(Vec3(1.0E-3, 0.0, 0.0));
+    EXPECT_EQ(ode.getForceModel().size(), 2u);
+
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, re, J));
+    EXPECT_EQ(ode.getForceModel().size(), 3u);
+
+    StaticForceModel<PointMassForce, ThrustForce, ZonalHarmonicsForce> fixed(
+        PointMassForce(earth), ThrustForce(Vec3(1.0E-5, 0.0, 0.0)), ZonalHarmonicsForce(mu_earth, re, J));
+
+    PosState s(Vec3(5000.0, -4000.0, 3000.0), Vec3(-2.0, 1.0, 6.5));
+    PosState d1 = ode.rates(EphemerisTime(0.0), s);
+    PosState d2 = fixed.rates(EphemerisTime(0.0), s);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_NEAR(d1.v[i], d2.v[i], 1.0E-18);
+
+    // Added terms survive a change of the built-in ones
+    ode.setForce(Vec3(0.0));
+    EXPECT_EQ(ode.getForceModel().size(), 2u);
+    ode.clearForceTerms();
+    EXPECT_EQ(ode.getForceModel().size(), 1u);
+
+    EXPECT_THROW(ode.addForceTerm(std::shared_ptr<const ForceTerm>()), AstroException);
+}
+
+TEST_F(ForceModelTest, ThirdBodyTidal)
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+    EphemerisTime et0(0.0);
+    auto ephemeris = std::make_shared<EphemerisCache>(std::vector<int>{ 399, 301 }, et0,
+                                                      et0 + TimeDelta(86400.0), TimeDelta(3600.0));
+    const double mu_moon = 4902.800066;
+    ThirdBodyForce moon(ephemeris, 301, mu_moon);
+
+    // No perturbation at the center of the Earth
+    Vec3 a(0.0);
+    moon.accumulate(PosState(), et0, a);
+    EXPECT_NEAR(glm::length(a), 0.0, 1.0E-20);
+
+    // Tidal acceleration mu (1 / (d - r)^2 - 1 / d^2) towards the Moon along
+    // the Earth-Moon line
+    Vec3 m, e;
+    ephemeris->getPosition(301, et0, m);
+    ephemeris->getPosition(399, et0, e);
+    Vec3   s = m - e;
+    double d = glm::length(s);
+    Vec3   r = s * (7000.0 / d);
+    a = Vec3(0.0);
+    moon.accumulate(PosState(r, Vec3(0.0)), et0, a);
+    double tidal = mu_moon * (1.0 / ((d - 7000.0) * (d - 7000.0)) - 1.0 / (d * d));
+    EXPECT_NEAR(glm::dot(a, s / d), tidal, 1.0E-9 * tidal);
+    EXPECT_NEAR(glm::length(glm::cross(a, s / d)), 0.0, 1.0E-9 * tidal);
+
+    EXPECT_THROW(ThirdBodyForce(nullptr, 301, mu_moon), AstroException);
+}
+
+TEST_F(ForceModelTest, StaticWithSolvers)
+{
+    ODE ode;
+    ode.addAttractor(earth);
+    StaticForceModel<PointMassForce> fixed{ PointMassForce(earth) };
+
+    double   r = 7000.0;
+    PosState s(Vec3(r, 0.0, 0.0), Vec3(0.0, std::sqrt(mu_earth / r), 0.0));
+    EphemerisTime et0(0.0);
+    EphemerisTime et1(600.0);
+
+    auto res1 = Yoshida<4>::doSteps(ode, s, et0, et1, TimeDelta(10.0));
+    auto res2 = Yoshida<4, StaticForceModel<PointMassForce>>::doSteps(fixed, s, et0, et1, TimeDelta(10.0));
+    ASSERT_EQ(res1.size(), res2.size());
+    EXPECT_NEAR(glm::length(res1.back().s.r - res2.back().s.r), 0.0, 1.0E-9);
+
+    // Adaptive steps through RKF78::step
+    auto f = [&](double t, const PosState& x) { return fixed.rates(EphemerisTime(t), x); };
+    PosState next;
+    double   h_next;
+    ASSERT_TRUE(RKF78::step(f, s, 0.0, 60.0, 1.0, next, h_next));
+    EXPECT_NEAR(glm::length(next.r), r, 1.0E-6);
+}
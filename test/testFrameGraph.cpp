@@ -0,0 +1,208 @@
+#include "../astro/SpiceCore.h"
+#include "../astro/ReferenceFrame.h"
+#include "../astro/FrameGraph.h"
+#include "../astro/Orbit.h"
+#include "../astro/State.h"
+#include "../astro/Time.h"
+#include "../astro/Util.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class FrameGraphTest : public ::testing::Test {
+
+protected:
+    FrameGraphTest();
+
+    virtual ~FrameGraphTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+};
+
+
+
+FrameGraphTest::FrameGraphTest()
+{
+
+}
+
+FrameGraphTest::~FrameGraphTest()
+{
+
+}
+
+void FrameGraphTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/pck/pck00010.tpc");
+}
+
+void FrameGraphTest::TearDown()
+{
+}
+
+// A circular, inclined test orbit about the Earth, given in J2000
+class CircularOrbit : public Orbit
+{
+public:
+    CircularOrbit(double _radius, double _incl)
+        : radius(_radius), incl(_incl)
+    {}
+
+    virtual PosState getState(const EphemerisTime& et)
+    {
+        double n = std::sqrt(398600.4418 / (radius * radius * radius));
+        double u = n * et.getETValue();
+        Vec3 r(std::cos(u), std::sin(u) * std::cos(incl), std::sin(u) * std::sin(incl));
+        Vec3 v(-std::sin(u), std::cos(u) * std::cos(incl), std::cos(u) * std::sin(incl));
+        return PosState(radius * r, radius * n * v);
+    }
+
+private:
+    double radius;
+    double incl;
+};
+
+TEST_F(FrameGraphTest, BodyFixedMatchesState)
+{
+    FrameGraph graph;
+    ReferenceFrame rfearth = ReferenceFrame::createBodyFixedSpice(399);
+    FrameGraph::FrameId earth = graph.addBodyFixedFrame("EARTH_FIXED", rfearth);
+
+    EphemerisTime et(1.0E6);
+    State s;
+    s.P.r = Vec3(-6045.0, -3490.0, 2500.0);
+    s.P.v = Vec3(-3.457, 6.618, 2.533);
+
+    State expected = s.transform(ReferenceFrame::createJ2000(), rfearth, et);
+    State actual   = graph.transform(s, graph.getRoot(), earth, et);
+    ASSERT_LT(glm::length(actual.P.r - expected.P.r), 1.0E-9);
+    ASSERT_LT(glm::length(actual.P.v - expected.P.v), 1.0E-12);
+    ASSERT_LT(glm::length(actual.R.q - expected.R.q), 1.0E-14);
+}
+
+TEST_F(FrameGraphTest, Topocentric)
+{
+    FrameGraph graph;
+    FrameGraph::FrameId earth = graph.addBodyFixedFrame("EARTH_FIXED", ReferenceFrame::createBodyFixedSpice(399));
+    double lon = 10.0 * RADPERDEG;
+    double lat = 60.0 * RADPERDEG;
+    FrameGraph::FrameId site = graph.addTopocentricFrame("SITE", earth, lon, lat, 0.1, 6378.137, 0.0);
+
+    EphemerisTime et(5000.0);
+
+    // The site itself is at the origin of its frame, and at rest
+    PosState siteFixed(Vec3(6378.237 * std::cos(lat) * std::cos(lon),
+                            6378.237 * std::cos(lat) * std::sin(lon),
+                            6378.237 * std::sin(lat)), Vec3(0.0));
+    PosState topo = graph.transform(siteFixed, earth, site, et);
+    ASSERT_LT(glm::length(topo.r), 1.0E-9);
+    ASSERT_LT(glm::length(topo.v), 1.0E-12);
+
+    // On a spherical body, zenith is along the site position
+    PosState zenith = graph.transform(PosState(Vec3(0.0, 0.0, 100.0), Vec3(0.0)), site, earth, et);
+    Vec3 dir = glm::normalize(zenith.r - siteFixed.r);
+    ASSERT_LT(glm::length(dir - glm::normalize(siteFixed.r)), 1.0E-12);
+
+    // Roundtrip through J2000
+    PosState j2000 = graph.transform(topo, site, graph.getRoot(), et);
+    PosState back  = graph.transform(j2000, graph.getRoot(), site, et);
+    ASSERT_LT(glm::length(back.r - topo.r), 1.0E-9);
+    ASSERT_LT(glm::length(back.v - topo.v), 1.0E-12);
+}
+
+TEST_F(FrameGraphTest, OrbitFrames)
+{
+    FrameGraph graph;
+    auto orbit = std::make_shared<CircularOrbit>(7000.0, 0.5);
+    FrameGraph::FrameId rsw  = graph.addOrbitFrame("RSW", graph.getRoot(), RSWFrame, orbit);
+    FrameGraph::FrameId lvlh = graph.addOrbitFrame("LVLH", graph.getRoot(), LVLHFrame, orbit);
+    FrameGraph::FrameId vnc  = graph.addOrbitFrame("VNC", graph.getRoot(), VNCFrame, orbit);
+
+    EphemerisTime et(1234.0);
+    PosState sat = orbit->getState(et);
+
+    // The satellite is at rest at the origin of its own frames
+    for (FrameGraph::FrameId f : { rsw, lvlh, vnc })
+    {
+        PosState s = graph.transform(sat, graph.getRoot(), f, et);
+        ASSERT_LT(glm::length(s.r), 1.0E-9);
+        ASSERT_LT(glm::length(s.v), 1.0E-9);
+    }
+
+    // A point 1 km further out is radial in RSW and up (-z) in LVLH
+    PosState above(sat.r * (7001.0 / 7000.0), sat.v * (7001.0 / 7000.0));
+    PosState inRsw = graph.transform(above, graph.getRoot(), rsw, et);
+    ASSERT_LT(glm::length(inRsw.r - Vec3(1.0, 0.0, 0.0)), 1.0E-9);
+    PosState inLvlh = graph.transform(above, graph.getRoot(), lvlh, et);
+    ASSERT_LT(glm::length(inLvlh.r - Vec3(0.0, 0.0, -1.0)), 1.0E-9);
+
+    // For a circular orbit, S in RSW and V in VNC coincide
+    PosState ahead(sat.r + glm::normalize(sat.v), sat.v);
+    ASSERT_NEAR(graph.transform(ahead, graph.getRoot(), rsw, et).r.y, 1.0, 1.0E-9);
+    ASSERT_NEAR(graph.transform(ahead, graph.getRoot(), vnc, et).r.x, 1.0, 1.0E-9);
+
+    // A point fixed in the rotating RSW frame moves with the frame rate in J2000
+    double n = std::sqrt(398600.4418 / (7000.0 * 7000.0 * 7000.0));
+    PosState fixedPoint = graph.transform(PosState(Vec3(1.0, 0.0, 0.0), Vec3(0.0)), rsw, graph.getRoot(), et);
+    ASSERT_NEAR(glm::length(fixedPoint.v), 7001.0 * n, 1.0E-9);
+
+    // Converting between sibling frames composes through their common parent
+    PosState viaRoot = graph.transform(graph.transform(above, graph.getRoot(), rsw, et), rsw, vnc, et);
+    PosState direct  = graph.transform(above, graph.getRoot(), vnc, et);
+    ASSERT_LT(glm::length(viaRoot.r - direct.r), 1.0E-9);
+    ASSERT_LT(glm::length(viaRoot.v - direct.v), 1.0E-9);
+}
+
+TEST_F(FrameGraphTest, TopocentricToOrbit)
+{
+    FrameGraph graph;
+    FrameGraph::FrameId earth = graph.addBodyFixedFrame("EARTH_FIXED", ReferenceFrame::createBodyFixedSpice(399));
+    FrameGraph::FrameId site  = graph.addTopocentricFrame("SITE", earth, 0.3, 0.7, 0.0, 6378.137, 1.0 / 298.257);
+    auto orbit = std::make_shared<CircularOrbit>(7000.0, 1.0);
+    FrameGraph::FrameId rsw   = graph.addOrbitFrame("RSW", graph.getRoot(), RSWFrame, orbit);
+
+    // Multi-hop conversion must equal the explicit chain
+    for (double t = 0.0; t < 5000.0; t += 1000.0)
+    {
+        EphemerisTime et(t);
+        PosState s(Vec3(100.0, 200.0, 300.0), Vec3(0.1, 0.2, 0.3));
+        PosState direct = graph.transform(s, site, rsw, et);
+        PosState chain  = graph.transform(graph.transform(graph.transform(s, site, earth, et),
+                                                          earth, graph.getRoot(), et),
+                                          graph.getRoot(), rsw, et);
+        ASSERT_LT(glm::length(direct.r - chain.r), 1.0E-8);
+        ASSERT_LT(glm::length(direct.v - chain.v), 1.0E-11);
+
+        // The composed transformation and its inverse must cancel
+        StateTransform st = graph.getTransform(site, rsw, et) * graph.getTransform(rsw, site, et);
+        ASSERT_LT(glm::length(st.o), 1.0E-8);
+        ASSERT_LT(glm::length(st.vo), 1.0E-11);
+    }
+}
+
+TEST_F(FrameGraphTest, SpiceFrames)
+{
+    FrameGraph graph;
+    FrameGraph::FrameId ecl = graph.addSpiceFrame("ECLIPJ2000");
+    ASSERT_EQ(graph.getType(ecl), SpiceFrame);
+    ASSERT_EQ(graph.getFrame("ECLIPJ2000"), ecl);
+
+    // The ecliptic pole is tilted by the obliquity from the J2000 pole
+    PosState pole = graph.transform(PosState(Vec3(0.0, 0.0, 1.0), Vec3(0.0)), ecl, graph.getRoot(), EphemerisTime(0.0));
+    ASSERT_NEAR(std::acos(pole.r.z) * DEGPERRAD, 23.439, 1.0E-3);
+    ASSERT_LT(glm::length(pole.v), 1.0E-15);
+
+    ASSERT_THROW(graph.addSpiceFrame("TULL"), AstroException);
+    ASSERT_THROW(graph.addSpiceFrame("ECLIPJ2000"), AstroException);
+    ASSERT_THROW(graph.getFrame("TULL"), AstroException);
+    ASSERT_THROW(graph.getTransform(ecl, 42, EphemerisTime(0.0)), AstroException);
+}
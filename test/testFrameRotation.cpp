@@ -0,0 +1,128 @@
+#include "../astro/SpiceCore.h"
+#include "../astro/ReferenceFrame.h"
+#include "../astro/FrameRotation.h"
+#include "../astro/Time.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class FrameRotationTest : public ::testing::Test {
+
+protected:
+    FrameRotationTest();
+
+    virtual ~FrameRotationTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+};
+
+
+
+FrameRotationTest::FrameRotationTest()
+{
+
+}
+
+FrameRotationTest::~FrameRotationTest()
+{
+
+}
+
+void FrameRotationTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/pck/pck00010.tpc");
+}
+
+void FrameRotationTest::TearDown()
+{
+}
+
+static double maxDiff(const Mat3& a, const Mat3& b)
+{
+    double d = 0.0;
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row)
+            d = std::max(d, std::abs(a[col][row] - b[col][row]));
+    return d;
+}
+
+TEST_F(FrameRotationTest, TransposeIsInverse)
+{
+    // The uncached rotation must be orthonormal, with transpose as inverse
+    astro::ReferenceFrame rf = ReferenceFrame::createBodyFixedSpice(399);
+    Mat3 M = rf.getRotationToJ2000(EphemerisTime(1.0E6));
+    ASSERT_LT(maxDiff(glm::transpose(M) * M, Mat3(1.0)), 1.0E-14);
+    ASSERT_LT(maxDiff(glm::transpose(M), glm::inverse(M)), 1.0E-14);
+}
+
+TEST_F(FrameRotationTest, CacheMatchesSpice)
+{
+    astro::ReferenceFrame rf = ReferenceFrame::createBodyFixedSpice(399);
+    EphemerisTime et0(0.0);
+    EphemerisTime et1(86400.0);
+    FrameRotationCache cache(399, et0, et1, TimeDelta(3600.0));
+
+    // Sample off-grid times
+    for (double t = 17.0; t < 86400.0; t += 1234.5)
+    {
+        Mat3 M_spice = rf.getRotationToJ2000(EphemerisTime(t));
+        Mat3 M_cache = cache.getRotationToJ2000(EphemerisTime(t));
+        ASSERT_LT(maxDiff(M_spice, M_cache), 1.0E-10);
+
+        // Quaternion and matrix forms must agree
+        Quat q = cache.getQuaternionToJ2000(EphemerisTime(t));
+        ASSERT_NEAR(glm::length(q), 1.0, 1.0E-14);
+        ASSERT_LT(maxDiff(glm::mat3_cast(q), M_cache), 1.0E-14);
+    }
+}
+
+TEST_F(FrameRotationTest, AngularVelocity)
+{
+    // The Earth rotates eastward about (roughly) J2000 +Z by about 7.292E-5 rad/s
+    FrameRotationCache cache(399, EphemerisTime(0.0), EphemerisTime(86400.0), TimeDelta(3600.0));
+    Vec3 w = cache.getAngularVelocity(EphemerisTime(5000.0));
+    ASSERT_NEAR(glm::length(w), 7.2921E-5, 1.0E-8);
+    ASSERT_GT(w.z / glm::length(w), 0.9999);
+
+    // Rotation rate must match a finite difference of the rotation
+    double dt = 1.0;
+    Mat3 dM_fd = (cache.getRotationToJ2000(EphemerisTime(5000.0 + dt)) -
+                  cache.getRotationToJ2000(EphemerisTime(5000.0 - dt))) * (0.5 / dt);
+    Mat3 dM = cache.getRotationRateToJ2000(EphemerisTime(5000.0));
+    ASSERT_LT(maxDiff(dM, dM_fd), 1.0E-12);
+}
+
+TEST_F(FrameRotationTest, OutOfSpanThrows)
+{
+    FrameRotationCache cache(399, EphemerisTime(0.0), EphemerisTime(3600.0), TimeDelta(600.0));
+    ASSERT_TRUE(cache.covers(EphemerisTime(3600.0)));
+    ASSERT_FALSE(cache.covers(EphemerisTime(3600.1)));
+    ASSERT_THROW(cache.getRotationToJ2000(EphemerisTime(-1.0)), astro::AstroException);
+    ASSERT_THROW(FrameRotationCache(399, EphemerisTime(0.0), EphemerisTime(3600.0), TimeDelta(0.0)), astro::AstroException);
+}
+
+TEST_F(FrameRotationTest, FrameUsesCache)
+{
+    astro::ReferenceFrame rf = ReferenceFrame::createBodyFixedSpice(399);
+    Mat3 M_spice = rf.getRotationToJ2000(EphemerisTime(1800.0));
+
+    rf.enableRotationCache(EphemerisTime(0.0), EphemerisTime(7200.0), TimeDelta(600.0));
+    ASSERT_TRUE(rf.getRotationCache() != nullptr);
+    Mat3 M_cache = rf.getRotationToJ2000(EphemerisTime(1800.0));
+    ASSERT_LT(maxDiff(M_spice, M_cache), 1.0E-10);
+
+    // Outside the cached span the frame falls back to Spice
+    ASSERT_NO_THROW(rf.getRotationToJ2000(EphemerisTime(10000.0)));
+
+    // A cache for another body is refused
+    auto moon = std::make_shared<const FrameRotationCache>(301, EphemerisTime(0.0), EphemerisTime(7200.0), TimeDelta(600.0));
+    ASSERT_THROW(rf.setRotationCache(moon), astro::AstroException);
+}
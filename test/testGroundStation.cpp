@@ -0,0 +1,158 @@
+#include "../astro/GroundStation.h"
+#include "../astro/FrameGraph.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Util.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+
+using namespace astro;
+
+class GroundStationTest : public ::testing::Test {
+
+protected:
+    GroundStationTest();
+
+    virtual ~GroundStationTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    // Circular equatorial orbit of radius r, at the longitude u at et0
+    std::unique_ptr<SimpleOrbit> equatorial(double r, double u) const;
+
+    double        mu_earth;
+    double        re;
+    EphemerisTime et0;
+};
+
+
+
+GroundStationTest::GroundStationTest()
+  :  mu_earth(398600.4418), re(6378.137), et0(0.0)
+{
+
+}
+
+GroundStationTest::~GroundStationTest()
+{
+
+}
+
+void GroundStationTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/pck/pck00010.tpc");
+}
+
+void GroundStationTest::TearDown()
+{
+}
+
+std::unique_ptr<SimpleOrbit> GroundStationTest::equatorial(double r, double u) const
+{
+    double v = std::sqrt(mu_earth / r);
+    PosState s(Vec3(r * std::cos(u), r * std::sin(u), 0.0), Vec3(-v * std::sin(u), v * std::cos(u), 0.0));
+    return std::unique_ptr<SimpleOrbit>(new SimpleOrbit(OrbitElements::fromStateVectorOE(s, et0, mu_earth)));
+}
+
+TEST_F(GroundStationTest, LookAngles)
+{
+    // On a non-rotating frame, at the equator and zero longitude
+    GroundStation st("EQ", ReferenceFrame::createJ2000(), 0.0, 0.0, 0.0);
+    EXPECT_NEAR(st.getPosition().x, re, 1.0E-9);
+
+    LookAngles la = st.lookAngles(PosState(Vec3(re + 1000.0, 0.0, 0.0), Vec3(2.0, 0.0, 0.0)), et0);
+    EXPECT_NEAR(la.elevation, astro::PIHALF, 1.0E-12);
+    EXPECT_NEAR(la.range, 1000.0, 1.0E-9);
+    EXPECT_NEAR(la.rangeRate, 2.0, 1.0E-12);
+
+    // North and east on the horizon
+    la = st.lookAngles(PosState(Vec3(re, 0.0, 1000.0), Vec3(0.0)), et0);
+    EXPECT_NEAR(la.elevation, 0.0, 1.0E-12);
+    EXPECT_NEAR(la.azimuth, 0.0, 1.0E-12);
+    la = st.lookAngles(PosState(Vec3(re, 1000.0, 0.0), Vec3(0.0)), et0);
+    EXPECT_NEAR(la.azimuth, astro::PIHALF, 1.0E-12);
+
+    // West, 45 degrees up
+    la = st.lookAngles(PosState(Vec3(re + 1000.0, -1000.0, 0.0), Vec3(0.0)), et0);
+    EXPECT_NEAR(la.azimuth, 1.5 * astro::PI, 1.0E-12);
+    EXPECT_NEAR(la.elevation, 0.25 * astro::PI, 1.0E-12);
+}
+
+TEST_F(GroundStationTest, TopocentricFrame)
+{
+    // Same as the topocentric frame of a frame graph, on the rotating Earth
+    ReferenceFrame earth = ReferenceFrame::createBodyFixedSpice(399);
+    GroundStation st("SITE", earth, 0.3, 0.7, 0.1);
+
+    FrameGraph graph;
+    FrameGraph::FrameId ef   = graph.addBodyFixedFrame("EARTH_FIXED", earth);
+    FrameGraph::FrameId site = graph.addTopocentricFrame("SITE", ef, 0.3, 0.7, 0.1, re, 1.0 / 298.257223563);
+
+    EphemerisTime et(1.0E8);
+    PosState s(Vec3(3000.0, 4000.0, 5000.0), Vec3(-3.0, 5.0, 2.0));
+    PosState a = st.toTopocentric(s, et);
+    PosState b = graph.transform(s, graph.getRoot(), site, et);
+    EXPECT_NEAR(glm::length(a.r - b.r), 0.0, 1.0E-8);
+    EXPECT_NEAR(glm::length(a.v - b.v), 0.0, 1.0E-11);
+}
+
+TEST_F(GroundStationTest, Passes)
+{
+    // A satellite on a circular equatorial orbit seen from a station on the
+    // equator of a non-rotating Earth: one symmetric pass per revolution, over
+    // the central angle where the elevation is above the mask
+    double r = 7000.0;
+    double n = std::sqrt(mu_earth / (r * r * r));
+    auto sat = equatorial(r, -1.0);
+    std::vector<Orbit*> sats = { sat.get() };
+
+    auto halfAngle = [&](double mask) { return std::acos(re * std::cos(mask) / r) - mask; };
+
+    std::vector<GroundStation> stations;
+    stations.push_back(GroundStation("ZERO", ReferenceFrame::createJ2000(), 0.0, 0.0, 0.0));
+    stations.push_back(GroundStation("MASKED", ReferenceFrame::createJ2000(), 0.0, 0.0, 0.0, 10.0 * astro::RADPERDEG));
+    // A pass of about 30 s, shorter than the step
+    stations.push_back(GroundStation("HIGH", ReferenceFrame::createJ2000(), 0.0, 0.0, 0.0, 80.0 * astro::RADPERDEG));
+
+    EphemerisTime et1 = et0 + TimeDelta(2.5 * astro::TWOPI / n);
+    auto windows = AccessFinder::find(stations, sats, et0, et1, TimeDelta(60.0), 1);
+    ASSERT_EQ(windows.size(), 9u);
+
+    for (const auto& w : windows)
+    {
+        const GroundStation& st = stations[w.station];
+        double a = halfAngle(st.getElevationMask());
+        int    k = static_cast<int>(&w - &windows[0]) % 3;
+        double tc = (1.0 + k * astro::TWOPI) / n;
+        EXPECT_NEAR((w.rise - et0).value, tc - a / n, 1.0E-3) << st.getName() << " " << k;
+        EXPECT_NEAR((w.set - et0).value, tc + a / n, 1.0E-3) << st.getName() << " " << k;
+        EXPECT_NEAR((w.culmination - et0).value, tc, 1.0E-2);
+        EXPECT_NEAR(w.maxElevation, astro::PIHALF, 1.0E-6);
+    }
+    EXPECT_LT((windows[6].set - windows[6].rise).value, 60.0);
+
+    // Already visible at the start, and still visible at the end
+    auto clipped = AccessFinder::find(stations, sats, et0 + TimeDelta(1.0 / n), et0 + TimeDelta(1.0 / n + 60.0),
+                                      TimeDelta(60.0));
+    ASSERT_EQ(clipped.size(), 3u);
+    EXPECT_EQ(clipped[0].rise.getETValue(), 1.0 / n);
+    EXPECT_EQ(clipped[0].set.getETValue(), 1.0 / n + 60.0);
+
+    // Independent of the number of threads
+    auto windows4 = AccessFinder::find(stations, sats, et0, et1, TimeDelta(60.0), 4);
+    ASSERT_EQ(windows4.size(), windows.size());
+    for (size_t k = 0; k < windows.size(); ++k)
+        EXPECT_EQ(windows4[k].rise.getETValue(), windows[k].rise.getETValue());
+
+    std::vector<GroundStation> mixed = { stations[0], GroundStation("ROT", ReferenceFrame::createBodyFixedSpice(399), 0.0, 0.0, 0.0) };
+    EXPECT_THROW(AccessFinder::find(mixed, sats, et0, et1, TimeDelta(60.0)), AstroException);
+}
@@ -0,0 +1,194 @@
+#include "../astro/Lambert.h"
+#include "../astro/OrbitElements.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class LambertTest : public ::testing::Test {
+
+protected:
+    LambertTest();
+
+    virtual ~LambertTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double mu_earth;
+    double mu_sun;
+};
+
+
+
+LambertTest::LambertTest()
+  :  mu_earth(398600.4418), mu_sun(1.32712440018E11)
+{
+
+}
+
+LambertTest::~LambertTest()
+{
+
+}
+
+void LambertTest::SetUp()
+{
+}
+
+void LambertTest::TearDown()
+{
+}
+
+TEST_F(LambertTest, Curtis)
+{
+    // H. Curtis, "Orbital Mechanics for Engineering Students", Example 5.2
+    Lambert::Solution sol = Lambert::solve(Vec3(5000.0, 10000.0, 2100.0), Vec3(-14600.0, 2500.0, 7000.0),
+                                           TimeDelta(3600.0), 398600.0);
+    EXPECT_NEAR(sol.v1.x, -5.9925, 1.0E-4);
+    EXPECT_NEAR(sol.v1.y,  1.9254, 1.0E-4);
+    EXPECT_NEAR(sol.v1.z,  3.2456, 1.0E-4);
+    EXPECT_NEAR(sol.v2.x, -3.3125, 1.0E-4);
+    EXPECT_NEAR(sol.v2.y, -4.1966, 1.0E-4);
+    EXPECT_NEAR(sol.v2.z, -0.38529, 1.0E-5);
+    EXPECT_LE(sol.iterations, 5);
+}
+
+TEST_F(LambertTest, KeplerRoundTrip)
+{
+    // Elliptic, hyperbolic and retrograde orbits, over less than one revolution
+    PosState starts[] = { PosState(Vec3(7000.0, 0.0, 500.0), Vec3(0.0, 8.5, 1.0)),
+                          PosState(Vec3(7000.0, 1000.0, 0.0), Vec3(-1.0, 12.0, 2.0)),
+                          PosState(Vec3(8000.0, 0.0, 0.0), Vec3(0.0, -7.0, 1.0)) };
+    bool retro[] = { false, false, true };
+
+    EphemerisTime et0(0.0);
+    for (int k = 0; k < 3; ++k)
+    {
+        OrbitElements oe = OrbitElements::fromStateVectorOE(starts[k], et0, mu_earth);
+        EphemerisTime et1 = et0 + TimeDelta(2000.0);
+        PosState s1 = oe.toStateVectorOE(et1);
+
+        Lambert::Solution sol = Lambert::solve(starts[k].r, s1.r, TimeDelta(2000.0), mu_earth, retro[k]);
+        EXPECT_NEAR(glm::length(sol.v1 - starts[k].v), 0.0, 1.0E-8);
+        EXPECT_NEAR(glm::length(sol.v2 - s1.v), 0.0, 1.0E-8);
+    }
+}
+
+TEST_F(LambertTest, MultiRevolution)
+{
+    PosState s0(Vec3(7000.0, 0.0, 500.0), Vec3(0.0, 8.0, 1.0));
+    EphemerisTime et0(0.0);
+    OrbitElements oe = OrbitElements::fromStateVectorOE(s0, et0, mu_earth);
+
+    // A bit more than two and a half revolutions
+    TimeDelta tof(2.6 * oe.T);
+    PosState  s1 = oe.toStateVectorOE(et0 + tof);
+
+    std::vector<Lambert::Solution> sols;
+    Lambert::solve(s0.r, s1.r, tof, mu_earth, sols, 5);
+    ASSERT_EQ(sols.size(), 5u);
+    EXPECT_EQ(sols[0].revs, 0);
+    EXPECT_EQ(sols[3].revs, 2);
+    EXPECT_FALSE(sols[3].right);
+    EXPECT_TRUE(sols[4].right);
+
+    // One of the two revolution solutions is the orbit itself
+    double best = 1.0;
+    for (const auto& sol : sols)
+        if (sol.revs == 2)
+            best = std::min(best, glm::length(sol.v1 - s0.v));
+    EXPECT_LT(best, 1.0E-8);
+
+    // Every solution ends at r2 after tof
+    for (const auto& sol : sols)
+    {
+        OrbitElements oes = OrbitElements::fromStateVectorOE(PosState(s0.r, sol.v1), et0, mu_earth);
+        EXPECT_NEAR(glm::length(oes.toStateVectorOE(et0 + tof).r - s1.r), 0.0, 1.0E-5);
+    }
+
+    // The solution vector is reused, and maxRevs limits it
+    Lambert::solve(s0.r, s1.r, tof, mu_earth, sols, 1);
+    EXPECT_EQ(sols.size(), 3u);
+
+    EXPECT_THROW(Lambert::solve(s0.r, s1.r, TimeDelta(-1.0), mu_earth), AstroException);
+    EXPECT_THROW(Lambert::solve(s0.r, 2.0 * s0.r, tof, mu_earth), AstroException);
+}
+
+TEST_F(LambertTest, PolarPlane)
+{
+    // The transfer plane contains the Z axis; solved as the short way
+    PosState s0(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 0.0, 8.0));
+    EphemerisTime et0(0.0);
+    OrbitElements oe = OrbitElements::fromStateVectorOE(s0, et0, mu_earth);
+    PosState s1 = oe.toStateVectorOE(et0 + TimeDelta(1500.0));
+    s1.r.y = 0.0; // Exactly in the XZ plane, but for rounding
+    s1.v.y = 0.0;
+
+    Lambert::Solution sol = Lambert::solve(s0.r, s1.r, TimeDelta(1500.0), mu_earth);
+    EXPECT_NEAR(glm::length(sol.v1 - s0.v), 0.0, 1.0E-8);
+    EXPECT_NEAR(glm::length(sol.v2 - s1.v), 0.0, 1.0E-8);
+}
+
+TEST_F(LambertTest, Porkchop)
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+
+    // Earth to Mars in the 2005 window
+    EphemerisTime dep0 = EphemerisTime::fromString("2005-07-01 00:00 UTC");
+    EphemerisTime arr0 = EphemerisTime::fromString("2006-01-01 00:00 UTC");
+    std::vector<EphemerisTime> deps, arrs;
+    for (int k = 0; k < 20; ++k)
+        deps.push_back(dep0 + TimeDelta(k * 4.0 * 86400.0));
+    for (int k = 0; k < 25; ++k)
+        arrs.push_back(arr0 + TimeDelta(k * 5.0 * 86400.0));
+
+    EphemerisCache eph({ 10, 399, 4 }, dep0 + TimeDelta(-86400.0), arrs.back() + TimeDelta(86400.0), TimeDelta(3600.0));
+    PorkchopGrid grid = Porkchop::compute(eph, 399, 4, 10, mu_sun, deps, arrs, 0, 1);
+    ASSERT_EQ(grid.c3.size(), deps.size() * arrs.size());
+
+    // The entries are the Lambert solutions between the cached states
+    PosState e, m, sun;
+    eph.getState(399, deps[7], e);
+    eph.getState(4, arrs[11], m);
+    eph.getState(10, deps[7], sun);
+    Vec3 rm = m.r;
+    eph.getState(10, arrs[11], m);
+    Lambert::Solution sol = Lambert::solve(e.r - sun.r, rm - m.r, arrs[11] - deps[7], mu_sun);
+    double vd = glm::length(sol.v1 - (e.v - sun.v));
+    EXPECT_NEAR(grid.c3At(7, 11), vd * vd, 1.0E-10);
+
+    // About 16 km^2/s^2 at best, as flown by MRO
+    double minC3 = 1.0E10;
+    for (double c3 : grid.c3)
+        minC3 = std::min(minC3, c3);
+    EXPECT_GT(minC3, 12.0);
+    EXPECT_LT(minC3, 20.0);
+
+    // Independent of the number of threads
+    PorkchopGrid grid4 = Porkchop::compute(eph, 399, 4, 10, mu_sun, deps, arrs, 0, 4);
+    for (size_t k = 0; k < grid.c3.size(); ++k)
+    {
+        if (std::isnan(grid.c3[k]))
+            EXPECT_TRUE(std::isnan(grid4.c3[k]));
+        else
+        {
+            EXPECT_EQ(grid4.c3[k], grid.c3[k]);
+            EXPECT_EQ(grid4.vInfArrival[k], grid.vInfArrival[k]);
+        }
+    }
+
+    // No transfer backwards in time
+    std::vector<EphemerisTime> late = { arrs.back() };
+    PorkchopGrid back = Porkchop::compute(eph, 399, 4, 10, mu_sun, late, arrs, 0, 1);
+    EXPECT_TRUE(std::isnan(back.c3At(0, 0)));
+}
@@ -0,0 +1,180 @@
+#include "../astro/LieGroup.h"
+#include "../astro/PCDM.h"
+#include "../astro/Exceptions.h"
+#include "../astro/Util.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class LieGroupTest : public ::testing::Test {
+
+protected:
+    LieGroupTest();
+
+    virtual ~LieGroupTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    // Global angular momentum and kinetic energy
+    Vec3   angularMomentum(const RotState& rs) const;
+    double energy(const RotState& rs) const;
+
+    // Angle between two attitudes
+    static double angle(const Quat& a, const Quat& b);
+
+    Mat3     Ib;
+    RotState rs0;
+};
+
+
+
+LieGroupTest::LieGroupTest()
+  :  Ib(0.0)
+{
+    // Tumbling close to the intermediate axis
+    Ib[0][0] = 1.0;
+    Ib[1][1] = 2.0;
+    Ib[2][2] = 3.0;
+    rs0 = RotState(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.05, 1.0, 0.05));
+}
+
+LieGroupTest::~LieGroupTest()
+{
+
+}
+
+void LieGroupTest::SetUp()
+{
+}
+
+void LieGroupTest::TearDown()
+{
+}
+
+Vec3 LieGroupTest::angularMomentum(const RotState& rs) const
+{
+    return rs.q * (Ib * (glm::inverse(rs.q) * rs.w));
+}
+
+double LieGroupTest::energy(const RotState& rs) const
+{
+    return 0.5 * glm::dot(rs.w, angularMomentum(rs));
+}
+
+double LieGroupTest::angle(const Quat& a, const Quat& b)
+{
+    Quat d = glm::inverse(a) * b;
+    return 2.0 * std::asin(std::min(1.0, glm::length(Vec3(d.x, d.y, d.z))));
+}
+
+TEST_F(LieGroupTest, ExpRotation)
+{
+    Quat q = expRotation(Vec3(0.0, 0.0, PIHALF));
+    Vec3 x = q * Vec3(1.0, 0.0, 0.0);
+    EXPECT_NEAR(x.x, 0.0, 1.0E-15);
+    EXPECT_NEAR(x.y, 1.0, 1.0E-15);
+
+    // Small angles use the series
+    Quat s = expRotation(Vec3(1.0E-6, 0.0, 0.0));
+    EXPECT_NEAR(s.x, 0.5E-6, 1.0E-18);
+    EXPECT_NEAR(glm::length(s), 1.0, 1.0E-15);
+}
+
+TEST_F(LieGroupTest, RKMK4ConstantW)
+{
+    // Quarter turn about X in 5 large steps
+    RotODE rode;
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.1, 0.0, 0.0));
+    EphemerisTime et(0.0);
+    auto resv = RKMK4::doSteps(rode, rs, et, et + TimeDelta(PIHALF / 0.1), TimeDelta(PIHALF / 0.5));
+
+    Vec3 ey = resv.back().rs.q * Vec3(0.0, 1.0, 0.0);
+    EXPECT_NEAR(ey.y, 0.0, 1.0E-14);
+    EXPECT_NEAR(ey.z, 1.0, 1.0E-14);
+}
+
+TEST_F(LieGroupTest, RKMK4Order)
+{
+    RotODE rode(Ib);
+    rode.setBodyTorque(Vec3(0.01, 0.0, -0.02));
+    EphemerisTime et0(0.0), et1(10.0);
+
+    RotState ref = RKMK4::doSteps(rode, rs0, et0, et1, TimeDelta(1.0E-3)).back().rs;
+    RotState a   = RKMK4::doSteps(rode, rs0, et0, et1, TimeDelta(0.1)).back().rs;
+    RotState b   = RKMK4::doSteps(rode, rs0, et0, et1, TimeDelta(0.05)).back().rs;
+
+    double ea = angle(a.q, ref.q) + glm::length(a.w - ref.w);
+    double eb = angle(b.q, ref.q) + glm::length(b.w - ref.w);
+    EXPECT_GT(ea / eb, 12.0);
+    EXPECT_LT(ea / eb, 20.0);
+    EXPECT_NEAR(glm::length(a.q), 1.0, 1.0E-15);
+
+    // Far more accurate than PCDM at the same step
+    PCDM::Result p = PCDM::doSteps(rode, rs0, et0, et1, TimeDelta(0.05)).back();
+    EXPECT_LT(100.0 * eb, angle(p.rs.q, ref.q) + glm::length(p.rs.w - ref.w));
+}
+
+TEST_F(LieGroupTest, SplittingOrder)
+{
+    RotODE rode(Ib);
+    rode.setGlobalTorque(Vec3(0.0, 0.01, 0.01));
+    EphemerisTime et0(0.0), et1(10.0);
+    RotState ref = RKMK4::doSteps(rode, rs0, et0, et1, TimeDelta(1.0E-3)).back().rs;
+
+    int order = RigidBodySplitting::getOrder();
+    for (int p : { 2, 4 })
+    {
+        RigidBodySplitting::setOrder(p);
+        RotState a = RigidBodySplitting::doSteps(rode, rs0, et0, et1, TimeDelta(0.1)).back().rs;
+        RotState b = RigidBodySplitting::doSteps(rode, rs0, et0, et1, TimeDelta(0.05)).back().rs;
+
+        double ea = angle(a.q, ref.q) + glm::length(a.w - ref.w);
+        double eb = angle(b.q, ref.q) + glm::length(b.w - ref.w);
+        EXPECT_NEAR(std::log2(ea / eb), p, 0.3);
+    }
+    RigidBodySplitting::setOrder(order);
+
+    EXPECT_THROW(RigidBodySplitting::setOrder(3), AstroException);
+}
+
+TEST_F(LieGroupTest, SplittingLongRun)
+{
+    // 5000 s of free tumbling, with steps of a tenth of a second
+    RotODE rode(Ib);
+    EphemerisTime et0(0.0), et1(5000.0);
+    auto resv = RigidBodySplitting::doSteps(rode, rs0, et0, et1, TimeDelta(0.1));
+
+    Vec3   L0 = angularMomentum(rs0);
+    double E0 = energy(rs0);
+    double maxEarly = 0.0, maxLate = 0.0;
+    for (size_t i = 0; i < resv.size(); ++i)
+    {
+        const RotState& rs = resv[i].rs;
+        EXPECT_LT(glm::length(angularMomentum(rs) - L0), 1.0E-11);
+
+        // The energy error is bounded, the same at the end as at the start
+        double dE = std::abs(energy(rs) - E0);
+        if (i < resv.size() / 10)
+            maxEarly = std::max(maxEarly, dE);
+        else if (i > 9 * resv.size() / 10)
+            maxLate = std::max(maxLate, dE);
+    }
+    EXPECT_LT(maxEarly, 1.0E-2 * E0);
+    EXPECT_LT(maxLate, 1.5 * maxEarly);
+}
+
+TEST_F(LieGroupTest, SplittingNeedsPrincipalAxes)
+{
+    Mat3 I(1.0);
+    I[0][1] = I[1][0] = 0.1;
+    RotODE rode(I);
+    EXPECT_THROW(RigidBodySplitting::doStep(rode, rs0, EphemerisTime(0.0), TimeDelta(0.1)), AstroException);
+}
@@ -0,0 +1,180 @@
+#include "../astro/Maneuver.h"
+#include "../astro/ODE.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class ManeuverTest : public ::testing::Test {
+
+protected:
+    ManeuverTest();
+
+    virtual ~ManeuverTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    ThrustArc arc(double start, double stop, AttitudeLaw law, const Vec3& dir) const;
+
+    double   mu_earth;
+    PosState s0;
+};
+
+
+
+ManeuverTest::ManeuverTest()
+  :  mu_earth(398600.4418)
+{
+    s0 = PosState(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 7.546, 0.0));
+}
+
+ManeuverTest::~ManeuverTest()
+{
+
+}
+
+void ManeuverTest::SetUp()
+{
+}
+
+void ManeuverTest::TearDown()
+{
+}
+
+ThrustArc ManeuverTest::arc(double start, double stop, AttitudeLaw law, const Vec3& dir) const
+{
+    ThrustArc a;
+    a.start     = EphemerisTime(start);
+    a.stop      = EphemerisTime(stop);
+    a.thrust    = 100.0;
+    a.isp       = 300.0;
+    a.law       = law;
+    a.direction = dir;
+    return a;
+}
+
+TEST_F(ManeuverTest, RocketEquationInFreeSpace)
+{
+    ODE ode;
+    ManeuverSchedule schedule;
+    schedule.addArc(arc(0.0, 1000.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0)));
+
+    double m0 = 1000.0;
+    PosState s(Vec3(0.0), Vec3(0.0));
+    auto res = Maneuver::doSteps(ode, schedule, s, m0, EphemerisTime(0.0), EphemerisTime(1000.0),
+                                 TimeDelta(100.0));
+
+    const Maneuver::Result& last = res.back();
+    double m1 = m0 - 100.0 / (300.0 * G0) * 1000.0;
+    EXPECT_NEAR(last.m, m1, 1.0E-9);
+
+    // Tsiolkovsky, in km/s
+    double dv = 300.0 * G0 / 1000.0 * std::log(m0 / m1);
+    EXPECT_NEAR(last.s.v.x, dv, 1.0E-12);
+    EXPECT_NEAR(last.s.v.y, 0.0, 1.0E-15);
+}
+
+TEST_F(ManeuverTest, StepsLandOnArcBoundaries)
+{
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+
+    ManeuverSchedule schedule;
+    schedule.addArc(arc(130.0, 410.0, AttitudeLaw::VNB, Vec3(1.0, 0.0, 0.0)));
+
+    double m0 = 500.0;
+    auto res = Maneuver::doSteps(ode, schedule, s0, m0, EphemerisTime(0.0), EphemerisTime(1000.0),
+                                 TimeDelta(60.0));
+
+    bool atStart = false, atStop = false;
+    for (size_t i = 1; i < res.size(); ++i)
+    {
+        const Maneuver::Result& r = res[i];
+        double t = r.et.getETValue();
+        atStart |= t == 130.0;
+        atStop  |= t == 410.0;
+
+        // No step crosses a boundary
+        double t0 = res[i - 1].et.getETValue();
+        EXPECT_FALSE(t0 < 130.0 && t > 130.0);
+        EXPECT_FALSE(t0 < 410.0 && t > 410.0);
+
+        // Mass only changes while burning
+        if (t <= 130.0)
+            EXPECT_EQ(r.m, m0);
+        if (t0 >= 410.0)
+            EXPECT_EQ(r.m, res[i - 1].m);
+    }
+    EXPECT_TRUE(atStart);
+    EXPECT_TRUE(atStop);
+    EXPECT_EQ(res.back().et.getETValue(), 1000.0);
+    EXPECT_NEAR(res.back().m, m0 - 100.0 / (300.0 * G0) * 280.0, 1.0E-9);
+}
+
+TEST_F(ManeuverTest, ProgradeBurnRaisesEnergy)
+{
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+
+    auto energy = [&](const PosState& s) {
+        return 0.5 * glm::dot(s.v, s.v) - mu_earth / glm::length(s.r);
+    };
+
+    ManeuverSchedule coast;
+    ManeuverSchedule prograde;
+    prograde.addArc(arc(0.0, 600.0, AttitudeLaw::VNB, Vec3(1.0, 0.0, 0.0)));
+    ManeuverSchedule retrograde;
+    retrograde.addArc(arc(0.0, 600.0, AttitudeLaw::VNB, Vec3(-1.0, 0.0, 0.0)));
+
+    EphemerisTime et0(0.0), et1(1200.0);
+    double e0 = energy(Maneuver::doSteps(ode, coast, s0, 500.0, et0, et1, TimeDelta(60.0)).back().s);
+    double e1 = energy(Maneuver::doSteps(ode, prograde, s0, 500.0, et0, et1, TimeDelta(60.0)).back().s);
+    double e2 = energy(Maneuver::doSteps(ode, retrograde, s0, 500.0, et0, et1, TimeDelta(60.0)).back().s);
+
+    EXPECT_NEAR(e0, energy(s0), 1.0E-6);
+    EXPECT_GT(e1, e0 + 1.0E-2);
+    EXPECT_LT(e2, e0 - 1.0E-2);
+
+    // A burn along the orbit normal turns the plane, and leaves the energy
+    // unchanged to first order
+    ManeuverSchedule normal;
+    normal.addArc(arc(0.0, 600.0, AttitudeLaw::RTN, Vec3(0.0, 0.0, 1.0)));
+    auto res = Maneuver::doSteps(ode, normal, s0, 500.0, et0, et1, TimeDelta(60.0));
+    EXPECT_GT(res.back().s.r.z, 0.0);
+    EXPECT_LT(std::abs(energy(res.back().s) - e0), 1.0E-2 * (e1 - e0));
+}
+
+TEST_F(ManeuverTest, Schedule)
+{
+    ManeuverSchedule schedule;
+    schedule.addArc(arc(500.0, 600.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0)));
+    schedule.addArc(arc(100.0, 200.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0)));
+    schedule.addArc(arc(200.0, 300.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0)));
+
+    ASSERT_EQ(schedule.getArcs().size(), 3u);
+    EXPECT_EQ(schedule.getArcs()[0].start.getETValue(), 100.0);
+    EXPECT_EQ(schedule.getArcs()[2].start.getETValue(), 500.0);
+
+    EXPECT_THROW(schedule.addArc(arc(550.0, 700.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0))), AstroException);
+    EXPECT_THROW(schedule.addArc(arc(0.0, 150.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0))), AstroException);
+    EXPECT_THROW(schedule.addArc(arc(700.0, 700.0, AttitudeLaw::Inertial, Vec3(1.0, 0.0, 0.0))), AstroException);
+    EXPECT_THROW(schedule.addArc(arc(700.0, 800.0, AttitudeLaw::Custom, Vec3(1.0, 0.0, 0.0))), AstroException);
+
+    EXPECT_EQ(schedule.activeArc(EphemerisTime(50.0)), nullptr);
+    EXPECT_EQ(schedule.activeArc(EphemerisTime(100.0)), &schedule.getArcs()[0]);
+    EXPECT_EQ(schedule.activeArc(EphemerisTime(200.0)), &schedule.getArcs()[1]);
+    EXPECT_EQ(schedule.activeArc(EphemerisTime(300.0)), nullptr);
+
+    EXPECT_EQ(schedule.nextBoundary(EphemerisTime(0.0), EphemerisTime(1000.0)).getETValue(), 100.0);
+    EXPECT_EQ(schedule.nextBoundary(EphemerisTime(150.0), EphemerisTime(1000.0)).getETValue(), 200.0);
+    EXPECT_EQ(schedule.nextBoundary(EphemerisTime(350.0), EphemerisTime(450.0)).getETValue(), 450.0);
+    EXPECT_EQ(schedule.nextBoundary(EphemerisTime(600.0), EphemerisTime(1000.0)).getETValue(), 1000.0);
+}
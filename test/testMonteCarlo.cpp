@@ -0,0 +1,193 @@
+#include "../astro/MonteCarlo.h"
+#include "../astro/Covariance.h"
+#include "../astro/ODE.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class MonteCarloTest : public ::testing::Test {
+
+protected:
+    MonteCarloTest();
+
+    virtual ~MonteCarloTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double   mu_earth;
+    ODE      ode;
+    PosState s0;
+    Mat6     P0;
+};
+
+
+
+MonteCarloTest::MonteCarloTest()
+  :  mu_earth(398600.4418)
+{
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+    s0 = PosState(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 6.0, 4.5));
+
+    // 100 m and 1 cm/s
+    for (int i = 0; i < 3; ++i)
+    {
+        P0(i, i)         = 1.0E-2;
+        P0(i + 3, i + 3) = 1.0E-10;
+    }
+}
+
+MonteCarloTest::~MonteCarloTest()
+{
+
+}
+
+void MonteCarloTest::SetUp()
+{
+}
+
+void MonteCarloTest::TearDown()
+{
+}
+
+TEST_F(MonteCarloTest, NormalSamples)
+{
+    SplitMix64 rng(42);
+    const int n = 100000;
+    double sum = 0.0, sum2 = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        double x = rng.normal();
+        sum  += x;
+        sum2 += x * x;
+    }
+    EXPECT_NEAR(sum / n, 0.0, 0.02);
+    EXPECT_NEAR(sum2 / n, 1.0, 0.02);
+
+    // Same seed, same stream
+    SplitMix64 a(7), b(7);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(a.next(), b.next());
+}
+
+TEST_F(MonteCarloTest, HistogramPercentiles)
+{
+    Histogram h(0.0, 10.0, 10);
+    Histogram g(0.0, 10.0, 10);
+    for (int i = 0; i < 100; ++i)
+        (i % 2 ? h : g).add(i * 0.1 + 0.05);
+    h.add(-1.0);
+    g.add(11.0);
+    h.merge(g);
+
+    EXPECT_EQ(h.count(), 102u);
+    EXPECT_EQ(h.getUnderflow(), 1u);
+    EXPECT_EQ(h.getOverflow(), 1u);
+    EXPECT_EQ(h.getCounts()[3], 10u);
+    EXPECT_DOUBLE_EQ(h.binCenter(3), 3.5);
+    EXPECT_NEAR(h.percentile(0.5), 5.0, 0.1);
+    EXPECT_DOUBLE_EQ(h.percentile(0.0), 0.0);
+    EXPECT_DOUBLE_EQ(h.percentile(1.0), 10.0);
+
+    EXPECT_THROW(h.merge(Histogram(0.0, 5.0, 10)), AstroException);
+    EXPECT_THROW(Histogram(1.0, 1.0, 10), AstroException);
+}
+
+TEST_F(MonteCarloTest, StatisticsMerge)
+{
+    StateStatistics all, a, b;
+    SplitMix64 rng(3);
+    for (int i = 0; i < 1000; ++i)
+    {
+        PosState s(Vec3(rng.normal(), 2.0 * rng.normal(), 5.0), Vec3(rng.normal(), 0.0, -rng.normal()));
+        all.add(s);
+        (i < 300 ? a : b).add(s);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.count(), 1000u);
+    EXPECT_NEAR(glm::length(a.mean().r - all.mean().r), 0.0, 1.0E-12);
+    Mat6 Pa = a.covariance(), Pall = all.covariance();
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_NEAR(Pa(i, j), Pall(i, j), 1.0E-12);
+    EXPECT_NEAR(Pall(1, 1), 4.0, 0.5);
+    EXPECT_NEAR(Pall(2, 2), 0.0, 1.0E-12);
+}
+
+TEST_F(MonteCarloTest, ReproducibleAcrossThreads)
+{
+    ode.setMass(100.0);
+    ode.setForce(Vec3(0.0, 1.0E-3, 0.0));
+    MonteCarlo mc(ode, s0, EphemerisTime(0.0));
+    mc.setStateCovariance(P0);
+    mc.setMassSigma(1.0);
+    mc.setForceSigma(Vec3(1.0E-5));
+    mc.addMetric({ [](const PosState& s) { return glm::length(s.r); }, 6000.0, 8000.0, 200 });
+
+    std::vector<EphemerisTime> epochs = { EphemerisTime(300.0), EphemerisTime(900.0) };
+    auto r1 = mc.run(150, epochs, TimeDelta(60.0), 99, 1);
+    auto r4 = mc.run(150, epochs, TimeDelta(60.0), 99, 4);
+
+    ASSERT_EQ(r1.stats.size(), 2u);
+    EXPECT_EQ(r1.stats[1].count(), 150u);
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_EQ(r1.stats[1].covariance()(i, j), r4.stats[1].covariance()(i, j));
+    EXPECT_EQ(r1.histograms[1][0].getCounts(), r4.histograms[1][0].getCounts());
+    EXPECT_EQ(r1.histograms[1][0].count(), 150u);
+
+    // The samples are the same, whichever thread draws them
+    MonteCarlo::Sample a = mc.sample(17, 99);
+    MonteCarlo::Sample b = mc.sample(17, 99);
+    EXPECT_EQ(a.s.r, b.s.r);
+    EXPECT_EQ(a.mass, b.mass);
+    EXPECT_NE(mc.sample(18, 99).mass, a.mass);
+}
+
+// Runs of several waves of blocks, the last one partial, give the same result
+// for any number of threads
+TEST_F(MonteCarloTest, ReproducibleAcrossWaves)
+{
+    MonteCarlo mc(ode, s0, EphemerisTime(0.0));
+    mc.setStateCovariance(P0);
+    mc.addMetric({ [](const PosState& s) { return s.r.z; }, -1000.0, 1000.0, 100 });
+
+    // 25 blocks: 7 waves on one thread, 3 on three threads
+    size_t n = 64 * 24 + 5;
+    std::vector<EphemerisTime> epochs = { EphemerisTime(300.0) };
+    auto r1 = mc.run(n, epochs, TimeDelta(60.0), 7, 1);
+    auto r3 = mc.run(n, epochs, TimeDelta(60.0), 7, 3);
+
+    EXPECT_EQ(r1.stats[0].count(), n);
+    EXPECT_EQ(r3.stats[0].count(), n);
+    EXPECT_EQ(r1.stats[0].mean().r, r3.stats[0].mean().r);
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_EQ(r1.stats[0].covariance()(i, j), r3.stats[0].covariance()(i, j));
+    EXPECT_EQ(r1.histograms[0][0].getCounts(), r3.histograms[0][0].getCounts());
+    EXPECT_EQ(r3.histograms[0][0].count(), n);
+}
+
+// The sample covariance agrees with the linear propagation
+TEST_F(MonteCarloTest, MatchesLinearCovariance)
+{
+    MonteCarlo mc(ode, s0, EphemerisTime(0.0));
+    mc.setStateCovariance(P0);
+
+    std::vector<EphemerisTime> epochs = { EphemerisTime(1500.0) };
+    auto mcr = mc.run(2000, epochs, TimeDelta(60.0), 1);
+    auto lin = Covariance::propagateLinear(ode, s0, P0, EphemerisTime(0.0), epochs, TimeDelta(60.0));
+
+    Mat6 Pm = mcr.stats[0].covariance();
+    Mat6 Pl = lin[0].P;
+    for (int i = 0; i < 6; ++i)
+        EXPECT_NEAR(Pm(i, i), Pl(i, i), 0.15 * Pl(i, i));
+    EXPECT_NEAR(glm::length(mcr.stats[0].mean().r - lin[0].s.r), 0.0, 0.02);
+}
@@ -96,6 +96,25 @@ TEST_F(NumIntTest, RKF78ToleranceRespected)
     astro::RKF78::setTolerance(1.0E-8); // restore default
 }
 
+// An explicit tolerance gives the same steps as the global one, and leaves
+// the global tolerance alone
+TEST_F(NumIntTest, RKF78ExplicitTolerance)
+{
+    astro::SimpleOrbit orbit1(oe0);
+    astro::EphemerisTime et1 = et0 + astro::TimeDelta(orbit1.getPeriod());
+
+    auto resv_explicit = astro::RKF78::doSteps(ode0, state0, et0, et1, astro::TimeDelta(1.0), 1.0E-11);
+    ASSERT_EQ(astro::RKF78::getTolerance(), 1.0E-8);
+
+    astro::RKF78::setTolerance(1.0E-11);
+    auto resv_global = astro::RKF78::doSteps(ode0, state0, et0, et1, astro::TimeDelta(1.0));
+    astro::RKF78::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(resv_explicit.size(), resv_global.size());
+    ASSERT_EQ(resv_explicit.back().s.r, resv_global.back().s.r);
+    ASSERT_EQ(resv_explicit.back().s.v, resv_global.back().s.v);
+}
+
 // After one full orbital period the propagated state must be close to the initial state.
 TEST_F(NumIntTest, RKF78AccuracyOneOrbit)
 {
@@ -499,3 +518,326 @@ TEST_F(NumIntTest, PCDMTestTorqueXN)
         assert_almost_eq(ez, Vec3(0,1,0), 1.0E-10);
 }
  
+
+// Circular orbit in the xy-plane, and its exact solution
+static astro::PosState circularState(double mu, double radius, double t)
+{
+    double n = std::sqrt(mu / (radius * radius * radius));
+    return astro::PosState(Vec3(radius * std::cos(n * t), radius * std::sin(n * t), 0.0),
+                           Vec3(-radius * n * std::sin(n * t), radius * n * std::cos(n * t), 0.0));
+}
+
+// Counts the force evaluations of an ODE
+class CountingODE : public astro::ODE
+{
+public:
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+    {
+        ++count;
+        astro::ODE::operator()(x, dxdt, et);
+    }
+
+    mutable long count = 0;
+};
+
+template<int N>
+static double yoshidaError(const astro::ODE& ode, double mu, double radius, double dt)
+{
+    double period = astro::TWOPI * std::sqrt(radius * radius * radius / mu);
+    astro::PosState s0 = circularState(mu, radius, 0.0);
+    auto resv = astro::Yoshida<N>::doSteps(ode, s0, EphemerisTime(0.0), EphemerisTime(period), astro::TimeDelta(dt));
+    return glm::length(resv.back().s.r - circularState(mu, radius, resv.back().et.getETValue()).r);
+}
+
+// Halving the step must reduce the error by about 2^N
+TEST_F(NumIntTest, YoshidaOrder)
+{
+    double period = astro::TWOPI * std::sqrt(7000.0 * 7000.0 * 7000.0 / mu_earth);
+
+    double e4a = yoshidaError<4>(ode0, mu_earth, 7000.0, period / 50.0);
+    double e4b = yoshidaError<4>(ode0, mu_earth, 7000.0, period / 100.0);
+    ASSERT_NEAR(std::log2(e4a / e4b), 4.0, 0.3);
+
+    double e6a = yoshidaError<6>(ode0, mu_earth, 7000.0, period / 25.0);
+    double e6b = yoshidaError<6>(ode0, mu_earth, 7000.0, period / 50.0);
+    ASSERT_NEAR(std::log2(e6a / e6b), 6.0, 0.4);
+
+    double e8a = yoshidaError<8>(ode0, mu_earth, 7000.0, period / 16.0);
+    double e8b = yoshidaError<8>(ode0, mu_earth, 7000.0, period / 32.0);
+    ASSERT_NEAR(std::log2(e8a / e8b), 8.0, 0.6);
+}
+
+// The energy error of a symplectic method stays bounded over many orbits
+TEST_F(NumIntTest, YoshidaEnergy)
+{
+    auto energy = [this](const astro::PosState& s) {
+        return 0.5 * glm::dot(s.v, s.v) - mu_earth / glm::length(s.r);
+    };
+
+    double a = 1.0 / (2.0 / glm::length(state0.r) - glm::dot(state0.v, state0.v) / mu_earth);
+    double period = astro::TWOPI * std::sqrt(a * a * a / mu_earth);
+    astro::Propagator<astro::ODE, astro::Yoshida<4>> pr(ode0);
+    auto resv = pr.doSteps(state0, et0, et0 + astro::TimeDelta(500.0 * period), astro::TimeDelta(period / 200.0));
+
+    double e0 = energy(state0);
+    double maxEarly = 0.0, maxLate = 0.0;
+    for (size_t i = 0; i < resv.size(); ++i)
+    {
+        double err = std::abs(energy(resv[i].s) - e0);
+        if (i < resv.size() / 10)
+            maxEarly = std::max(maxEarly, err);
+        else if (i > 9 * resv.size() / 10)
+            maxLate = std::max(maxLate, err);
+    }
+    ASSERT_LT(std::abs(maxEarly / e0), 1.0E-6);
+    ASSERT_LT(maxLate, 1.5 * maxEarly);
+}
+
+TEST_F(NumIntTest, GaussJacksonAccuracy)
+{
+    double radius = 7000.0;
+    double period = astro::TWOPI * std::sqrt(radius * radius * radius / mu_earth);
+    astro::PosState s0 = circularState(mu_earth, radius, 0.0);
+
+    // Ten orbits, ending with a partial step
+    astro::EphemerisTime et1(10.0 * period);
+    astro::Propagator<astro::ODE, astro::GaussJackson> pr(ode0);
+    auto resv = pr.doSteps(s0, EphemerisTime(0.0), et1, astro::TimeDelta(30.0));
+    ASSERT_EQ(resv.back().et.getETValue(), et1.getETValue());
+
+    // The startup tolerance is passed to RKF78, not set globally
+    ASSERT_EQ(astro::RKF78::getTolerance(), 1.0E-8);
+
+    for (const auto& res : resv)
+    {
+        astro::PosState exact = circularState(mu_earth, radius, res.et.getETValue());
+        ASSERT_LT(glm::length(res.s.r - exact.r), 1.0E-5);
+        ASSERT_LT(glm::length(res.s.v - exact.v), 1.0E-8);
+    }
+
+    // PECE is at least as accurate
+    astro::GaussJackson::setCorrectorEvaluations(1);
+    auto resPece = pr.doSteps(s0, EphemerisTime(0.0), et1, astro::TimeDelta(30.0));
+    astro::GaussJackson::setCorrectorEvaluations(0);
+    astro::PosState exact = circularState(mu_earth, radius, et1.getETValue());
+    ASSERT_LT(glm::length(resPece.back().s.r - exact.r), 1.0E-5);
+}
+
+// After the startup, one force evaluation per step
+TEST_F(NumIntTest, GaussJacksonEvaluations)
+{
+    CountingODE ode;
+    ode.addAttractor(earth);
+    astro::PosState s0 = circularState(mu_earth, 7000.0, 0.0);
+
+    auto resv = astro::GaussJackson::doSteps(ode, s0, EphemerisTime(0.0), EphemerisTime(600.0), astro::TimeDelta(60.0));
+    long startup = ode.count;
+    ASSERT_EQ(resv.size(), 11u);
+
+    ode.count = 0;
+    resv = astro::GaussJackson::doSteps(ode, s0, EphemerisTime(0.0), EphemerisTime(600.0 + 1000 * 60.0), astro::TimeDelta(60.0));
+    ASSERT_EQ(ode.count - startup, 1000);
+}
+
+TEST_F(NumIntTest, RadauIIAAccuracyOneOrbit)
+{
+    double radius = 7000.0;
+    double period = astro::TWOPI * std::sqrt(radius * radius * radius / mu_earth);
+    astro::PosState s0 = circularState(mu_earth, radius, 0.0);
+
+    astro::Propagator<astro::ODE, astro::RadauIIA> pr(ode0);
+    astro::RadauIIA::setTolerance(1.0E-11);
+    auto resv = pr.doSteps(s0, EphemerisTime(0.0), EphemerisTime(period), astro::TimeDelta(10.0));
+    astro::RadauIIA::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(resv.back().et.getETValue(), period);
+    ASSERT_LT(glm::length(resv.back().s.r - s0.r), 0.001);
+    ASSERT_LT(glm::length(resv.back().s.v - s0.v), 1.0E-6);
+}
+
+// Strongly damps the velocity towards the local circular velocity, which makes
+// the problem stiff: explicit methods need steps below 1/k for stability
+class DampedODE : public astro::ODE
+{
+public:
+    DampedODE(double _mu, double _k)
+        : mu(_mu), k(_k)
+    {}
+
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+    {
+        astro::ODE::operator()(x, dxdt, et);
+        Vec3 h = glm::normalize(glm::cross(x.r, x.v));
+        Vec3 vc = glm::normalize(glm::cross(h, x.r)) * std::sqrt(mu / glm::length(x.r));
+        dxdt.v -= k * (x.v - vc);
+    }
+
+private:
+    double mu;
+    double k;
+};
+
+TEST_F(NumIntTest, RadauIIAStiff)
+{
+    DampedODE ode(mu_earth, 100.0);
+    ode.addAttractor(earth);
+
+    double radius = 7000.0;
+    double period = astro::TWOPI * std::sqrt(radius * radius * radius / mu_earth);
+    astro::PosState s0 = circularState(mu_earth, radius, 0.0);
+    s0.v *= 1.01;
+
+    auto resv = astro::RadauIIA::doSteps(ode, s0, EphemerisTime(0.0), EphemerisTime(period), astro::TimeDelta(1.0));
+
+    // An explicit method would need more than 100 * period steps
+    ASSERT_LT(resv.size(), 1000u);
+
+    // The orbit has been forced circular
+    const astro::PosState& sf = resv.back().s;
+    ASSERT_NEAR(glm::length(sf.v), std::sqrt(mu_earth / glm::length(sf.r)), 1.0E-6);
+    ASSERT_NEAR(glm::dot(sf.r, sf.v), 0.0, 1.0E-3);
+}
+
+// Without perturbations the deviation stays zero and the reference is exact
+TEST_F(NumIntTest, EnckeKeplerian)
+{
+    astro::EphemerisTime et1(10.0 * oe0.T);
+    auto resv = astro::Encke::doSteps(ode0, state0, et0, et1, astro::TimeDelta(10.0));
+
+    astro::SimpleOrbit orbit(oe0);
+    astro::PosState exact = orbit.getState(et1);
+    ASSERT_EQ(resv.back().et, et1);
+    ASSERT_LT(glm::length(resv.back().s.r - exact.r), 1.0E-6);
+
+    auto cowell = astro::RKF78::doSteps(ode0, state0, et0, et1, astro::TimeDelta(10.0));
+    ASSERT_LT(resv.size(), cowell.size());
+}
+
+// A weak along track thrust: same accuracy as Cowell in fewer steps, with
+// rectifications as the orbit is raised
+TEST_F(NumIntTest, EnckePerturbed)
+{
+    astro::ODE ode;
+    ode.addAttractor(earth);
+    ode.setForce(Vec3(0.0, 1.0E-7, 0.0));
+
+    double radius = 7000.0;
+    double period = astro::TWOPI * std::sqrt(radius * radius * radius / mu_earth);
+    astro::PosState s0 = circularState(mu_earth, radius, 0.0);
+    astro::EphemerisTime et1(10.0 * period);
+
+    astro::RKF78::setTolerance(1.0E-13);
+    auto ref = astro::RKF78::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-10);
+    auto cowell = astro::RKF78::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    auto encke = astro::Encke::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(encke.back().et, et1);
+    ASSERT_LT(glm::length(encke.back().s.r - ref.back().s.r), 1.0E-3);
+    ASSERT_LT(glm::length(encke.back().s.v - ref.back().s.v), 1.0E-6);
+    ASSERT_LT(encke.size(), cowell.size());
+}
+
+// Strong along track thrust, fading out over the first ten minutes
+class BurnODE : public astro::ODE
+{
+public:
+    virtual void operator()(const PosState& x, PosState& dxdt, const EphemerisTime& et) const
+    {
+        astro::ODE::operator()(x, dxdt, et);
+        double t = et.getETValue() / 120.0;
+        dxdt.v += glm::normalize(x.v) * (2.0E-3 * std::exp(-t * t));
+    }
+};
+
+TEST_F(NumIntTest, EnckeCowellSwitch)
+{
+    BurnODE ode;
+    ode.addAttractor(earth);
+    astro::PosState s0 = circularState(mu_earth, 7000.0, 0.0);
+    astro::EphemerisTime et1(6000.0);
+
+    ASSERT_GT(astro::Encke::perturbationRatio(ode, s0, EphemerisTime(0.0)), 0.1);
+    ASSERT_LT(astro::Encke::perturbationRatio(ode, s0, EphemerisTime(600.0)), 1.0E-10);
+
+    astro::RKF78::setTolerance(1.0E-13);
+    auto ref = astro::RKF78::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-11);
+    auto encke = astro::Encke::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(encke.back().et, et1);
+    ASSERT_LT(glm::length(encke.back().s.r - ref.back().s.r), 1.0E-3);
+}
+
+TEST_F(NumIntTest, KSConversion)
+{
+    std::vector<astro::PosState> states = {
+        astro::PosState(Vec3(7000.0, -1200.0, 300.0), Vec3(1.0, 7.5, 0.4)),
+        astro::PosState(Vec3(-7000.0, 1200.0, -3000.0), Vec3(-2.0, -6.5, 1.4))
+    };
+    for (const astro::PosState& s : states)
+    {
+        astro::KSState k = astro::KS::toKS(s, et0, mu_earth);
+        astro::PosState s2 = astro::KS::fromKS(k);
+        ASSERT_NEAR(glm::dot(k.u, k.u), glm::length(s.r), 1.0E-9);
+        ASSERT_LT(glm::length(s2.r - s.r), 1.0E-9);
+        ASSERT_LT(glm::length(s2.v - s.v), 1.0E-12);
+    }
+}
+
+// A highly eccentric orbit: KS needs far fewer steps than Cowell, and the
+// steps in fictitious time are nearly uniform
+TEST_F(NumIntTest, KSEccentricOrbit)
+{
+    double rp = 7000.0, ra = 140000.0;
+    double a = 0.5 * (rp + ra);
+    double period = astro::TWOPI * std::sqrt(a * a * a / mu_earth);
+    astro::PosState s0(Vec3(rp, 0.0, 0.0), Vec3(0.0, std::sqrt(mu_earth * (2.0 / rp - 1.0 / a)), 0.0));
+    astro::EphemerisTime et1(period);
+
+    astro::RKF78::setTolerance(1.0E-11);
+    auto ks = astro::KS::doSteps(ode0, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    auto cowell = astro::RKF78::doSteps(ode0, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(ks.back().et, et1);
+    ASSERT_LT(glm::length(ks.back().s.r - s0.r), 1.0E-4);
+    ASSERT_LT(glm::length(ks.back().s.v - s0.v), 1.0E-8);
+    ASSERT_LT(3 * ks.size(), cowell.size());
+
+    // Fictitious step ds = dt / r, away from the start and the last step
+    double dsMin = 1.0E99, dsMax = 0.0;
+    for (size_t i = 5; i + 1 < ks.size(); ++i)
+    {
+        double ds = ks[i].dt_next.value / glm::length(ks[i].s.r);
+        dsMin = std::min(dsMin, ds);
+        dsMax = std::max(dsMax, ds);
+    }
+    ASSERT_LT(dsMax / dsMin, 1.5);
+}
+
+TEST_F(NumIntTest, KSPerturbed)
+{
+    astro::ODE ode;
+    ode.addAttractor(earth);
+    ode.addAttractor({ Vec3(384400.0, 0.0, 0.0), 4902.8 });
+    ode.setForce(Vec3(0.0, 0.0, 1.0E-7));
+
+    double rp = 7000.0, ra = 140000.0;
+    double a = 0.5 * (rp + ra);
+    double period = astro::TWOPI * std::sqrt(a * a * a / mu_earth);
+    astro::PosState s0(Vec3(rp, 0.0, 0.0), Vec3(0.0, std::sqrt(mu_earth * (2.0 / rp - 1.0 / a)), 0.0));
+    astro::EphemerisTime et1(2.5 * period);
+
+    astro::RKF78::setTolerance(1.0E-13);
+    auto ref = astro::RKF78::doSteps(ode, s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-11);
+    auto ks = astro::Propagator<astro::ODE, astro::KS>(ode).doSteps(s0, EphemerisTime(0.0), et1, astro::TimeDelta(10.0));
+    astro::RKF78::setTolerance(1.0E-8); // restore default
+
+    ASSERT_EQ(ks.back().et, et1);
+    ASSERT_LT(glm::length(ks.back().s.r - ref.back().s.r), 1.0E-3);
+    ASSERT_LT(glm::length(ks.back().s.v - ref.back().s.v), 1.0E-6);
+}
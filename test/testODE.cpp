@@ -2,6 +2,8 @@
 #include "../astro/ODE.h"
 #include "../astro/State.h"
 #include "../astro/Util.h"
+#include "../astro/Atmosphere.h"
+#include "../astro/RKF78.h"
 #include <gtest/gtest.h>
 
 #include <cmath>
@@ -184,6 +186,63 @@ TEST_F(ODETest, ClearForce)
     EXPECT_NEAR(sdot_f.v.z, sdot_0.v.z, 1.0e-12);
 }
 
+// ---------------------------------------------------------------------------
+// ODE::setDrag tests
+// ---------------------------------------------------------------------------
+
+// Drag opposes the velocity relative to the co-rotating atmosphere, scaled by
+// the ballistic coefficient
+TEST_F(ODETest, DragAcceleration)
+{
+    auto atm = std::make_shared<astro::ExponentialAtmosphere>();
+    double r = 6378.137 + 300.0;
+    double v = std::sqrt(mu_earth / r);
+    PosState s(Vec3(r, 0.0, 0.0), Vec3(0.0, v, 0.0));
+    EphemerisTime et(0.0);
+
+    ODE ode_d;
+    ode_d.addAttractor({Vec3(0.0), mu_earth});
+    ode_d.setMass(500.0);
+    ode_d.setDrag(atm, 2.2, 4.0);
+    EXPECT_NEAR(ode_d.getBallisticCoefficient(), 2.2 * 4.0 / 500.0, 1.0e-15);
+
+    PosState sdot_d = ode_d.rates(et, s);
+    PosState sdot_0 = ode0.rates(et, s);
+
+    double vrel = v - 7.2921158553E-5 * r; // [km/s]
+    double rho  = 2.418E-11;               // [kg/m^3] at 300 km
+    double a    = 0.5 * rho * (2.2 * 4.0 / 500.0) * (vrel * 1000.0) * (vrel * 1000.0) / 1000.0; // [km/s^2]
+    EXPECT_NEAR(sdot_d.v.y - sdot_0.v.y, -a, 1.0e-18);
+    EXPECT_NEAR(sdot_d.v.x - sdot_0.v.x, 0.0, 1.0e-18);
+
+    // Disabled again
+    ode_d.setDrag(nullptr, 0.0, 0.0);
+    PosState sdot_n = ode_d.rates(et, s);
+    EXPECT_EQ(sdot_n.v.y, sdot_0.v.y);
+
+    ASSERT_THROW(ode_d.setDrag(atm, -1.0, 4.0), astro::AstroException);
+}
+
+// Drag lowers the orbital energy
+TEST_F(ODETest, DragDecay)
+{
+    auto atm = std::make_shared<astro::ExponentialAtmosphere>();
+    double r = 6378.137 + 250.0;
+    PosState s0(Vec3(r, 0.0, 0.0), Vec3(0.0, std::sqrt(mu_earth / r), 0.0));
+
+    ODE ode_d;
+    ode_d.addAttractor({Vec3(0.0), mu_earth});
+    ode_d.setMass(100.0);
+    ode_d.setDrag(atm, 2.2, 1.0);
+
+    auto res = astro::RKF78::doSteps(ode_d, s0, EphemerisTime(0.0), EphemerisTime(5400.0), astro::TimeDelta(10.0));
+    const PosState& s1 = res.back().s;
+    double e0 = 0.5 * glm::dot(s0.v, s0.v) - mu_earth / glm::length(s0.r);
+    double e1 = 0.5 * glm::dot(s1.v, s1.v) - mu_earth / glm::length(s1.r);
+    EXPECT_LT(e1, e0);
+    EXPECT_GT(e1, e0 - 1.0e-2);
+}
+
 // ---------------------------------------------------------------------------
 
 TEST_F(ODETest, RotODESingularInertia)
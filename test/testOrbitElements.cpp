@@ -520,6 +520,26 @@ TEST_F(OrbitElementsTest, OrbitElementsToStateVector2)
     ASSERT_LT(fabs(state.v.z-state2.v.z), 1.0E-5);
 }
 
+// Equatorial orbits with the perigee off the X axis, and exactly circular orbits
+TEST_F(OrbitElementsTest, OrbitElementsToStateVectorDegenerate)
+{
+    double v = std::sqrt(mu_earth / 7000.0);
+    std::vector<astro::PosState> states = {
+        astro::PosState(Vec3(5000.0, 5000.0, 0.0), Vec3(-5.0, 6.0, 0.0)),  // Prograde equatorial
+        astro::PosState(Vec3(5000.0, 5000.0, 0.0), Vec3(6.0, -5.0, 0.0)),  // Retrograde equatorial
+        astro::PosState(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, v, 0.0)),        // Circular equatorial
+        astro::PosState(Vec3(0.0, 7000.0, 0.0), Vec3(-0.6 * v, 0.0, 0.8 * v)) // Circular inclined
+    };
+
+    for (const astro::PosState& state : states)
+    {
+        astro::OrbitElements oe = astro::OrbitElements::fromStateVectorOE(state, et, mu_earth);
+        astro::PosState state2 = oe.toStateVectorOE(et);
+        ASSERT_LT(glm::length(state.r - state2.r), 1.0E-6);
+        ASSERT_LT(glm::length(state.v - state2.v), 1.0E-9);
+    }
+}
+
 TEST_F(OrbitElementsTest, OrbitElementsToStateVectorSpice1)
 {
     double rpd = astro::RADPERDEG;
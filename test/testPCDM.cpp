@@ -1,5 +1,8 @@
+#include "../astro/PCDM.h"
 #include "../astro/State.h"
 #include "../astro/Time.h"
+#include "../astro/Exceptions.h"
+#include "../astro/Util.h"
 
 #include <gtest/gtest.h>
 
@@ -52,10 +55,88 @@ void PCDMTest::TearDown()
 
 
 
-TEST_F(PCDMTest, PCDMTest)
+// Angular momentum in the global frame, L = R Ib R^T w
+static Vec3 angularMomentum(const Mat3& Ib, const RotState& rs)
 {
+    return rs.q * (Ib * (glm::inverse(rs.q) * rs.w));
+}
 
-    // No test so far    
+TEST_F(PCDMTest, AdaptiveConstantW)
+{
+    double w = 0.1;
+    RotODE rode;
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(w, 0.0, 0.0));
+
+    // Quarter turn about X, from a small initial step
+    EphemerisTime et(12345);
+    EphemerisTime et2 = et + TimeDelta(PIHALF / w);
+    auto resv = PCDM::doAdaptiveSteps(rode, rs, et, et2, TimeDelta(1.0 / 60.0));
+
+    EXPECT_EQ(resv.back().et.getETValue(), et2.getETValue());
+    Vec3 ey = resv.back().rs.q * Vec3(0.0, 1.0, 0.0);
+    EXPECT_NEAR(ey.y, 0.0, 1.0E-10);
+    EXPECT_NEAR(ey.z, 1.0, 1.0E-10);
+
+    // Exact for constant w, so the step grows at the maximum rate
+    EXPECT_LT(resv.size(), 12u);
 }
 
+TEST_F(PCDMTest, AdaptiveTumbling)
+{
+    // Spin close to the intermediate axis, which flips periodically
+    Mat3 Ib(0.0);
+    Ib[0][0] = 1.0;
+    Ib[1][1] = 2.0;
+    Ib[2][2] = 3.0;
+    RotODE rode(Ib);
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.01, 1.0, 0.01));
+
+    EphemerisTime et(0.0);
+    EphemerisTime et2(30.0);
+    double tol = PCDM::getTolerance();
+    PCDM::setTolerance(1.0E-6);
+    auto resv = PCDM::doAdaptiveSteps(rode, rs, et, et2, TimeDelta(0.1));
+    PCDM::setTolerance(tol);
+
+    // Torque free: the global angular momentum and the energy are conserved
+    Vec3 L0 = angularMomentum(Ib, rs);
+    double E0 = 0.5 * glm::dot(rs.w, L0);
+    for (const auto& r : resv)
+    {
+        Vec3 L = angularMomentum(Ib, r.rs);
+        EXPECT_LT(glm::length(L - L0), 1.0E-2 * glm::length(L0));
+        EXPECT_NEAR(0.5 * glm::dot(r.rs.w, L), E0, 1.0E-2 * E0);
+        EXPECT_NEAR(glm::length(r.rs.q), 1.0, 1.0E-12);
+    }
+
+    // The steps shrink through the flips, and grow between them
+    double hmin = 1.0E9, hmax = 0.0;
+    for (size_t i = 1; i + 1 < resv.size(); ++i)
+    {
+        double h = (resv[i].et - resv[i - 1].et).value;
+        hmin = std::min(hmin, h);
+        hmax = std::max(hmax, h);
+    }
+    EXPECT_GT(hmax, 2.0 * hmin);
+}
 
+TEST_F(PCDMTest, AdaptiveTolerance)
+{
+    double tol = PCDM::getTolerance();
+    EXPECT_THROW(PCDM::setTolerance(0.0), AstroException);
+
+    Mat3 Ib(1.0);
+    Ib[2][2] = 2.0;
+    RotODE rode(Ib);
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.3, 0.0, 1.0));
+    EphemerisTime et(0.0), et2(20.0);
+
+    // Tighter tolerance takes more steps
+    PCDM::setTolerance(1.0E-5);
+    size_t coarse = PCDM::doAdaptiveSteps(rode, rs, et, et2, TimeDelta(0.1)).size();
+    PCDM::setTolerance(1.0E-7);
+    size_t fine = PCDM::doAdaptiveSteps(rode, rs, et, et2, TimeDelta(0.1)).size();
+    PCDM::setTolerance(tol);
+
+    EXPECT_GT(fine, 4 * coarse);
+}
@@ -0,0 +1,201 @@
+#include "../astro/RadiationPressure.h"
+#include "../astro/Ephemeris.h"
+#include "../astro/SpiceCore.h"
+#include "../astro/ODE.h"
+#include "../astro/RKF78.h"
+#include "../astro/Util.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class RadiationPressureTest : public ::testing::Test {
+
+protected:
+    RadiationPressureTest();
+
+    virtual ~RadiationPressureTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    astro::EphemerisTime et0;
+    std::shared_ptr<astro::EphemerisCache> ephemeris;
+};
+
+
+
+RadiationPressureTest::RadiationPressureTest()
+  :  et0(0.0)
+{
+
+}
+
+RadiationPressureTest::~RadiationPressureTest()
+{
+
+}
+
+void RadiationPressureTest::SetUp()
+{
+    astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls");
+    astro::Spice().loadKernel("../data/spice/spk/de430.bsp");
+    ephemeris = std::make_shared<astro::EphemerisCache>(std::vector<int>{ 10, 399, 301 }, et0,
+                                                        et0 + astro::TimeDelta(86400.0), astro::TimeDelta(600.0));
+}
+
+void RadiationPressureTest::TearDown()
+{
+}
+
+static const double AU = 149597870.7;
+
+TEST_F(RadiationPressureTest, ConicalShadow)
+{
+    Vec3 sun(AU, 0.0, 0.0);
+    double re = 6378.137;
+
+    // Sunlit side, and behind the Earth
+    ASSERT_EQ(astro::SolarRadiationPressure::shadow(Vec3(7000.0, 0.0, 0.0), sun, Vec3(0.0), re), 1.0);
+    ASSERT_EQ(astro::SolarRadiationPressure::shadow(Vec3(0.0, 7000.0, 0.0), sun, Vec3(0.0), re), 1.0);
+    ASSERT_EQ(astro::SolarRadiationPressure::shadow(Vec3(-7000.0, 0.0, 0.0), sun, Vec3(0.0), re), 0.0);
+
+    // Through the penumbra the visible fraction grows monotonically
+    double prev = 0.0;
+    int partial = 0;
+    for (double y = 6300.0; y <= 6450.0; y += 1.0)
+    {
+        double nu = astro::SolarRadiationPressure::shadow(Vec3(-7000.0, y, 0.0), sun, Vec3(0.0), re);
+        ASSERT_GE(nu, prev);
+        if (nu > 0.0 && nu < 1.0)
+            ++partial;
+        prev = nu;
+    }
+    ASSERT_EQ(prev, 1.0);
+    ASSERT_GT(partial, 10);
+
+    // Annular: a small body in front of the Sun
+    double nu = astro::SolarRadiationPressure::shadow(Vec3(0.0), sun, Vec3(1.0E6, 0.0, 0.0), 1000.0);
+    double a = std::asin(696000.0 / AU);
+    double b = std::asin(1000.0 / 1.0E6);
+    ASSERT_NEAR(nu, 1.0 - b * b / (a * a), 1.0E-12);
+}
+
+TEST_F(RadiationPressureTest, CannonballAndPlates)
+{
+    Vec3 sun(AU, 0.0, 0.0);
+    Vec3 r(0.0, 7000.0, 0.0);
+
+    // Cannonball at 1 AU, away from the Sun
+    astro::SolarRadiationPressure ball(ephemeris, 1.5, 10.0);
+    Vec3 a = ball.acceleration(r, et0, sun + r, 1.0, 1000.0);
+    ASSERT_NEAR(a.x, -4.56E-6 * 1.5 * 10.0 / 1000.0 / 1000.0, 1.0E-20);
+    ASSERT_NEAR(a.y, 0.0, 1.0E-20);
+    ASSERT_EQ(ball.acceleration(r, et0, sun + r, 0.0, 1000.0), Vec3(0.0));
+
+    // A mirror facing the Sun doubles the pressure; an absorber tilted 60
+    // degrees gets half of it, along the light
+    auto fixed = [](const Quat& q) { return [q](const EphemerisTime&) { return q; }; };
+    Quat identity(1.0, 0.0, 0.0, 0.0);
+    astro::SolarRadiationPressure mirror(ephemeris, { { Vec3(1.0, 0.0, 0.0), 10.0, 1.0, 0.0 } }, fixed(identity));
+    a = mirror.acceleration(r, et0, sun + r, 1.0, 1000.0);
+    ASSERT_NEAR(a.x, -2.0 * 4.56E-6 * 10.0 / 1.0E6, 1.0E-20);
+
+    std::vector<SRPPlate> absorber = { { Vec3(1.0, 0.0, 0.0), 10.0, 0.0, 0.0 } };
+    astro::SolarRadiationPressure tilted(ephemeris, absorber,
+                                         fixed(glm::angleAxis(60.0 * astro::RADPERDEG, Vec3(0.0, 0.0, 1.0))));
+    a = tilted.acceleration(r, et0, sun + r, 1.0, 1000.0);
+    ASSERT_NEAR(a.x, -0.5 * 4.56E-6 * 10.0 / 1.0E6, 1.0E-20);
+    ASSERT_NEAR(a.y, 0.0, 1.0E-20);
+
+    // Facing away
+    astro::SolarRadiationPressure away(ephemeris, absorber, fixed(glm::angleAxis(astro::PI, Vec3(0.0, 0.0, 1.0))));
+    ASSERT_LT(glm::length(away.acceleration(r, et0, sun + r, 1.0, 1000.0)), 1.0E-25);
+
+    ASSERT_THROW(astro::SolarRadiationPressure(ephemeris, { { Vec3(1.0, 0.0, 0.0), 10.0, 0.8, 0.3 } },
+                                               fixed(identity)), astro::AstroException);
+    ASSERT_THROW(astro::SolarRadiationPressure(ephemeris, absorber, nullptr), astro::AstroException);
+    ASSERT_THROW(astro::SolarRadiationPressure(ephemeris, 1.3, 0.0), astro::AstroException);
+}
+
+// The plates follow an attitude that changes with time
+TEST_F(RadiationPressureTest, TimeVaryingAttitude)
+{
+    // An absorber spinning about Z once every 1200 s, facing the Sun at et0
+    const double w = astro::TWOPI / 1200.0;
+    EphemerisTime t0 = et0;
+    auto srp = std::make_shared<astro::SolarRadiationPressure>(
+        ephemeris, std::vector<SRPPlate>{ { Vec3(1.0, 0.0, 0.0), 10.0, 0.0, 0.0 } },
+        [t0, w](const EphemerisTime& et) { return glm::angleAxis(w * (et - t0).value, Vec3(0.0, 0.0, 1.0)); });
+
+    // The force along the light goes as the cosine of the spin angle, the
+    // projected area, and vanishes while the plate faces away
+    Vec3 sun(AU, 0.0, 0.0);
+    Vec3 r(0.0, 7000.0, 0.0);
+    double full = 4.56E-6 * 10.0 / 1.0E6;
+    for (double t : { 0.0, 100.0, 200.0, 400.0, 600.0, 1100.0 })
+    {
+        double c = std::max(std::cos(w * t), 0.0);
+        Vec3   a = srp->acceleration(r, et0 + TimeDelta(t), sun + r, 1.0, 1000.0);
+        EXPECT_NEAR(a.x, -full * c, 1.0E-20);
+        EXPECT_NEAR(a.y, 0.0, 1.0E-20);
+    }
+
+    // In the ODE, each evaluation uses the attitude at its own time: a plate
+    // facing the Sun at et0, turned edge-on a quarter turn later
+    PosState sunState, earth;
+    ephemeris->getState(10, et0, sunState);
+    ephemeris->getState(399, et0, earth);
+    Vec3 toSun = glm::normalize(sunState.r - earth.r);
+    Vec3 axis  = glm::normalize(glm::cross(toSun, Vec3(0.0, 0.0, 1.0)));
+    auto spinning = std::make_shared<astro::SolarRadiationPressure>(
+        ephemeris, std::vector<SRPPlate>{ { toSun, 10.0, 0.0, 0.0 } },
+        [t0, w, axis](const EphemerisTime& et) { return glm::angleAxis(w * (et - t0).value, axis); });
+
+    astro::ODE ode, ode_srp;
+    ode.addAttractor({ Vec3(0.0), 398600.0 });
+    ode_srp.addAttractor({ Vec3(0.0), 398600.0 });
+    ode_srp.setMass(1000.0);
+    ode_srp.setSolarRadiationPressure(spinning);
+
+    PosState lit(toSun * 7000.0, Vec3(0.0, 0.0, 7.5));
+    EphemerisTime quarter = et0 + TimeDelta(300.0);
+    Vec3 d0 = ode_srp.rates(et0, lit).v - ode.rates(et0, lit).v;
+    Vec3 d1 = ode_srp.rates(quarter, lit).v - ode.rates(quarter, lit).v;
+    EXPECT_GT(glm::length(d0), 0.5 * full);
+    EXPECT_LT(glm::length(d1), 1.0E-6 * glm::length(d0));
+}
+
+// The acceleration in the ODE vanishes in the Earth's shadow
+TEST_F(RadiationPressureTest, ODEShadow)
+{
+    auto srp = std::make_shared<astro::SolarRadiationPressure>(ephemeris, 1.3, 1.0);
+    srp->addOcculter(301, 1737.4);
+
+    PosState sun, earth;
+    ephemeris->getState(10, et0, sun);
+    ephemeris->getState(399, et0, earth);
+    Vec3 toSun = glm::normalize(sun.r - earth.r);
+    double scale = AU / glm::length(sun.r - earth.r);
+
+    astro::ODE ode, ode_srp;
+    ode.addAttractor({ Vec3(0.0), 398600.0 });
+    ode_srp.addAttractor({ Vec3(0.0), 398600.0 });
+    ode_srp.setMass(100.0);
+    ode_srp.setSolarRadiationPressure(srp);
+
+    PosState lit(toSun * 7000.0, Vec3(0.0, 0.0, 7.5));
+    PosState dark(-toSun * 7000.0, Vec3(0.0, 0.0, 7.5));
+    Vec3 dLit  = ode_srp.rates(et0, lit).v - ode.rates(et0, lit).v;
+    Vec3 dDark = ode_srp.rates(et0, dark).v - ode.rates(et0, dark).v;
+
+    ASSERT_NEAR(glm::length(dLit), 4.56E-6 * 1.3 / 100.0 / 1000.0 * scale * scale, 1.0E-15);
+    ASSERT_LT(glm::dot(dLit, toSun), 0.0);
+    ASSERT_EQ(dDark, Vec3(0.0));
+}
@@ -189,3 +189,12 @@ TEST_F(ReferenceFrameTest, FromStringTest1)
 
     ASSERT_THROW(astro::ReferenceFrame err = astro::ReferenceFrame::fromString("TULL"), std::runtime_error);
 }
+
+TEST_F(ReferenceFrameTest, FromStringBodyFixed)
+{
+    astro::Spice().loadKernel("../data/spice/pck/pck00010.tpc");
+    astro::ReferenceFrame rf = astro::ReferenceFrame::fromString("IAU_EARTH");
+    ASSERT_EQ(rf.getType(), ReferenceFrameType::BodyFixedRotating);
+    ASSERT_EQ(rf.getCenterId(), 399);
+    ASSERT_TRUE(rf == astro::ReferenceFrame::createBodyFixedSpice(399));
+}
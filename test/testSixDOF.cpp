@@ -0,0 +1,165 @@
+#include "../astro/SixDOF.h"
+#include "../astro/RKF78.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class SixDOFTest : public ::testing::Test {
+
+protected:
+    SixDOFTest();
+
+    virtual ~SixDOFTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double   mu_earth;
+    PosState s0; // Circular, in the XY plane
+};
+
+
+
+SixDOFTest::SixDOFTest()
+  :  mu_earth(398600.4418)
+{
+    double r = 7000.0;
+    s0 = PosState(Vec3(r, 0.0, 0.0), Vec3(0.0, std::sqrt(mu_earth / r), 0.0));
+}
+
+SixDOFTest::~SixDOFTest()
+{
+
+}
+
+void SixDOFTest::SetUp()
+{
+}
+
+void SixDOFTest::TearDown()
+{
+}
+
+TEST_F(SixDOFTest, GravityGradientTorque)
+{
+    Mat3 Ib(0.0);
+    Ib[0][0] = 1.0;
+    Ib[1][1] = 4.0;
+    Ib[2][2] = 5.0;
+
+    // None along a principal axis
+    Vec3 t = gravityGradientTorque(Vec3(7000.0, 0.0, 0.0), mu_earth, Ib);
+    EXPECT_EQ(glm::length(t), 0.0);
+
+    // 3 GM / r^3 cos sin (Iy - Ix) about Z at 30 degrees
+    double a = 30.0 * std::acos(-1.0) / 180.0;
+    t = gravityGradientTorque(Vec3(7000.0 * std::cos(a), 7000.0 * std::sin(a), 0.0), mu_earth, Ib);
+    double expected = 3.0 * mu_earth / std::pow(7000.0, 3.0) * std::cos(a) * std::sin(a) * 3.0;
+    EXPECT_NEAR(t.z, expected, 1.0E-15);
+    EXPECT_NEAR(t.x, 0.0, 1.0E-20);
+}
+
+TEST_F(SixDOFTest, UncoupledMatchesSeparatePropagation)
+{
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+    RotODE rode;
+    SixDOF sixdof(ode, rode);
+
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.0, 0.0, 0.05));
+    EphemerisTime et0(0.0), et1(3000.0);
+    auto res = sixdof.doSteps(State(s0, rs), et0, et1, TimeDelta(60.0));
+
+    PosState ref = RKF78::propagateTo(ode, s0, et0, { et1 }, TimeDelta(60.0)).back();
+    EXPECT_LT(glm::length(res.back().s.P.r - ref.r), 1.0E-6);
+
+    // Translation takes large steps, the attitude many substeps
+    EXPECT_LT(res.size(), 40u);
+    double angle = 0.05 * 3000.0 * 0.5;
+    Quat   q     = res.back().s.R.q;
+    EXPECT_NEAR(std::abs(q.w), std::abs(std::cos(angle)), 1.0E-10);
+}
+
+TEST_F(SixDOFTest, ThrustFollowsSpinningBody)
+{
+    // Spinning about Z, with the thrust along body X
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+    ode.setMass(1000.0);
+    RotODE rode;
+    SixDOF sixdof(ode, rode);
+    Vec3 f(10.0, 0.0, 0.0); // [N], 1e-5 km/s^2
+    sixdof.setBodyForce(f);
+    sixdof.setAttitudeStep(TimeDelta(0.5));
+
+    double w = 0.02;
+    double T = 1000.0;
+    State  s(s0, RotState(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.0, 0.0, w)));
+    auto res = sixdof.doSteps(s, EphemerisTime(0.0), EphemerisTime(T), TimeDelta(60.0));
+
+    // Reference with the exact attitude, in small steps
+    auto rates = [&](double t, const PosState& x) {
+        PosState d = ode.rates(EphemerisTime(t), x);
+        d.v += Vec3(std::cos(w * t), std::sin(w * t), 0.0) * (f.x / (1000.0 * 1000.0));
+        return d;
+    };
+    PosState ref = s0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        PosState next;
+        double   h_next;
+        ASSERT_TRUE(RKF78::step(rates, ref, i * 1.0, 1.0, 1.0, next, h_next));
+        ref = next;
+    }
+
+    const PosState& p = res.back().s.P;
+    EXPECT_LT(glm::length(p.r - ref.r), 1.0E-6);
+    EXPECT_LT(glm::length(p.v - ref.v), 1.0E-9);
+    EXPECT_LT(res.size(), 100u);
+
+    // Far from the result with the thrust fixed in the inertial frame
+    sixdof.setAttitudeStep(TimeDelta(1.0));
+    State still(s0, RotState());
+    EXPECT_GT(glm::length(sixdof.doSteps(still, EphemerisTime(0.0), EphemerisTime(T), TimeDelta(60.0)).back().s.P.r - ref.r), 1.0);
+}
+
+TEST_F(SixDOFTest, GravityGradientLibration)
+{
+    ODE ode;
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+
+    // Long axis X, pitching about the orbit normal Z
+    Mat3 Ib(0.0);
+    Ib[0][0] = 1.0;
+    Ib[1][1] = 10.0;
+    Ib[2][2] = 10.0;
+    RotODE rode(Ib);
+    SixDOF sixdof(ode, rode);
+    sixdof.setGravityGradient(true);
+
+    // Pitched 5 degrees from the radial, turning at the orbit rate
+    double n      = std::sqrt(mu_earth / std::pow(7000.0, 3.0));
+    double theta0 = 5.0 * std::acos(-1.0) / 180.0;
+    RotState rs(Quat(std::cos(0.5 * theta0), 0.0, 0.0, std::sin(0.5 * theta0)), Vec3(0.0, 0.0, n));
+
+    // Half a period of the small pitch libration, n sqrt(3 (Iy - Ix) / Iz)
+    double wp = n * std::sqrt(3.0 * 9.0 / 10.0);
+    EphemerisTime et0(0.0), et1(std::acos(-1.0) / wp);
+    auto res = sixdof.doSteps(State(s0, rs), et0, et1, TimeDelta(60.0));
+
+    const State& sf = res.back().s;
+    Vec3   x     = sf.R.q * Vec3(1.0, 0.0, 0.0);
+    Vec3   rhat  = glm::normalize(sf.P.r);
+    double pitch = std::atan2(glm::cross(rhat, x).z, glm::dot(rhat, x));
+    EXPECT_NEAR(pitch, -theta0, 0.05 * theta0);
+
+    EXPECT_THROW(SixDOF(ODE(), rode).setGravityGradient(true), AstroException);
+}
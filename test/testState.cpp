@@ -277,14 +277,59 @@ TEST_F(StateTest, TransformRotationChanges)
     ASSERT_GT(glm::length(earthState.R.w - ship.R.w), 1.0E-4);
 }
 
+// The batch transform must agree with transforming one state at a time.
+TEST_F(StateTest, TransformTrajectoryMatchesSingle)
+{
+    ASSERT_NO_THROW(astro::Spice().loadKernel("../data/spice/lsk/naif0012.tls"));
+    ASSERT_NO_THROW(astro::Spice().loadKernel("../data/spice/pck/pck00010.tpc"));
 
+    astro::ReferenceFrame rfj2000 = astro::ReferenceFrame::createJ2000();
+    astro::ReferenceFrame rfearth = astro::ReferenceFrame::createBodyFixedSpice(399);
 
-   
-    
-    
-
-
-
-
-
-
+    // Two objects sampled at the same epochs
+    std::vector<astro::State> states;
+    std::vector<astro::EphemerisTime> ets;
+    for (int i = 0; i < 50; ++i)
+    {
+        for (int obj = 0; obj < 2; ++obj)
+        {
+            astro::State s;
+            s.P.r = Vec3(-6045.0 + 100.0 * obj, -3490.0 + i, 2500.0);
+            s.P.v = Vec3(-3.457, 6.618, 2.533 + 0.1 * obj);
+            s.R.q = glm::normalize(Quat(1.0, 0.5, 0.3 * obj, 0.2));
+            s.R.w = Vec3(0.01, 0.02, -0.005);
+            states.push_back(s);
+            ets.push_back(astro::EphemerisTime(1.0E6 + 60.0 * i));
+        }
+    }
+
+    std::vector<astro::State> earthStates;
+    astro::State::transformTrajectory(rfj2000, rfearth, states, ets, earthStates);
+    ASSERT_EQ(earthStates.size(), states.size());
+
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        astro::State single = states[i].transform(rfj2000, rfearth, ets[i]);
+        ASSERT_LT(glm::length(earthStates[i].P.r - single.P.r), 1.0E-9);
+        ASSERT_LT(glm::length(earthStates[i].P.v - single.P.v), 1.0E-12);
+        ASSERT_LT(glm::length(earthStates[i].R.w - single.R.w), 1.0E-14);
+        ASSERT_LT(glm::length(earthStates[i].R.q - single.R.q), 1.0E-14);
+    }
+
+    // And back again, translational states only, through a rotation cache
+    rfearth.enableRotationCache(astro::EphemerisTime(1.0E6), astro::EphemerisTime(1.0E6 + 3600.0), astro::TimeDelta(600.0));
+    std::vector<astro::PosState> earthPos, j2000Pos;
+    for (const auto& s : earthStates)
+        earthPos.push_back(s.P);
+    astro::State::transformTrajectory(rfearth, rfj2000, earthPos, ets, j2000Pos);
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        ASSERT_LT(glm::length(j2000Pos[i].r - states[i].P.r), 1.0E-5);
+        ASSERT_LT(glm::length(j2000Pos[i].v - states[i].P.v), 1.0E-8);
+    }
+
+    // Mismatched sizes and two rotating frames are refused
+    ASSERT_THROW(astro::State::transformTrajectory(rfearth, rfearth, states, ets, earthStates), astro::AstroException);
+    ets.pop_back();
+    ASSERT_THROW(astro::State::transformTrajectory(rfj2000, rfearth, states, ets, earthStates), astro::AstroException);
+}
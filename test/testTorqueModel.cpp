@@ -0,0 +1,219 @@
+#include "../astro/TorqueModel.h"
+#include "../astro/ODE.h"
+#include "../astro/LieGroup.h"
+#include "../astro/PCDM.h"
+#include "../astro/Exceptions.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class TorqueModelTest : public ::testing::Test {
+
+protected:
+    TorqueModelTest();
+
+    virtual ~TorqueModelTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double   mu_earth;
+    Mat3     Ib;
+    PosState s0;
+};
+
+
+
+TorqueModelTest::TorqueModelTest()
+  :  mu_earth(398600.4418), Ib(0.0)
+{
+    Ib[0][0] = 100.0;
+    Ib[1][1] = 400.0;
+    Ib[2][2] = 500.0;
+    s0 = PosState(Vec3(6778.137, 0.0, 0.0), Vec3(0.0, 7.6686, 0.0));
+}
+
+TorqueModelTest::~TorqueModelTest()
+{
+
+}
+
+void TorqueModelTest::SetUp()
+{
+}
+
+void TorqueModelTest::TearDown()
+{
+}
+
+// Counts the calls of each part
+class CountingTorque : public TorqueTerm
+{
+public:
+    virtual void prepare(const EphemerisTime&, const PosState&, TorqueEnvironment&) const { ++prepares; }
+    virtual Vec3 torque(const TorqueEnvironment&, const Quat&, const Vec3&, const Mat3&) const
+    {
+        ++torques;
+        return Vec3(0.0);
+    }
+
+    mutable int prepares = 0;
+    mutable int torques  = 0;
+};
+
+TEST_F(TorqueModelTest, GravityGradient)
+{
+    RotODE rode(Ib);
+    rode.addTorqueTerm(GravityGradientTorque(mu_earth));
+
+    // Body X turned 30 degrees from the radial, about Z
+    double a = 30.0 * std::acos(-1.0) / 180.0;
+    RotState rs(Quat(std::cos(0.5 * a), 0.0, 0.0, std::sin(0.5 * a)), Vec3(0.0));
+    EXPECT_THROW(rode.rates(EphemerisTime(0.0), rs), AstroException);
+
+    rode.setPositionSource([this](const EphemerisTime&) { return s0; });
+    TorqueStep step;
+    rode.prepare(EphemerisTime(0.0), EphemerisTime(0.0), step);
+    Vec3 t = rode.bodyTorque(rs, step);
+
+    // Restoring: 3 n^2 (Iy - Ix) cos sin, turning X back to the radial
+    double n2 = mu_earth / std::pow(6778.137, 3.0);
+    EXPECT_NEAR(t.z, -3.0 * n2 * 300.0 * std::cos(a) * std::sin(a), 1.0E-15);
+    EXPECT_NEAR(t.x, 0.0, 1.0E-18);
+    EXPECT_NEAR(t.y, 0.0, 1.0E-18);
+
+    // Angular acceleration about Z
+    EXPECT_NEAR(rode.rates(EphemerisTime(0.0), rs).w.z, t.z / 500.0, 1.0E-18);
+
+    // Unprepared
+    EXPECT_THROW(rode.bodyTorque(rs, TorqueStep()), AstroException);
+
+    rode.clearTorqueTerms();
+    EXPECT_EQ(glm::length(rode.bodyTorque(rs, TorqueStep())), 0.0);
+}
+
+TEST_F(TorqueModelTest, SeveralTermsOfOneKind)
+{
+    // Gravity gradients of the Earth and of a Moon 384400 km away along Y
+    double mu_moon = 4902.800066;
+    Vec3   moon(0.0, 384400.0, 0.0);
+    double a = 30.0 * std::acos(-1.0) / 180.0;
+    RotState rs(Quat(std::cos(0.5 * a), 0.0, 0.0, std::sin(0.5 * a)), Vec3(0.0));
+
+    RotODE earthOnly(Ib), moonOnly(Ib), both(Ib);
+    earthOnly.addTorqueTerm(GravityGradientTorque(mu_earth));
+    moonOnly.addTorqueTerm(GravityGradientTorque(mu_moon, moon));
+    both.addTorqueTerm(GravityGradientTorque(mu_earth));
+    both.addTorqueTerm(GravityGradientTorque(mu_moon, moon));
+    TorqueStep steps[3];
+    RotODE*    rodes[3] = { &earthOnly, &moonOnly, &both };
+    for (int i = 0; i < 3; ++i)
+    {
+        rodes[i]->setPositionSource([this](const EphemerisTime&) { return s0; });
+        rodes[i]->prepare(EphemerisTime(0.0), EphemerisTime(0.0), steps[i]);
+    }
+
+    Vec3 te = earthOnly.bodyTorque(rs, steps[0]);
+    Vec3 tm = moonOnly.bodyTorque(rs, steps[1]);
+    EXPECT_GT(glm::length(tm), 0.0);
+    EXPECT_NEAR(glm::length(both.bodyTorque(rs, steps[2]) - (te + tm)), 0.0, 1.0E-18);
+}
+
+TEST_F(TorqueModelTest, Aerodynamic)
+{
+    auto atm = std::make_shared<ExponentialAtmosphere>();
+    Vec3 cp(0.5, 0.0, 0.0);
+    AerodynamicTorque aero(atm, 2.2, 4.0, cp, Vec3(0.0));
+
+    TorqueEnvironment env;
+    aero.prepare(EphemerisTime(0.0), s0, env);
+    EXPECT_EQ(env.density, atm->density(s0.r, EphemerisTime(0.0)));
+
+    // Flow along -Y, the force along -Y acts at +X: torque about -Z
+    Vec3   t = aero.torque(env, Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.0), Ib);
+    double v = 7668.6;
+    EXPECT_NEAR(t.z, -0.5 * 0.5 * env.density * 2.2 * 4.0 * v * v, 1.0E-15);
+
+    // Turned 90 degrees about Z, the flow is along body +X, through cp
+    double c = std::sqrt(0.5);
+    t = aero.torque(env, Quat(c, 0.0, 0.0, c), Vec3(0.0), Ib);
+    EXPECT_NEAR(glm::length(t), 0.0, 1.0E-18);
+
+    EXPECT_THROW(AerodynamicTorque(nullptr, 2.2, 4.0, cp), AstroException);
+    EXPECT_THROW(SRPTorque(nullptr, 1.3, 4.0, cp), AstroException);
+}
+
+TEST_F(TorqueModelTest, MagneticDipole)
+{
+    MagneticTorque mag(Vec3(0.0, 0.0, 1.0));
+
+    // North along the equator, down into the Earth at the north pole
+    Vec3 B = mag.field(Vec3(6378.137, 0.0, 0.0));
+    EXPECT_NEAR(B.z, 3.12E-5, 1.0E-18);
+    B = mag.field(Vec3(0.0, 0.0, 2.0 * 6378.137));
+    EXPECT_NEAR(B.z, -2.0 * 3.12E-5 / 8.0, 1.0E-18);
+
+    // m x B, for a dipole along body Z and the body turned 90 degrees about X
+    TorqueEnvironment env;
+    mag.prepare(EphemerisTime(0.0), s0, env);
+    double c = std::sqrt(0.5);
+    Vec3   t = mag.torque(env, Quat(c, c, 0.0, 0.0), Vec3(0.0), Ib);
+    Vec3   Bb = Quat(c, -c, 0.0, 0.0) * env.B;
+    EXPECT_NEAR(t.x, glm::cross(Vec3(0.0, 0.0, 1.0), Bb).x, 1.0E-16);
+    EXPECT_GT(std::abs(t.x), 1.0E-6);
+}
+
+TEST_F(TorqueModelTest, PreparedOncePerStep)
+{
+    auto counter = std::make_shared<CountingTorque>();
+    RotODE rode(Ib);
+    rode.addTorqueTerm(counter);
+    std::vector<double> times;
+    rode.setPositionSource([&](const EphemerisTime& et) {
+        times.push_back(et.getETValue());
+        return s0;
+    });
+
+    RotState rs(Quat(1.0, 0.0, 0.0, 0.0), Vec3(0.01, 0.02, 0.0));
+    EphemerisTime et(0.0);
+    for (int i = 0; i < 10; ++i)
+    {
+        rs = RKMK4::doStep(rode, rs, et, TimeDelta(1.0)).rs;
+        et = et + TimeDelta(1.0);
+    }
+    EXPECT_EQ(counter->prepares, 10);
+    EXPECT_EQ(counter->torques, 40);
+
+    // Once per step, at the middle of the step, in each integrator's doSteps
+    times.clear();
+    RKMK4::doSteps(rode, rs, EphemerisTime(0.0), EphemerisTime(10.0), TimeDelta(2.0));
+    ASSERT_EQ(times.size(), 5u);
+    EXPECT_EQ(times[4], 9.0);
+
+    times.clear();
+    PCDM::doSteps(rode, rs, EphemerisTime(0.0), EphemerisTime(10.0), TimeDelta(2.0));
+    EXPECT_EQ(times.size(), 5u);
+
+    times.clear();
+    auto adaptive = PCDM::doAdaptiveSteps(rode, rs, EphemerisTime(0.0), EphemerisTime(10.0), TimeDelta(2.0));
+    int tries = 0;
+    for (size_t i = 1; i < adaptive.size(); ++i)
+        tries += adaptive[i].numTries;
+    EXPECT_EQ(times.size(), 3u * tries); // One step and two half steps each
+
+    Mat3 diag(0.0);
+    diag[0][0] = 1.0;
+    diag[1][1] = 2.0;
+    diag[2][2] = 3.0;
+    rode.setInertialMatrix(diag);
+    times.clear();
+    RigidBodySplitting::doSteps(rode, rs, EphemerisTime(0.0), EphemerisTime(10.0), TimeDelta(2.0));
+    EXPECT_EQ(times.size(), 5u);
+}
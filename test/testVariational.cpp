@@ -0,0 +1,172 @@
+#include "../astro/Variational.h"
+#include "../astro/ODE.h"
+#include "../astro/RKF78.h"
+#include "../astro/Atmosphere.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace astro;
+
+class VariationalTest : public ::testing::Test {
+
+protected:
+    VariationalTest();
+
+    virtual ~VariationalTest();
+
+    // Code here will be called immediately after the constructor (right
+    // before each test).
+    virtual void SetUp();
+
+    // Code here will be called immediately after each test (right
+    // before the destructor).
+    virtual void TearDown();
+
+    double mu_earth;
+    double re;
+    astro::ODE ode;
+};
+
+
+
+VariationalTest::VariationalTest()
+  :  mu_earth(398600.4418), re(6378.137)
+{
+    ode.addAttractor({ Vec3(0.0), mu_earth });
+}
+
+VariationalTest::~VariationalTest()
+{
+
+}
+
+void VariationalTest::SetUp()
+{
+    RKF78::setTolerance(1.0E-12);
+}
+
+void VariationalTest::TearDown()
+{
+    RKF78::setTolerance(1.0E-8);
+}
+
+TEST_F(VariationalTest, Mat6)
+{
+    Mat6 a;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            a(i, j) = i * 6 + j;
+
+    Mat3 b = a.block(1, 0);
+    EXPECT_DOUBLE_EQ(b[0][0], a(3, 0));
+    EXPECT_DOUBLE_EQ(b[2][1], a(4, 2)); // column 2, row 1
+
+    Mat6 c;
+    c.setBlock(1, 0, b);
+    EXPECT_EQ(c.block(1, 0), b);
+
+    Mat6 p = a * Mat6(1.0);
+    Mat6 t = a.transpose();
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+        {
+            EXPECT_DOUBLE_EQ(p(i, j), a(i, j));
+            EXPECT_DOUBLE_EQ(t(i, j), a(j, i));
+        }
+
+    PosState x(Vec3(1.0, 0.0, 0.0), Vec3(0.0, 0.0, 1.0));
+    PosState y = a * x;
+    EXPECT_DOUBLE_EQ(y.r.y, a(1, 0) + a(1, 5));
+    EXPECT_DOUBLE_EQ(y.v.z, a(5, 0) + a(5, 5));
+    EXPECT_DOUBLE_EQ(maxNorm(a), 35.0);
+}
+
+// Analytic partials against central differences of the accelerations
+TEST_F(VariationalTest, PartialsMatchDifferences)
+{
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, re, { 1.08262668E-3, -2.53265649E-6, -1.61962159E-6 }));
+    ode.setMass(500.0);
+    ode.setDrag(std::make_shared<ExponentialAtmosphere>(), 2.2, 4.0);
+    ode.setForce(Vec3(1.0E-3, 0.0, 0.0));
+
+    PosState      s(Vec3(4000.0, -3500.0, 4200.0), Vec3(-4.0, 2.0, 5.5));
+    EphemerisTime et(0.0);
+    Mat3 dadr, dadv;
+    ode.partials(et, s, dadr, dadv);
+
+    for (int j = 0; j < 3; ++j)
+    {
+        double   hr = 1.0E-3, hv = 1.0E-5;
+        PosState p = s, m = s;
+        p.r[j] += hr;
+        m.r[j] -= hr;
+        Vec3 dr = (ode.rates(et, p).v - ode.rates(et, m).v) / (2.0 * hr);
+        p = s;
+        m = s;
+        p.v[j] += hv;
+        m.v[j] -= hv;
+        Vec3 dv = (ode.rates(et, p).v - ode.rates(et, m).v) / (2.0 * hv);
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_NEAR(dadr[j][i], dr[i], 1.0E-6 * std::abs(dr[i]) + 1.0E-14);
+            EXPECT_NEAR(dadv[j][i], dv[i], 1.0E-5 * std::abs(dv[i]) + 1.0E-12);
+        }
+    }
+
+    // The drag is the only velocity dependent term
+    EXPECT_LT(dadv[0][0], 0.0);
+}
+
+// STM against finite differences of full propagations
+TEST_F(VariationalTest, STMMatchesDifferences)
+{
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, re, { 1.08262668E-3 }));
+
+    PosState s(Vec3(7000.0, 0.0, 0.0), Vec3(0.0, 6.5, 3.5));
+    EphemerisTime et0(0.0);
+    EphemerisTime et1(2500.0);
+
+    auto res = Variational::doSteps(ode, s, et0, et1, TimeDelta(60.0));
+    ASSERT_EQ(res.back().et, et1);
+
+    // The state matches a plain propagation
+    auto ref = RKF78::doSteps(ode, s, et0, et1, TimeDelta(60.0));
+    EXPECT_NEAR(glm::length(res.back().s.r - ref.back().s.r), 0.0, 1.0E-6);
+
+    const Mat6& phi = res.back().phi;
+    for (int j = 0; j < 6; ++j)
+    {
+        double   h = (j < 3) ? 1.0E-2 : 1.0E-5;
+        PosState p = s, m = s;
+        if (j < 3) { p.r[j] += h; m.r[j] -= h; }
+        else       { p.v[j - 3] += h; m.v[j - 3] -= h; }
+        PosState sp = RKF78::doSteps(ode, p, et0, et1, TimeDelta(60.0)).back().s;
+        PosState sm = RKF78::doSteps(ode, m, et0, et1, TimeDelta(60.0)).back().s;
+        PosState d  = (sp - sm) * (1.0 / (2.0 * h));
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_NEAR(phi(i, j), d.r[i], 1.0E-5 * maxNorm(d) + 1.0E-9);
+            EXPECT_NEAR(phi(i + 3, j), d.v[i], 1.0E-5 * maxNorm(d) + 1.0E-9);
+        }
+    }
+}
+
+// For conservative forces the STM is symplectic: phi^T J phi = J
+TEST_F(VariationalTest, STMSymplectic)
+{
+    ode.addForceTerm(ZonalHarmonicsForce(mu_earth, re, { 1.08262668E-3, -2.53265649E-6 }));
+
+    PosState s(Vec3(-6000.0, 3000.0, 1000.0), Vec3(-2.0, -5.5, 4.0));
+    auto res = Variational::doSteps(ode, s, EphemerisTime(0.0), EphemerisTime(6000.0), TimeDelta(60.0));
+
+    Mat6 J;
+    J.setBlock(0, 1, Mat3(1.0));
+    J.setBlock(1, 0, Mat3(-1.0));
+
+    const Mat6& phi = res.back().phi;
+    Mat6 K = phi.transpose() * J * phi;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 6; ++j)
+            EXPECT_NEAR(K(i, j), J(i, j), 1.0E-8 * maxNorm(phi) * maxNorm(phi));
+}